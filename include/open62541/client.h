@@ -171,6 +171,16 @@ struct UA_ClientConfig {
     UA_UInt32 connectivityCheckInterval;     /* Connectivity check interval in ms.
                                               * 0 = background task disabled */
 
+    /* Batching of async operations. The single-operation async Read, Write and
+     * Call functions from client_highlevel_async.h collect their operations for
+     * up to batchingWindow ms (0 = batching disabled). Then the operations of a
+     * service are sent in one request and the results are split up again for
+     * the callbacks. A batch is sent early when it reaches
+     * batchingMaxOperations (0 = unlimited) or the operation limit of the
+     * server. The operations of a batch share the requestId of the request. */
+    UA_Double batchingWindow;
+    UA_UInt32 batchingMaxOperations;
+
     /* EventLoop */
     UA_EventLoop *eventLoop;
     UA_Boolean externalEventLoop; /* The EventLoop is not deleted with the config */
@@ -217,6 +227,13 @@ struct UA_ClientConfig {
     /* Number of PublishResponse queued up in the server */
     UA_UInt16 outStandingPublishRequests;
 
+    /* Decode the PublishResponses into memory that is reused by the client.
+     * Strings and arrays of the notifications point directly into the receive
+     * buffer. This avoids heap allocations for every notification. The values
+     * handed to the DataChange, Event and StatusChange callbacks are then only
+     * valid until the callback returns. They must be copied to keep them. */
+    UA_Boolean zeroCopyNotifications;
+
     /* If the client does not receive a PublishResponse after the defined delay
      * of ``(sub->publishingInterval * sub->maxKeepAliveCount) +
      * client->config.timeout)``, then subscriptionInactivityCallback is called
@@ -512,6 +512,50 @@ UA_EXPORT UA_THREADSAFE UA_BrowsePathResult
 UA_Client_translateBrowsePathToNodeIds(UA_Client *client,
                                        const UA_BrowsePath *browsePath);
 
+/**
+ * Crawling
+ * ^^^^^^^^
+ *
+ * The crawler browses the address space from a set of start nodes. The targets
+ * of the returned references are browsed in turn. Every node is browsed only
+ * once. Several nodes are browsed with each request and several requests are
+ * kept in flight. Continuation points are followed with BrowseNext. The
+ * results are handed to the callback as they arrive and are not accumulated in
+ * memory. Only the queue of the nodes that remain to be browsed and the set of
+ * the already visited NodeIds are kept.
+ *
+ * Targets on other servers (with a ServerIndex) are not followed. */
+
+typedef struct {
+    /* Template for the BrowseDescription of every node (the NodeId is
+     * ignored). Use the HierarchicalReferences with subtypes to crawl the
+     * tree of the address space. */
+    UA_BrowseDescription browseDescription;
+    UA_ViewDescription view;
+    UA_UInt32 requestedMaxReferencesPerNode; /* 0 -> the server decides */
+    size_t maxNodesPerRequest;  /* 0 -> 100 */
+    size_t maxRequestsInFlight; /* 0 -> 4 */
+} UA_ClientCrawlSettings;
+
+/* Called for the result of every browsed node. A node with continuation
+ * points is reported once for the Browse and once for each BrowseNext
+ * response. Return false to stop the crawl. */
+typedef UA_Boolean
+(*UA_ClientCrawlCallback)(UA_Client *client, void *context,
+                          const UA_NodeId *nodeId,
+                          const UA_BrowseResult *result);
+
+/* Runs until all reachable nodes are browsed or the callback stops the crawl.
+ * If the server returns an error for a request, the error is reported as the
+ * result of its nodes and the crawl continues. If a request cannot be sent
+ * (e.g. the connection was lost), the crawl stops and the error is returned.
+ * The callback is called from within the EventLoop of the client and must not
+ * use the synchronous services. */
+UA_EXPORT UA_THREADSAFE UA_StatusCode
+UA_Client_crawl(UA_Client *client, const UA_ClientCrawlSettings *settings,
+                size_t startNodesSize, const UA_NodeId *startNodes,
+                UA_ClientCrawlCallback callback, void *context);
+
 /**
  * Node Management
  * ~~~~~~~~~~~~~~~
@@ -0,0 +1,88 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_CLIENT_POOL_H_
+#define UA_CLIENT_POOL_H_
+
+#include <open62541/client.h>
+
+_UA_BEGIN_DECLS
+
+/**
+ * .. _client-pool:
+ *
+ * Client Pool
+ * -----------
+ *
+ * A single client serializes all requests through one SecureChannel and
+ * Session. The client pool opens several connections with their own
+ * SecureChannel and Session to the same server. The operations of large Read,
+ * Browse and HistoryRead requests are split into chunks that are spread over
+ * the connections and sent in parallel. The results are collected into a
+ * single response in the order of the request.
+ *
+ * Continuation points are only valid for the Session that created them.
+ * Therefore the pool follows them internally (with BrowseNext and HistoryRead)
+ * on the same connection and appends the results. The responses of the pool
+ * contain no continuation points.
+ *
+ * All clients of the pool must use the same EventLoop. The pool functions are
+ * synchronous and run the EventLoop until all responses have been received.
+ * ``UA_ClientPool_newDefault`` from ``client_config_default.h`` creates a pool
+ * of clients with the default configuration. */
+
+typedef struct UA_ClientPool UA_ClientPool;
+
+/* Creates an empty pool. The operations of a request are split up evenly over
+ * the connected clients. With maxOperationsPerRequest set, the chunks are
+ * smaller and several chunks are sent per client. */
+UA_EXPORT UA_ClientPool *
+UA_ClientPool_new(size_t maxOperationsPerRequest);
+
+/* Adds a client to the pool. The pool takes ownership of the client. All
+ * clients must use the EventLoop of the first client. The clients are deleted
+ * in the reverse order of adding them. So the first client can own the
+ * EventLoop. */
+UA_EXPORT UA_StatusCode
+UA_ClientPool_addClient(UA_ClientPool *pool, UA_Client *client);
+
+/* Disconnects and deletes all clients */
+UA_EXPORT void
+UA_ClientPool_delete(UA_ClientPool *pool);
+
+UA_EXPORT size_t
+UA_ClientPool_getSize(const UA_ClientPool *pool);
+
+/* Returns NULL if the index is out of range. The clients can be accessed to
+ * adjust their configuration (e.g. security settings or the user identity)
+ * before connecting. */
+UA_EXPORT UA_Client *
+UA_ClientPool_getClient(UA_ClientPool *pool, size_t index);
+
+/* Connects all clients to the endpoint. Returns the first error. */
+UA_EXPORT UA_StatusCode
+UA_ClientPool_connect(UA_ClientPool *pool, const char *endpointUrl);
+
+UA_EXPORT void
+UA_ClientPool_disconnect(UA_ClientPool *pool);
+
+/* The chunks are sent on the connected clients only. If the request for a
+ * chunk fails, the error is set as the status of its operations. The
+ * ServiceResult is only bad if no chunk succeeded. */
+
+UA_EXPORT UA_ReadResponse
+UA_ClientPool_read(UA_ClientPool *pool, const UA_ReadRequest *request);
+
+UA_EXPORT UA_BrowseResponse
+UA_ClientPool_browse(UA_ClientPool *pool, const UA_BrowseRequest *request);
+
+/* The continuation points are followed for results with HistoryData,
+ * HistoryModifiedData and HistoryEvent. */
+UA_EXPORT UA_HistoryReadResponse
+UA_ClientPool_historyRead(UA_ClientPool *pool, const UA_HistoryReadRequest *request);
+
+_UA_END_DECLS
+
+#endif /* UA_CLIENT_POOL_H_ */
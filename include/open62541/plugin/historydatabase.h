@@ -128,8 +128,9 @@ struct UA_HistoryDatabase {
                UA_HistoryReadResponse *response,
                UA_HistoryEvent * const * const historyData);
 
-    /* No default implementation is provided by UA_HistoryDatabase_default
-     * for the following function */
+    /* This function is called for the ReadProcessed operation with the
+     * aggregates of OPC UA Part 13. UA_HistoryDatabase_default computes the
+     * standard aggregates from the low level API of the backends. */
     void
     (*readProcessed)(UA_Server *server,
                void *hdbContext,
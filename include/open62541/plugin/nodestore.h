@@ -315,10 +315,15 @@ UA_NodePointer_toNodeId(UA_NodePointer np);
  * not known or not important. The ``nodeClass`` attribute is used to ensure the
  * correctness of casting from ``UA_Node`` to a specific node type. */
 
+/* The reference target keeps a summary of the target node attributes that
+ * cannot change after the node was created. Browse uses them to filter and
+ * describe the targets without getting the target node from the Nodestore. */
 typedef struct {
     UA_NodePointer targetId;  /* Has to be the first entry */
     UA_UInt32 targetNameHash; /* Hash of the target's BrowseName. Set to zero
                                * if the target is remote. */
+    UA_NodeClass targetNodeClass; /* NodeClass of the target. Unspecified if the
+                                   * target is remote or not known. */
 } UA_ReferenceTarget;
 
 typedef struct UA_ReferenceTargetTreeElem {
@@ -871,12 +876,21 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst);
 UA_EXPORT UA_Node *
 UA_Node_copy_alloc(const UA_Node *src);
 
-/* Add a single reference to the node */
+/* Add a single reference to the node. The NodeClass of the target is stored
+ * as unspecified. */
 UA_StatusCode UA_EXPORT
 UA_Node_addReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
                      const UA_ExpandedNodeId *targetNodeId,
                      UA_UInt32 targetBrowseNameHash);
 
+/* Add a single reference to the node. The BrowseName hash and the NodeClass of
+ * the target are stored with the reference. */
+UA_StatusCode UA_EXPORT
+UA_Node_addReference_ex(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
+                        const UA_ExpandedNodeId *targetNodeId,
+                        UA_UInt32 targetBrowseNameHash,
+                        UA_NodeClass targetNodeClass);
+
 /* Delete a single reference from the node */
 UA_StatusCode UA_EXPORT
 UA_Node_deleteReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
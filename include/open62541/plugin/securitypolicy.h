@@ -355,7 +355,20 @@ struct UA_SecurityPolicy {
  *
  * For PubSub encryption, the message nonce is part of the (unencrypted)
  * SecurityHeader. The nonce is required for the de- and encryption and has to
- * be set in the channel context before de/encrypting. */
+ * be set in the channel context before de/encrypting.
+ *
+ * Subscribers can hand several received messages to the policy at once. Each
+ * message is described by the ranges of its buffer to be verified and
+ * decrypted (in-place). Empty ranges are skipped. The result of each message is
+ * written to its status field. */
+
+typedef struct {
+    UA_ByteString signedPart;    /* Content the signature is computed over */
+    UA_ByteString signature;     /* Empty if the message is not signed */
+    UA_ByteString messageNonce;  /* From the SecurityHeader */
+    UA_ByteString encryptedPart; /* Empty if the message is not encrypted */
+    UA_StatusCode status;
+} UA_PubSubSecuredMessage;
 
 struct UA_PubSubSecurityPolicy;
 typedef struct UA_PubSubSecurityPolicy UA_PubSubSecurityPolicy;
@@ -395,6 +408,14 @@ struct UA_PubSubSecurityPolicy {
                        const UA_ByteString *nonce)
     UA_FUNC_ATTR_WARN_UNUSED_RESULT;
 
+    /* Verify and decrypt a batch of received messages with the keys of the
+     * context. The message nonce is taken from each message and the nonce set
+     * in the context is left untouched. Optional, can be NULL. Then
+     * setMessageNonce, verify and decrypt are called for every message. */
+    void
+    (*verifyAndDecryptBatch)(void *wgContext, size_t messagesSize,
+                             UA_PubSubSecuredMessage *messages);
+
     const UA_Logger *logger;
 
     /* Deletes the dynamic content of the policy */
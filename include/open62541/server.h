@@ -238,6 +238,13 @@ struct UA_ServerConfig {
     /* Limits for Requests */
     UA_UInt32 maxReferencesPerNode;
 
+    /* Number of resolved browse paths (TranslateBrowsePathsToNodeIds and
+     * UA_Server_browseSimplifiedBrowsePath) that are cached. The least recently
+     * used entries are evicted. Adding or deleting nodes or references
+     * invalidates the entries that visited the affected nodes. Paths starting
+     * at an event are not cached. 0 disables the cache. */
+    UA_UInt32 browsePathCacheSize;
+
 #ifdef UA_ENABLE_ENCRYPTION
     /* Limits for TrustList */
     UA_UInt32 maxTrustListSize; /* in bytes, 0 => unlimited */
@@ -1555,6 +1562,28 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
                        const UA_NodeId originId, UA_ByteString *outEventId,
                        const UA_Boolean deleteEventNode);
 
+/* Emits an event without creating a node representation. The event fields are
+ * taken from the key-value map. The key is the BrowsePath of the field
+ * relative to the event, e.g. ``UA_QUALIFIEDNAME(0, "Severity")``. The
+ * elements of a nested path are separated by a slash and share the namespace
+ * index of the key, e.g. ``UA_QUALIFIEDNAME(0, "EnabledState/Id")``. Only the
+ * Value attribute of the fields can be selected. The standard fields
+ * `EventId`, `EventType` and `SourceNode` are set automatically. `Time` and
+ * `ReceiveTime` are set to the current time if they are not in the map. The
+ * information model is not modified, so this is much faster for frequent
+ * events. Conditions cannot be emitted this way.
+ *
+ * @param server The server object
+ * @param eventType The type of the event. Must be a subtype of BaseEventType.
+ * @param originId The node that emits the event
+ * @param eventFields The field values of the event. Can be NULL.
+ * @param outEventId The EventId of the new event. Can be NULL.
+ * @return The StatusCode of the UA_Server_emitEvent method */
+UA_StatusCode UA_EXPORT UA_THREADSAFE
+UA_Server_emitEvent(UA_Server *server, const UA_NodeId eventType,
+                    const UA_NodeId originId, const UA_KeyValueMap *eventFields,
+                    UA_ByteString *outEventId);
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
 
 /**
@@ -1845,9 +1874,17 @@ UA_Server_setAsyncOperationResult(UA_Server *server,
  * Statistic counters keeping track of the current state of the stack. Counters
  * are structured per OPC UA communication layer. */
 
+typedef struct {
+    size_t currentEntries;
+    size_t hitCount;
+    size_t missCount;
+    size_t invalidationCount; /* Outdated entries removed after changes */
+} UA_BrowsePathCacheStatistics;
+
 typedef struct {
    UA_SecureChannelStatistics scs;
    UA_SessionStatistics ss;
+   UA_BrowsePathCacheStatistics bpcs;
 } UA_ServerStatistics;
 
 UA_ServerStatistics UA_EXPORT
@@ -296,6 +296,16 @@ UA_Server_processPubSubConnectionReceive(UA_Server *server,
                                          const UA_NodeId connectionId,
                                          const UA_ByteString packet);
 
+/* Inject several packets at once. The headers of the packets are decoded first.
+ * Then the packets for the same ReaderGroup are verified and decrypted with a
+ * single call into the PubSubSecurityPolicy. The packets are decrypted in
+ * place. So their content is modified. */
+UA_EXPORT UA_StatusCode UA_THREADSAFE
+UA_Server_processPubSubConnectionReceiveBatch(UA_Server *server,
+                                              const UA_NodeId connectionId,
+                                              size_t packetsSize,
+                                              UA_ByteString *packets);
+
 /* Returns a deep copy of the config */
 UA_StatusCode UA_EXPORT UA_THREADSAFE
 UA_Server_getPubSubConnectionConfig(UA_Server *server,
@@ -491,6 +501,16 @@ typedef struct {
     UA_PubSubSecurityPolicy *securityPolicy;
     UA_String securityGroupId;
 
+    /* Fixed-layout publish path for unsecured UADP messages. The NetworkMessage
+     * is encoded once (see UA_Server_computeWriterGroupOffsetTable) if all
+     * DataSetMessages fit into it and all fields have a fixed-size scalar type.
+     * In every publish cycle only the sequence numbers, timestamps and field
+     * values are patched into the encoded message before sending. Fields with
+     * an external value backend are read without allocations. Configure a
+     * static send buffer for the ConnectionManager (the "send-bufsize"
+     * parameter) to avoid allocations for the network buffer as well. */
+    UA_Boolean fixedLayout;
+
     UA_PUBSUB_COMPONENT_CONTEXT /* Context Configuration */
 } UA_WriterGroupConfig;
 
@@ -569,6 +589,12 @@ typedef struct {
     UA_String name;
     UA_UInt16 dataSetWriterId;
     UA_DataSetFieldContentMask dataSetFieldContentMask;
+
+    /* Number of DataSetMessages from one KeyFrame to the next, including the
+     * KeyFrame. The messages in between are DeltaFrames that contain only the
+     * fields whose value has changed since the last message. With 0 or 1 only
+     * KeyFrames are sent. DeltaFrames require the enableDeltaFrames option of
+     * the PubSub configuration and are not used for the RawData encoding. */
     UA_UInt32 keyFrameCount;
     UA_ExtensionObject messageSettings;
     UA_ExtensionObject transportSettings;
@@ -789,6 +815,15 @@ typedef struct {
     UA_PubSubSecurityPolicy *securityPolicy;
     UA_String securityGroupId;
 
+    /* Fixed-layout receive path for unsecured UADP messages. The layout of the
+     * NetworkMessage is precomputed from the offset table (see
+     * UA_Server_computeReaderGroupOffsetTable) if all fields of the
+     * DataSetReaders have a fixed-size scalar type. A received message is
+     * compared against the template and the field values are written to the
+     * TargetVariables directly from the buffer. Messages that do not match the
+     * template take the normal decoding path. */
+    UA_Boolean fixedLayout;
+
     UA_PUBSUB_COMPONENT_CONTEXT /* Context Configuration */
 } UA_ReaderGroupConfig;
 
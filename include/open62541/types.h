@@ -1439,6 +1439,12 @@ typedef struct {
      * memory is not freed if decoding fails afterwards. */
     void *callocContext;
     void * (*calloc)(void *callocContext, size_t nelem, size_t elsize);
+
+    /* Only together with the calloc override: Arrays of types with the same
+     * memory layout as their binary encoding (e.g. the content of strings)
+     * point into the input buffer instead of being copied. The decoded value
+     * must not be used after the input buffer is freed. */
+    UA_Boolean zeroCopy;
 } UA_DecodeBinaryOptions;
 
 /* Decodes a data structure from the input buffer in the binary format. It is
@@ -52,6 +52,11 @@ typedef struct {
     UA_Byte encryptingKey[UA_AES128CTR_KEY_LENGTH];
     UA_Byte keyNonce[UA_AES128CTR_KEYNONCE_LENGTH];
     UA_Byte messageNonce[UA_AES128CTR_MESSAGENONCE_LENGTH];
+
+    /* The cipher state is derived from the keys once and reused for every
+     * message until the keys are replaced */
+    mbedtls_aes_context aesContext;
+    mbedtls_md_context_t hmacContext;
 } PUBSUB_AES128CTR_ChannelContext;
 
 /*******************/
@@ -70,13 +75,12 @@ verify_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
-    PUBSUB_AES128CTR_PolicyContext *pc =
-        (PUBSUB_AES128CTR_PolicyContext *)cc->policyContext;
-
+    /* The signing key is already loaded into the HMAC context. Resetting
+     * restores the state after the key setup. */
     unsigned char mac[UA_SHA256_LENGTH];
-    UA_ByteString signingKey =
-        {UA_AES128CTR_SIGNING_KEY_LENGTH, cc->signingKey};
-    if(mbedtls_hmac(&pc->sha256MdContext, &signingKey, message, mac) != UA_STATUSCODE_GOOD)
+    if(mbedtls_md_hmac_reset(&cc->hmacContext) != 0 ||
+       mbedtls_md_hmac_update(&cc->hmacContext, message->data, message->length) != 0 ||
+       mbedtls_md_hmac_finish(&cc->hmacContext, mac) != 0)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
     /* Compare with Signature */
@@ -91,10 +95,9 @@ sign_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     if(signature->length != UA_SHA256_LENGTH)
         return UA_STATUSCODE_BADINTERNALERROR;
 
-    UA_ByteString signingKey =
-        {UA_AES128CTR_SIGNING_KEY_LENGTH, cc->signingKey};
-    if(mbedtls_hmac(&cc->policyContext->sha256MdContext, &signingKey, 
-                    message, signature->data) != UA_STATUSCODE_GOOD)
+    if(mbedtls_md_hmac_reset(&cc->hmacContext) != 0 ||
+       mbedtls_md_hmac_update(&cc->hmacContext, message->data, message->length) != 0 ||
+       mbedtls_md_hmac_finish(&cc->hmacContext, signature->data) != 0)
         return UA_STATUSCODE_BADSECURITYCHECKSFAILED;
 
     return UA_STATUSCODE_GOOD;
@@ -125,50 +128,70 @@ getPlainTextBlockSize_sp_pubsub_aes128ctr(const void *channelContext) {
     return UA_AES128CTR_PLAIN_TEXT_BLOCK_SIZE;
 }
 
+/* CTR mode does not need padding. The counter block is built from the key
+ * nonce and the message nonce. Block counter starts at 1 according to part 14
+ * (7.2.2.4.3.2). */
 static UA_StatusCode
-encrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
-                            UA_ByteString *data) {
-    if(cc == NULL || data == NULL)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
-    /* CTR mode does not need padding */
-
-    /* Decode the header to Extract the message nonce */
-
-    /* Keylength in bits */
-    unsigned int keylength = (unsigned int)(UA_AES128CTR_KEY_LENGTH * 8);
-    mbedtls_aes_context aesContext;
-    int mbedErr = mbedtls_aes_setkey_enc(&aesContext, cc->encryptingKey, keylength);
-    if(mbedErr)
-        return UA_STATUSCODE_BADINTERNALERROR;
-
-    /* Prepare the counterBlock required for encryption/decryption 
-     * Block counter starts at 1 according to part 14 (7.2.2.4.3.2)*/
-    UA_Byte counterBlockCopy[UA_AES128CTR_ENCRYPTION_BLOCK_SIZE];
+crypt_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
+                          const UA_Byte *messageNonce, UA_ByteString *data) {
+    UA_Byte counterBlockCopy[UA_AES128CTR_COUNTERBLOCK_SIZE];
     UA_Byte counterInitialValue[4] = {0,0,0,1};
     memcpy(counterBlockCopy, cc->keyNonce, UA_AES128CTR_KEYNONCE_LENGTH);
     memcpy(counterBlockCopy + UA_AES128CTR_KEYNONCE_LENGTH,
-           cc->messageNonce, UA_AES128CTR_MESSAGENONCE_LENGTH);
+           messageNonce, UA_AES128CTR_MESSAGENONCE_LENGTH);
     memcpy(counterBlockCopy + UA_AES128CTR_KEYNONCE_LENGTH +
            UA_AES128CTR_MESSAGENONCE_LENGTH, &counterInitialValue, 4);
 
     size_t counterblockoffset = 0;
     UA_Byte aesBuffer[UA_AES128CTR_ENCRYPTION_BLOCK_SIZE];
-    mbedErr = mbedtls_aes_crypt_ctr(&aesContext, data->length, &counterblockoffset,
-                                    counterBlockCopy, aesBuffer, data->data, data->data);
+    int mbedErr = mbedtls_aes_crypt_ctr(&cc->aesContext, data->length,
+                                        &counterblockoffset, counterBlockCopy,
+                                        aesBuffer, data->data, data->data);
     if(mbedErr)
         return UA_STATUSCODE_BADINTERNALERROR;
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+encrypt_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
+                            UA_ByteString *data) {
+    if(cc == NULL || data == NULL)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return crypt_sp_pubsub_aes128ctr(cc, cc->messageNonce, data);
+}
+
 /* a decryption function is exactly the same as an encryption one, since they all do XOR
  * operations*/
 static UA_StatusCode
-decrypt_sp_pubsub_aes128ctr(const PUBSUB_AES128CTR_ChannelContext *cc,
+decrypt_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
                             UA_ByteString *data) {
     return encrypt_sp_pubsub_aes128ctr(cc, data);
 }
 
+/* Verify and decrypt with the cipher state of the channel context. The nonce of
+ * each message is used directly for the counter block. */
+static void
+verifyAndDecryptBatch_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
+                                          size_t messagesSize,
+                                          UA_PubSubSecuredMessage *messages) {
+    for(size_t i = 0; i < messagesSize; i++) {
+        UA_PubSubSecuredMessage *m = &messages[i];
+        m->status = UA_STATUSCODE_GOOD;
+        if(m->signature.length > 0) {
+            m->status = verify_sp_pubsub_aes128ctr(cc, &m->signedPart, &m->signature);
+            if(m->status != UA_STATUSCODE_GOOD)
+                continue;
+        }
+        if(m->encryptedPart.length == 0)
+            continue;
+        if(m->messageNonce.length != UA_AES128CTR_MESSAGENONCE_LENGTH) {
+            m->status = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+            continue;
+        }
+        m->status = crypt_sp_pubsub_aes128ctr(cc, m->messageNonce.data, &m->encryptedPart);
+    }
+}
+
 /*Tested, meeting  Profile*/
 static UA_StatusCode
 generateKey_sp_pubsub_aes128ctr(void *policyContext, const UA_ByteString *secret,
@@ -194,8 +217,23 @@ generateNonce_sp_pubsub_aes128ctr(void *policyContext, UA_ByteString *out) {
 /* ChannelModule */
 /*****************/
 
+/* Derive the cipher state from the current keys */
+static UA_StatusCode
+channelContext_loadKeys_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc) {
+    /* Keylength in bits */
+    unsigned int keylength = (unsigned int)(UA_AES128CTR_KEY_LENGTH * 8);
+    if(mbedtls_aes_setkey_enc(&cc->aesContext, cc->encryptingKey, keylength) != 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(mbedtls_md_hmac_starts(&cc->hmacContext, cc->signingKey,
+                              UA_AES128CTR_SIGNING_KEY_LENGTH) != 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
 static void
 channelContext_deleteContext_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc) {
+    mbedtls_aes_free(&cc->aesContext);
+    mbedtls_md_free(&cc->hmacContext);
     UA_free(cc);
 }
 
@@ -224,6 +262,20 @@ channelContext_newContext_sp_pubsub_aes128ctr(void *policyContext,
         memcpy(cc->encryptingKey, encryptingKey->data, encryptingKey->length);
     if(keyNonce)
         memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
+
+    /* Set up the cipher state. Keys that are not yet defined remain zeroed
+     * until setSecurityKeys is called. */
+    mbedtls_aes_init(&cc->aesContext);
+    mbedtls_md_init(&cc->hmacContext);
+    const mbedtls_md_info_t *mdInfo = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    UA_StatusCode res = UA_STATUSCODE_BADINTERNALERROR;
+    if(mbedtls_md_setup(&cc->hmacContext, mdInfo, 1) == 0)
+        res = channelContext_loadKeys_sp_pubsub_aes128ctr(cc);
+    if(res != UA_STATUSCODE_GOOD) {
+        channelContext_deleteContext_sp_pubsub_aes128ctr(cc);
+        return res;
+    }
+
     *wgContext = cc;
     return UA_STATUSCODE_GOOD;
 }
@@ -242,7 +294,7 @@ channelContext_setKeys_sp_pubsub_aes128ctr(PUBSUB_AES128CTR_ChannelContext *cc,
     memcpy(cc->signingKey, signingKey->data, signingKey->length);
     memcpy(cc->encryptingKey, encryptingKey->data, encryptingKey->length);
     memcpy(cc->keyNonce, keyNonce->data, keyNonce->length);
-    return UA_STATUSCODE_GOOD;
+    return channelContext_loadKeys_sp_pubsub_aes128ctr(cc);
 }
 
 static UA_StatusCode
@@ -391,6 +443,8 @@ UA_PubSubSecurityPolicy_Aes128Ctr(UA_PubSubSecurityPolicy *policy,
             channelContext_setKeys_sp_pubsub_aes128ctr;
     policy->setMessageNonce = (UA_StatusCode(*)(void *, const UA_ByteString *))
         channelContext_setMessageNonce_sp_pubsub_aes128ctr;
+    policy->verifyAndDecryptBatch = (void (*)(void *, size_t, UA_PubSubSecuredMessage *))
+        verifyAndDecryptBatch_sp_pubsub_aes128ctr;
     policy->clear = deleteMembers_sp_pubsub_aes128ctr;
     policy->policyContext = NULL;
 
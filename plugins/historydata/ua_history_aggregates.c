@@ -0,0 +1,609 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_history_aggregates.h"
+
+#include <string.h>
+
+/* Number of samples read from the backend at once */
+#define AGGREGATE_CHUNKSIZE 256
+
+/* StatusCode info bits of aggregate results (OPC UA Part 4, 7.34.1) */
+#define AGGREGATE_CALCULATED (UA_STATUSCODE_INFOTYPE_DATAVALUE | 0x01)
+#define AGGREGATE_INTERPOLATED (UA_STATUSCODE_INFOTYPE_DATAVALUE | 0x02)
+#define AGGREGATE_PARTIAL 0x04
+
+typedef enum {
+    AGGREGATE_INTERPOLATIVE,
+    AGGREGATE_AVERAGE,
+    AGGREGATE_TIMEAVERAGE,
+    AGGREGATE_TOTAL,
+    AGGREGATE_MINIMUM,
+    AGGREGATE_MAXIMUM,
+    AGGREGATE_MINIMUMACTUALTIME,
+    AGGREGATE_MAXIMUMACTUALTIME,
+    AGGREGATE_RANGE,
+    AGGREGATE_COUNT,
+    AGGREGATE_START,
+    AGGREGATE_END,
+    AGGREGATE_DELTA
+} AggregateKind;
+
+static const struct {
+    UA_UInt32 id;
+    AggregateKind kind;
+} aggregateFunctions[] = {
+    {UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE, AGGREGATE_INTERPOLATIVE},
+    {UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, AGGREGATE_AVERAGE},
+    {UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE, AGGREGATE_TIMEAVERAGE},
+    {UA_NS0ID_AGGREGATEFUNCTION_TOTAL, AGGREGATE_TOTAL},
+    {UA_NS0ID_AGGREGATEFUNCTION_MINIMUM, AGGREGATE_MINIMUM},
+    {UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, AGGREGATE_MAXIMUM},
+    {UA_NS0ID_AGGREGATEFUNCTION_MINIMUMACTUALTIME, AGGREGATE_MINIMUMACTUALTIME},
+    {UA_NS0ID_AGGREGATEFUNCTION_MAXIMUMACTUALTIME, AGGREGATE_MAXIMUMACTUALTIME},
+    {UA_NS0ID_AGGREGATEFUNCTION_RANGE, AGGREGATE_RANGE},
+    {UA_NS0ID_AGGREGATEFUNCTION_COUNT, AGGREGATE_COUNT},
+    {UA_NS0ID_AGGREGATEFUNCTION_START, AGGREGATE_START},
+    {UA_NS0ID_AGGREGATEFUNCTION_END, AGGREGATE_END},
+    {UA_NS0ID_AGGREGATEFUNCTION_DELTA, AGGREGATE_DELTA}
+};
+
+/* The time-weighted aggregates interpolate between the samples. The others
+ * can be computed from a UA_HistoryDataSummary. */
+static UA_Boolean
+isTimeWeighted(AggregateKind kind) {
+    return (kind == AGGREGATE_INTERPOLATIVE || kind == AGGREGATE_TIMEAVERAGE ||
+            kind == AGGREGATE_TOTAL);
+}
+
+UA_Boolean
+UA_HistoryAggregate_toDouble(const UA_Variant *value, UA_Double *out) {
+    if(!value->type || !UA_Variant_isScalar(value) || !value->data)
+        return false;
+    switch(value->type->typeKind) {
+    case UA_DATATYPEKIND_BOOLEAN: *out = *(const UA_Boolean*)value->data ? 1.0 : 0.0; break;
+    case UA_DATATYPEKIND_SBYTE: *out = *(const UA_SByte*)value->data; break;
+    case UA_DATATYPEKIND_BYTE: *out = *(const UA_Byte*)value->data; break;
+    case UA_DATATYPEKIND_INT16: *out = *(const UA_Int16*)value->data; break;
+    case UA_DATATYPEKIND_UINT16: *out = *(const UA_UInt16*)value->data; break;
+    case UA_DATATYPEKIND_INT32: *out = *(const UA_Int32*)value->data; break;
+    case UA_DATATYPEKIND_UINT32: *out = *(const UA_UInt32*)value->data; break;
+    case UA_DATATYPEKIND_INT64: *out = (UA_Double)*(const UA_Int64*)value->data; break;
+    case UA_DATATYPEKIND_UINT64: *out = (UA_Double)*(const UA_UInt64*)value->data; break;
+    case UA_DATATYPEKIND_FLOAT: *out = *(const UA_Float*)value->data; break;
+    case UA_DATATYPEKIND_DOUBLE: *out = *(const UA_Double*)value->data; break;
+    default: return false;
+    }
+    return true;
+}
+
+void
+UA_HistoryDataSummary_add(UA_HistoryDataSummary *summary, UA_DateTime timestamp,
+                          UA_Boolean included, UA_Boolean uncertain,
+                          UA_Double value) {
+    summary->count++;
+    if(!included)
+        return;
+    if(summary->goodCount == 0) {
+        summary->min = summary->max = summary->first = value;
+        summary->minTimestamp = summary->maxTimestamp = summary->firstTimestamp = timestamp;
+    } else {
+        if(value < summary->min) {
+            summary->min = value;
+            summary->minTimestamp = timestamp;
+        }
+        if(value > summary->max) {
+            summary->max = value;
+            summary->maxTimestamp = timestamp;
+        }
+    }
+    summary->last = value;
+    summary->lastTimestamp = timestamp;
+    summary->sum += value;
+    summary->goodCount++;
+    if(uncertain)
+        summary->uncertainCount++;
+}
+
+void
+UA_HistoryDataSummary_merge(UA_HistoryDataSummary *summary,
+                            const UA_HistoryDataSummary *next) {
+    summary->count += next->count;
+    if(next->goodCount == 0)
+        return;
+    if(summary->goodCount == 0) {
+        size_t count = summary->count;
+        *summary = *next;
+        summary->count = count;
+        return;
+    }
+    if(next->min < summary->min) {
+        summary->min = next->min;
+        summary->minTimestamp = next->minTimestamp;
+    }
+    if(next->max > summary->max) {
+        summary->max = next->max;
+        summary->maxTimestamp = next->maxTimestamp;
+    }
+    summary->last = next->last;
+    summary->lastTimestamp = next->lastTimestamp;
+    summary->sum += next->sum;
+    summary->goodCount += next->goodCount;
+    summary->uncertainCount += next->uncertainCount;
+}
+
+/*************/
+/* Intervals */
+/*************/
+
+typedef struct {
+    UA_DateTime start; /* The interval is [start, end) */
+    UA_DateTime end;
+    UA_Boolean partial; /* Shorter than the processing interval */
+    UA_HistoryDataSummary summary;
+
+    /* Time-weighted aggregates. The area below the linear interpolation of
+     * the samples is integrated from the value at the start of the interval
+     * to the value at the end. */
+    UA_Boolean startDone;
+    UA_Boolean hasStartValue;
+    UA_Boolean startRaw; /* A sample exists at the start */
+    UA_Double startValue;
+    UA_Boolean hasPoint;
+    UA_DateTime pointTimestamp;
+    UA_Double pointValue;
+    UA_Double area;
+    UA_DateTime covered;
+} AggregateInterval;
+
+typedef struct {
+    UA_Boolean treatUncertainAsBad;
+    UA_Byte percentDataGood;
+
+    /* The last included sample */
+    UA_Boolean hasPrev;
+    UA_DateTime prevTimestamp;
+    UA_Double prevValue;
+} AggregateState;
+
+static UA_DateTime
+sampleTimestamp(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    return value->serverTimestamp;
+}
+
+/* Returns whether the sample contributes to the aggregate */
+static UA_Boolean
+classifySample(const AggregateState *state, const UA_DataValue *value,
+               UA_Boolean *uncertain, UA_Double *number) {
+    UA_StatusCode status = value->hasStatus ? value->status : UA_STATUSCODE_GOOD;
+    *uncertain = UA_StatusCode_isUncertain(status);
+    if(UA_StatusCode_isBad(status) || (*uncertain && state->treatUncertainAsBad))
+        return false;
+    return value->hasValue && UA_HistoryAggregate_toDouble(&value->value, number);
+}
+
+static UA_Double
+interpolate(UA_DateTime t0, UA_Double v0, UA_DateTime t1, UA_Double v1, UA_DateTime t) {
+    if(t1 == t0)
+        return v0;
+    return v0 + (v1 - v0) * ((UA_Double)(t - t0) / (UA_Double)(t1 - t0));
+}
+
+static void
+addArea(AggregateInterval *interval, UA_DateTime timestamp, UA_Double value) {
+    if(interval->hasPoint) {
+        UA_DateTime duration = timestamp - interval->pointTimestamp;
+        interval->area += (UA_Double)duration * (interval->pointValue + value) / 2.0;
+        interval->covered += duration;
+    }
+    interval->hasPoint = true;
+    interval->pointTimestamp = timestamp;
+    interval->pointValue = value;
+}
+
+static void
+setStartValue(AggregateInterval *interval, UA_Double value, UA_Boolean raw) {
+    interval->startDone = true;
+    interval->hasStartValue = true;
+    interval->startRaw = raw;
+    interval->startValue = value;
+    addArea(interval, interval->start, value);
+}
+
+/* Close the interval with the next included sample after its end (if any).
+ * Without a next sample the last value is extrapolated. */
+static void
+closeInterval(AggregateState *state, AggregateInterval *interval,
+              AggregateInterval *following, UA_Boolean hasNext,
+              UA_DateTime nextTimestamp, UA_Double nextValue) {
+    if(!state->hasPrev)
+        return;
+    UA_Double value = state->prevValue;
+    if(hasNext)
+        value = interpolate(state->prevTimestamp, state->prevValue,
+                            nextTimestamp, nextValue, interval->start);
+    if(!interval->startDone)
+        setStartValue(interval, value, false);
+    if(hasNext)
+        value = interpolate(state->prevTimestamp, state->prevValue,
+                            nextTimestamp, nextValue, interval->end);
+    if(interval->hasPoint)
+        addArea(interval, interval->end, value);
+    if(following)
+        setStartValue(following, value, hasNext && nextTimestamp == following->start);
+}
+
+static void
+addSample(AggregateState *state, AggregateInterval *interval,
+          const UA_DataValue *value) {
+    UA_DateTime timestamp = sampleTimestamp(value);
+    UA_Boolean uncertain = false;
+    UA_Double number = 0.0;
+    UA_Boolean included = classifySample(state, value, &uncertain, &number);
+    UA_HistoryDataSummary_add(&interval->summary, timestamp, included, uncertain, number);
+    if(!included)
+        return;
+    if(!interval->startDone) {
+        if(timestamp == interval->start)
+            setStartValue(interval, number, true);
+        else if(state->hasPrev)
+            setStartValue(interval, interpolate(state->prevTimestamp, state->prevValue,
+                                                timestamp, number, interval->start), false);
+        interval->startDone = true;
+    }
+    addArea(interval, timestamp, number);
+    state->hasPrev = true;
+    state->prevTimestamp = timestamp;
+    state->prevValue = number;
+}
+
+/* Read the samples from the start of the first interval to the first sample
+ * after the last interval in one pass. The intervals are ascending and
+ * adjacent. */
+static UA_StatusCode
+streamSamples(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+              const UA_HistoryDataBackend *backend, const UA_NodeId *nodeId,
+              AggregateState *state, AggregateInterval *intervals, size_t intervalsSize) {
+    size_t storeEnd = backend->getEnd(server, backend->context, sessionId,
+                                      sessionContext, nodeId);
+
+    /* The sample before the first interval */
+    size_t before = backend->getDateTimeMatch(server, backend->context, sessionId,
+                                              sessionContext, nodeId,
+                                              intervals[0].start, MATCH_BEFORE);
+    if(before != storeEnd) {
+        const UA_DataValue *dv = backend->getDataValue(server, backend->context, sessionId,
+                                                       sessionContext, nodeId, before);
+        UA_Boolean uncertain;
+        if(dv && classifySample(state, dv, &uncertain, &state->prevValue)) {
+            state->hasPrev = true;
+            state->prevTimestamp = sampleTimestamp(dv);
+        }
+    }
+
+    size_t k = 0;
+    size_t startIndex = backend->getDateTimeMatch(server, backend->context, sessionId,
+                                                  sessionContext, nodeId,
+                                                  intervals[0].start, MATCH_EQUAL_OR_AFTER);
+    if(startIndex != storeEnd) {
+        size_t endIndex = backend->getDateTimeMatch(server, backend->context, sessionId,
+                                                    sessionContext, nodeId,
+                                                    intervals[intervalsSize - 1].end,
+                                                    MATCH_EQUAL_OR_AFTER);
+        if(endIndex == storeEnd)
+            endIndex = backend->lastIndex(server, backend->context, sessionId,
+                                          sessionContext, nodeId);
+
+        UA_DataValue values[AGGREGATE_CHUNKSIZE];
+        UA_ByteString cp = UA_BYTESTRING_NULL;
+        const UA_NumericRange noRange = {0, NULL};
+        do {
+            UA_ByteString outCp = UA_BYTESTRING_NULL;
+            size_t provided = 0;
+            UA_StatusCode res =
+                backend->copyDataValues(server, backend->context, sessionId, sessionContext,
+                                        nodeId, startIndex, endIndex, false,
+                                        AGGREGATE_CHUNKSIZE, noRange, false, &cp,
+                                        &outCp, &provided, values);
+            UA_ByteString_clear(&cp);
+            cp = outCp;
+            if(res != UA_STATUSCODE_GOOD) {
+                UA_ByteString_clear(&cp);
+                return res;
+            }
+            for(size_t i = 0; i < provided; i++) {
+                UA_DateTime timestamp = sampleTimestamp(&values[i]);
+                if(k < intervalsSize && timestamp >= intervals[k].end) {
+                    UA_Boolean uncertain;
+                    UA_Double number = 0.0;
+                    UA_Boolean included =
+                        classifySample(state, &values[i], &uncertain, &number);
+                    while(k < intervalsSize && timestamp >= intervals[k].end) {
+                        closeInterval(state, &intervals[k],
+                                      (k + 1 < intervalsSize) ? &intervals[k + 1] : NULL,
+                                      included, timestamp, number);
+                        k++;
+                    }
+                }
+                if(k < intervalsSize && timestamp >= intervals[k].start)
+                    addSample(state, &intervals[k], &values[i]);
+                UA_DataValue_clear(&values[i]);
+            }
+        } while(cp.length > 0 && k < intervalsSize);
+        UA_ByteString_clear(&cp);
+    }
+
+    /* Extrapolate after the last sample */
+    for(; k < intervalsSize; k++)
+        closeInterval(state, &intervals[k],
+                      (k + 1 < intervalsSize) ? &intervals[k + 1] : NULL,
+                      false, 0, 0.0);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Use the pre-computed statistics of the backend */
+static UA_StatusCode
+summarizeIntervals(UA_Server *server, const UA_NodeId *sessionId, void *sessionContext,
+                   const UA_HistoryDataBackend *backend, const UA_NodeId *nodeId,
+                   AggregateInterval *intervals, size_t intervalsSize) {
+    size_t storeEnd = backend->getEnd(server, backend->context, sessionId,
+                                      sessionContext, nodeId);
+    for(size_t k = 0; k < intervalsSize; k++) {
+        AggregateInterval *interval = &intervals[k];
+        size_t first = backend->getDateTimeMatch(server, backend->context, sessionId,
+                                                 sessionContext, nodeId,
+                                                 interval->start, MATCH_EQUAL_OR_AFTER);
+        size_t last = backend->getDateTimeMatch(server, backend->context, sessionId,
+                                                sessionContext, nodeId,
+                                                interval->end, MATCH_BEFORE);
+        if(first == storeEnd || last == storeEnd)
+            continue;
+        const UA_DataValue *dv = backend->getDataValue(server, backend->context, sessionId,
+                                                       sessionContext, nodeId, first);
+        if(!dv || sampleTimestamp(dv) >= interval->end)
+            continue;
+        UA_StatusCode res =
+            backend->getSummary(server, backend->context, sessionId, sessionContext,
+                                nodeId, first, last, &interval->summary);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/**********/
+/* Result */
+/**********/
+
+static UA_StatusCode
+setResultValue(UA_DataValue *dv, UA_Double value) {
+    dv->hasValue = true;
+    return UA_Variant_setScalarCopy(&dv->value, &value, &UA_TYPES[UA_TYPES_DOUBLE]);
+}
+
+static UA_StatusCode
+makeResult(const AggregateState *state, AggregateKind kind,
+           const AggregateInterval *interval, UA_TimestampsToReturn timestampsToReturn,
+           UA_DataValue *dv) {
+    const UA_HistoryDataSummary *s = &interval->summary;
+    UA_DateTime timestamp = interval->start;
+    UA_StatusCode status = AGGREGATE_CALCULATED;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+
+    if(kind == AGGREGATE_COUNT) {
+        UA_Int32 count = (UA_Int32)s->goodCount;
+        dv->hasValue = true;
+        res = UA_Variant_setScalarCopy(&dv->value, &count, &UA_TYPES[UA_TYPES_INT32]);
+    } else if(isTimeWeighted(kind)) {
+        if(kind == AGGREGATE_INTERPOLATIVE && interval->hasStartValue) {
+            status = interval->startRaw ? UA_STATUSCODE_GOOD : AGGREGATE_INTERPOLATED;
+            res = setResultValue(dv, interval->startValue);
+        } else if(kind != AGGREGATE_INTERPOLATIVE && interval->covered > 0) {
+            UA_Double value = interval->area / (UA_Double)interval->covered;
+            if(kind == AGGREGATE_TOTAL)
+                value = interval->area / (UA_Double)UA_DATETIME_SEC;
+            res = setResultValue(dv, value);
+        } else if(kind != AGGREGATE_INTERPOLATIVE && s->goodCount > 0) {
+            /* A single sample without neighbours */
+            res = setResultValue(dv, (kind == AGGREGATE_TOTAL) ? 0.0 : s->first);
+        } else {
+            status = UA_STATUSCODE_BADNODATA;
+        }
+    } else if(s->goodCount == 0) {
+        status = UA_STATUSCODE_BADNODATA;
+    } else {
+        UA_Double value = 0.0;
+        switch(kind) {
+        case AGGREGATE_AVERAGE: value = s->sum / (UA_Double)s->goodCount; break;
+        case AGGREGATE_MINIMUM: value = s->min; break;
+        case AGGREGATE_MAXIMUM: value = s->max; break;
+        case AGGREGATE_MINIMUMACTUALTIME: value = s->min; timestamp = s->minTimestamp; break;
+        case AGGREGATE_MAXIMUMACTUALTIME: value = s->max; timestamp = s->maxTimestamp; break;
+        case AGGREGATE_RANGE: value = s->max - s->min; break;
+        case AGGREGATE_START: value = s->first; break;
+        case AGGREGATE_END: value = s->last; break;
+        case AGGREGATE_DELTA: value = s->last - s->first; break;
+        default: break;
+        }
+        res = setResultValue(dv, value);
+    }
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Uncertain if too few samples are good */
+    if(!UA_StatusCode_isBad(status) && s->count > 0 &&
+       s->goodCount * 100 < (size_t)state->percentDataGood * s->count)
+        status = UA_STATUSCODE_UNCERTAINDATASUBNORMAL | (status & 0xffff);
+    if(interval->partial && kind != AGGREGATE_INTERPOLATIVE &&
+       !UA_StatusCode_isBad(status))
+        status |= UA_STATUSCODE_INFOTYPE_DATAVALUE | AGGREGATE_PARTIAL;
+    dv->hasStatus = (status != UA_STATUSCODE_GOOD);
+    dv->status = status;
+
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SOURCE ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
+        dv->hasSourceTimestamp = true;
+        dv->sourceTimestamp = timestamp;
+    }
+    if(timestampsToReturn == UA_TIMESTAMPSTORETURN_SERVER ||
+       timestampsToReturn == UA_TIMESTAMPSTORETURN_BOTH) {
+        dv->hasServerTimestamp = true;
+        dv->serverTimestamp = timestamp;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+UA_StatusCode
+UA_HistoryAggregate_read(UA_Server *server, const UA_NodeId *sessionId,
+                         void *sessionContext, const UA_HistoryDataBackend *backend,
+                         const UA_NodeId *nodeId,
+                         const UA_ReadProcessedDetails *details,
+                         const UA_NodeId *aggregateType,
+                         UA_TimestampsToReturn timestampsToReturn, size_t maxSize,
+                         UA_Boolean releaseContinuationPoints,
+                         const UA_ByteString *continuationPoint,
+                         UA_ByteString *outContinuationPoint,
+                         UA_HistoryData *result) {
+    /* Look up the aggregate */
+    size_t a = 0;
+    const size_t aggregatesSize = sizeof(aggregateFunctions) / sizeof(aggregateFunctions[0]);
+    if(aggregateType->namespaceIndex == 0 &&
+       aggregateType->identifierType == UA_NODEIDTYPE_NUMERIC) {
+        for(; a < aggregatesSize; a++) {
+            if(aggregateFunctions[a].id == aggregateType->identifier.numeric)
+                break;
+        }
+    } else {
+        a = aggregatesSize;
+    }
+    if(a == aggregatesSize)
+        return UA_STATUSCODE_BADAGGREGATENOTSUPPORTED;
+    AggregateKind kind = aggregateFunctions[a].kind;
+
+    /* The negated comparison also rejects NaN */
+    if(details->startTime == details->endTime || !(details->processingInterval >= 0.0))
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    /* Resume at the next interval */
+    size_t next = 0;
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(size_t))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&next, continuationPoint->data, sizeof(size_t));
+    }
+    if(releaseContinuationPoints)
+        return UA_STATUSCODE_GOOD;
+
+    /* Split the time range into intervals beginning at the startTime. For
+     * endTime < startTime the intervals go backwards in time. A processing
+     * interval of zero is a single interval. */
+    UA_Boolean reverse = details->endTime < details->startTime;
+    UA_UInt64 range = reverse ?
+        (UA_UInt64)details->startTime - (UA_UInt64)details->endTime :
+        (UA_UInt64)details->endTime - (UA_UInt64)details->startTime;
+    if(range > (UA_UInt64)UA_INT64_MAX)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    UA_DateTime duration = (UA_DateTime)range;
+
+    /* Range-check the processing interval before the conversion */
+    UA_DateTime length = duration;
+    if(details->processingInterval < (UA_Double)duration / UA_DATETIME_MSEC)
+        length = (UA_DateTime)(details->processingInterval * UA_DATETIME_MSEC);
+    if(length <= 0)
+        length = duration;
+    size_t total = (size_t)(duration / length + (duration % length != 0));
+    if(next >= total)
+        return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+    size_t count = total - next;
+    if(maxSize == 0 || maxSize > UA_HISTORYAGGREGATE_MAXINTERVALS)
+        maxSize = UA_HISTORYAGGREGATE_MAXINTERVALS;
+    if(count > maxSize)
+        count = maxSize;
+
+    /* Ascending in time */
+    AggregateInterval *intervals = (AggregateInterval*)
+        UA_calloc(count, sizeof(AggregateInterval));
+    if(!intervals)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < count; i++) {
+        size_t k = next + i;
+        AggregateInterval *interval = &intervals[reverse ? count - 1 - i : i];
+        /* k * length is below the duration. The last interval is clipped
+         * without computing beyond the end of the time range. */
+        if(reverse) {
+            interval->end = details->startTime - (UA_DateTime)k * length;
+            interval->start = (interval->end - details->endTime > length) ?
+                interval->end - length : details->endTime;
+        } else {
+            interval->start = details->startTime + (UA_DateTime)k * length;
+            interval->end = (details->endTime - interval->start > length) ?
+                interval->start + length : details->endTime;
+        }
+        interval->partial = (interval->end - interval->start < length);
+    }
+
+    AggregateState state;
+    memset(&state, 0, sizeof(AggregateState));
+    state.treatUncertainAsBad = true;
+    state.percentDataGood = 100;
+    if(!details->aggregateConfiguration.useServerCapabilitiesDefaults) {
+        state.treatUncertainAsBad = details->aggregateConfiguration.treatUncertainAsBad;
+        state.percentDataGood = details->aggregateConfiguration.percentDataGood;
+    }
+
+    /* Compute the intervals from the backend statistics. Uncertain samples
+     * are included in the statistics, so they can only be used if uncertain
+     * samples count as good. */
+    UA_StatusCode res = UA_STATUSCODE_BADNOTSUPPORTED;
+    if(backend->getSummary && !isTimeWeighted(kind)) {
+        res = summarizeIntervals(server, sessionId, sessionContext, backend, nodeId,
+                                 intervals, count);
+        for(size_t i = 0; res == UA_STATUSCODE_GOOD && i < count; i++) {
+            if(state.treatUncertainAsBad && intervals[i].summary.uncertainCount > 0)
+                res = UA_STATUSCODE_BADNOTSUPPORTED;
+        }
+        if(res != UA_STATUSCODE_GOOD) {
+            for(size_t i = 0; i < count; i++)
+                memset(&intervals[i].summary, 0, sizeof(UA_HistoryDataSummary));
+        }
+    }
+    if(res != UA_STATUSCODE_GOOD)
+        res = streamSamples(server, sessionId, sessionContext, backend, nodeId,
+                            &state, intervals, count);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_free(intervals);
+        return res;
+    }
+
+    /* Write the results in the order of the request */
+    result->dataValues = (UA_DataValue*)UA_Array_new(count, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    if(!result->dataValues) {
+        UA_free(intervals);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    result->dataValuesSize = count;
+    for(size_t i = 0; i < count && res == UA_STATUSCODE_GOOD; i++)
+        res = makeResult(&state, kind, &intervals[reverse ? count - 1 - i : i],
+                         timestampsToReturn, &result->dataValues[i]);
+    UA_free(intervals);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_Array_delete(result->dataValues, result->dataValuesSize,
+                        &UA_TYPES[UA_TYPES_DATAVALUE]);
+        result->dataValues = NULL;
+        result->dataValuesSize = 0;
+        return res;
+    }
+
+    if(next + count < total) {
+        res = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(size_t));
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        next += count;
+        memcpy(outContinuationPoint->data, &next, sizeof(size_t));
+    }
+    return UA_STATUSCODE_GOOD;
+}
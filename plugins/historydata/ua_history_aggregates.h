@@ -0,0 +1,51 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORY_AGGREGATES_H_
+#define UA_HISTORY_AGGREGATES_H_
+
+#include <open62541/plugin/historydata/history_data_backend.h>
+
+_UA_BEGIN_DECLS
+
+/* Converts a scalar numeric value (Boolean to Double) to a Double. Returns
+ * false for other values. */
+UA_Boolean
+UA_HistoryAggregate_toDouble(const UA_Variant *value, UA_Double *out);
+
+/* Adds a sample to the summary. included is false for samples without a
+ * numeric value or with a Bad status. */
+void
+UA_HistoryDataSummary_add(UA_HistoryDataSummary *summary, UA_DateTime timestamp,
+                          UA_Boolean included, UA_Boolean uncertain,
+                          UA_Double value);
+
+/* Adds the statistics of the following samples */
+void
+UA_HistoryDataSummary_merge(UA_HistoryDataSummary *summary,
+                            const UA_HistoryDataSummary *next);
+
+/* Maximum number of intervals per response if maxSize is zero */
+#define UA_HISTORYAGGREGATE_MAXINTERVALS 10000
+
+/* Computes the aggregate of ReadProcessed for one node from the low level API
+ * of the backend. The result contains one DataValue per processing interval.
+ * At most maxSize (or UA_HISTORYAGGREGATE_MAXINTERVALS) intervals are
+ * returned, the continuation point resumes with the next interval. */
+UA_StatusCode
+UA_HistoryAggregate_read(UA_Server *server, const UA_NodeId *sessionId,
+                         void *sessionContext, const UA_HistoryDataBackend *backend,
+                         const UA_NodeId *nodeId,
+                         const UA_ReadProcessedDetails *details,
+                         const UA_NodeId *aggregateType,
+                         UA_TimestampsToReturn timestampsToReturn, size_t maxSize,
+                         UA_Boolean releaseContinuationPoints,
+                         const UA_ByteString *continuationPoint,
+                         UA_ByteString *outContinuationPoint,
+                         UA_HistoryData *result);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORY_AGGREGATES_H_ */
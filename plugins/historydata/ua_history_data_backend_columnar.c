@@ -0,0 +1,1128 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_columnar.h>
+
+#include "ua_history_aggregates.h"
+#include "ua_history_nodeid_index.h"
+
+#include <limits.h>
+#include <stddef.h>
+#include <string.h>
+
+#define COLUMNAR_BLOCKSIZE UA_HISTORYDATABACKEND_COLUMNAR_BLOCKSIZE
+
+/* Upper bound of the encoded size of one sample in bytes. Two integers with a
+ * 4 bit prefix and 64 bit payload and one XOR value with a 14 bit header. */
+#define COLUMNAR_MAXSAMPLESIZE 32
+
+/**************/
+/* Bit Stream */
+/**************/
+
+typedef struct {
+    UA_Byte *data;
+    size_t capacity; /* In bytes */
+    size_t length;   /* In bits */
+} BitStream;
+
+typedef struct {
+    const UA_Byte *data;
+    size_t pos; /* In bits */
+} BitReader;
+
+static UA_StatusCode
+BitStream_reserve(BitStream *bs, size_t bytes) {
+    size_t needed = ((bs->length + 7) / 8) + bytes;
+    if(needed <= bs->capacity)
+        return UA_STATUSCODE_GOOD;
+    size_t newCapacity = (bs->capacity > 0) ? bs->capacity * 2 : 64;
+    while(newCapacity < needed)
+        newCapacity *= 2;
+    UA_Byte *data = (UA_Byte*)UA_realloc(bs->data, newCapacity);
+    if(!data)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memset(&data[bs->capacity], 0, newCapacity - bs->capacity);
+    bs->data = data;
+    bs->capacity = newCapacity;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* The capacity must be reserved beforehand */
+static void
+BitStream_write(BitStream *bs, UA_UInt64 value, UA_Byte bits) {
+    while(bits > 0) {
+        UA_Byte avail = (UA_Byte)(8 - (bs->length & 7));
+        UA_Byte take = (bits < avail) ? bits : avail;
+        UA_Byte chunk = (UA_Byte)((value >> (bits - take)) & ((1u << take) - 1));
+        bs->data[bs->length >> 3] |= (UA_Byte)(chunk << (avail - take));
+        bs->length += take;
+        bits = (UA_Byte)(bits - take);
+    }
+}
+
+static UA_UInt64
+BitReader_read(BitReader *br, UA_Byte bits) {
+    UA_UInt64 value = 0;
+    while(bits > 0) {
+        UA_Byte avail = (UA_Byte)(8 - (br->pos & 7));
+        UA_Byte take = (bits < avail) ? bits : avail;
+        UA_Byte chunk = (UA_Byte)
+            ((br->data[br->pos >> 3] >> (avail - take)) & ((1u << take) - 1));
+        value = (value << take) | chunk;
+        br->pos += take;
+        bits = (UA_Byte)(bits - take);
+    }
+    return value;
+}
+
+/* Integers (delta-of-delta) are zigzag-encoded with a variable-length
+ * prefix: 0 -> 0 | 10 -> 14 bit | 110 -> 20 bit | 1110 -> 32 bit | 1111 -> 64
+ * bit. The arithmetic wraps around, so that every difference is exact. */
+static void
+writeInteger(BitStream *bs, UA_UInt64 v) {
+    UA_UInt64 zz = (v << 1) ^ (((UA_Int64)v < 0) ? ~(UA_UInt64)0 : 0);
+    if(zz == 0) {
+        BitStream_write(bs, 0, 1);
+    } else if(zz < ((UA_UInt64)1 << 14)) {
+        BitStream_write(bs, 0x2, 2);
+        BitStream_write(bs, zz, 14);
+    } else if(zz < ((UA_UInt64)1 << 20)) {
+        BitStream_write(bs, 0x6, 3);
+        BitStream_write(bs, zz, 20);
+    } else if(zz < ((UA_UInt64)1 << 32)) {
+        BitStream_write(bs, 0xe, 4);
+        BitStream_write(bs, zz, 32);
+    } else {
+        BitStream_write(bs, 0xf, 4);
+        BitStream_write(bs, zz, 64);
+    }
+}
+
+static UA_UInt64
+readInteger(BitReader *br) {
+    UA_UInt64 zz;
+    if(BitReader_read(br, 1) == 0)
+        return 0;
+    if(BitReader_read(br, 1) == 0)
+        zz = BitReader_read(br, 14);
+    else if(BitReader_read(br, 1) == 0)
+        zz = BitReader_read(br, 20);
+    else if(BitReader_read(br, 1) == 0)
+        zz = BitReader_read(br, 32);
+    else
+        zz = BitReader_read(br, 64);
+    return (zz >> 1) ^ ((zz & 1) ? ~(UA_UInt64)0 : 0);
+}
+
+static UA_Byte
+leadingZeros(UA_UInt64 v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (UA_Byte)__builtin_clzll(v);
+#else
+    UA_Byte n = 0;
+    for(UA_UInt64 mask = (UA_UInt64)1 << 63; !(v & mask); mask >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+static UA_Byte
+trailingZeros(UA_UInt64 v) {
+#if defined(__GNUC__) || defined(__clang__)
+    return (UA_Byte)__builtin_ctzll(v);
+#else
+    UA_Byte n = 0;
+    for(; !(v & 1); v >>= 1)
+        n++;
+    return n;
+#endif
+}
+
+/*********/
+/* Store */
+/*********/
+
+typedef struct {
+    UA_UInt64 id; /* Identifies the block in the decoding cache */
+    size_t start; /* Index of the first sample in the node */
+    size_t count;
+    UA_DateTime firstTimestamp;
+    UA_DateTime lastTimestamp;
+
+    /* The block is compressed if the type is set. All samples share the
+     * DataType, the StatusCode and the presence of the SourceTimestamp. */
+    const UA_DataType *type;
+    UA_Boolean hasSourceTimestamp;
+    UA_Boolean hasStatus;
+    UA_StatusCode status;
+    BitStream bits;
+
+    /* Encoder state to append samples */
+    UA_UInt64 prevDelta;
+    UA_UInt64 prevOffset; /* ServerTimestamp - timestamp */
+    UA_UInt64 prevValue;
+    UA_Byte prevLeading;
+    UA_Byte prevTrailing;
+
+    /* Statistics of the compressed samples for the aggregates */
+    UA_HistoryDataSummary summary;
+
+    /* Uncompressed samples */
+    size_t capacity;
+    UA_DateTime *timestamps;
+    UA_DataValue *values;
+} ColumnarBlock;
+
+typedef struct {
+    UA_NodeId nodeId;
+    size_t count;
+    UA_UInt32 version; /* Incremented when samples move to a different index */
+    size_t blocksSize;
+    size_t blocksCapacity;
+    ColumnarBlock *blocks;
+} ColumnarNode;
+
+/* The most recently decoded block */
+typedef struct {
+    UA_UInt64 blockId;
+    size_t count;
+    UA_DateTime timestamps[COLUMNAR_BLOCKSIZE];
+    UA_DateTime serverTimestamps[COLUMNAR_BLOCKSIZE];
+    UA_UInt64 values[COLUMNAR_BLOCKSIZE];
+} DecodedBlock;
+
+typedef struct {
+    ColumnarNode *nodes;
+    size_t nodesSize;
+    size_t nodesCapacity;
+    UA_HistoryNodeIdIndex index;
+    UA_UInt64 lastBlockId;
+    DecodedBlock decoded;
+
+    /* Returned from getDataValue for compressed samples */
+    UA_DataValue current;
+    UA_UInt64 currentValue;
+} ColumnarContext;
+
+/* Continuation point of copyDataValues. See the memory backend. */
+typedef struct {
+    size_t skip;
+    size_t index;
+    UA_UInt32 version;
+    UA_DateTime lastTimestamp;
+} ColumnarCursor;
+
+static void
+ColumnarBlock_clear(ColumnarBlock *b) {
+    UA_free(b->bits.data);
+    for(size_t i = 0; i < b->count && b->values; i++)
+        UA_DataValue_clear(&b->values[i]);
+    UA_free(b->values);
+    UA_free(b->timestamps);
+    memset(b, 0, sizeof(ColumnarBlock));
+}
+
+static void
+ColumnarNode_clear(ColumnarNode *node) {
+    for(size_t i = 0; i < node->blocksSize; i++)
+        ColumnarBlock_clear(&node->blocks[i]);
+    UA_free(node->blocks);
+    UA_NodeId_clear(&node->nodeId);
+    memset(node, 0, sizeof(ColumnarNode));
+}
+
+static ColumnarNode *
+getNode(ColumnarContext *ctx, const UA_NodeId *nodeId) {
+    size_t pos = UA_HistoryNodeIdIndex_find(&ctx->index, ctx->nodes, nodeId);
+    return (pos != SIZE_MAX) ? &ctx->nodes[pos] : NULL;
+}
+
+static ColumnarNode *
+getOrAddNode(ColumnarContext *ctx, const UA_NodeId *nodeId) {
+    ColumnarNode *node = getNode(ctx, nodeId);
+    if(node)
+        return node;
+    if(ctx->nodesSize >= ctx->nodesCapacity) {
+        size_t newCapacity = (ctx->nodesCapacity > 0) ? ctx->nodesCapacity * 2 : 1;
+        ColumnarNode *nodes = (ColumnarNode*)
+            UA_realloc(ctx->nodes, newCapacity * sizeof(ColumnarNode));
+        if(!nodes)
+            return NULL;
+        ctx->nodes = nodes;
+        ctx->nodesCapacity = newCapacity;
+    }
+    node = &ctx->nodes[ctx->nodesSize];
+    memset(node, 0, sizeof(ColumnarNode));
+    if(UA_NodeId_copy(nodeId, &node->nodeId) != UA_STATUSCODE_GOOD)
+        return NULL;
+    if(UA_HistoryNodeIdIndex_add(&ctx->index, nodeId, ctx->nodesSize) != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&node->nodeId);
+        return NULL;
+    }
+    ctx->nodesSize++;
+    return node;
+}
+
+static UA_Boolean
+isCompressible(const UA_DataValue *value) {
+    if(!value->hasValue || value->hasSourcePicoseconds ||
+       value->hasServerPicoseconds || !UA_Variant_isScalar(&value->value))
+        return false;
+    const UA_DataType *type = value->value.type;
+    return (type >= &UA_TYPES[UA_TYPES_BOOLEAN] && type <= &UA_TYPES[UA_TYPES_DOUBLE]);
+}
+
+static UA_Boolean
+fitsBlock(const ColumnarBlock *b, const UA_DataValue *value) {
+    return (b->type == value->value.type &&
+            b->hasSourceTimestamp == value->hasSourceTimestamp &&
+            b->hasStatus == value->hasStatus &&
+            (!b->hasStatus || b->status == value->status));
+}
+
+/* Decode a compressed block into the cache */
+static const DecodedBlock *
+decodeBlock(ColumnarContext *ctx, const ColumnarBlock *b) {
+    DecodedBlock *d = &ctx->decoded;
+    if(d->blockId == b->id && d->count == b->count)
+        return d;
+    BitReader br = {b->bits.data, 0};
+    UA_UInt64 ts = 0, delta = 0, offset = 0, value = 0;
+    UA_Byte leading = 0, trailing = 0;
+    for(size_t i = 0; i < b->count; i++) {
+        delta += readInteger(&br);
+        ts += delta;
+        offset += readInteger(&br);
+        if(BitReader_read(&br, 1) == 1) {
+            if(BitReader_read(&br, 1) == 1) {
+                leading = (UA_Byte)BitReader_read(&br, 6);
+                UA_Byte meaningful = (UA_Byte)(BitReader_read(&br, 6) + 1);
+                trailing = (UA_Byte)(64 - leading - meaningful);
+            }
+            value ^= BitReader_read(&br, (UA_Byte)(64 - leading - trailing)) << trailing;
+        }
+        d->timestamps[i] = (UA_DateTime)ts;
+        d->serverTimestamps[i] = (UA_DateTime)(ts + offset);
+        d->values[i] = value;
+    }
+    d->blockId = b->id;
+    d->count = b->count;
+    return d;
+}
+
+/* The timestamp of the sample must be larger or equal than the last sample.
+ * The capacity of the bit stream must be reserved. */
+static void
+encodeSample(ColumnarBlock *b, UA_DateTime timestamp, const UA_DataValue *value) {
+    UA_UInt64 prevTs = (b->count > 0) ? (UA_UInt64)b->lastTimestamp : 0;
+    UA_UInt64 delta = (UA_UInt64)timestamp - prevTs;
+    writeInteger(&b->bits, delta - b->prevDelta);
+    b->prevDelta = delta;
+
+    UA_UInt64 offset = (UA_UInt64)value->serverTimestamp - (UA_UInt64)timestamp;
+    writeInteger(&b->bits, offset - b->prevOffset);
+    b->prevOffset = offset;
+
+    UA_UInt64 v = 0;
+    memcpy(&v, value->value.data, b->type->memSize);
+    UA_UInt64 x = v ^ b->prevValue;
+    b->prevValue = v;
+    if(x == 0) {
+        BitStream_write(&b->bits, 0, 1);
+    } else {
+        UA_Byte leading = leadingZeros(x);
+        UA_Byte trailing = trailingZeros(x);
+        if(b->count > 0 && leading >= b->prevLeading && trailing >= b->prevTrailing) {
+            /* Reuse the window of meaningful bits */
+            BitStream_write(&b->bits, 0x2, 2);
+            BitStream_write(&b->bits, x >> b->prevTrailing,
+                            (UA_Byte)(64 - b->prevLeading - b->prevTrailing));
+        } else {
+            UA_Byte meaningful = (UA_Byte)(64 - leading - trailing);
+            BitStream_write(&b->bits, 0x3, 2);
+            BitStream_write(&b->bits, leading, 6);
+            BitStream_write(&b->bits, (UA_UInt64)(meaningful - 1), 6);
+            BitStream_write(&b->bits, x >> trailing, meaningful);
+            b->prevLeading = leading;
+            b->prevTrailing = trailing;
+        }
+    }
+
+    UA_StatusCode status = (b->hasStatus) ? b->status : UA_STATUSCODE_GOOD;
+    UA_Double number = 0.0;
+    UA_HistoryAggregate_toDouble(&value->value, &number);
+    UA_HistoryDataSummary_add(&b->summary, timestamp, !UA_StatusCode_isBad(status),
+                              UA_StatusCode_isUncertain(status), number);
+
+    if(b->count == 0)
+        b->firstTimestamp = timestamp;
+    b->lastTimestamp = timestamp;
+    b->count++;
+}
+
+/* Find the block that contains the sample index */
+static ColumnarBlock *
+findBlock(ColumnarNode *node, size_t index) {
+    size_t lo = 0, hi = node->blocksSize;
+    while(hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if(node->blocks[mid].start <= index)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    return &node->blocks[lo];
+}
+
+/* Returns a view of the sample that must not be cleared. The view is valid
+ * until the store is modified or the next sample is viewed. */
+static const UA_DataValue *
+sampleValue(ColumnarContext *ctx, ColumnarNode *node, size_t index,
+            UA_DateTime *timestamp) {
+    ColumnarBlock *b = findBlock(node, index);
+    size_t pos = index - b->start;
+    if(!b->type) {
+        if(timestamp)
+            *timestamp = b->timestamps[pos];
+        return &b->values[pos];
+    }
+
+    const DecodedBlock *d = decodeBlock(ctx, b);
+    UA_DataValue *dv = &ctx->current;
+    UA_DataValue_init(dv);
+    ctx->currentValue = d->values[pos];
+    UA_Variant_setScalar(&dv->value, &ctx->currentValue, b->type);
+    dv->value.storageType = UA_VARIANT_DATA_NODELETE;
+    dv->hasValue = true;
+    dv->hasSourceTimestamp = b->hasSourceTimestamp;
+    if(b->hasSourceTimestamp)
+        dv->sourceTimestamp = d->timestamps[pos];
+    dv->hasServerTimestamp = true;
+    dv->serverTimestamp = d->serverTimestamps[pos];
+    dv->hasStatus = b->hasStatus;
+    dv->status = b->status;
+    if(timestamp)
+        *timestamp = d->timestamps[pos];
+    return dv;
+}
+
+/* Convert a compressed block to uncompressed samples */
+static UA_StatusCode
+unpackBlock(ColumnarContext *ctx, ColumnarNode *node, ColumnarBlock *b) {
+    if(!b->type)
+        return UA_STATUSCODE_GOOD;
+    size_t capacity = (b->count > 0) ? b->count * 2 : 1;
+    UA_DateTime *timestamps = (UA_DateTime*)UA_malloc(capacity * sizeof(UA_DateTime));
+    UA_DataValue *values = (UA_DataValue*)UA_calloc(capacity, sizeof(UA_DataValue));
+    if(!timestamps || !values) {
+        UA_free(timestamps);
+        UA_free(values);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < b->count; i++) {
+        const UA_DataValue *dv =
+            sampleValue(ctx, node, b->start + i, &timestamps[i]);
+        res |= UA_DataValue_copy(dv, &values[i]);
+    }
+    if(res != UA_STATUSCODE_GOOD) {
+        for(size_t i = 0; i < b->count; i++)
+            UA_DataValue_clear(&values[i]);
+        UA_free(timestamps);
+        UA_free(values);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_free(b->bits.data);
+    memset(&b->bits, 0, sizeof(BitStream));
+    b->type = NULL;
+    b->timestamps = timestamps;
+    b->values = values;
+    b->capacity = capacity;
+    return UA_STATUSCODE_GOOD;
+}
+
+static ColumnarBlock *
+insertBlock(ColumnarContext *ctx, ColumnarNode *node, size_t pos) {
+    if(node->blocksSize >= node->blocksCapacity) {
+        size_t newCapacity = (node->blocksCapacity > 0) ? node->blocksCapacity * 2 : 4;
+        ColumnarBlock *blocks = (ColumnarBlock*)
+            UA_realloc(node->blocks, newCapacity * sizeof(ColumnarBlock));
+        if(!blocks)
+            return NULL;
+        node->blocks = blocks;
+        node->blocksCapacity = newCapacity;
+    }
+    memmove(&node->blocks[pos + 1], &node->blocks[pos],
+            (node->blocksSize - pos) * sizeof(ColumnarBlock));
+    node->blocksSize++;
+    ColumnarBlock *b = &node->blocks[pos];
+    memset(b, 0, sizeof(ColumnarBlock));
+    b->id = ++ctx->lastBlockId;
+    b->start = (pos > 0) ? node->blocks[pos - 1].start + node->blocks[pos - 1].count : 0;
+    return b;
+}
+
+static void
+removeBlock(ColumnarNode *node, size_t pos) {
+    ColumnarBlock_clear(&node->blocks[pos]);
+    memmove(&node->blocks[pos], &node->blocks[pos + 1],
+            (node->blocksSize - pos - 1) * sizeof(ColumnarBlock));
+    node->blocksSize--;
+}
+
+static void
+updateBlockStarts(ColumnarNode *node, size_t from) {
+    size_t start = (from > 0) ? node->blocks[from - 1].start + node->blocks[from - 1].count : 0;
+    for(size_t i = from; i < node->blocksSize; i++) {
+        node->blocks[i].start = start;
+        start += node->blocks[i].count;
+    }
+}
+
+/* Add an uncompressed sample at the position in the block */
+static UA_StatusCode
+insertIntoBlock(ColumnarBlock *b, size_t pos, UA_DateTime timestamp,
+                const UA_DataValue *value) {
+    if(b->count >= b->capacity) {
+        size_t newCapacity = (b->capacity > 0) ? b->capacity * 2 : COLUMNAR_BLOCKSIZE;
+        UA_DateTime *timestamps = (UA_DateTime*)
+            UA_realloc(b->timestamps, newCapacity * sizeof(UA_DateTime));
+        if(!timestamps)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        b->timestamps = timestamps;
+        UA_DataValue *values = (UA_DataValue*)
+            UA_realloc(b->values, newCapacity * sizeof(UA_DataValue));
+        if(!values)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        b->values = values;
+        b->capacity = newCapacity;
+    }
+    UA_DataValue copy;
+    UA_StatusCode res = UA_DataValue_copy(value, &copy);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    memmove(&b->timestamps[pos + 1], &b->timestamps[pos],
+            (b->count - pos) * sizeof(UA_DateTime));
+    memmove(&b->values[pos + 1], &b->values[pos],
+            (b->count - pos) * sizeof(UA_DataValue));
+    b->timestamps[pos] = timestamp;
+    b->values[pos] = copy;
+    b->count++;
+    b->firstTimestamp = b->timestamps[0];
+    b->lastTimestamp = b->timestamps[b->count - 1];
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Split an uncompressed block that grew beyond twice the block size */
+static UA_StatusCode
+splitBlock(ColumnarContext *ctx, ColumnarNode *node, size_t pos) {
+    if(node->blocks[pos].count <= 2 * COLUMNAR_BLOCKSIZE)
+        return UA_STATUSCODE_GOOD;
+    ColumnarBlock *right = insertBlock(ctx, node, pos + 1);
+    if(!right)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    ColumnarBlock *left = &node->blocks[pos];
+    size_t half = left->count / 2;
+    size_t moved = left->count - half;
+    right->timestamps = (UA_DateTime*)UA_malloc(moved * sizeof(UA_DateTime));
+    right->values = (UA_DataValue*)UA_malloc(moved * sizeof(UA_DataValue));
+    if(!right->timestamps || !right->values) {
+        removeBlock(node, pos + 1);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    memcpy(right->timestamps, &left->timestamps[half], moved * sizeof(UA_DateTime));
+    memcpy(right->values, &left->values[half], moved * sizeof(UA_DataValue));
+    right->capacity = moved;
+    right->count = moved;
+    right->firstTimestamp = right->timestamps[0];
+    right->lastTimestamp = right->timestamps[moved - 1];
+    left->count = half;
+    left->lastTimestamp = left->timestamps[half - 1];
+    updateBlockStarts(node, pos + 1);
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Append a sample whose timestamp is not before the last sample */
+static UA_StatusCode
+appendSample(ColumnarContext *ctx, ColumnarNode *node, UA_DateTime timestamp,
+             const UA_DataValue *value) {
+    ColumnarBlock *b = (node->blocksSize > 0) ? &node->blocks[node->blocksSize - 1] : NULL;
+    UA_Boolean compressible = isCompressible(value);
+    if(b && b->count < COLUMNAR_BLOCKSIZE) {
+        if(b->type && compressible && fitsBlock(b, value)) {
+            UA_StatusCode res = BitStream_reserve(&b->bits, COLUMNAR_MAXSAMPLESIZE);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+            encodeSample(b, timestamp, value);
+            node->count++;
+            return UA_STATUSCODE_GOOD;
+        }
+        if(!b->type && !compressible) {
+            UA_StatusCode res = insertIntoBlock(b, b->count, timestamp, value);
+            if(res == UA_STATUSCODE_GOOD)
+                node->count++;
+            return res;
+        }
+    }
+
+    /* Start a new block */
+    b = insertBlock(ctx, node, node->blocksSize);
+    if(!b)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_StatusCode res;
+    if(compressible) {
+        b->type = value->value.type;
+        b->hasSourceTimestamp = value->hasSourceTimestamp;
+        b->hasStatus = value->hasStatus;
+        b->status = value->status;
+        res = BitStream_reserve(&b->bits, COLUMNAR_MAXSAMPLESIZE);
+        if(res == UA_STATUSCODE_GOOD)
+            encodeSample(b, timestamp, value);
+    } else {
+        res = insertIntoBlock(b, 0, timestamp, value);
+    }
+    if(res != UA_STATUSCODE_GOOD) {
+        removeBlock(node, node->blocksSize - 1);
+        return res;
+    }
+    node->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Insert the sample at the index. The server timestamp of the value is set. */
+static UA_StatusCode
+insertSample(ColumnarContext *ctx, ColumnarNode *node, size_t index,
+             UA_DateTime timestamp, const UA_DataValue *value) {
+    if(index == node->count &&
+       (node->count == 0 || timestamp >= node->blocks[node->blocksSize - 1].lastTimestamp))
+        return appendSample(ctx, node, timestamp, value);
+
+    /* Insert into an uncompressed block */
+    size_t pos = (size_t)(findBlock(node, (index < node->count) ? index : index - 1) - node->blocks);
+    ColumnarBlock *b = &node->blocks[pos];
+    UA_StatusCode res = unpackBlock(ctx, node, b);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = insertIntoBlock(b, index - b->start, timestamp, value);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    node->count++;
+    node->version++;
+    updateBlockStarts(node, pos + 1);
+    return splitBlock(ctx, node, pos);
+}
+
+/* Remove the samples in [from, to) */
+static void
+removeSamples(ColumnarContext *ctx, ColumnarNode *node, size_t from, size_t to) {
+    size_t pos = (size_t)(findBlock(node, from) - node->blocks);
+    while(from < to && pos < node->blocksSize) {
+        ColumnarBlock *b = &node->blocks[pos];
+        size_t first = from - b->start;
+        size_t last = (to - b->start < b->count) ? to - b->start : b->count;
+        if(first == 0 && last == b->count) {
+            node->count -= b->count;
+            to -= b->count;
+            removeBlock(node, pos);
+            updateBlockStarts(node, pos);
+            continue;
+        }
+        if(unpackBlock(ctx, node, b) != UA_STATUSCODE_GOOD)
+            return;
+        for(size_t i = first; i < last; i++)
+            UA_DataValue_clear(&b->values[i]);
+        memmove(&b->timestamps[first], &b->timestamps[last],
+                (b->count - last) * sizeof(UA_DateTime));
+        memmove(&b->values[first], &b->values[last],
+                (b->count - last) * sizeof(UA_DataValue));
+        b->count -= last - first;
+        b->firstTimestamp = b->timestamps[0];
+        b->lastTimestamp = b->timestamps[b->count - 1];
+        node->count -= last - first;
+        to -= last - first;
+        updateBlockStarts(node, pos + 1);
+        from = b->start + b->count;
+        pos++;
+    }
+    node->version++;
+}
+
+/* The first index with a timestamp equal or after. Returns whether the
+ * timestamp is matched exactly. */
+static UA_Boolean
+searchTimestamp(ColumnarContext *ctx, ColumnarNode *node, UA_DateTime timestamp,
+                size_t *index) {
+    if(!node || node->count == 0) {
+        *index = 0;
+        return false;
+    }
+
+    /* Find the first block that ends at or after the timestamp */
+    size_t lo = 0, hi = node->blocksSize;
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if(node->blocks[mid].lastTimestamp < timestamp)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo == node->blocksSize) {
+        *index = node->count;
+        return false;
+    }
+
+    /* Search inside the block */
+    ColumnarBlock *b = &node->blocks[lo];
+    const UA_DateTime *ts = (b->type) ? decodeBlock(ctx, b)->timestamps : b->timestamps;
+    size_t l = 0, h = b->count;
+    while(l < h) {
+        size_t mid = (l + h) / 2;
+        if(ts[mid] < timestamp)
+            l = mid + 1;
+        else
+            h = mid;
+    }
+    *index = b->start + l;
+    return (l < b->count && ts[l] == timestamp);
+}
+
+static UA_DateTime
+valueTimestamp(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    return value->serverTimestamp;
+}
+
+/**************************/
+/* Backend Implementation */
+/**************************/
+
+static size_t
+getDateTimeMatch_backend_columnar(UA_Server *server, void *context,
+                                  const UA_NodeId *sessionId, void *sessionContext,
+                                  const UA_NodeId *nodeId, const UA_DateTime timestamp,
+                                  const MatchStrategy strategy) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    ColumnarNode *node = getNode(ctx, nodeId);
+    size_t end = (node) ? node->count : 0;
+    size_t current;
+    UA_Boolean found = searchTimestamp(ctx, node, timestamp, &current);
+
+    if((strategy == MATCH_EQUAL || strategy == MATCH_EQUAL_OR_AFTER ||
+        strategy == MATCH_EQUAL_OR_BEFORE) && found)
+        return current;
+    switch(strategy) {
+    case MATCH_AFTER:
+        if(found)
+            return current + 1;
+        return current;
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+    case MATCH_BEFORE:
+        if(current > 0)
+            return current - 1;
+        return end;
+    default:
+        break;
+    }
+    return end;
+}
+
+static size_t
+getEnd_backend_columnar(UA_Server *server, void *context,
+                        const UA_NodeId *sessionId, void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    ColumnarNode *node = getNode((ColumnarContext*)context, nodeId);
+    return (node) ? node->count : 0;
+}
+
+static size_t
+lastIndex_backend_columnar(UA_Server *server, void *context,
+                           const UA_NodeId *sessionId, void *sessionContext,
+                           const UA_NodeId *nodeId) {
+    ColumnarNode *node = getNode((ColumnarContext*)context, nodeId);
+    if(!node || node->count == 0)
+        return 0;
+    return node->count - 1;
+}
+
+static size_t
+firstIndex_backend_columnar(UA_Server *server, void *context,
+                            const UA_NodeId *sessionId, void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static size_t
+resultSize_backend_columnar(UA_Server *server, void *context,
+                            const UA_NodeId *sessionId, void *sessionContext,
+                            const UA_NodeId *nodeId, size_t startIndex,
+                            size_t endIndex) {
+    ColumnarNode *node = getNode((ColumnarContext*)context, nodeId);
+    if(!node || node->count == 0 || startIndex == node->count ||
+       endIndex == node->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static UA_Boolean
+boundSupported_backend_columnar(UA_Server *server, void *context,
+                                const UA_NodeId *sessionId, void *sessionContext,
+                                const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_columnar(UA_Server *server, void *context,
+                                             const UA_NodeId *sessionId,
+                                             void *sessionContext,
+                                             const UA_NodeId *nodeId,
+                                             const UA_TimestampsToReturn ttr) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    ColumnarNode *node = getNode(ctx, nodeId);
+    if(!node || node->count == 0)
+        return true;
+    const UA_DataValue *first = sampleValue(ctx, node, 0, NULL);
+    if(ttr == UA_TIMESTAMPSTORETURN_NEITHER ||
+       ttr == UA_TIMESTAMPSTORETURN_INVALID ||
+       (ttr == UA_TIMESTAMPSTORETURN_SERVER && !first->hasServerTimestamp) ||
+       (ttr == UA_TIMESTAMPSTORETURN_SOURCE && !first->hasSourceTimestamp) ||
+       (ttr == UA_TIMESTAMPSTORETURN_BOTH &&
+        !(first->hasSourceTimestamp && first->hasServerTimestamp)))
+        return false;
+    return true;
+}
+
+/* Fully covered compressed blocks use their statistics. The other samples
+ * are read. */
+static UA_StatusCode
+getSummary_backend_columnar(UA_Server *server, void *context,
+                            const UA_NodeId *sessionId, void *sessionContext,
+                            const UA_NodeId *nodeId, size_t startIndex,
+                            size_t endIndex, UA_HistoryDataSummary *summary) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    ColumnarNode *node = getNode(ctx, nodeId);
+    if(!node || startIndex > endIndex || endIndex >= node->count)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    memset(summary, 0, sizeof(UA_HistoryDataSummary));
+    size_t pos = (size_t)(findBlock(node, startIndex) - node->blocks);
+    size_t index = startIndex;
+    for(; index <= endIndex; pos++) {
+        ColumnarBlock *b = &node->blocks[pos];
+        size_t last = b->start + b->count - 1;
+        if(last > endIndex)
+            last = endIndex;
+        if(b->type && index == b->start && last == b->start + b->count - 1) {
+            UA_HistoryDataSummary_merge(summary, &b->summary);
+            index = last + 1;
+            continue;
+        }
+        for(; index <= last; index++) {
+            UA_DateTime timestamp;
+            const UA_DataValue *dv = sampleValue(ctx, node, index, &timestamp);
+            UA_StatusCode status = (dv->hasStatus) ? dv->status : UA_STATUSCODE_GOOD;
+            UA_Double number = 0.0;
+            UA_Boolean included = !UA_StatusCode_isBad(status) && dv->hasValue &&
+                UA_HistoryAggregate_toDouble(&dv->value, &number);
+            UA_HistoryDataSummary_add(summary, timestamp, included,
+                                      UA_StatusCode_isUncertain(status), number);
+        }
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static const UA_DataValue *
+getDataValue_backend_columnar(UA_Server *server, void *context,
+                              const UA_NodeId *sessionId, void *sessionContext,
+                              const UA_NodeId *nodeId, size_t index) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    ColumnarNode *node = getNode(ctx, nodeId);
+    if(!node || index >= node->count)
+        return NULL;
+    return sampleValue(ctx, node, index, NULL);
+}
+
+static UA_StatusCode
+copyDataValues_backend_columnar(UA_Server *server, void *context,
+                                const UA_NodeId *sessionId, void *sessionContext,
+                                const UA_NodeId *nodeId, size_t startIndex,
+                                size_t endIndex, UA_Boolean reverse, size_t maxValues,
+                                UA_NumericRange range,
+                                UA_Boolean releaseContinuationPoints,
+                                const UA_ByteString *continuationPoint,
+                                UA_ByteString *outContinuationPoint,
+                                size_t *providedValues, UA_DataValue *values) {
+    ColumnarCursor cursor;
+    memset(&cursor, 0, sizeof(ColumnarCursor));
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(ColumnarCursor))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&cursor, continuationPoint->data, sizeof(ColumnarCursor));
+    }
+
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    ColumnarNode *node = getNode(ctx, nodeId);
+    size_t end = (node) ? node->count : 0;
+
+    /* Resume at the cursor or after the last delivered timestamp */
+    size_t index = startIndex;
+    if(cursor.skip > 0) {
+        if(node && cursor.version == node->version)
+            index = cursor.index;
+        else
+            index = getDateTimeMatch_backend_columnar(server, context, sessionId,
+                                                      sessionContext, nodeId,
+                                                      cursor.lastTimestamp,
+                                                      reverse ? MATCH_BEFORE : MATCH_AFTER);
+    }
+
+    /* Number of values left in the range */
+    size_t remaining = 0;
+    if(index < end) {
+        if(reverse && index >= endIndex)
+            remaining = index - endIndex + 1;
+        else if(!reverse && endIndex >= index)
+            remaining = endIndex - index + 1;
+    }
+
+    /* Decoding happens block by block when the samples are viewed */
+    size_t counter = 0;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    while(counter < remaining && counter < maxValues) {
+        const UA_DataValue *dv = sampleValue(ctx, node, index, &cursor.lastTimestamp);
+        if(range.dimensionsSize > 0) {
+            /* A value outside of the range is returned without a value */
+            values[counter] = *dv;
+            UA_Variant_init(&values[counter].value);
+            if(dv->hasValue &&
+               UA_Variant_copyRange(&dv->value, &values[counter].value,
+                                    range) != UA_STATUSCODE_GOOD)
+                values[counter].hasValue = false;
+        } else {
+            res = UA_DataValue_copy(dv, &values[counter]);
+        }
+        if(res != UA_STATUSCODE_GOOD)
+            break;
+        ++counter;
+        if(reverse)
+            --index;
+        else
+            ++index;
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    if(remaining > counter) {
+        cursor.skip += counter;
+        cursor.index = index;
+        cursor.version = node->version;
+        res = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(ColumnarCursor));
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        memcpy(outContinuationPoint->data, &cursor, sizeof(ColumnarCursor));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_columnar(UA_Server *server, void *context,
+                                      const UA_NodeId *sessionId, void *sessionContext,
+                                      const UA_NodeId *nodeId, UA_Boolean historizing,
+                                      const UA_DataValue *value) {
+    ColumnarContext *ctx = (ColumnarContext*)context;
+    ColumnarNode *node = getOrAddNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_DateTime timestamp;
+    if(value->hasSourceTimestamp)
+        timestamp = value->sourceTimestamp;
+    else if(value->hasServerTimestamp)
+        timestamp = value->serverTimestamp;
+    else
+        timestamp = UA_DateTime_now();
+
+    /* The stored value always has a server timestamp */
+    UA_DataValue v = *value;
+    if(!v.hasServerTimestamp) {
+        v.serverTimestamp = timestamp;
+        v.hasServerTimestamp = true;
+    }
+
+    size_t index = node->count;
+    if(node->count > 0 && timestamp < node->blocks[node->blocksSize - 1].lastTimestamp)
+        searchTimestamp(ctx, node, timestamp, &index);
+    return insertSample(ctx, node, index, timestamp, &v);
+}
+
+static UA_StatusCode
+insertDataValue_backend_columnar(UA_Server *server, void *hdbContext,
+                                 const UA_NodeId *sessionId, void *sessionContext,
+                                 const UA_NodeId *nodeId, const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    ColumnarContext *ctx = (ColumnarContext*)hdbContext;
+    ColumnarNode *node = getOrAddNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_DateTime timestamp = valueTimestamp(value);
+    size_t index;
+    if(searchTimestamp(ctx, node, timestamp, &index))
+        return UA_STATUSCODE_BADENTRYEXISTS;
+
+    UA_DataValue v = *value;
+    if(!v.hasServerTimestamp) {
+        v.serverTimestamp = timestamp;
+        v.hasServerTimestamp = true;
+    }
+    return insertSample(ctx, node, index, timestamp, &v);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_columnar(UA_Server *server, void *hdbContext,
+                                  const UA_NodeId *sessionId, void *sessionContext,
+                                  const UA_NodeId *nodeId, const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    ColumnarContext *ctx = (ColumnarContext*)hdbContext;
+    ColumnarNode *node = getNode(ctx, nodeId);
+    UA_DateTime timestamp = valueTimestamp(value);
+    size_t index;
+    if(!searchTimestamp(ctx, node, timestamp, &index))
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+
+    ColumnarBlock *b = findBlock(node, index);
+    UA_StatusCode res = unpackBlock(ctx, node, b);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_DataValue copy;
+    res = UA_DataValue_copy(value, &copy);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    if(!copy.hasServerTimestamp) {
+        copy.serverTimestamp = timestamp;
+        copy.hasServerTimestamp = true;
+    }
+    UA_DataValue_clear(&b->values[index - b->start]);
+    b->values[index - b->start] = copy;
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+updateDataValue_backend_columnar(UA_Server *server, void *hdbContext,
+                                 const UA_NodeId *sessionId, void *sessionContext,
+                                 const UA_NodeId *nodeId, const UA_DataValue *value) {
+    /* First try to replace, because it is cheap */
+    UA_StatusCode res =
+        replaceDataValue_backend_columnar(server, hdbContext, sessionId,
+                                          sessionContext, nodeId, value);
+    if(res == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+    res = insertDataValue_backend_columnar(server, hdbContext, sessionId,
+                                           sessionContext, nodeId, value);
+    if(res == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return res;
+}
+
+static UA_StatusCode
+removeDataValue_backend_columnar(UA_Server *server, void *hdbContext,
+                                 const UA_NodeId *sessionId, void *sessionContext,
+                                 const UA_NodeId *nodeId, UA_DateTime startTimestamp,
+                                 UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    ColumnarContext *ctx = (ColumnarContext*)hdbContext;
+    ColumnarNode *node = getNode(ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADNODATA;
+
+    /* The first index which is deleted and the first which is not */
+    size_t index1, index2;
+    if(startTimestamp == endTimestamp) {
+        if(!searchTimestamp(ctx, node, startTimestamp, &index1))
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        index1 = getDateTimeMatch_backend_columnar(server, hdbContext, sessionId,
+                                                   sessionContext, nodeId,
+                                                   startTimestamp, MATCH_EQUAL_OR_AFTER);
+        index2 = getDateTimeMatch_backend_columnar(server, hdbContext, sessionId,
+                                                   sessionContext, nodeId,
+                                                   endTimestamp, MATCH_BEFORE);
+        if(index2 == node->count || index1 == node->count || index1 > index2)
+            return UA_STATUSCODE_BADNODATA;
+        ++index2;
+    }
+    removeSamples(ctx, node, index1, index2);
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+ColumnarContext_delete(ColumnarContext *ctx) {
+    for(size_t i = 0; i < ctx->nodesSize; i++)
+        ColumnarNode_clear(&ctx->nodes[i]);
+    UA_free(ctx->nodes);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
+    UA_free(ctx);
+}
+
+static void
+deleteMembers_backend_columnar(UA_HistoryDataBackend *backend) {
+    if(!backend || !backend->context)
+        return;
+    ColumnarContext_delete((ColumnarContext*)backend->context);
+    backend->context = NULL;
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_Columnar(size_t initialNodeIdStoreSize) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    ColumnarContext *ctx = (ColumnarContext*)UA_calloc(1, sizeof(ColumnarContext));
+    if(!ctx)
+        return result;
+    if(initialNodeIdStoreSize == 0)
+        initialNodeIdStoreSize = 1;
+    ctx->nodes = (ColumnarNode*)UA_calloc(initialNodeIdStoreSize, sizeof(ColumnarNode));
+    if(!ctx->nodes) {
+        UA_free(ctx);
+        return result;
+    }
+    ctx->nodesCapacity = initialNodeIdStoreSize;
+    UA_HistoryNodeIdIndex_init(&ctx->index, sizeof(ColumnarNode),
+                               offsetof(ColumnarNode, nodeId));
+    result.serverSetHistoryData = &serverSetHistoryData_backend_columnar;
+    result.getSummary = &getSummary_backend_columnar;
+    result.resultSize = &resultSize_backend_columnar;
+    result.getEnd = &getEnd_backend_columnar;
+    result.lastIndex = &lastIndex_backend_columnar;
+    result.firstIndex = &firstIndex_backend_columnar;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_columnar;
+    result.copyDataValues = &copyDataValues_backend_columnar;
+    result.getDataValue = &getDataValue_backend_columnar;
+    result.boundSupported = &boundSupported_backend_columnar;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_columnar;
+    result.insertDataValue = &insertDataValue_backend_columnar;
+    result.updateDataValue = &updateDataValue_backend_columnar;
+    result.replaceDataValue = &replaceDataValue_backend_columnar;
+    result.removeDataValue = &removeDataValue_backend_columnar;
+    result.deleteMembers = &deleteMembers_backend_columnar;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_Columnar_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_columnar(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
@@ -0,0 +1,1077 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/plugin/historydata/history_data_backend_file.h>
+
+#if defined(__linux__) || defined(__unix__)
+
+#include "mp_printf.h"
+#include "ua_history_nodeid_index.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#define FILE_INDEXINTERVAL UA_HISTORYDATABACKEND_FILE_INDEXINTERVAL
+#define FILE_SUFFIX ".uahist"
+#define FILE_PATHSIZE 1024
+#define FILE_NUMBERSIZE 21 /* The dot and up to 20 digits of the number */
+
+#ifndef NAME_MAX
+# define NAME_MAX 255
+#endif
+
+/* A segment starts with the magic. Every record consists of the length of the
+ * encoded DataValue (UInt32), the timestamp of the sample (Int64) and the
+ * binary-encoded DataValue. Integers are little-endian. The unused tail of the
+ * segment is zeroed. A record length of zero marks the end. */
+static const UA_Byte fileMagic[8] = {'U', 'A', 'H', 'I', 'S', 'T', '0', '1'};
+#define FILE_HEADERSIZE 8
+#define FILE_RECORDHEADERSIZE 12
+
+typedef struct {
+    UA_DateTime timestamp;
+    size_t offset;
+} FileIndexEntry;
+
+typedef struct {
+    UA_UInt64 number; /* Part of the file name */
+    UA_Byte *map;
+    size_t capacity;  /* Size of the file and of the mapping */
+    size_t used;      /* Bytes used by the header and the records */
+    size_t start;     /* Index of the first sample in the node */
+    size_t count;
+    UA_DateTime lastTimestamp;
+
+    /* Entry k points to the record k * FILE_INDEXINTERVAL */
+    size_t indexSize;
+    FileIndexEntry *index;
+} FileSegment;
+
+typedef struct {
+    UA_NodeId nodeId;
+    char *name; /* Escaped NodeId for the file names */
+    size_t count;
+    UA_UInt32 version; /* Incremented when samples move to a different index */
+    size_t segmentsSize;
+    FileSegment *segments;
+} FileNode;
+
+typedef struct {
+    char *directory;
+    size_t segmentSize;
+    UA_Duration retention;
+    size_t nodesSize;
+    FileNode *nodes;
+    UA_HistoryNodeIdIndex index;
+    UA_DataValue current; /* Decoded in getDataValue */
+} FileContext;
+
+/* Continuation point of copyDataValues. See the memory backend. */
+typedef struct {
+    size_t skip;
+    size_t index;
+    UA_UInt32 version;
+    UA_DateTime lastTimestamp;
+} FileCursor;
+
+/***********/
+/* Records */
+/***********/
+
+static void
+writeUInt32(UA_Byte *pos, UA_UInt32 v) {
+    for(size_t i = 0; i < 4; i++)
+        pos[i] = (UA_Byte)(v >> (8 * i));
+}
+
+static UA_UInt32
+readUInt32(const UA_Byte *pos) {
+    UA_UInt32 v = 0;
+    for(size_t i = 0; i < 4; i++)
+        v |= (UA_UInt32)pos[i] << (8 * i);
+    return v;
+}
+
+static void
+writeInt64(UA_Byte *pos, UA_Int64 v) {
+    for(size_t i = 0; i < 8; i++)
+        pos[i] = (UA_Byte)((UA_UInt64)v >> (8 * i));
+}
+
+static UA_Int64
+readInt64(const UA_Byte *pos) {
+    UA_UInt64 v = 0;
+    for(size_t i = 0; i < 8; i++)
+        v |= (UA_UInt64)pos[i] << (8 * i);
+    return (UA_Int64)v;
+}
+
+static size_t
+recordSize(const FileSegment *seg, size_t offset) {
+    return FILE_RECORDHEADERSIZE + readUInt32(&seg->map[offset]);
+}
+
+static UA_DateTime
+recordTimestamp(const FileSegment *seg, size_t offset) {
+    return readInt64(&seg->map[offset + 4]);
+}
+
+static UA_StatusCode
+decodeRecord(const FileSegment *seg, size_t offset, UA_DataValue *value) {
+    UA_ByteString buf;
+    buf.length = readUInt32(&seg->map[offset]);
+    buf.data = &seg->map[offset + FILE_RECORDHEADERSIZE];
+    return UA_decodeBinary(&buf, value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+}
+
+/* The space for the record is available */
+static UA_StatusCode
+encodeRecord(FileSegment *seg, size_t offset, UA_DateTime timestamp,
+             const UA_DataValue *value, size_t encodedSize) {
+    writeUInt32(&seg->map[offset], (UA_UInt32)encodedSize);
+    writeInt64(&seg->map[offset + 4], timestamp);
+    UA_ByteString buf;
+    buf.length = encodedSize;
+    buf.data = &seg->map[offset + FILE_RECORDHEADERSIZE];
+    return UA_encodeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE], &buf, NULL);
+}
+
+/************/
+/* Segments */
+/************/
+
+static UA_StatusCode
+segmentPath(const FileContext *ctx, const FileNode *node, UA_UInt64 number,
+            char *path) {
+    int len = mp_snprintf(path, FILE_PATHSIZE, "%s/%s.%08llu%s", ctx->directory,
+                          node->name, (unsigned long long)number, FILE_SUFFIX);
+    if(len < 0 || len >= FILE_PATHSIZE)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Rebuild the timestamp index from the records */
+static UA_StatusCode
+scanSegment(FileSegment *seg) {
+    size_t indexCapacity = seg->capacity / (FILE_RECORDHEADERSIZE * FILE_INDEXINTERVAL) + 1;
+    FileIndexEntry *index = (FileIndexEntry*)
+        UA_realloc(seg->index, indexCapacity * sizeof(FileIndexEntry));
+    if(!index)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    seg->index = index;
+    seg->indexSize = 0;
+    seg->count = 0;
+    size_t offset = FILE_HEADERSIZE;
+    while(offset + FILE_RECORDHEADERSIZE <= seg->capacity) {
+        UA_UInt32 len = readUInt32(&seg->map[offset]);
+        if(len == 0 || offset + FILE_RECORDHEADERSIZE + len > seg->capacity)
+            break; /* End or incomplete record */
+        UA_DateTime timestamp = recordTimestamp(seg, offset);
+        if(seg->count % FILE_INDEXINTERVAL == 0) {
+            seg->index[seg->indexSize].timestamp = timestamp;
+            seg->index[seg->indexSize].offset = offset;
+            seg->indexSize++;
+        }
+        seg->lastTimestamp = timestamp;
+        seg->count++;
+        offset += FILE_RECORDHEADERSIZE + len;
+    }
+    seg->used = offset;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Map the segment file. The file is created with the capacity if it does not
+ * exist. Existing files are grown to the capacity. The disk space is allocated
+ * before mapping. */
+static UA_StatusCode
+mapSegment(const FileContext *ctx, const FileNode *node, FileSegment *seg,
+           size_t capacity) {
+    char path[FILE_PATHSIZE];
+    UA_StatusCode res = segmentPath(ctx, node, seg->number, path);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    int fd = open(path, O_RDWR | O_CREAT, 0644);
+    if(fd < 0)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    struct stat st;
+    if(fstat(fd, &st) != 0) {
+        close(fd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+    size_t size = (size_t)st.st_size;
+    UA_Boolean created = (size == 0);
+    if(size < capacity)
+        size = capacity;
+    if(size < FILE_HEADERSIZE) {
+        close(fd);
+        return UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* Reserve the disk space. This also grows the file. Writing to a sparse
+     * file through the mapping raises SIGBUS when the disk is full. */
+    int err;
+    do {
+        err = posix_fallocate(fd, 0, (off_t)size);
+    } while(err == EINTR);
+    if(err != 0) {
+        close(fd);
+        return (err == ENOSPC) ?
+            UA_STATUSCODE_BADRESOURCEUNAVAILABLE : UA_STATUSCODE_BADINTERNALERROR;
+    }
+
+    /* The mapping remains valid after the file is closed */
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    close(fd);
+    if(map == MAP_FAILED)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    if(created) {
+        memcpy(map, fileMagic, FILE_HEADERSIZE);
+    } else if(memcmp(map, fileMagic, FILE_HEADERSIZE) != 0) {
+        munmap(map, size);
+        return UA_STATUSCODE_BADDECODINGERROR;
+    }
+    if(seg->map)
+        munmap(seg->map, seg->capacity);
+    seg->map = (UA_Byte*)map;
+    seg->capacity = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+FileSegment_clear(FileSegment *seg) {
+    if(seg->map) {
+        msync(seg->map, seg->capacity, MS_ASYNC);
+        munmap(seg->map, seg->capacity);
+    }
+    UA_free(seg->index);
+    memset(seg, 0, sizeof(FileSegment));
+}
+
+static void
+updateSegmentStarts(FileNode *node) {
+    size_t start = 0;
+    for(size_t i = 0; i < node->segmentsSize; i++) {
+        node->segments[i].start = start;
+        start += node->segments[i].count;
+    }
+    node->count = start;
+}
+
+static UA_StatusCode
+addSegment(FileContext *ctx, FileNode *node, UA_UInt64 number, size_t capacity) {
+    FileSegment *segments = (FileSegment*)
+        UA_realloc(node->segments, (node->segmentsSize + 1) * sizeof(FileSegment));
+    if(!segments)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    node->segments = segments;
+    FileSegment *seg = &segments[node->segmentsSize];
+    memset(seg, 0, sizeof(FileSegment));
+    seg->number = number;
+    UA_StatusCode res = mapSegment(ctx, node, seg, capacity);
+    if(res == UA_STATUSCODE_GOOD)
+        res = scanSegment(seg);
+    if(res != UA_STATUSCODE_GOOD) {
+        FileSegment_clear(seg);
+        return res;
+    }
+
+    /* Drop loaded segments without records. They were created right before
+     * a shutdown. */
+    if(capacity == 0 && seg->count == 0) {
+        char path[FILE_PATHSIZE];
+        if(segmentPath(ctx, node, number, path) == UA_STATUSCODE_GOOD)
+            unlink(path);
+        FileSegment_clear(seg);
+        return UA_STATUSCODE_GOOD;
+    }
+    seg->start = node->count;
+    node->count += seg->count;
+    node->segmentsSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+deleteSegment(FileContext *ctx, FileNode *node, size_t pos) {
+    char path[FILE_PATHSIZE];
+    if(segmentPath(ctx, node, node->segments[pos].number, path) == UA_STATUSCODE_GOOD)
+        unlink(path);
+    FileSegment_clear(&node->segments[pos]);
+    memmove(&node->segments[pos], &node->segments[pos + 1],
+            (node->segmentsSize - pos - 1) * sizeof(FileSegment));
+    node->segmentsSize--;
+    updateSegmentStarts(node);
+    node->version++;
+}
+
+/* Replace the bytes [from, to) of the segment with a record. The following
+ * records are moved and the file grows if required. */
+static UA_StatusCode
+spliceSegment(FileContext *ctx, FileNode *node, FileSegment *seg,
+              size_t from, size_t to, UA_DateTime timestamp,
+              const UA_DataValue *value) {
+    size_t encodedSize = 0;
+    size_t insertSize = 0;
+    if(value) {
+        encodedSize = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+        if(encodedSize == 0 || encodedSize > UA_UINT32_MAX)
+            return UA_STATUSCODE_BADENCODINGERROR;
+        insertSize = FILE_RECORDHEADERSIZE + encodedSize;
+    }
+    size_t oldUsed = seg->used;
+    size_t newUsed = oldUsed - (to - from) + insertSize;
+    if(newUsed > seg->capacity) {
+        size_t capacity = seg->capacity * 2;
+        if(capacity < newUsed)
+            capacity = newUsed;
+        UA_StatusCode res = mapSegment(ctx, node, seg, capacity);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+    }
+    memmove(&seg->map[from + insertSize], &seg->map[to], oldUsed - to);
+    if(newUsed < oldUsed)
+        memset(&seg->map[newUsed], 0, oldUsed - newUsed);
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    if(value)
+        res = encodeRecord(seg, from, timestamp, value, encodedSize);
+    res |= scanSegment(seg);
+    updateSegmentStarts(node);
+    return res;
+}
+
+/*********/
+/* Nodes */
+/*********/
+
+/* Escape all characters except for letters and digits. If the escaped name
+ * exceeds the limits for file names and paths, the name is "_h" followed by
+ * a 64-bit hash of the NodeId. This cannot clash with an escaped name, where
+ * the underscore is followed by two uppercase hex digits. */
+static char *
+escapeNodeId(const FileContext *ctx, const UA_NodeId *nodeId) {
+    UA_String s = UA_STRING_NULL;
+    if(UA_NodeId_print(nodeId, &s) != UA_STATUSCODE_GOOD)
+        return NULL;
+    size_t maxLen = NAME_MAX - FILE_NUMBERSIZE - strlen(FILE_SUFFIX);
+    size_t dirLen = strlen(ctx->directory);
+    if(dirLen + 1 + FILE_NUMBERSIZE + strlen(FILE_SUFFIX) >= FILE_PATHSIZE) {
+        UA_String_clear(&s);
+        return NULL;
+    }
+    size_t pathLen = FILE_PATHSIZE - dirLen - 1 - FILE_NUMBERSIZE - strlen(FILE_SUFFIX) - 1;
+    if(pathLen < maxLen)
+        maxLen = pathLen;
+
+    static const char hex[] = "0123456789ABCDEF";
+    size_t len = 0;
+    for(size_t i = 0; i < s.length; i++) {
+        UA_Byte c = s.data[i];
+        len += ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                (c >= '0' && c <= '9')) ? 1 : 3;
+    }
+
+    char *name = NULL;
+    if(len <= maxLen) {
+        name = (char*)UA_malloc(len + 1);
+        if(name) {
+            size_t pos = 0;
+            for(size_t i = 0; i < s.length; i++) {
+                UA_Byte c = s.data[i];
+                if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') ||
+                   (c >= '0' && c <= '9')) {
+                    name[pos++] = (char)c;
+                } else {
+                    name[pos++] = '_';
+                    name[pos++] = hex[c >> 4];
+                    name[pos++] = hex[c & 0x0f];
+                }
+            }
+            name[pos] = 0;
+        }
+    } else if(maxLen >= 18) {
+        /* FNV-1a */
+        UA_UInt64 hash = 14695981039346656037ULL;
+        for(size_t i = 0; i < s.length; i++) {
+            hash ^= s.data[i];
+            hash *= 1099511628211ULL;
+        }
+        name = (char*)UA_malloc(19);
+        if(name) {
+            name[0] = '_';
+            name[1] = 'h';
+            for(size_t i = 0; i < 16; i++)
+                name[2 + i] = hex[(hash >> (60 - 4 * i)) & 0x0f];
+            name[18] = 0;
+        }
+    }
+    UA_String_clear(&s);
+    return name;
+}
+
+static int
+cmpSegmentNumber(const void *a, const void *b) {
+    UA_UInt64 na = *(const UA_UInt64*)a;
+    UA_UInt64 nb = *(const UA_UInt64*)b;
+    return (na < nb) ? -1 : (na > nb);
+}
+
+/* Open the existing segments of the node in the order of their numbers */
+static UA_StatusCode
+loadSegments(FileContext *ctx, FileNode *node) {
+    DIR *dir = opendir(ctx->directory);
+    if(!dir)
+        return UA_STATUSCODE_BADINTERNALERROR;
+    size_t nameLen = strlen(node->name);
+    size_t suffixLen = strlen(FILE_SUFFIX);
+    UA_UInt64 *numbers = NULL;
+    size_t numbersSize = 0;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    struct dirent *entry;
+    while((entry = readdir(dir))) {
+        size_t len = strlen(entry->d_name);
+        if(len <= nameLen + 1 + suffixLen ||
+           strncmp(entry->d_name, node->name, nameLen) != 0 ||
+           entry->d_name[nameLen] != '.' ||
+           strcmp(&entry->d_name[len - suffixLen], FILE_SUFFIX) != 0)
+            continue;
+        char *end = NULL;
+        unsigned long long number = strtoull(&entry->d_name[nameLen + 1], &end, 10);
+        if(end != &entry->d_name[len - suffixLen])
+            continue;
+        UA_UInt64 *newNumbers = (UA_UInt64*)
+            UA_realloc(numbers, (numbersSize + 1) * sizeof(UA_UInt64));
+        if(!newNumbers) {
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+            break;
+        }
+        numbers = newNumbers;
+        numbers[numbersSize++] = (UA_UInt64)number;
+    }
+    closedir(dir);
+
+    /* Segments that cannot be mapped are skipped */
+    if(numbersSize > 1)
+        qsort(numbers, numbersSize, sizeof(UA_UInt64), cmpSegmentNumber);
+    for(size_t i = 0; i < numbersSize && res == UA_STATUSCODE_GOOD; i++) {
+        if(addSegment(ctx, node, numbers[i], 0) == UA_STATUSCODE_BADOUTOFMEMORY)
+            res = UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    UA_free(numbers);
+    return res;
+}
+
+static void
+FileNode_clear(FileNode *node) {
+    for(size_t i = 0; i < node->segmentsSize; i++)
+        FileSegment_clear(&node->segments[i]);
+    UA_free(node->segments);
+    UA_free(node->name);
+    UA_NodeId_clear(&node->nodeId);
+    memset(node, 0, sizeof(FileNode));
+}
+
+/* Returns the node. The segments on disk are loaded on first use. */
+static FileNode *
+getNode(UA_Server *server, FileContext *ctx, const UA_NodeId *nodeId) {
+    size_t pos = UA_HistoryNodeIdIndex_find(&ctx->index, ctx->nodes, nodeId);
+    if(pos != SIZE_MAX)
+        return &ctx->nodes[pos];
+    FileNode *nodes = (FileNode*)
+        UA_realloc(ctx->nodes, (ctx->nodesSize + 1) * sizeof(FileNode));
+    if(!nodes)
+        return NULL;
+    ctx->nodes = nodes;
+    FileNode *node = &nodes[ctx->nodesSize];
+    memset(node, 0, sizeof(FileNode));
+    node->name = escapeNodeId(ctx, nodeId);
+    if(!node->name) {
+        UA_LOG_WARNING(UA_Server_getConfig(server)->logging, UA_LOGCATEGORY_SERVER,
+                       "HistoryFile: No file name for the node %N in the "
+                       "directory %s", *nodeId, ctx->directory);
+        return NULL;
+    }
+    if(UA_NodeId_copy(nodeId, &node->nodeId) != UA_STATUSCODE_GOOD ||
+       loadSegments(ctx, node) != UA_STATUSCODE_GOOD ||
+       UA_HistoryNodeIdIndex_add(&ctx->index, nodeId, ctx->nodesSize) != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(UA_Server_getConfig(server)->logging, UA_LOGCATEGORY_SERVER,
+                       "HistoryFile: Could not load the history of the node %N "
+                       "from the directory %s", *nodeId, ctx->directory);
+        FileNode_clear(node);
+        return NULL;
+    }
+    ctx->nodesSize++;
+    return node;
+}
+
+/* Find the segment and the offset of the record with the index */
+static FileSegment *
+locate(FileNode *node, size_t index, size_t *offset) {
+    size_t lo = 0, hi = node->segmentsSize;
+    while(hi - lo > 1) {
+        size_t mid = (lo + hi) / 2;
+        if(node->segments[mid].start <= index)
+            lo = mid;
+        else
+            hi = mid;
+    }
+    FileSegment *seg = &node->segments[lo];
+    size_t pos = index - seg->start;
+    size_t off = seg->index[pos / FILE_INDEXINTERVAL].offset;
+    for(size_t i = 0; i < pos % FILE_INDEXINTERVAL; i++)
+        off += recordSize(seg, off);
+    *offset = off;
+    return seg;
+}
+
+/* The first index with a timestamp equal or after. Returns whether the
+ * timestamp is matched exactly. */
+static UA_Boolean
+searchTimestamp(FileNode *node, UA_DateTime timestamp, size_t *index) {
+    /* Find the first segment that ends at or after the timestamp */
+    size_t lo = 0, hi = node->segmentsSize;
+    while(lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if(node->segments[mid].lastTimestamp < timestamp)
+            lo = mid + 1;
+        else
+            hi = mid;
+    }
+    if(lo == node->segmentsSize) {
+        *index = node->count;
+        return false;
+    }
+
+    /* Find the last index entry before the timestamp */
+    FileSegment *seg = &node->segments[lo];
+    size_t l = 0, h = seg->indexSize;
+    while(l < h) {
+        size_t mid = (l + h) / 2;
+        if(seg->index[mid].timestamp < timestamp)
+            l = mid + 1;
+        else
+            h = mid;
+    }
+    size_t entry = (l > 0) ? l - 1 : 0;
+
+    /* Walk the records */
+    size_t pos = entry * FILE_INDEXINTERVAL;
+    size_t offset = seg->index[entry].offset;
+    while(pos < seg->count && recordTimestamp(seg, offset) < timestamp) {
+        offset += recordSize(seg, offset);
+        pos++;
+    }
+    *index = seg->start + pos;
+    return (pos < seg->count && recordTimestamp(seg, offset) == timestamp);
+}
+
+/* Append a record in a new segment if the last segment is full */
+static UA_StatusCode
+appendRecord(FileContext *ctx, FileNode *node, UA_DateTime timestamp,
+             const UA_DataValue *value) {
+    size_t encodedSize = UA_calcSizeBinary(value, &UA_TYPES[UA_TYPES_DATAVALUE], NULL);
+    if(encodedSize == 0 || encodedSize > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADENCODINGERROR;
+    size_t size = FILE_RECORDHEADERSIZE + encodedSize;
+
+    FileSegment *seg = (node->segmentsSize > 0) ?
+        &node->segments[node->segmentsSize - 1] : NULL;
+    if(!seg || seg->used + size > seg->capacity) {
+        if(seg)
+            msync(seg->map, seg->capacity, MS_ASYNC);
+        UA_UInt64 number = (seg) ? seg->number + 1 : 0;
+        size_t capacity = ctx->segmentSize;
+        if(capacity < FILE_HEADERSIZE + size)
+            capacity = FILE_HEADERSIZE + size;
+        UA_StatusCode res = addSegment(ctx, node, number, capacity);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        seg = &node->segments[node->segmentsSize - 1];
+
+        /* Drop the segments beyond the retention */
+        if(ctx->retention > 0) {
+            UA_DateTime oldest = timestamp -
+                (UA_DateTime)(ctx->retention * UA_DATETIME_MSEC);
+            while(node->segmentsSize > 1 && node->segments[0].lastTimestamp < oldest)
+                deleteSegment(ctx, node, 0);
+            seg = &node->segments[node->segmentsSize - 1];
+        }
+    }
+
+    size_t offset = seg->used;
+    UA_StatusCode res = encodeRecord(seg, offset, timestamp, value, encodedSize);
+    if(res != UA_STATUSCODE_GOOD) {
+        memset(&seg->map[offset], 0, size);
+        if(seg->count == 0)
+            deleteSegment(ctx, node, node->segmentsSize - 1);
+        return res;
+    }
+    if(seg->count % FILE_INDEXINTERVAL == 0) {
+        seg->index[seg->indexSize].timestamp = timestamp;
+        seg->index[seg->indexSize].offset = offset;
+        seg->indexSize++;
+    }
+    seg->lastTimestamp = timestamp;
+    seg->count++;
+    seg->used += size;
+    node->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Insert the record at the index and keep the timestamp order */
+static UA_StatusCode
+insertRecord(FileContext *ctx, FileNode *node, size_t index,
+             UA_DateTime timestamp, const UA_DataValue *value) {
+    if(index == node->count)
+        return appendRecord(ctx, node, timestamp, value);
+    size_t offset;
+    FileSegment *seg = locate(node, index, &offset);
+    node->version++;
+    return spliceSegment(ctx, node, seg, offset, offset, timestamp, value);
+}
+
+static UA_DateTime
+keyTimestamp(const UA_DataValue *value) {
+    if(value->hasSourceTimestamp)
+        return value->sourceTimestamp;
+    if(value->hasServerTimestamp)
+        return value->serverTimestamp;
+    return UA_DateTime_now();
+}
+
+/**************************/
+/* Backend Implementation */
+/**************************/
+
+static size_t
+getDateTimeMatch_backend_file(UA_Server *server, void *context,
+                              const UA_NodeId *sessionId, void *sessionContext,
+                              const UA_NodeId *nodeId, const UA_DateTime timestamp,
+                              const MatchStrategy strategy) {
+    FileNode *node = getNode(server, (FileContext*)context, nodeId);
+    if(!node)
+        return 0;
+    size_t current;
+    UA_Boolean found = searchTimestamp(node, timestamp, &current);
+
+    if((strategy == MATCH_EQUAL || strategy == MATCH_EQUAL_OR_AFTER ||
+        strategy == MATCH_EQUAL_OR_BEFORE) && found)
+        return current;
+    switch(strategy) {
+    case MATCH_AFTER:
+        if(found)
+            return current + 1;
+        return current;
+    case MATCH_EQUAL_OR_AFTER:
+        return current;
+    case MATCH_EQUAL_OR_BEFORE:
+    case MATCH_BEFORE:
+        if(current > 0)
+            return current - 1;
+        return node->count;
+    default:
+        break;
+    }
+    return node->count;
+}
+
+static size_t
+getEnd_backend_file(UA_Server *server, void *context,
+                    const UA_NodeId *sessionId, void *sessionContext,
+                    const UA_NodeId *nodeId) {
+    FileNode *node = getNode(server, (FileContext*)context, nodeId);
+    return (node) ? node->count : 0;
+}
+
+static size_t
+lastIndex_backend_file(UA_Server *server, void *context,
+                       const UA_NodeId *sessionId, void *sessionContext,
+                       const UA_NodeId *nodeId) {
+    FileNode *node = getNode(server, (FileContext*)context, nodeId);
+    if(!node || node->count == 0)
+        return 0;
+    return node->count - 1;
+}
+
+static size_t
+firstIndex_backend_file(UA_Server *server, void *context,
+                        const UA_NodeId *sessionId, void *sessionContext,
+                        const UA_NodeId *nodeId) {
+    return 0;
+}
+
+static size_t
+resultSize_backend_file(UA_Server *server, void *context,
+                        const UA_NodeId *sessionId, void *sessionContext,
+                        const UA_NodeId *nodeId, size_t startIndex,
+                        size_t endIndex) {
+    FileNode *node = getNode(server, (FileContext*)context, nodeId);
+    if(!node || node->count == 0 || startIndex == node->count ||
+       endIndex == node->count)
+        return 0;
+    return endIndex - startIndex + 1;
+}
+
+static UA_Boolean
+boundSupported_backend_file(UA_Server *server, void *context,
+                            const UA_NodeId *sessionId, void *sessionContext,
+                            const UA_NodeId *nodeId) {
+    return true;
+}
+
+static UA_Boolean
+timestampsToReturnSupported_backend_file(UA_Server *server, void *context,
+                                         const UA_NodeId *sessionId,
+                                         void *sessionContext,
+                                         const UA_NodeId *nodeId,
+                                         const UA_TimestampsToReturn ttr) {
+    FileNode *node = getNode(server, (FileContext*)context, nodeId);
+    if(!node || node->count == 0)
+        return true;
+    UA_DataValue first;
+    size_t offset;
+    FileSegment *seg = locate(node, 0, &offset);
+    if(decodeRecord(seg, offset, &first) != UA_STATUSCODE_GOOD)
+        return false;
+    UA_Boolean supported = true;
+    if(ttr == UA_TIMESTAMPSTORETURN_NEITHER ||
+       ttr == UA_TIMESTAMPSTORETURN_INVALID ||
+       (ttr == UA_TIMESTAMPSTORETURN_SERVER && !first.hasServerTimestamp) ||
+       (ttr == UA_TIMESTAMPSTORETURN_SOURCE && !first.hasSourceTimestamp) ||
+       (ttr == UA_TIMESTAMPSTORETURN_BOTH &&
+        !(first.hasSourceTimestamp && first.hasServerTimestamp)))
+        supported = false;
+    UA_DataValue_clear(&first);
+    return supported;
+}
+
+/* The DataValue is decoded and valid until the next call */
+static const UA_DataValue *
+getDataValue_backend_file(UA_Server *server, void *context,
+                          const UA_NodeId *sessionId, void *sessionContext,
+                          const UA_NodeId *nodeId, size_t index) {
+    FileContext *ctx = (FileContext*)context;
+    FileNode *node = getNode(server, ctx, nodeId);
+    if(!node || index >= node->count)
+        return NULL;
+    UA_DataValue_clear(&ctx->current);
+    size_t offset;
+    FileSegment *seg = locate(node, index, &offset);
+    if(decodeRecord(seg, offset, &ctx->current) != UA_STATUSCODE_GOOD)
+        return NULL;
+    return &ctx->current;
+}
+
+static UA_StatusCode
+copyDataValues_backend_file(UA_Server *server, void *context,
+                            const UA_NodeId *sessionId, void *sessionContext,
+                            const UA_NodeId *nodeId, size_t startIndex,
+                            size_t endIndex, UA_Boolean reverse, size_t maxValues,
+                            UA_NumericRange range,
+                            UA_Boolean releaseContinuationPoints,
+                            const UA_ByteString *continuationPoint,
+                            UA_ByteString *outContinuationPoint,
+                            size_t *providedValues, UA_DataValue *values) {
+    FileCursor cursor;
+    memset(&cursor, 0, sizeof(FileCursor));
+    if(continuationPoint->length > 0) {
+        if(continuationPoint->length != sizeof(FileCursor))
+            return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+        memcpy(&cursor, continuationPoint->data, sizeof(FileCursor));
+    }
+
+    FileNode *node = getNode(server, (FileContext*)context, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Resume at the cursor or after the last delivered timestamp */
+    size_t index = startIndex;
+    if(cursor.skip > 0) {
+        if(cursor.version == node->version)
+            index = cursor.index;
+        else
+            index = getDateTimeMatch_backend_file(server, context, sessionId,
+                                                  sessionContext, nodeId,
+                                                  cursor.lastTimestamp,
+                                                  reverse ? MATCH_BEFORE : MATCH_AFTER);
+    }
+
+    /* Number of values left in the range */
+    size_t remaining = 0;
+    if(index < node->count) {
+        if(reverse && index >= endIndex)
+            remaining = index - endIndex + 1;
+        else if(!reverse && endIndex >= index)
+            remaining = endIndex - index + 1;
+    }
+
+    /* Decode from the mapped segments. Forward reads walk the records. */
+    size_t counter = 0;
+    size_t offset = 0;
+    FileSegment *seg = NULL;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    while(counter < remaining && counter < maxValues) {
+        if(reverse || !seg || index >= seg->start + seg->count)
+            seg = locate(node, index, &offset);
+        cursor.lastTimestamp = recordTimestamp(seg, offset);
+        if(range.dimensionsSize > 0) {
+            /* A value outside of the range is returned without a value */
+            UA_DataValue dv;
+            res = decodeRecord(seg, offset, &dv);
+            if(res != UA_STATUSCODE_GOOD)
+                break;
+            values[counter] = dv;
+            UA_Variant_init(&values[counter].value);
+            if(dv.hasValue &&
+               UA_Variant_copyRange(&dv.value, &values[counter].value,
+                                    range) != UA_STATUSCODE_GOOD)
+                values[counter].hasValue = false;
+            UA_Variant_clear(&dv.value);
+        } else {
+            res = decodeRecord(seg, offset, &values[counter]);
+            if(res != UA_STATUSCODE_GOOD)
+                break;
+        }
+        offset += recordSize(seg, offset);
+        ++counter;
+        if(reverse)
+            --index;
+        else
+            ++index;
+    }
+
+    if(providedValues)
+        *providedValues = counter;
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    if(remaining > counter) {
+        cursor.skip += counter;
+        cursor.index = index;
+        cursor.version = node->version;
+        res = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(FileCursor));
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        memcpy(outContinuationPoint->data, &cursor, sizeof(FileCursor));
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_StatusCode
+serverSetHistoryData_backend_file(UA_Server *server, void *context,
+                                  const UA_NodeId *sessionId, void *sessionContext,
+                                  const UA_NodeId *nodeId, UA_Boolean historizing,
+                                  const UA_DataValue *value) {
+    FileContext *ctx = (FileContext*)context;
+    FileNode *node = getNode(server, ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* The stored value always has a server timestamp */
+    UA_DateTime timestamp = keyTimestamp(value);
+    UA_DataValue v = *value;
+    if(!v.hasServerTimestamp) {
+        v.serverTimestamp = timestamp;
+        v.hasServerTimestamp = true;
+    }
+
+    size_t index = node->count;
+    if(node->count > 0 &&
+       timestamp < node->segments[node->segmentsSize - 1].lastTimestamp)
+        searchTimestamp(node, timestamp, &index);
+    return insertRecord(ctx, node, index, timestamp, &v);
+}
+
+static UA_StatusCode
+insertDataValue_backend_file(UA_Server *server, void *hdbContext,
+                             const UA_NodeId *sessionId, void *sessionContext,
+                             const UA_NodeId *nodeId, const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    FileContext *ctx = (FileContext*)hdbContext;
+    FileNode *node = getNode(server, ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_DateTime timestamp = keyTimestamp(value);
+    size_t index;
+    if(searchTimestamp(node, timestamp, &index))
+        return UA_STATUSCODE_BADENTRYEXISTS;
+
+    UA_DataValue v = *value;
+    if(!v.hasServerTimestamp) {
+        v.serverTimestamp = timestamp;
+        v.hasServerTimestamp = true;
+    }
+    return insertRecord(ctx, node, index, timestamp, &v);
+}
+
+static UA_StatusCode
+replaceDataValue_backend_file(UA_Server *server, void *hdbContext,
+                              const UA_NodeId *sessionId, void *sessionContext,
+                              const UA_NodeId *nodeId, const UA_DataValue *value) {
+    if(!value->hasSourceTimestamp && !value->hasServerTimestamp)
+        return UA_STATUSCODE_BADINVALIDTIMESTAMP;
+    FileContext *ctx = (FileContext*)hdbContext;
+    FileNode *node = getNode(server, ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    UA_DateTime timestamp = keyTimestamp(value);
+    size_t index;
+    if(!searchTimestamp(node, timestamp, &index))
+        return UA_STATUSCODE_BADNOENTRYEXISTS;
+
+    UA_DataValue v = *value;
+    if(!v.hasServerTimestamp) {
+        v.serverTimestamp = timestamp;
+        v.hasServerTimestamp = true;
+    }
+    size_t offset;
+    FileSegment *seg = locate(node, index, &offset);
+    return spliceSegment(ctx, node, seg, offset, offset + recordSize(seg, offset),
+                         timestamp, &v);
+}
+
+static UA_StatusCode
+updateDataValue_backend_file(UA_Server *server, void *hdbContext,
+                             const UA_NodeId *sessionId, void *sessionContext,
+                             const UA_NodeId *nodeId, const UA_DataValue *value) {
+    /* First try to replace, because it is cheap */
+    UA_StatusCode res =
+        replaceDataValue_backend_file(server, hdbContext, sessionId,
+                                      sessionContext, nodeId, value);
+    if(res == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYREPLACED;
+    res = insertDataValue_backend_file(server, hdbContext, sessionId,
+                                       sessionContext, nodeId, value);
+    if(res == UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_GOODENTRYINSERTED;
+    return res;
+}
+
+static UA_StatusCode
+removeDataValue_backend_file(UA_Server *server, void *hdbContext,
+                             const UA_NodeId *sessionId, void *sessionContext,
+                             const UA_NodeId *nodeId, UA_DateTime startTimestamp,
+                             UA_DateTime endTimestamp) {
+    if(startTimestamp > endTimestamp)
+        return UA_STATUSCODE_BADTIMESTAMPNOTSUPPORTED;
+    FileContext *ctx = (FileContext*)hdbContext;
+    FileNode *node = getNode(server, ctx, nodeId);
+    if(!node)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* The first index which is deleted and the first which is not */
+    size_t index1, index2;
+    if(startTimestamp == endTimestamp) {
+        if(!searchTimestamp(node, startTimestamp, &index1))
+            return UA_STATUSCODE_BADNODATA;
+        index2 = index1 + 1;
+    } else {
+        index1 = getDateTimeMatch_backend_file(server, hdbContext, sessionId,
+                                               sessionContext, nodeId,
+                                               startTimestamp, MATCH_EQUAL_OR_AFTER);
+        index2 = getDateTimeMatch_backend_file(server, hdbContext, sessionId,
+                                               sessionContext, nodeId,
+                                               endTimestamp, MATCH_BEFORE);
+        if(index2 == node->count || index1 == node->count || index1 > index2)
+            return UA_STATUSCODE_BADNODATA;
+        ++index2;
+    }
+
+    /* Remove backwards. This keeps the indices of the earlier segments. */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = node->segmentsSize; i > 0; i--) {
+        FileSegment *seg = &node->segments[i - 1];
+        size_t first = (index1 > seg->start) ? index1 : seg->start;
+        size_t last = (index2 < seg->start + seg->count) ? index2 : seg->start + seg->count;
+        if(first >= last)
+            continue;
+        if(first == seg->start && last == seg->start + seg->count) {
+            deleteSegment(ctx, node, i - 1);
+            continue;
+        }
+        size_t from, to = seg->used;
+        locate(node, first, &from);
+        if(last < seg->start + seg->count)
+            locate(node, last, &to);
+        res |= spliceSegment(ctx, node, seg, from, to, 0, NULL);
+    }
+    node->version++;
+    return res;
+}
+
+static void
+deleteMembers_backend_file(UA_HistoryDataBackend *backend) {
+    if(!backend || !backend->context)
+        return;
+    FileContext *ctx = (FileContext*)backend->context;
+    for(size_t i = 0; i < ctx->nodesSize; i++)
+        FileNode_clear(&ctx->nodes[i]);
+    UA_free(ctx->nodes);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
+    UA_DataValue_clear(&ctx->current);
+    UA_free(ctx->directory);
+    UA_free(ctx);
+    backend->context = NULL;
+}
+
+UA_HistoryDataBackend
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           UA_Duration retention) {
+    UA_HistoryDataBackend result;
+    memset(&result, 0, sizeof(UA_HistoryDataBackend));
+    if(!directory)
+        return result;
+    if(mkdir(directory, 0755) != 0 && errno != EEXIST)
+        return result;
+    FileContext *ctx = (FileContext*)UA_calloc(1, sizeof(FileContext));
+    if(!ctx)
+        return result;
+    size_t len = strlen(directory);
+    ctx->directory = (char*)UA_malloc(len + 1);
+    if(!ctx->directory) {
+        UA_free(ctx);
+        return result;
+    }
+    memcpy(ctx->directory, directory, len + 1);
+    ctx->segmentSize = segmentSize;
+    ctx->retention = retention;
+    UA_HistoryNodeIdIndex_init(&ctx->index, sizeof(FileNode),
+                               offsetof(FileNode, nodeId));
+    result.serverSetHistoryData = &serverSetHistoryData_backend_file;
+    result.resultSize = &resultSize_backend_file;
+    result.getEnd = &getEnd_backend_file;
+    result.lastIndex = &lastIndex_backend_file;
+    result.firstIndex = &firstIndex_backend_file;
+    result.getDateTimeMatch = &getDateTimeMatch_backend_file;
+    result.copyDataValues = &copyDataValues_backend_file;
+    result.getDataValue = &getDataValue_backend_file;
+    result.boundSupported = &boundSupported_backend_file;
+    result.timestampsToReturnSupported = &timestampsToReturnSupported_backend_file;
+    result.insertDataValue = &insertDataValue_backend_file;
+    result.updateDataValue = &updateDataValue_backend_file;
+    result.replaceDataValue = &replaceDataValue_backend_file;
+    result.removeDataValue = &removeDataValue_backend_file;
+    result.deleteMembers = &deleteMembers_backend_file;
+    result.getHistoryData = NULL;
+    result.context = ctx;
+    return result;
+}
+
+void
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend) {
+    deleteMembers_backend_file(backend);
+    memset(backend, 0, sizeof(UA_HistoryDataBackend));
+}
+
+#endif /* defined(__linux__) || defined(__unix__) */
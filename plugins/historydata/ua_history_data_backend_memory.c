@@ -8,7 +8,10 @@
 
 #include <open62541/plugin/historydata/history_data_backend_memory.h>
 
+#include "ua_history_nodeid_index.h"
+
 #include <limits.h>
+#include <stddef.h>
 #include <string.h>
 
 typedef struct {
@@ -29,8 +32,21 @@ typedef struct {
     size_t storeSize;
     /* New field useful for circular buffer management */
     size_t lastInserted;
+    /* Incremented when values are moved to a different index */
+    UA_UInt32 version;
 } UA_NodeIdStoreContextItem_backend_memory;
 
+/* Continuation point of copyDataValues. The index resumes a read in constant
+ * time as long as the version of the store is unchanged. Otherwise the sorted
+ * store is searched for the value after the last delivered timestamp. The
+ * circular store skips the number of values already delivered. */
+typedef struct {
+    size_t skip;
+    size_t index;
+    UA_UInt32 version;
+    UA_DateTime lastTimestamp;
+} UA_MemoryStoreCursor;
+
 static void
 UA_NodeIdStoreContextItem_clear(UA_NodeIdStoreContextItem_backend_memory* item) {
     UA_NodeId_clear(&item->nodeId);
@@ -46,6 +62,8 @@ typedef struct {
     size_t storeEnd;
     size_t storeSize;
     size_t initialStoreSize;
+    UA_Boolean circular; /* The values are not sorted by their timestamp */
+    UA_HistoryNodeIdIndex index; /* Position of the NodeIds in the dataStore */
 } UA_MemoryStoreContext;
 
 static void
@@ -54,6 +72,7 @@ UA_MemoryStoreContext_clear(UA_MemoryStoreContext* ctx) {
         UA_NodeIdStoreContextItem_clear(&ctx->dataStore[i]);
     }
     UA_free(ctx->dataStore);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
     memset(ctx, 0, sizeof(UA_MemoryStoreContext));
 }
 
@@ -83,6 +102,10 @@ getNewNodeIdContext_backend_memory(UA_MemoryStoreContext* context,
     item->dataStore = store;
     item->storeSize = ctx->initialStoreSize;
     item->storeEnd = 0;
+    if (UA_HistoryNodeIdIndex_add(&ctx->index, nodeId, ctx->storeEnd) != UA_STATUSCODE_GOOD) {
+        UA_NodeIdStoreContextItem_clear(item);
+        return NULL;
+    }
     ++ctx->storeEnd;
     return item;
 }
@@ -92,11 +115,9 @@ getNodeIdStoreContextItem_backend_memory(UA_MemoryStoreContext* context,
                                          UA_Server *server,
                                          const UA_NodeId *nodeId)
 {
-    for (size_t i = 0; i < context->storeEnd; ++i) {
-        if (UA_NodeId_equal(nodeId, &context->dataStore[i].nodeId)) {
-            return &context->dataStore[i];
-        }
-    }
+    size_t pos = UA_HistoryNodeIdIndex_find(&context->index, context->dataStore, nodeId);
+    if (pos != SIZE_MAX)
+        return &context->dataStore[pos];
     return getNewNodeIdContext_backend_memory(context, server, nodeId);
 }
 
@@ -187,16 +208,9 @@ getDateTimeMatch_backend_memory(UA_Server *server,
 
 
 static UA_StatusCode
-serverSetHistoryData_backend_memory(UA_Server *server,
-                                    void *context,
-                                    const UA_NodeId *sessionId,
-                                    void *sessionContext,
-                                    const UA_NodeId * nodeId,
-                                    UA_Boolean historizing,
-                                    const UA_DataValue *value)
+addDataValue_backend_memory(UA_NodeIdStoreContextItem_backend_memory *item,
+                               const UA_DataValue *value)
 {
-    UA_NodeIdStoreContextItem_backend_memory *item = getNodeIdStoreContextItem_backend_memory((UA_MemoryStoreContext*)context, server, nodeId);
-
     if (item->storeEnd >= item->storeSize) {
         size_t newStoreSize = item->storeSize == 0 ? INITIAL_MEMORY_STORE_SIZE : item->storeSize * 2;
         item->dataStore = (UA_DataValueMemoryStoreItem **)UA_realloc(item->dataStore,  (newStoreSize * sizeof(UA_DataValueMemoryStoreItem*)));
@@ -215,27 +229,62 @@ serverSetHistoryData_backend_memory(UA_Server *server,
         timestamp = UA_DateTime_now();
     }
     UA_DataValueMemoryStoreItem *newItem = (UA_DataValueMemoryStoreItem *)UA_calloc(1, sizeof(UA_DataValueMemoryStoreItem));
+    if (!newItem)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
     newItem->timestamp = timestamp;
     UA_DataValue_copy(value, &newItem->value);
     if(!newItem->value.hasServerTimestamp) {
         newItem->value.serverTimestamp = timestamp;
         newItem->value.hasServerTimestamp = true;
     }
-    size_t index = getDateTimeMatch_backend_memory(server,
-                                                   context,
-                                                   NULL,
-                                                   NULL,
-                                                   nodeId,
-                                                   timestamp,
-                                                   MATCH_EQUAL_OR_AFTER);
-    if (item->storeEnd > 0 && index < item->storeEnd) {
+    /* Samples in timestamp order are appended without the binary search */
+    size_t index = item->storeEnd;
+    if (item->storeEnd > 0 && item->dataStore[item->storeEnd - 1]->timestamp >= timestamp) {
+        binarySearch_backend_memory(item, timestamp, &index);
         memmove(&item->dataStore[index+1], &item->dataStore[index], sizeof(UA_DataValueMemoryStoreItem*) * (item->storeEnd - index));
+        ++item->version;
     }
     item->dataStore[index] = newItem;
     ++item->storeEnd;
     return UA_STATUSCODE_GOOD;
 }
 
+static UA_StatusCode
+serverSetHistoryData_backend_memory(UA_Server *server,
+                                    void *context,
+                                    const UA_NodeId *sessionId,
+                                    void *sessionContext,
+                                    const UA_NodeId * nodeId,
+                                    UA_Boolean historizing,
+                                    const UA_DataValue *value)
+{
+    UA_NodeIdStoreContextItem_backend_memory *item = getNodeIdStoreContextItem_backend_memory((UA_MemoryStoreContext*)context, server, nodeId);
+    if (!item)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    return addDataValue_backend_memory(item, value);
+}
+
+static UA_StatusCode
+serverSetHistoryDataBatch_backend_memory(UA_Server *server,
+                                         void *context,
+                                         size_t valuesSize,
+                                         const UA_NodeId *nodeIds,
+                                         const UA_DataValue *values)
+{
+    /* The item is looked up once for consecutive samples of a NodeId */
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_NodeIdStoreContextItem_backend_memory *item = NULL;
+    for (size_t i = 0; i < valuesSize; ++i) {
+        if (!item || !UA_NodeId_equal(&nodeIds[i], &nodeIds[i-1]))
+            item = getNodeIdStoreContextItem_backend_memory((UA_MemoryStoreContext*)context, server, &nodeIds[i]);
+        UA_StatusCode res2 = item ? addDataValue_backend_memory(item, &values[i])
+                                  : UA_STATUSCODE_BADOUTOFMEMORY;
+        if (res == UA_STATUSCODE_GOOD)
+            res = res2;
+    }
+    return res;
+}
+
 static void
 UA_MemoryStoreContext_delete(UA_MemoryStoreContext* ctx) {
     UA_MemoryStoreContext_clear(ctx);
@@ -344,52 +393,82 @@ copyDataValues_backend_memory(UA_Server *server,
                               size_t * providedValues,
                               UA_DataValue * values)
 {
-    size_t skip = 0;
+    UA_MemoryStoreCursor cursor;
+    memset(&cursor, 0, sizeof(UA_MemoryStoreCursor));
     if (continuationPoint->length > 0) {
-        if (continuationPoint->length == sizeof(size_t)) {
-            skip = *((size_t*)(continuationPoint->data));
+        if (continuationPoint->length == sizeof(UA_MemoryStoreCursor)) {
+            memcpy(&cursor, continuationPoint->data, sizeof(UA_MemoryStoreCursor));
         } else {
             return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
         }
     }
-    const UA_NodeIdStoreContextItem_backend_memory* item = getNodeIdStoreContextItem_backend_memory((UA_MemoryStoreContext*)context, server, nodeId);
+    UA_MemoryStoreContext *ctx = (UA_MemoryStoreContext*)context;
+    const UA_NodeIdStoreContextItem_backend_memory* item = getNodeIdStoreContextItem_backend_memory(ctx, server, nodeId);
+
+    /* The continuation point is given by the client. Reject a cursor outside
+     * of the requested range. */
+    size_t rangeSize = 0;
+    if (reverse && startIndex >= endIndex)
+        rangeSize = startIndex - endIndex + 1;
+    else if (!reverse && endIndex >= startIndex)
+        rangeSize = endIndex - startIndex + 1;
+    if (cursor.skip > rangeSize)
+        return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+    if (cursor.skip > 0 && cursor.version == item->version &&
+        (cursor.index >= item->storeEnd ||
+         (reverse && (cursor.index > startIndex || cursor.index < endIndex)) ||
+         (!reverse && (cursor.index < startIndex || cursor.index > endIndex))))
+        return UA_STATUSCODE_BADCONTINUATIONPOINTINVALID;
+
+    /* Resume at the cursor */
     size_t index = startIndex;
+    if (cursor.skip > 0) {
+        if (cursor.version == item->version) {
+            index = cursor.index;
+        } else if (ctx->circular) {
+            index = reverse ? startIndex - cursor.skip : startIndex + cursor.skip;
+        } else {
+            index = getDateTimeMatch_backend_memory(server, context, sessionId, sessionContext,
+                                                    nodeId, cursor.lastTimestamp,
+                                                    reverse ? MATCH_BEFORE : MATCH_AFTER);
+        }
+    }
+
+    /* Number of values left in the range */
+    size_t remaining = 0;
+    if (index < item->storeEnd) {
+        if (reverse && index >= endIndex)
+            remaining = index - endIndex + 1;
+        else if (!reverse && endIndex >= index)
+            remaining = endIndex - index + 1;
+    }
+
     size_t counter = 0;
-    size_t skipedValues = 0;
-    if (reverse) {
-        while (index >= endIndex && index < item->storeEnd && counter < maxValues) {
-            if (skipedValues++ >= skip) {
-                if (range.dimensionsSize > 0) {
-                    UA_DataValue_backend_copyRange(&item->dataStore[index]->value, &values[counter], range);
-                } else {
-                    UA_DataValue_copy(&item->dataStore[index]->value, &values[counter]);
-                }
-                ++counter;
-            }
-            --index;
+    while (counter < remaining && counter < maxValues) {
+        if (range.dimensionsSize > 0) {
+            UA_DataValue_backend_copyRange(&item->dataStore[index]->value, &values[counter], range);
+        } else {
+            UA_DataValue_copy(&item->dataStore[index]->value, &values[counter]);
         }
-    } else {
-        while (index <= endIndex && counter < maxValues) {
-            if (skipedValues++ >= skip) {
-                if (range.dimensionsSize > 0) {
-                    UA_DataValue_backend_copyRange(&item->dataStore[index]->value, &values[counter], range);
-                } else {
-                    UA_DataValue_copy(&item->dataStore[index]->value, &values[counter]);
-                }
-                ++counter;
-            }
+        cursor.lastTimestamp = item->dataStore[index]->timestamp;
+        ++counter;
+        if (reverse)
+            --index;
+        else
             ++index;
-        }
     }
 
     if (providedValues)
         *providedValues = counter;
 
-    if ((!reverse && (endIndex-startIndex-skip+1) > counter) || (reverse && (startIndex-endIndex-skip+1) > counter)) {
-        outContinuationPoint->length = sizeof(size_t);
-        size_t t = sizeof(size_t);
-        outContinuationPoint->data = (UA_Byte*)UA_malloc(t);
-        *((size_t*)(outContinuationPoint->data)) = skip + counter;
+    if (remaining > counter) {
+        cursor.skip += counter;
+        cursor.index = index;
+        cursor.version = item->version;
+        UA_StatusCode res = UA_ByteString_allocBuffer(outContinuationPoint, sizeof(UA_MemoryStoreCursor));
+        if (res != UA_STATUSCODE_GOOD)
+            return res;
+        memcpy(outContinuationPoint->data, &cursor, sizeof(UA_MemoryStoreCursor));
     }
 
     return UA_STATUSCODE_GOOD;
@@ -437,6 +516,7 @@ insertDataValue_backend_memory(UA_Server *server,
 
     if (item->storeEnd > 0 && index < item->storeEnd) {
         memmove(&item->dataStore[index+1], &item->dataStore[index], sizeof(UA_DataValueMemoryStoreItem*) * (item->storeEnd - index));
+        ++item->version;
     }
     item->dataStore[index] = newItem;
     ++item->storeEnd;
@@ -559,6 +639,7 @@ removeDataValue_backend_memory(UA_Server *server,
     }
     memmove(&item->dataStore[index1], &item->dataStore[index2], sizeof(UA_DataValueMemoryStoreItem*) * (item->storeEnd - index2));
     item->storeEnd -= index2 - index1;
+    ++item->version;
 #else
     (void)index1;
     (void)index2;
@@ -592,7 +673,10 @@ UA_HistoryDataBackend_Memory(size_t initialNodeIdStoreSize, size_t initialDataSt
     ctx->initialStoreSize = initialDataStoreSize;
     ctx->storeSize = initialNodeIdStoreSize;
     ctx->storeEnd = 0;
+    UA_HistoryNodeIdIndex_init(&ctx->index, sizeof(UA_NodeIdStoreContextItem_backend_memory),
+                               offsetof(UA_NodeIdStoreContextItem_backend_memory, nodeId));
     result.serverSetHistoryData = &serverSetHistoryData_backend_memory;
+    result.serverSetHistoryDataBatch = &serverSetHistoryDataBatch_backend_memory;
     result.resultSize = &resultSize_backend_memory;
     result.getEnd = &getEnd_backend_memory;
     result.lastIndex = &lastIndex_backend_memory;
@@ -640,6 +724,10 @@ getNewNodeIdContext_backend_memory_Circular(UA_MemoryStoreContext *context,
     item->dataStore = store;
     item->storeSize = ctx->initialStoreSize;
     item->storeEnd = 0;
+    if (UA_HistoryNodeIdIndex_add(&ctx->index, nodeId, ctx->storeEnd) != UA_STATUSCODE_GOOD) {
+        UA_NodeIdStoreContextItem_clear(item);
+        return NULL;
+    }
     ++ctx->storeEnd;
     return item;
 }
@@ -648,11 +736,9 @@ static UA_NodeIdStoreContextItem_backend_memory *
 getNodeIdStoreContextItem_backend_memory_Circular(UA_MemoryStoreContext *context,
                                                   UA_Server *server,
                                                   const UA_NodeId *nodeId) {
-    for(size_t i = 0; i < context->storeEnd; ++i) {
-        if(UA_NodeId_equal(nodeId, &context->dataStore[i].nodeId)) {
-            return &context->dataStore[i];
-        }
-    }
+    size_t pos = UA_HistoryNodeIdIndex_find(&context->index, context->dataStore, nodeId);
+    if(pos != SIZE_MAX)
+        return &context->dataStore[pos];
     return getNewNodeIdContext_backend_memory_Circular(context, server, nodeId);
 }
 
@@ -694,6 +780,7 @@ serverSetHistoryData_backend_memory_Circular(UA_Server *server,
     if(item->dataStore[item->lastInserted] != NULL) {
         UA_DataValueMemoryStoreItem_clear(item->dataStore[item->lastInserted]);
         UA_free(item->dataStore[item->lastInserted]);
+        ++item->version;
     }
     item->dataStore[item->lastInserted] = newItem;
     ++item->lastInserted;
@@ -878,7 +965,11 @@ getHistoryData_service_Circular(UA_Server *server,
 UA_HistoryDataBackend
 UA_HistoryDataBackend_Memory_Circular(size_t initialNodeIdStoreSize, size_t initialDataStoreSize) {
     UA_HistoryDataBackend result = UA_HistoryDataBackend_Memory(initialNodeIdStoreSize, initialDataStoreSize);
+    if (!result.context)
+        return result;
+    ((UA_MemoryStoreContext*)result.context)->circular = true;
     result.serverSetHistoryData = &serverSetHistoryData_backend_memory_Circular;
+    result.serverSetHistoryDataBatch = NULL;
     result.getHistoryData = &getHistoryData_service_Circular;
     return result;
 }
@@ -10,6 +10,9 @@
 #include <open62541/plugin/historydata/history_data_gathering_default.h>
 #include <open62541/plugin/historydata/history_database_default.h>
 
+#include "ua_history_nodeid_index.h"
+
+#include <stddef.h>
 #include <string.h>
 
 typedef struct {
@@ -18,12 +21,136 @@ typedef struct {
     UA_MonitoredItemCreateResult monitoredResult;
 } UA_NodeIdStoreContextItem_gathering_default;
 
+/* Ring buffer of the buffered gathering. The samples are added and stored
+ * from the EventLoop of the server, so no locking is required. */
+typedef struct {
+    size_t position; /* Of the item in the dataStore */
+    UA_DataValue value;
+} UA_HistoryBufferEntry;
+
+typedef struct {
+    UA_HistoryBufferConfig config;
+    UA_HistoryBufferStatistics stats;
+    UA_HistoryBufferEntry *entries;
+    size_t first;
+    UA_UInt64 callbackId; /* Registered with the first NodeId */
+
+    /* Arrays of batchSize for the backend */
+    UA_NodeId *batchNodeIds; /* Shallow copies */
+    UA_DataValue *batchValues;
+} UA_HistoryBuffer;
+
 typedef struct {
     UA_NodeIdStoreContextItem_gathering_default *dataStore;
     size_t storeEnd;
     size_t storeSize;
+    UA_HistoryNodeIdIndex index; /* Position of the NodeIds in the dataStore */
+    UA_HistoryBuffer *buffer; /* Only for the buffered gathering */
 } UA_NodeIdStoreContext;
 
+static UA_NodeIdStoreContextItem_gathering_default*
+getNodeIdStoreContextItem_gathering_default(UA_NodeIdStoreContext *context,
+                                            const UA_NodeId *nodeId)
+{
+    size_t pos = UA_HistoryNodeIdIndex_find(&context->index, context->dataStore, nodeId);
+    if (pos == SIZE_MAX)
+        return NULL;
+    return &context->dataStore[pos];
+}
+
+/* Hand the next batch of buffered samples to the backends. Consecutive
+ * samples with the same backend are passed in one call. */
+static void
+storeBatch(UA_Server *server, UA_NodeIdStoreContext *ctx) {
+    UA_HistoryBuffer *buf = ctx->buffer;
+    size_t n = buf->stats.size;
+    if(n > buf->config.batchSize)
+        n = buf->config.batchSize;
+    size_t i = 0;
+    while(i < n) {
+        const UA_HistoryDataBackend *backend =
+            &ctx->dataStore[buf->entries[buf->first].position].setting.historizingBackend;
+        size_t count = 0;
+        for(; i < n; i++) {
+            UA_HistoryBufferEntry *entry = &buf->entries[buf->first];
+            UA_NodeIdStoreContextItem_gathering_default *item = &ctx->dataStore[entry->position];
+            if(item->setting.historizingBackend.context != backend->context)
+                break;
+            buf->batchNodeIds[count] = item->nodeId;
+            buf->batchValues[count] = entry->value;
+            count++;
+            buf->first = (buf->first + 1) % buf->config.capacity;
+            buf->stats.size--;
+        }
+        if(backend->serverSetHistoryDataBatch) {
+            backend->serverSetHistoryDataBatch(server, backend->context, count,
+                                               buf->batchNodeIds, buf->batchValues);
+        } else {
+            for(size_t j = 0; j < count; j++)
+                backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                              &buf->batchNodeIds[j], UA_TRUE,
+                                              &buf->batchValues[j]);
+        }
+        for(size_t j = 0; j < count; j++)
+            UA_DataValue_clear(&buf->batchValues[j]);
+        buf->stats.stored += count;
+    }
+}
+
+/* Store at most one batch per callback. The callback runs in the EventLoop
+ * and must not block it for the time of draining a full buffer. */
+static void
+flushCallback_gathering_buffered(UA_Server *server, void *data) {
+    UA_NodeIdStoreContext *ctx = (UA_NodeIdStoreContext*)data;
+    if(ctx->buffer->stats.size > 0)
+        storeBatch(server, ctx);
+}
+
+static void
+bufferSample(UA_Server *server, UA_NodeIdStoreContext *ctx,
+             UA_NodeIdStoreContextItem_gathering_default *item,
+             const UA_DataValue *value) {
+    UA_HistoryBuffer *buf = ctx->buffer;
+    if(buf->stats.size == buf->config.capacity) {
+        switch(buf->config.policy) {
+        case UA_HISTORYBUFFERPOLICY_DROPOLDEST:
+            UA_DataValue_clear(&buf->entries[buf->first].value);
+            buf->first = (buf->first + 1) % buf->config.capacity;
+            buf->stats.size--;
+            buf->stats.dropped++;
+            break;
+        case UA_HISTORYBUFFERPOLICY_FLUSH:
+            storeBatch(server, ctx);
+            buf->stats.forcedFlushes++;
+            break;
+        case UA_HISTORYBUFFERPOLICY_DROPNEWEST:
+        default:
+            buf->stats.dropped++;
+            return;
+        }
+    }
+    UA_HistoryBufferEntry *entry =
+        &buf->entries[(buf->first + buf->stats.size) % buf->config.capacity];
+    if(UA_DataValue_copy(value, &entry->value) != UA_STATUSCODE_GOOD) {
+        buf->stats.dropped++;
+        return;
+    }
+    /* Stamp the sample now. A backend would otherwise use the time of storing
+     * the batch. */
+    if(!entry->value.hasServerTimestamp) {
+        UA_EventLoop *el = UA_Server_getConfig(server)->eventLoop;
+        entry->value.serverTimestamp = el->dateTime_now(el);
+        entry->value.hasServerTimestamp = true;
+    }
+    entry->position = (size_t)(item - ctx->dataStore);
+    buf->stats.size++;
+    buf->stats.buffered++;
+    if(buf->stats.size > buf->stats.highWatermark)
+        buf->stats.highWatermark = buf->stats.size;
+}
+
+/* The MonitoredItem context is the UA_NodeIdStoreContext. The items move
+ * when the dataStore grows. */
 static void
 dataChangeCallback_gathering_default(UA_Server *server,
                                      UA_UInt32 monitoredItemId,
@@ -33,30 +160,27 @@ dataChangeCallback_gathering_default(UA_Server *server,
                                      UA_UInt32 attributeId,
                                      const UA_DataValue *value)
 {
-    UA_NodeIdStoreContextItem_gathering_default *context = (UA_NodeIdStoreContextItem_gathering_default*)monitoredItemContext;
-    context->setting.historizingBackend.serverSetHistoryData(server,
-                                                             context->setting.historizingBackend.context,
-                                                             NULL,
-                                                             NULL,
-                                                             nodeId,
-                                                             UA_TRUE,
-                                                             value);
-}
-
-static UA_NodeIdStoreContextItem_gathering_default*
-getNodeIdStoreContextItem_gathering_default(UA_NodeIdStoreContext *context,
-                                            const UA_NodeId *nodeId)
-{
-    for (size_t i = 0; i < context->storeEnd; ++i) {
-        if (UA_NodeId_equal(&context->dataStore[i].nodeId, nodeId)) {
-            return &context->dataStore[i];
-        }
+    UA_NodeIdStoreContextItem_gathering_default *item =
+        getNodeIdStoreContextItem_gathering_default((UA_NodeIdStoreContext*)monitoredItemContext, nodeId);
+    if (!item)
+        return;
+    UA_NodeIdStoreContext *ctx = (UA_NodeIdStoreContext*)monitoredItemContext;
+    if (ctx->buffer) {
+        bufferSample(server, ctx, item, value);
+        return;
     }
-    return NULL;
+    item->setting.historizingBackend.serverSetHistoryData(server,
+                                                          item->setting.historizingBackend.context,
+                                                          NULL,
+                                                          NULL,
+                                                          nodeId,
+                                                          UA_TRUE,
+                                                          value);
 }
 
 static UA_StatusCode
-startPoll(UA_Server *server, UA_NodeIdStoreContextItem_gathering_default *item)
+startPoll(UA_Server *server, UA_NodeIdStoreContext *ctx,
+          UA_NodeIdStoreContextItem_gathering_default *item)
 {
     UA_MonitoredItemCreateRequest monitorRequest =
             UA_MonitoredItemCreateRequest_default(item->nodeId);
@@ -66,7 +190,7 @@ startPoll(UA_Server *server, UA_NodeIdStoreContextItem_gathering_default *item)
             UA_Server_createDataChangeMonitoredItem(server,
                                                     UA_TIMESTAMPSTORETURN_BOTH,
                                                     monitorRequest,
-                                                    item,
+                                                    ctx,
                                                     &dataChangeCallback_gathering_default);
     return item->monitoredResult.statusCode;
 }
@@ -110,7 +234,7 @@ startPoll_gathering_default(UA_Server *server,
         return UA_STATUSCODE_BADNODEIDINVALID;
     if (item->monitoredResult.monitoredItemId > 0)
         return UA_STATUSCODE_BADMONITOREDITEMIDINVALID;
-    return startPoll(server, item);
+    return startPoll(server, ctx, item);
 }
 
 static UA_StatusCode
@@ -135,6 +259,10 @@ registerNodeId_gathering_default(UA_Server *server,
     }
     UA_NodeId_copy(nodeId, &ctx->dataStore[ctx->storeEnd].nodeId);
     size_t current = ctx->storeEnd;
+    if (UA_HistoryNodeIdIndex_add(&ctx->index, nodeId, current) != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&ctx->dataStore[current].nodeId);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
     ctx->dataStore[current].setting = setting;
     ++ctx->storeEnd;
     return UA_STATUSCODE_GOOD;
@@ -166,6 +294,17 @@ deleteMembers_gathering_default(UA_HistoryDataGathering *gathering)
         UA_assert(ctx->dataStore[i].monitoredResult.monitoredItemId == 0);
     }
     UA_free(ctx->dataStore);
+    UA_HistoryNodeIdIndex_clear(&ctx->index);
+    if (ctx->buffer) {
+        /* The EventLoop with the flush callback is already deleted */
+        UA_HistoryBuffer *buf = ctx->buffer;
+        for (size_t i = 0; i < buf->stats.size; i++)
+            UA_DataValue_clear(&buf->entries[(buf->first + i) % buf->config.capacity].value);
+        UA_free(buf->entries);
+        UA_free(buf->batchNodeIds);
+        UA_free(buf->batchValues);
+        UA_free(buf);
+    }
     UA_free(gathering->context);
 }
 
@@ -200,6 +339,10 @@ setValue_gathering_default(UA_Server *server,
         return;
     }
     if (item->setting.historizingUpdateStrategy == UA_HISTORIZINGUPDATESTRATEGY_VALUESET) {
+        if (ctx->buffer) {
+            bufferSample(server, ctx, item, value);
+            return;
+        }
         item->setting.historizingBackend.serverSetHistoryData(server,
                                                               item->setting.historizingBackend.context,
                                                               sessionId,
@@ -226,6 +369,8 @@ UA_HistoryDataGathering_Default(size_t initialNodeIdStoreSize)
     context->storeEnd = 0;
     context->storeSize = initialNodeIdStoreSize;
     context->dataStore = (UA_NodeIdStoreContextItem_gathering_default*)UA_calloc(initialNodeIdStoreSize, sizeof(UA_NodeIdStoreContextItem_gathering_default));
+    UA_HistoryNodeIdIndex_init(&context->index, sizeof(UA_NodeIdStoreContextItem_gathering_default),
+                               offsetof(UA_NodeIdStoreContextItem_gathering_default, nodeId));
     gathering.context = context;
     return gathering;
 }
@@ -245,6 +390,10 @@ registerNodeId_gathering_circular(UA_Server *server, void *context,
     }
     UA_NodeId_copy(nodeId, &ctx->dataStore[ctx->storeEnd].nodeId);
     size_t current = ctx->storeEnd;
+    if(UA_HistoryNodeIdIndex_add(&ctx->index, nodeId, current) != UA_STATUSCODE_GOOD) {
+        UA_NodeId_clear(&ctx->dataStore[current].nodeId);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
     ctx->dataStore[current].setting = setting;
     ++ctx->storeEnd;
     return UA_STATUSCODE_GOOD;
@@ -256,3 +405,72 @@ UA_HistoryDataGathering_Circular(size_t initialNodeIdStoreSize) {
     gathering.registerNodeId = &registerNodeId_gathering_circular;
     return gathering;
 }
+
+/* Buffered implementation */
+
+static UA_StatusCode
+registerNodeId_gathering_buffered(UA_Server *server, void *context,
+                                  const UA_NodeId *nodeId,
+                                  const UA_HistorizingNodeIdSettings setting) {
+    UA_NodeIdStoreContext *ctx = (UA_NodeIdStoreContext *)context;
+    UA_StatusCode res = registerNodeId_gathering_default(server, context, nodeId, setting);
+    if(res != UA_STATUSCODE_GOOD || ctx->buffer->callbackId != 0)
+        return res;
+    return UA_Server_addRepeatedCallback(server, flushCallback_gathering_buffered, ctx,
+                                         ctx->buffer->config.flushInterval,
+                                         &ctx->buffer->callbackId);
+}
+
+UA_HistoryDataGathering
+UA_HistoryDataGathering_Buffered(size_t initialNodeIdStoreSize,
+                                 const UA_HistoryBufferConfig *config) {
+    UA_HistoryDataGathering gathering = UA_HistoryDataGathering_Default(initialNodeIdStoreSize);
+    UA_NodeIdStoreContext *ctx = (UA_NodeIdStoreContext *)gathering.context;
+    if(!ctx || !config || config->capacity == 0 || config->batchSize == 0 ||
+       config->flushInterval <= 0.0) {
+        gathering.deleteMembers(&gathering);
+        memset(&gathering, 0, sizeof(UA_HistoryDataGathering));
+        return gathering;
+    }
+    UA_HistoryBuffer *buf = (UA_HistoryBuffer*)UA_calloc(1, sizeof(UA_HistoryBuffer));
+    if(!buf) {
+        gathering.deleteMembers(&gathering);
+        memset(&gathering, 0, sizeof(UA_HistoryDataGathering));
+        return gathering;
+    }
+    ctx->buffer = buf;
+    buf->config = *config;
+    if(buf->config.batchSize > buf->config.capacity)
+        buf->config.batchSize = buf->config.capacity;
+    buf->entries = (UA_HistoryBufferEntry*)
+        UA_calloc(buf->config.capacity, sizeof(UA_HistoryBufferEntry));
+    buf->batchNodeIds = (UA_NodeId*)UA_calloc(buf->config.batchSize, sizeof(UA_NodeId));
+    buf->batchValues = (UA_DataValue*)UA_calloc(buf->config.batchSize, sizeof(UA_DataValue));
+    if(!buf->entries || !buf->batchNodeIds || !buf->batchValues) {
+        gathering.deleteMembers(&gathering);
+        memset(&gathering, 0, sizeof(UA_HistoryDataGathering));
+        return gathering;
+    }
+    gathering.registerNodeId = &registerNodeId_gathering_buffered;
+    return gathering;
+}
+
+void
+UA_HistoryDataGathering_Buffered_flush(UA_Server *server,
+                                       UA_HistoryDataGathering *gathering) {
+    UA_NodeIdStoreContext *ctx = (UA_NodeIdStoreContext *)gathering->context;
+    if(!ctx || !ctx->buffer)
+        return;
+    while(ctx->buffer->stats.size > 0)
+        storeBatch(server, ctx);
+}
+
+UA_StatusCode
+UA_HistoryDataGathering_Buffered_getStatistics(const UA_HistoryDataGathering *gathering,
+                                               UA_HistoryBufferStatistics *stats) {
+    const UA_NodeIdStoreContext *ctx = (const UA_NodeIdStoreContext *)gathering->context;
+    if(!ctx || !ctx->buffer)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    *stats = ctx->buffer->stats;
+    return UA_STATUSCODE_GOOD;
+}
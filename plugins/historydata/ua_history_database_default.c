@@ -8,6 +8,8 @@
 #include <open62541/plugin/historydata/history_data_gathering_default.h>
 #include <open62541/plugin/historydata/history_database_default.h>
 
+#include "ua_history_aggregates.h"
+
 #include <limits.h>
 
 typedef struct {
@@ -578,6 +580,80 @@ readRaw_service_default(UA_Server *server,
     return;
 }
 
+static void
+readProcessed_service_default(UA_Server *server,
+                              void *context,
+                              const UA_NodeId *sessionId,
+                              void *sessionContext,
+                              const UA_RequestHeader *requestHeader,
+                              const UA_ReadProcessedDetails *historyReadDetails,
+                              UA_TimestampsToReturn timestampsToReturn,
+                              UA_Boolean releaseContinuationPoints,
+                              size_t nodesToReadSize,
+                              const UA_HistoryReadValueId *nodesToRead,
+                              UA_HistoryReadResponse *response,
+                              UA_HistoryData * const * const historyData)
+{
+    /* One aggregate per node */
+    if (historyReadDetails->aggregateTypeSize != nodesToReadSize) {
+        response->responseHeader.serviceResult = UA_STATUSCODE_BADAGGREGATELISTMISMATCH;
+        return;
+    }
+    UA_HistoryDatabaseContext_default *ctx = (UA_HistoryDatabaseContext_default*)context;
+    for (size_t i = 0; i < nodesToReadSize; ++i) {
+        UA_Byte accessLevel = 0;
+        UA_Server_readAccessLevel(server,
+                                  nodesToRead[i].nodeId,
+                                  &accessLevel);
+        if (!(accessLevel & UA_ACCESSLEVELMASK_HISTORYREAD)) {
+            response->results[i].statusCode = UA_STATUSCODE_BADUSERACCESSDENIED;
+            continue;
+        }
+
+        UA_Boolean historizing = false;
+        UA_Server_readHistorizing(server,
+                                  nodesToRead[i].nodeId,
+                                  &historizing);
+        if (!historizing) {
+            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+            continue;
+        }
+
+        const UA_HistorizingNodeIdSettings *setting = ctx->gathering.getHistorizingSetting(
+                    server,
+                    ctx->gathering.context,
+                    &nodesToRead[i].nodeId);
+
+        if (!setting) {
+            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONINVALID;
+            continue;
+        }
+
+        /* The aggregates use the low level API */
+        const UA_HistoryDataBackend *backend = &setting->historizingBackend;
+        if (!backend->getDateTimeMatch || !backend->copyDataValues) {
+            response->results[i].statusCode = UA_STATUSCODE_BADHISTORYOPERATIONUNSUPPORTED;
+            continue;
+        }
+
+        response->results[i].statusCode = UA_HistoryAggregate_read(
+                    server,
+                    sessionId,
+                    sessionContext,
+                    backend,
+                    &nodesToRead[i].nodeId,
+                    historyReadDetails,
+                    &historyReadDetails->aggregateType[i],
+                    timestampsToReturn,
+                    setting->maxHistoryDataResponseSize,
+                    releaseContinuationPoints,
+                    &nodesToRead[i].continuationPoint,
+                    &response->results[i].continuationPoint,
+                    historyData[i]);
+    }
+    response->responseHeader.serviceResult = UA_STATUSCODE_GOOD;
+}
+
 static void
 setValue_service_default(UA_Server *server,
                          void *context,
@@ -619,6 +695,7 @@ UA_HistoryDatabase_default(UA_HistoryDataGathering gathering)
     context->gathering = gathering;
     hdb.context = context;
     hdb.readRaw = &readRaw_service_default;
+    hdb.readProcessed = &readProcessed_service_default;
     hdb.setValue = &setValue_service_default;
     hdb.updateData = &updateData_service_default;
     hdb.deleteRawModified = &deleteRawModified_service_default;
@@ -0,0 +1,85 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_history_nodeid_index.h"
+
+#include <string.h>
+
+/* Open addressing with linear probing. The position is stored plus one, so
+ * that a zeroed slot is empty. */
+struct UA_HistoryNodeIdSlot {
+    UA_UInt32 hash;
+    size_t position;
+};
+
+void
+UA_HistoryNodeIdIndex_init(UA_HistoryNodeIdIndex *index, size_t entrySize,
+                           size_t nodeIdOffset) {
+    memset(index, 0, sizeof(UA_HistoryNodeIdIndex));
+    index->entrySize = entrySize;
+    index->nodeIdOffset = nodeIdOffset;
+}
+
+void
+UA_HistoryNodeIdIndex_clear(UA_HistoryNodeIdIndex *index) {
+    UA_free(index->slots);
+    index->slots = NULL;
+    index->slotsSize = 0;
+    index->used = 0;
+}
+
+size_t
+UA_HistoryNodeIdIndex_find(const UA_HistoryNodeIdIndex *index,
+                           const void *entries, const UA_NodeId *nodeId) {
+    if(index->slotsSize == 0)
+        return SIZE_MAX;
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    size_t mask = index->slotsSize - 1;
+    for(size_t i = hash & mask; index->slots[i].position != 0; i = (i + 1) & mask) {
+        if(index->slots[i].hash != hash)
+            continue;
+        size_t pos = index->slots[i].position - 1;
+        const UA_NodeId *entryId = (const UA_NodeId*)(const void*)
+            ((const UA_Byte*)entries + (pos * index->entrySize) + index->nodeIdOffset);
+        if(UA_NodeId_equal(entryId, nodeId))
+            return pos;
+    }
+    return SIZE_MAX;
+}
+
+static void
+insertSlot(struct UA_HistoryNodeIdSlot *slots, size_t slotsSize,
+           UA_UInt32 hash, size_t position) {
+    size_t mask = slotsSize - 1;
+    size_t i = hash & mask;
+    while(slots[i].position != 0)
+        i = (i + 1) & mask;
+    slots[i].hash = hash;
+    slots[i].position = position;
+}
+
+UA_StatusCode
+UA_HistoryNodeIdIndex_add(UA_HistoryNodeIdIndex *index,
+                          const UA_NodeId *nodeId, size_t position) {
+    /* Grow to keep the load factor below 1/2 */
+    if((index->used + 1) * 2 > index->slotsSize) {
+        size_t slotsSize = (index->slotsSize > 0) ? index->slotsSize * 2 : 16;
+        struct UA_HistoryNodeIdSlot *slots = (struct UA_HistoryNodeIdSlot*)
+            UA_calloc(slotsSize, sizeof(struct UA_HistoryNodeIdSlot));
+        if(!slots)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        for(size_t i = 0; i < index->slotsSize; i++) {
+            if(index->slots[i].position != 0)
+                insertSlot(slots, slotsSize, index->slots[i].hash,
+                           index->slots[i].position);
+        }
+        UA_free(index->slots);
+        index->slots = slots;
+        index->slotsSize = slotsSize;
+    }
+    insertSlot(index->slots, index->slotsSize, UA_NodeId_hash(nodeId), position + 1);
+    index->used++;
+    return UA_STATUSCODE_GOOD;
+}
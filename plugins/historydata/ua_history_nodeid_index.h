@@ -0,0 +1,47 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORY_NODEID_INDEX_H_
+#define UA_HISTORY_NODEID_INDEX_H_
+
+#include <open62541/types.h>
+
+_UA_BEGIN_DECLS
+
+/* Hash index from NodeIds to the position of an entry in an array. The
+ * history plugins keep their per-NodeId entries in arrays that are
+ * reallocated when they grow. The index stores the positions, so it stays
+ * valid when the array moves. Entries are never removed.
+ *
+ * The NodeId of an entry is found at nodeIdOffset inside the entry of
+ * entrySize bytes. */
+typedef struct {
+    size_t entrySize;
+    size_t nodeIdOffset;
+    size_t slotsSize; /* Power of two or zero */
+    size_t used;
+    struct UA_HistoryNodeIdSlot *slots;
+} UA_HistoryNodeIdIndex;
+
+void
+UA_HistoryNodeIdIndex_init(UA_HistoryNodeIdIndex *index, size_t entrySize,
+                           size_t nodeIdOffset);
+
+void
+UA_HistoryNodeIdIndex_clear(UA_HistoryNodeIdIndex *index);
+
+/* Returns the position of the entry or SIZE_MAX if not found */
+size_t
+UA_HistoryNodeIdIndex_find(const UA_HistoryNodeIdIndex *index,
+                           const void *entries, const UA_NodeId *nodeId);
+
+/* Adds the position of a new entry */
+UA_StatusCode
+UA_HistoryNodeIdIndex_add(UA_HistoryNodeIdIndex *index,
+                          const UA_NodeId *nodeId, size_t position);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORY_NODEID_INDEX_H_ */
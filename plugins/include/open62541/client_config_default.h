@@ -10,12 +10,18 @@
 #define UA_CLIENT_CONFIG_DEFAULT_H_
 
 #include <open62541/client.h>
+#include <open62541/client_pool.h>
 
 _UA_BEGIN_DECLS
 
 UA_StatusCode UA_EXPORT
 UA_ClientConfig_setDefault(UA_ClientConfig *config);
 
+/* Creates a pool of clients with the default configuration. The first client
+ * owns the EventLoop that is used by all clients of the pool. */
+UA_EXPORT UA_ClientPool *
+UA_ClientPool_newDefault(size_t size, size_t maxOperationsPerRequest);
+
 /* If certificates are used for authentication, this is only possible when
  * openssl or mbedtls is used. Libressl is currently not supported.*/
 #if defined(UA_ENABLE_ENCRYPTION_OPENSSL) || defined(UA_ENABLE_ENCRYPTION_MBEDTLS)
@@ -24,6 +24,25 @@ typedef enum {
                              that is earlier in time from the provided timestamp. */
 } MatchStrategy;
 
+/* Statistics of a range of samples for the aggregates of ReadProcessed. Only
+ * samples with a scalar numeric value and a status that is not Bad are
+ * included in the values. The timestamps are the source timestamps, or the
+ * server timestamps if no source timestamp is set. */
+typedef struct {
+    size_t count;          /* All samples in the range */
+    size_t goodCount;      /* Included samples */
+    size_t uncertainCount; /* Included samples with an Uncertain status */
+    UA_Double sum;
+    UA_Double min;
+    UA_DateTime minTimestamp; /* Of the first sample with the min value */
+    UA_Double max;
+    UA_DateTime maxTimestamp; /* Of the first sample with the max value */
+    UA_Double first;
+    UA_DateTime firstTimestamp;
+    UA_Double last;
+    UA_DateTime lastTimestamp;
+} UA_HistoryDataSummary;
+
 typedef struct UA_HistoryDataBackend UA_HistoryDataBackend;
 
 struct UA_HistoryDataBackend {
@@ -50,6 +69,23 @@ struct UA_HistoryDataBackend {
                             UA_Boolean historizing,
                             const UA_DataValue *value);
 
+    /* This function sets a batch of DataValues in the historical data storage.
+     * It is optional and used by gatherings that buffer the samples. If it is
+     * NULL, serverSetHistoryData is called for every DataValue.
+     *
+     * server is the server the nodes live in.
+     * hdbContext is the context of the UA_HistoryDataBackend.
+     * valuesSize is the number of entries in nodeIds and values.
+     * nodeIds contains the node for each value. The values of a node are in
+     *         the order in which they were sampled.
+     * The first error is returned. The remaining values are still stored. */
+    UA_StatusCode
+    (*serverSetHistoryDataBatch)(UA_Server *server,
+                                 void *hdbContext,
+                                 size_t valuesSize,
+                                 const UA_NodeId *nodeIds,
+                                 const UA_DataValue *values);
+
     /* This function is the high level interface for the ReadRaw operation. Set
      * it to NULL if you use the low level API for your plugin. It should be
      * used if the low level interface does not suite your database. It is more
@@ -284,6 +320,30 @@ struct UA_HistoryDataBackend {
                        const UA_NodeId *nodeId,
                        UA_DateTime startTimestamp,
                        UA_DateTime endTimestamp);
+
+    /* This function is optional and part of the low level HistoryRead API. It
+     * returns the statistics of the samples between startIndex and endIndex
+     * including both. Backends implement it if they keep pre-computed
+     * statistics, so that the aggregates of ReadProcessed do not need to read
+     * every sample. If it is NULL or does not return UA_STATUSCODE_GOOD, the
+     * samples are read with copyDataValues.
+     *
+     * server is the server the node lives in.
+     * hdbContext is the context of the UA_HistoryDataBackend.
+     * sessionId and sessionContext identify the session that wants to read historical data.
+     * nodeId is the node id of the node for which the statistics are requested.
+     * startIndex is the index of the first element in the range.
+     * endIndex is the index of the last element in the range.
+     * summary is the output. */
+    UA_StatusCode
+    (*getSummary)(UA_Server *server,
+                  void *hdbContext,
+                  const UA_NodeId *sessionId,
+                  void *sessionContext,
+                  const UA_NodeId *nodeId,
+                  size_t startIndex,
+                  size_t endIndex,
+                  UA_HistoryDataSummary *summary);
 };
 
 _UA_END_DECLS
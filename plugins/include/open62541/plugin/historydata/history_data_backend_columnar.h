@@ -0,0 +1,37 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_COLUMNAR_H_
+#define UA_HISTORYDATABACKEND_COLUMNAR_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+/* Maximum number of samples in a compressed block */
+#define UA_HISTORYDATABACKEND_COLUMNAR_BLOCKSIZE 1024
+
+/* This function constructs a UA_HistoryDataBackend that keeps the samples of
+ * each NodeId in blocks of timestamp and value columns.
+ *
+ * Samples with a scalar numeric value (Boolean to Double) that are appended in
+ * timestamp order are compressed. The timestamps are stored as
+ * delta-of-deltas and the values are XOR'ed with the previous value
+ * (Gorilla-style). A block is compressed as long as the DataType, the
+ * StatusCode and the presence of the SourceTimestamp do not change. Other
+ * samples and blocks that are modified out of order are stored as DataValues.
+ * Compressed blocks are decoded when they are read.
+ *
+ * initialNodeIdStoreSize is the initial number of NodeIds with historical
+ * data. The store grows when more NodeIds are added. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_Columnar(size_t initialNodeIdStoreSize);
+
+void UA_EXPORT
+UA_HistoryDataBackend_Columnar_clear(UA_HistoryDataBackend *backend);
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_COLUMNAR_H_ */
@@ -0,0 +1,47 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#ifndef UA_HISTORYDATABACKEND_FILE_H_
+#define UA_HISTORYDATABACKEND_FILE_H_
+
+#include "history_data_backend.h"
+
+_UA_BEGIN_DECLS
+
+/* The file backend is available only for Linux/Unices */
+#if defined(__linux__) || defined(__unix__)
+
+/* Every n-th sample of a segment is kept in the timestamp index */
+#define UA_HISTORYDATABACKEND_FILE_INDEXINTERVAL 32
+
+/* This function constructs a UA_HistoryDataBackend that persists the samples
+ * in the directory. The directory is created if it does not exist.
+ *
+ * The samples of each NodeId are appended as binary-encoded DataValues to
+ * segment files named `<NodeId>.<number>.uahist`. The segments are mapped into
+ * memory for reading and writing. A sparse index of the sample timestamps is
+ * kept in memory for the binary search. Samples that are not in timestamp
+ * order, replaced or removed move the following samples of the segment.
+ *
+ * The existing segments of a NodeId are loaded when the NodeId is first used.
+ * So the history survives a restart of the server.
+ *
+ * segmentSize is the size of a new segment file in bytes. It is increased for
+ * DataValues that do not fit. If the retention is not zero, segments whose
+ * newest sample is older than the retention (in ms) relative to the newest
+ * sample of the NodeId are deleted when a new segment is started. */
+UA_HistoryDataBackend UA_EXPORT
+UA_HistoryDataBackend_File(const char *directory, size_t segmentSize,
+                           UA_Duration retention);
+
+/* Unmaps and closes the segments. The files remain in the directory. */
+void UA_EXPORT
+UA_HistoryDataBackend_File_clear(UA_HistoryDataBackend *backend);
+
+#endif
+
+_UA_END_DECLS
+
+#endif /* UA_HISTORYDATABACKEND_FILE_H_ */
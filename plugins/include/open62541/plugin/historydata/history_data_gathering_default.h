@@ -23,6 +23,54 @@ UA_HistoryDataGathering_Default(size_t initialNodeIdStoreSize);
 UA_HistoryDataGathering UA_EXPORT
 UA_HistoryDataGathering_Circular(size_t initialNodeIdStoreSize);
 
+/* What happens to a sample when the buffer of the buffered gathering is
+ * full */
+typedef enum {
+    UA_HISTORYBUFFERPOLICY_DROPNEWEST = 0, /* Discard the new sample */
+    UA_HISTORYBUFFERPOLICY_DROPOLDEST = 1, /* Discard the oldest buffered sample */
+    UA_HISTORYBUFFERPOLICY_FLUSH = 2       /* Store a batch right away */
+} UA_HistoryBufferPolicy;
+
+typedef struct {
+    size_t capacity;           /* Maximum number of buffered samples */
+    size_t batchSize;          /* Maximum number of samples per batch */
+    UA_Duration flushInterval; /* Interval in ms for storing the buffer */
+    UA_HistoryBufferPolicy policy;
+} UA_HistoryBufferConfig;
+
+typedef struct {
+    UA_UInt64 buffered;     /* Samples added to the buffer */
+    UA_UInt64 stored;       /* Samples handed to the backends */
+    UA_UInt64 dropped;      /* Samples discarded because the buffer was full */
+    UA_UInt64 forcedFlushes; /* Batches stored because the buffer was full */
+    size_t size;            /* Samples currently in the buffer */
+    size_t highWatermark;   /* Maximum number of samples in the buffer */
+} UA_HistoryBufferStatistics;
+
+/* This function constructs a UA_HistoryDataGathering that buffers the samples
+ * of the POLL and VALUESET strategies instead of storing them right away. The
+ * buffer is stored from a repeated callback of the server that is registered
+ * with the first NodeId. Each callback stores at most one batch, so the batch
+ * size and the flush interval must keep up with the sampling rate. Otherwise
+ * the buffer fills up and the policy applies. Backends that implement
+ * serverSetHistoryDataBatch receive the samples as a batch. Samples without a
+ * server timestamp are stamped when they are buffered.
+ *
+ * The gathering must be deleted together with the server. Buffered samples
+ * that are not flushed before are discarded. */
+UA_HistoryDataGathering UA_EXPORT
+UA_HistoryDataGathering_Buffered(size_t initialNodeIdStoreSize,
+                                 const UA_HistoryBufferConfig *config);
+
+/* Stores all buffered samples in the backends */
+void UA_EXPORT
+UA_HistoryDataGathering_Buffered_flush(UA_Server *server,
+                                       UA_HistoryDataGathering *gathering);
+
+UA_StatusCode UA_EXPORT
+UA_HistoryDataGathering_Buffered_getStatistics(const UA_HistoryDataGathering *gathering,
+                                               UA_HistoryBufferStatistics *stats);
+
 _UA_END_DECLS
 
 #endif /* UA_HISTORYDATAGATHERING_DEFAULT_H_ */
@@ -14,6 +14,17 @@
 
 _UA_BEGIN_DECLS
 
+/* The default history database supports ReadRaw, ReadProcessed, UpdateData
+ * and DeleteRawModified with the backends of the gathering.
+ *
+ * ReadProcessed computes the aggregates Interpolative, Average, TimeAverage,
+ * Total, Minimum, Maximum, MinimumActualTime, MaximumActualTime, Range,
+ * Count, Start, End and Delta over numeric values. The results are Doubles
+ * (Count is an Int32) with the start of the interval as timestamp.
+ * TimeAverage, Total and Interpolative interpolate linearly between the
+ * samples and extrapolate the last value. The samples are read in one pass
+ * per request. Backends that implement getSummary provide the statistics for
+ * the other aggregates without reading the samples. */
 UA_HistoryDatabase UA_EXPORT
 UA_HistoryDatabase_default(UA_HistoryDataGathering gathering);
 
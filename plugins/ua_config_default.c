@@ -469,6 +469,9 @@ setDefaultConfig(UA_ServerConfig *conf, UA_UInt16 portNumber) {
     conf->maxSessions = 100;
     conf->maxSessionTimeout = 60.0 * 60.0 * 1000.0; /* 1h */
 
+    /* Cache of the resolved browse paths */
+    conf->browsePathCacheSize = 256;
+
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* Limits for Subscriptions */
     conf->publishingIntervalLimits = UA_DURATIONRANGE(100.0, 3600.0 * 1000.0);
@@ -1603,6 +1606,47 @@ UA_Client * UA_Client_new(void) {
     return UA_Client_newWithConfig(&config);
 }
 
+UA_ClientPool *
+UA_ClientPool_newDefault(size_t size, size_t maxOperationsPerRequest) {
+    UA_ClientPool *pool = UA_ClientPool_new(maxOperationsPerRequest);
+    if(!pool)
+        return NULL;
+
+    UA_EventLoop *el = NULL;
+    for(size_t i = 0; i < size; i++) {
+        UA_Client *client;
+        if(i == 0) {
+            client = UA_Client_new();
+        } else {
+            /* Use the EventLoop of the first client */
+            UA_ClientConfig config;
+            memset(&config, 0, sizeof(UA_ClientConfig));
+            config.eventLoop = el;
+            config.externalEventLoop = true;
+            UA_StatusCode res = UA_ClientConfig_setDefault(&config);
+            if(res != UA_STATUSCODE_GOOD) {
+                UA_ClientConfig_clear(&config);
+                UA_ClientPool_delete(pool);
+                return NULL;
+            }
+            client = UA_Client_newWithConfig(&config);
+        }
+
+        if(!client) {
+            UA_ClientPool_delete(pool);
+            return NULL;
+        }
+        if(UA_ClientPool_addClient(pool, client) != UA_STATUSCODE_GOOD) {
+            UA_Client_delete(client);
+            UA_ClientPool_delete(pool);
+            return NULL;
+        }
+        if(i == 0)
+            el = UA_Client_getConfig(client)->eventLoop;
+    }
+    return pool;
+}
+
 UA_StatusCode
 UA_ClientConfig_setDefault(UA_ClientConfig *config) {
     /* The following fields are untouched and OK to leave as NULL or 0:
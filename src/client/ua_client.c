@@ -28,6 +28,25 @@
 static void
 clientHouseKeeping(UA_Client *client, void *_);
 
+static enum ZIP_CMP
+cmpRequestId(const UA_UInt32 *a, const UA_UInt32 *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+static enum ZIP_CMP
+cmpTimeout(const UA_DateTime *a, const UA_DateTime *b) {
+    if(*a == *b)
+        return ZIP_CMP_EQ;
+    return (*a < *b) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+ZIP_FUNCTIONS(UA_AsyncServiceIdTree, AsyncServiceCall, idTreeEntry,
+              UA_UInt32, requestId, cmpRequestId)
+ZIP_FUNCTIONS(UA_AsyncServiceTimeoutTree, AsyncServiceCall, timeoutTreeEntry,
+              UA_DateTime, timeout, cmpTimeout)
+
 /********************/
 /* Client Lifecycle */
 /********************/
@@ -63,6 +82,8 @@ UA_ClientConfig_copy(UA_ClientConfig const *src, UA_ClientConfig *dst){
 
     dst->sessionLocaleIdsSize = src->sessionLocaleIdsSize;
     dst->connectivityCheckInterval = src->connectivityCheckInterval;
+    dst->batchingWindow = src->batchingWindow;
+    dst->batchingMaxOperations = src->batchingMaxOperations;
     dst->certificateVerification = src->certificateVerification;
     dst->clientContext = src->clientContext;
     dst->customDataTypes = src->customDataTypes;
@@ -75,6 +96,7 @@ UA_ClientConfig_copy(UA_ClientConfig const *src, UA_ClientConfig *dst){
         dst->certificateVerification.logging = dst->logging;
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     dst->outStandingPublishRequests = src->outStandingPublishRequests;
+    dst->zeroCopyNotifications = src->zeroCopyNotifications;
 #endif
     dst->requestedSessionTimeout = src->requestedSessionTimeout;
     dst->secureChannelLifeTime = src->secureChannelLifeTime;
@@ -218,6 +240,67 @@ UA_ClientConfig_delete(UA_ClientConfig *config){
     UA_free(config);
 }
 
+/*********/
+/* Arena */
+/*********/
+
+#define UA_CLIENTARENA_ALIGN(size) (((size) + 7) & ~(size_t)7)
+
+static void *
+arenaCalloc(void *context, size_t nelem, size_t elsize) {
+    UA_ClientArena *arena = (UA_ClientArena*)context;
+    if(elsize > 0 && nelem > SIZE_MAX / elsize)
+        return NULL;
+    size_t size = UA_CLIENTARENA_ALIGN(nelem * elsize);
+
+    /* Allocate from the arena */
+    if(arena->size - arena->used >= size) {
+        void *p = &arena->data[arena->used];
+        arena->used += size;
+        memset(p, 0, size);
+        return p;
+    }
+
+    /* Allocate on the heap until the arena is reset */
+    UA_ClientArenaOverflow *o = (UA_ClientArenaOverflow*)
+        UA_calloc(1, sizeof(UA_ClientArenaOverflow) + size);
+    if(!o)
+        return NULL;
+    o->next = arena->overflow;
+    arena->overflow = o;
+    arena->overflowSize += size;
+    return &o[1];
+}
+
+static void
+arenaReset(UA_ClientArena *arena) {
+    /* Free the overflow */
+    UA_ClientArenaOverflow *o = arena->overflow;
+    while(o) {
+        UA_ClientArenaOverflow *next = o->next;
+        UA_free(o);
+        o = next;
+    }
+    arena->overflow = NULL;
+
+    /* Grow the arena to fit everything next time */
+    size_t required = arena->used + arena->overflowSize;
+    if(required > arena->size) {
+        UA_free(arena->data);
+        arena->data = (UA_Byte*)UA_malloc(required);
+        arena->size = (arena->data) ? required : 0;
+    }
+    arena->used = 0;
+    arena->overflowSize = 0;
+}
+
+static void
+arenaClear(UA_ClientArena *arena) {
+    arenaReset(arena);
+    UA_free(arena->data);
+    memset(arena, 0, sizeof(UA_ClientArena));
+}
+
 static void
 UA_Client_clear(UA_Client *client) {
     /* Prevent new async service calls in UA_Client_AsyncService_removeAll */
@@ -241,6 +324,7 @@ UA_Client_clear(UA_Client *client) {
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     __Client_Subscriptions_clear(client);
 #endif
+    arenaClear(&client->notificationArena);
 
     /* Remove the internal regular callback */
     UA_Client_removeCallback(client, client->houseKeepingCallbackId);
@@ -343,7 +427,8 @@ notifyClientState(UA_Client *client) {
 /* Raw Services */
 /****************/
 
-/* For both synchronous and asynchronous service calls */
+/* For both synchronous and asynchronous service calls. A non-zero requestId was
+ * reserved before. Otherwise a new requestId is generated and returned. */
 static UA_StatusCode
 sendRequest(UA_Client *client, const void *request,
             const UA_DataType *requestType, UA_UInt32 *requestId) {
@@ -382,7 +467,9 @@ sendRequest(UA_Client *client, const void *request,
         rr->timeoutHint = client->config.timeout;
 
     /* Generate the request id */
-    UA_UInt32 rqId = ++client->requestId;
+    UA_UInt32 rqId = *requestId;
+    if(rqId == 0)
+        rqId = ++client->requestId;
 
 #ifdef UA_ENABLE_TYPEDESCRIPTION
     UA_LOG_DEBUG_CHANNEL(client->config.logging, &client->channel,
@@ -415,16 +502,25 @@ sendRequest(UA_Client *client, const void *request,
 static const UA_NodeId
 serviceFaultId = {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_SERVICEFAULT_ENCODING_DEFAULTBINARY}};
 
-/* Look for the async callback in the linked list, execute and delete it */
+static void
+addAsyncServiceCall(UA_Client *client, AsyncServiceCall *ac) {
+    ZIP_INSERT(UA_AsyncServiceIdTree, &client->asyncServiceCalls, ac);
+    ZIP_INSERT(UA_AsyncServiceTimeoutTree, &client->asyncServiceTimeouts, ac);
+}
+
+static void
+removeAsyncServiceCall(UA_Client *client, AsyncServiceCall *ac) {
+    ZIP_REMOVE(UA_AsyncServiceIdTree, &client->asyncServiceCalls, ac);
+    ZIP_REMOVE(UA_AsyncServiceTimeoutTree, &client->asyncServiceTimeouts, ac);
+}
+
+/* Look up the async callback by the requestId, execute and delete it */
 static UA_StatusCode
 processMSGResponse(UA_Client *client, UA_UInt32 requestId,
                    const UA_ByteString *msg) {
     /* Find the callback */
-    AsyncServiceCall *ac;
-    LIST_FOREACH(ac, &client->asyncServiceCalls, pointers) {
-        if(ac->requestId == requestId)
-            break;
-    }
+    AsyncServiceCall *ac =
+        ZIP_FIND(UA_AsyncServiceIdTree, &client->asyncServiceCalls, &requestId);
 
     /* Part 6, 6.7.6: After the security validation is complete the receiver
      * shall verify the RequestId and the SequenceNumber. If these checks fail a
@@ -440,9 +536,10 @@ processMSGResponse(UA_Client *client, UA_UInt32 requestId,
     UA_Response asyncResponse;
     UA_Response *response = (ac->syncResponse) ? ac->syncResponse : &asyncResponse;
     const UA_DataType *responseType = ac->responseType;
+    UA_ClientArena *arena = NULL;
 
     /* Dequeue ac. We might disconnect the client (remove all ac) in the callback. */
-    LIST_REMOVE(ac, pointers);
+    removeAsyncServiceCall(client, ac);
 
     /* Decode the response type */
     size_t offset = 0;
@@ -483,6 +580,19 @@ processMSGResponse(UA_Client *client, UA_UInt32 requestId,
     UA_DecodeBinaryOptions opt;
     memset(&opt, 0, sizeof(UA_DecodeBinaryOptions));
     opt.customTypes = client->config.customDataTypes;
+
+    /* Decode PublishResponses into the arena. The values point into the
+     * message. So the response is only valid during the callback. */
+    if(client->config.zeroCopyNotifications && !ac->syncResponse &&
+       responseType == &UA_TYPES[UA_TYPES_PUBLISHRESPONSE] &&
+       !client->notificationArena.inUse) {
+        arena = &client->notificationArena;
+        arena->inUse = true;
+        opt.calloc = arenaCalloc;
+        opt.callocContext = arena;
+        opt.zeroCopy = true;
+    }
+
     retval = UA_decodeBinaryInternal(msg, &offset, response, responseType, &opt);
 
  process:
@@ -526,7 +636,12 @@ processMSGResponse(UA_Client *client, UA_UInt32 requestId,
     /* Clean up */
     UA_NodeId_clear(&responseTypeId);
     if(!ac->syncResponse) {
-        UA_clear(response, ac->responseType);
+        if(arena) {
+            arenaReset(arena);
+            arena->inUse = false;
+        } else {
+            UA_clear(response, ac->responseType);
+        }
         UA_free(ac);
     } else {
         /* Return a special status code after processing a synchronous message.
@@ -639,20 +754,21 @@ __Client_Service(UA_Client *client, const void *request,
     ac.responseType = responseType;
     ac.syncResponse = (UA_Response*)response;
     ac.requestId = requestId;
-    ac.start = el->dateTime_nowMonotonic(el); /* Start timeout after sending */
-    ac.timeout = rh->timeoutHint;
     ac.requestHandle = rh->requestHandle;
-    if(ac.timeout == 0)
-        ac.timeout = UA_UINT32_MAX; /* 0 -> unlimited */
+    UA_UInt32 timeout_remaining = rh->timeoutHint;
+    if(timeout_remaining == 0)
+        timeout_remaining = UA_UINT32_MAX; /* 0 -> unlimited */
 
-    LIST_INSERT_HEAD(&client->asyncServiceCalls, &ac, pointers);
+    /* Time until which the request has to be answered. Start the timeout after
+     * sending. */
+    UA_DateTime maxDate = el->dateTime_nowMonotonic(el) +
+        ((UA_DateTime)timeout_remaining * UA_DATETIME_MSEC);
+    ac.timeout = maxDate;
 
-    /* Time until which the request has to be answered */
-    UA_DateTime maxDate = ac.start + ((UA_DateTime)ac.timeout * UA_DATETIME_MSEC);
+    addAsyncServiceCall(client, &ac);
 
     /* Run the EventLoop until the request was processed, the request has timed
      * out or the client connection fails */
-    UA_UInt32 timeout_remaining = ac.timeout;
     while(true) {
         /* Unlock before dropping into the EventLoop. The client lock is
          * re-taken in the network callback if an event occurs. */
@@ -682,7 +798,7 @@ __Client_Service(UA_Client *client, const void *request,
         }
 
         /* Update the remaining timeout or break */
-        UA_DateTime now = ac.start = el->dateTime_nowMonotonic(el);
+        UA_DateTime now = el->dateTime_nowMonotonic(el);
         if(now > maxDate) {
             retval = UA_STATUSCODE_BADTIMEOUT;
             break;
@@ -690,8 +806,8 @@ __Client_Service(UA_Client *client, const void *request,
         timeout_remaining = (UA_UInt32)((maxDate - now) / UA_DATETIME_MSEC);
     }
 
-    /* Detach from the internal async service list */
-    LIST_REMOVE(&ac, pointers);
+    /* Detach from the internal async service trees */
+    removeAsyncServiceCall(client, &ac);
 
     /* Return the status code */
     respHeader->serviceResult = retval;
@@ -729,27 +845,29 @@ __Client_AsyncService_cancel(UA_Client *client, AsyncServiceCall *ac,
 void
 __Client_AsyncService_removeAll(UA_Client *client, UA_StatusCode statusCode) {
     /* Make this function reentrant. One of the async callbacks could indirectly
-     * operate on the list. Moving all elements to a local list before iterating
-     * that. */
-    UA_AsyncServiceList asyncServiceCalls = client->asyncServiceCalls;
-    LIST_INIT(&client->asyncServiceCalls);
-    if(asyncServiceCalls.lh_first)
-        asyncServiceCalls.lh_first->pointers.le_prev = &asyncServiceCalls.lh_first;
-
-    /* Cancel and remove the elements from the local list */
-    AsyncServiceCall *ac, *ac_tmp;
-    LIST_FOREACH_SAFE(ac, &asyncServiceCalls, pointers, ac_tmp) {
-        LIST_REMOVE(ac, pointers);
+     * operate on the trees. Moving all elements to a local tree before
+     * iterating that. */
+    UA_AsyncServiceIdTree asyncServiceCalls = client->asyncServiceCalls;
+    ZIP_INIT(&client->asyncServiceCalls);
+    ZIP_INIT(&client->asyncServiceTimeouts);
+
+    /* Cancel and remove the elements from the local tree */
+    AsyncServiceCall *ac;
+    while((ac = ZIP_MIN(UA_AsyncServiceIdTree, &asyncServiceCalls))) {
+        ZIP_REMOVE(UA_AsyncServiceIdTree, &asyncServiceCalls, ac);
         __Client_AsyncService_cancel(client, ac, statusCode);
     }
+
+    /* Cancel the operations that were not yet sent */
+    __Client_Batch_removeAll(client, statusCode);
 }
 
-UA_StatusCode
-__Client_AsyncService(UA_Client *client, const void *request,
-                      const UA_DataType *requestType,
-                      UA_ClientAsyncServiceCallback callback,
-                      const UA_DataType *responseType,
-                      void *userdata, UA_UInt32 *requestId) {
+static UA_StatusCode
+asyncService(UA_Client *client, const void *request,
+             const UA_DataType *requestType,
+             UA_ClientAsyncServiceCallback callback,
+             const UA_DataType *responseType,
+             void *userdata, UA_UInt32 reservedId, UA_UInt32 *requestId) {
     UA_LOCK_ASSERT(&client->clientMutex);
 
     /* Is the SecureChannel connected? */
@@ -759,12 +877,13 @@ __Client_AsyncService(UA_Client *client, const void *request,
         return UA_STATUSCODE_BADSERVERNOTCONNECTED;
     }
 
-    /* Prepare the entry for the linked list */
+    /* Prepare the entry for the async service trees */
     AsyncServiceCall *ac = (AsyncServiceCall*)UA_malloc(sizeof(AsyncServiceCall));
     if(!ac)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Call the service and set the requestId */
+    ac->requestId = reservedId;
     UA_StatusCode retval = sendRequest(client, request, requestType, &ac->requestId);
     if(retval != UA_STATUSCODE_GOOD) {
         /* If sending failed, the status is set to closing. The SecureChannel is
@@ -783,13 +902,14 @@ __Client_AsyncService(UA_Client *client, const void *request,
     ac->responseType = responseType;
     ac->userdata = userdata;
     ac->syncResponse = NULL;
-    ac->start = el->dateTime_nowMonotonic(el);
-    ac->timeout = rh->timeoutHint;
     ac->requestHandle = rh->requestHandle;
-    if(ac->timeout == 0)
-        ac->timeout = UA_UINT32_MAX; /* 0 -> unlimited */
+    UA_UInt32 timeout = rh->timeoutHint;
+    if(timeout == 0)
+        timeout = UA_UINT32_MAX; /* 0 -> unlimited */
+    ac->timeout = el->dateTime_nowMonotonic(el) +
+        ((UA_DateTime)timeout * UA_DATETIME_MSEC);
 
-    LIST_INSERT_HEAD(&client->asyncServiceCalls, ac, pointers);
+    addAsyncServiceCall(client, ac);
 
     /* Return the generated request id */
     if(requestId)
@@ -801,6 +921,26 @@ __Client_AsyncService(UA_Client *client, const void *request,
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+__Client_AsyncService(UA_Client *client, const void *request,
+                      const UA_DataType *requestType,
+                      UA_ClientAsyncServiceCallback callback,
+                      const UA_DataType *responseType,
+                      void *userdata, UA_UInt32 *requestId) {
+    return asyncService(client, request, requestType, callback,
+                        responseType, userdata, 0, requestId);
+}
+
+UA_StatusCode
+__Client_AsyncServiceWithId(UA_Client *client, const void *request,
+                            const UA_DataType *requestType,
+                            UA_ClientAsyncServiceCallback callback,
+                            const UA_DataType *responseType,
+                            void *userdata, UA_UInt32 requestId) {
+    return asyncService(client, request, requestType, callback,
+                        responseType, userdata, requestId, NULL);
+}
+
 static UA_StatusCode
 cancelByRequestHandle(UA_Client *client, UA_UInt32 requestHandle, UA_UInt32 *cancelCount) {
     UA_CancelRequest creq;
@@ -831,13 +971,10 @@ UA_Client_cancelByRequestId(UA_Client *client, UA_UInt32 requestId,
                             UA_UInt32 *cancelCount) {
     lockClient(client);
     UA_StatusCode res = UA_STATUSCODE_BADNOTFOUND;
-    AsyncServiceCall *ac;
-    LIST_FOREACH(ac, &client->asyncServiceCalls, pointers) {
-        if(ac->requestId != requestId)
-            continue;
+    AsyncServiceCall *ac =
+        ZIP_FIND(UA_AsyncServiceIdTree, &client->asyncServiceCalls, &requestId);
+    if(ac)
         res = cancelByRequestHandle(client, ac->requestHandle, cancelCount);
-        break;
-    }
     unlockClient(client);
     return res;
 }
@@ -898,28 +1035,30 @@ UA_Client_removeCallback(UA_Client *client, UA_UInt64 callbackId) {
 /* Housekeeping Tasks */
 /**********************/
 
+static void *
+removeTimedOutId(void *context, AsyncServiceCall *ac) {
+    UA_Client *client = (UA_Client*)context;
+    ZIP_REMOVE(UA_AsyncServiceIdTree, &client->asyncServiceCalls, ac);
+    return NULL;
+}
+
 static void
 asyncServiceTimeoutCheck(UA_Client *client) {
     /* Make this function reentrant. One of the async callbacks could indirectly
-     * operate on the list. Moving all elements to a local list before iterating
-     * that. */
+     * operate on the trees. Moving all timed out elements to a local tree
+     * before iterating that. Only the timed out elements are visited. */
     UA_EventLoop *el = client->config.eventLoop;
     UA_DateTime now = el->dateTime_nowMonotonic(el);
-    UA_AsyncServiceList asyncServiceCalls;
-    AsyncServiceCall *ac, *ac_tmp;
-    LIST_INIT(&asyncServiceCalls);
-    LIST_FOREACH_SAFE(ac, &client->asyncServiceCalls, pointers, ac_tmp) {
-        if(!ac->timeout)
-           continue;
-        if(ac->start + (UA_DateTime)(ac->timeout * UA_DATETIME_MSEC) <= now) {
-            LIST_REMOVE(ac, pointers);
-            LIST_INSERT_HEAD(&asyncServiceCalls, ac, pointers);
-        }
-    }
+    UA_AsyncServiceTimeoutTree timedOut;
+    ZIP_INIT(&timedOut);
+    ZIP_UNZIP(UA_AsyncServiceTimeoutTree, &client->asyncServiceTimeouts,
+              &now, &timedOut, &client->asyncServiceTimeouts);
+    ZIP_ITER(UA_AsyncServiceTimeoutTree, &timedOut, removeTimedOutId, client);
 
-    /* Cancel and remove the elements from the local list */
-    LIST_FOREACH_SAFE(ac, &asyncServiceCalls, pointers, ac_tmp) {
-        LIST_REMOVE(ac, pointers);
+    /* Cancel and remove the elements from the local tree */
+    AsyncServiceCall *ac;
+    while((ac = ZIP_MIN(UA_AsyncServiceTimeoutTree, &timedOut))) {
+        ZIP_REMOVE(UA_AsyncServiceTimeoutTree, &timedOut, ac);
         __Client_AsyncService_cancel(client, ac, UA_STATUSCODE_BADTIMEOUT);
     }
 }
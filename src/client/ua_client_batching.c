@@ -0,0 +1,351 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include "ua_client_internal.h"
+
+/* Batching of the single-operation async services. The operations of a service
+ * are collected until the batching window ends or the batch is full. Then they
+ * are sent in a single request. The response is split up for the callbacks of
+ * the individual operations. */
+
+enum {
+    UA_CLIENTBATCH_READ = 0,
+    UA_CLIENTBATCH_WRITE = 1,
+    UA_CLIENTBATCH_CALL = 2
+};
+
+/* The request, operation and response type of the batches */
+static const UA_DataType *
+batchRequestType(size_t index) {
+    switch(index) {
+    case UA_CLIENTBATCH_READ: return &UA_TYPES[UA_TYPES_READREQUEST];
+    case UA_CLIENTBATCH_WRITE: return &UA_TYPES[UA_TYPES_WRITEREQUEST];
+    default: return &UA_TYPES[UA_TYPES_CALLREQUEST];
+    }
+}
+
+static const UA_DataType *
+batchOperationType(size_t index) {
+    switch(index) {
+    case UA_CLIENTBATCH_READ: return &UA_TYPES[UA_TYPES_READVALUEID];
+    case UA_CLIENTBATCH_WRITE: return &UA_TYPES[UA_TYPES_WRITEVALUE];
+    default: return &UA_TYPES[UA_TYPES_CALLMETHODREQUEST];
+    }
+}
+
+static const UA_DataType *
+batchResponseType(size_t index) {
+    switch(index) {
+    case UA_CLIENTBATCH_READ: return &UA_TYPES[UA_TYPES_READRESPONSE];
+    case UA_CLIENTBATCH_WRITE: return &UA_TYPES[UA_TYPES_WRITERESPONSE];
+    default: return &UA_TYPES[UA_TYPES_CALLRESPONSE];
+    }
+}
+
+/* Context of a sent batch to split up the response */
+typedef struct {
+    size_t index;
+    size_t callbacksSize;
+    UA_ClientBatchCallback *callbacks;
+} UA_ClientBatchContext;
+
+/* Call the callbacks with an empty response that contains the StatusCode */
+static void
+cancelCallbacks(UA_Client *client, size_t index, UA_UInt32 requestId,
+                UA_ClientBatchCallback *callbacks, size_t callbacksSize,
+                UA_StatusCode statusCode) {
+    const UA_DataType *responseType = batchResponseType(index);
+    for(size_t i = 0; i < callbacksSize; i++) {
+        UA_Response response;
+        UA_init(&response, responseType);
+        response.responseHeader.serviceResult = statusCode;
+        callbacks[i].callback(client, callbacks[i].userdata, requestId, &response);
+        UA_clear(&response, responseType);
+    }
+}
+
+/* The response for a single operation points into the arrays of the batch
+ * response. The batch response is cleaned up by the caller. */
+static void
+batchResponseCallback(UA_Client *client, void *userdata,
+                      UA_UInt32 requestId, void *r) {
+    UA_ClientBatchContext *ctx = (UA_ClientBatchContext*)userdata;
+
+    /* The response types of Read, Write and Call have the same layout up to the
+     * type of the results. Take the array sizes from the Read response. */
+    UA_ReadResponse *rr = (UA_ReadResponse*)r;
+    UA_StatusCode res = rr->responseHeader.serviceResult;
+    if(res == UA_STATUSCODE_GOOD && rr->resultsSize != ctx->callbacksSize)
+        res = UA_STATUSCODE_BADUNEXPECTEDERROR;
+    if(res != UA_STATUSCODE_GOOD) {
+        cancelCallbacks(client, ctx->index, requestId, ctx->callbacks,
+                        ctx->callbacksSize, res);
+        goto cleanup;
+    }
+    UA_Boolean diagnostics = (rr->diagnosticInfosSize == rr->resultsSize);
+
+    for(size_t i = 0; i < ctx->callbacksSize; i++) {
+        UA_ReadResponse readResponse;
+        UA_WriteResponse writeResponse;
+        UA_CallResponse callResponse;
+        UA_ReadResponse *single; /* Same layout as above */
+        switch(ctx->index) {
+        case UA_CLIENTBATCH_READ:
+            readResponse = *rr;
+            readResponse.results = &rr->results[i];
+            single = &readResponse;
+            break;
+        case UA_CLIENTBATCH_WRITE:
+            writeResponse = *(UA_WriteResponse*)r;
+            writeResponse.results = &((UA_WriteResponse*)r)->results[i];
+            single = (UA_ReadResponse*)&writeResponse;
+            break;
+        default:
+            callResponse = *(UA_CallResponse*)r;
+            callResponse.results = &((UA_CallResponse*)r)->results[i];
+            single = (UA_ReadResponse*)&callResponse;
+            break;
+        }
+        single->resultsSize = 1;
+        single->diagnosticInfosSize = (diagnostics) ? 1 : 0;
+        single->diagnosticInfos = (diagnostics) ? &rr->diagnosticInfos[i] : NULL;
+        ctx->callbacks[i].callback(client, ctx->callbacks[i].userdata,
+                                   requestId, single);
+    }
+
+ cleanup:
+    UA_free(ctx->callbacks);
+    UA_free(ctx);
+}
+
+static void
+sendBatch(UA_Client *client, size_t index) {
+    UA_LOCK_ASSERT(&client->clientMutex);
+
+    /* Detach the batch. Operations that are added in a callback during sending
+     * go to a new batch. */
+    UA_ClientBatch b = client->batches[index];
+    if(b.operationsSize == 0)
+        return;
+    client->batches[index].operationsSize = 0;
+    client->batches[index].operationsCapacity = 0;
+    client->batches[index].operations = NULL;
+    client->batches[index].callbacks = NULL;
+
+    /* Create the request with all operations */
+    UA_ReadRequest readRequest;
+    UA_WriteRequest writeRequest;
+    UA_CallRequest callRequest;
+    const void *request;
+    switch(index) {
+    case UA_CLIENTBATCH_READ:
+        UA_ReadRequest_init(&readRequest);
+        readRequest.nodesToRead = (UA_ReadValueId*)b.operations;
+        readRequest.nodesToReadSize = b.operationsSize;
+        readRequest.timestampsToReturn = b.timestampsToReturn;
+        request = &readRequest;
+        break;
+    case UA_CLIENTBATCH_WRITE:
+        UA_WriteRequest_init(&writeRequest);
+        writeRequest.nodesToWrite = (UA_WriteValue*)b.operations;
+        writeRequest.nodesToWriteSize = b.operationsSize;
+        request = &writeRequest;
+        break;
+    default:
+        UA_CallRequest_init(&callRequest);
+        callRequest.methodsToCall = (UA_CallMethodRequest*)b.operations;
+        callRequest.methodsToCallSize = b.operationsSize;
+        request = &callRequest;
+        break;
+    }
+
+    /* The context takes over the callbacks */
+    UA_StatusCode res = UA_STATUSCODE_BADOUTOFMEMORY;
+    UA_ClientBatchContext *ctx = (UA_ClientBatchContext*)
+        UA_malloc(sizeof(UA_ClientBatchContext));
+    if(ctx) {
+        ctx->index = index;
+        ctx->callbacksSize = b.operationsSize;
+        ctx->callbacks = b.callbacks;
+        res = __Client_AsyncServiceWithId(client, request, batchRequestType(index),
+                                          batchResponseCallback,
+                                          batchResponseType(index), ctx, b.requestId);
+        if(res != UA_STATUSCODE_GOOD)
+            UA_free(ctx);
+    }
+    UA_Array_delete(b.operations, b.operationsSize, batchOperationType(index));
+    if(res == UA_STATUSCODE_GOOD)
+        return;
+
+    UA_LOG_WARNING(client->config.logging, UA_LOGCATEGORY_CLIENT,
+                   "Sending a batch of %lu operations failed with StatusCode %s",
+                   (long unsigned)b.operationsSize, UA_StatusCode_name(res));
+    cancelCallbacks(client, index, b.requestId, b.callbacks, b.operationsSize, res);
+    UA_free(b.callbacks);
+}
+
+void
+__Client_Batch_flush(UA_Client *client) {
+    for(size_t i = 0; i < UA_CLIENT_BATCHES; i++)
+        sendBatch(client, i);
+}
+
+static void
+batchWindowCallback(UA_Client *client, void *_) {
+    lockClient(client);
+    client->batchCallbackId = 0;
+    __Client_Batch_flush(client);
+    unlockClient(client);
+}
+
+UA_StatusCode
+__Client_Batch_add(UA_Client *client, const UA_DataType *requestType,
+                   const void *operation, UA_TimestampsToReturn timestampsToReturn,
+                   UA_ClientAsyncServiceCallback callback, void *userdata,
+                   UA_UInt32 *requestId) {
+    UA_LOCK_ASSERT(&client->clientMutex);
+
+    /* Is the SecureChannel connected? */
+    if(client->channel.state != UA_SECURECHANNELSTATE_OPEN) {
+        UA_LOG_ERROR(client->config.logging, UA_LOGCATEGORY_CLIENT,
+                     "SecureChannel must be connected to send request");
+        return UA_STATUSCODE_BADSERVERNOTCONNECTED;
+    }
+
+    size_t index = UA_CLIENTBATCH_CALL;
+    if(requestType == &UA_TYPES[UA_TYPES_READREQUEST])
+        index = UA_CLIENTBATCH_READ;
+    else if(requestType == &UA_TYPES[UA_TYPES_WRITEREQUEST])
+        index = UA_CLIENTBATCH_WRITE;
+    UA_ClientBatch *b = &client->batches[index];
+
+    /* Reads can only be combined with the same TimestampsToReturn */
+    if(index == UA_CLIENTBATCH_READ && b->operationsSize > 0 &&
+       b->timestampsToReturn != timestampsToReturn)
+        sendBatch(client, index);
+
+    /* Grow the arrays */
+    const UA_DataType *operationType = batchOperationType(index);
+    if(b->operationsSize == b->operationsCapacity) {
+        size_t capacity = (b->operationsCapacity == 0) ? 16 : b->operationsCapacity * 2;
+        void *operations = UA_realloc(b->operations, capacity * operationType->memSize);
+        if(!operations)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        b->operations = operations;
+        UA_ClientBatchCallback *callbacks = (UA_ClientBatchCallback*)
+            UA_realloc(b->callbacks, capacity * sizeof(UA_ClientBatchCallback));
+        if(!callbacks)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        b->callbacks = callbacks;
+        b->operationsCapacity = capacity;
+    }
+
+    /* Copy the operation */
+    void *target = (void*)((uintptr_t)b->operations +
+                           b->operationsSize * operationType->memSize);
+    UA_StatusCode res = UA_copy(operation, target, operationType);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Reserve the requestId with the first operation */
+    if(b->operationsSize == 0) {
+        b->requestId = ++client->requestId;
+        b->timestampsToReturn = timestampsToReturn;
+    }
+    b->callbacks[b->operationsSize].callback = callback;
+    b->callbacks[b->operationsSize].userdata = userdata;
+    b->operationsSize++;
+    if(requestId)
+        *requestId = b->requestId;
+
+    /* Send when the batch is full */
+    UA_UInt32 max = client->config.batchingMaxOperations;
+    if(b->maxOperations > 0 && (max == 0 || b->maxOperations < max))
+        max = b->maxOperations;
+    if(max > 0 && b->operationsSize >= max) {
+        sendBatch(client, index);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Start the batching window. Send right away if that fails. */
+    if(client->batchCallbackId == 0) {
+        UA_EventLoop *el = client->config.eventLoop;
+        res = el->addTimer(el, (UA_Callback)batchWindowCallback, client, NULL,
+                           client->config.batchingWindow, NULL,
+                           UA_TIMERPOLICY_ONCE, &client->batchCallbackId);
+        if(res != UA_STATUSCODE_GOOD)
+            sendBatch(client, index);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+__Client_Batch_removeAll(UA_Client *client, UA_StatusCode statusCode) {
+    if(client->batchCallbackId != 0) {
+        UA_EventLoop *el = client->config.eventLoop;
+        el->removeTimer(el, client->batchCallbackId);
+        client->batchCallbackId = 0;
+    }
+
+    for(size_t i = 0; i < UA_CLIENT_BATCHES; i++) {
+        /* Detach the batch before calling the callbacks */
+        UA_ClientBatch b = client->batches[i];
+        client->batches[i].operationsSize = 0;
+        client->batches[i].operationsCapacity = 0;
+        client->batches[i].operations = NULL;
+        client->batches[i].callbacks = NULL;
+
+        UA_Array_delete(b.operations, b.operationsSize, batchOperationType(i));
+        cancelCallbacks(client, i, b.requestId, b.callbacks, b.operationsSize,
+                        statusCode);
+        UA_free(b.callbacks);
+    }
+}
+
+static void
+responseReadOperationLimits(UA_Client *client, void *userdata,
+                            UA_UInt32 requestId, UA_ReadResponse *rr) {
+    if(rr->responseHeader.serviceResult != UA_STATUSCODE_GOOD ||
+       rr->resultsSize != UA_CLIENT_BATCHES)
+        return;
+    for(size_t i = 0; i < UA_CLIENT_BATCHES; i++) {
+        UA_DataValue *dv = &rr->results[i];
+        if(dv->hasValue &&
+           UA_Variant_hasScalarType(&dv->value, &UA_TYPES[UA_TYPES_UINT32]))
+            client->batches[i].maxOperations = *(UA_UInt32*)dv->value.data;
+    }
+}
+
+void
+__Client_Batch_readOperationLimits(UA_Client *client) {
+    UA_LOCK_ASSERT(&client->clientMutex);
+
+    /* In the order of the batches */
+    UA_ReadValueId rvi[UA_CLIENT_BATCHES];
+    for(size_t i = 0; i < UA_CLIENT_BATCHES; i++) {
+        UA_ReadValueId_init(&rvi[i]);
+        rvi[i].attributeId = UA_ATTRIBUTEID_VALUE;
+    }
+    rvi[UA_CLIENTBATCH_READ].nodeId =
+        UA_NS0ID(SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERREAD);
+    rvi[UA_CLIENTBATCH_WRITE].nodeId =
+        UA_NS0ID(SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERWRITE);
+    rvi[UA_CLIENTBATCH_CALL].nodeId =
+        UA_NS0ID(SERVER_SERVERCAPABILITIES_OPERATIONLIMITS_MAXNODESPERMETHODCALL);
+
+    UA_ReadRequest rr;
+    UA_ReadRequest_init(&rr);
+    rr.nodesToRead = rvi;
+    rr.nodesToReadSize = UA_CLIENT_BATCHES;
+
+    UA_StatusCode res =
+        __Client_AsyncService(client, &rr, &UA_TYPES[UA_TYPES_READREQUEST],
+                              (UA_ClientAsyncServiceCallback)responseReadOperationLimits,
+                              &UA_TYPES[UA_TYPES_READRESPONSE], NULL, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        UA_LOG_WARNING(client->config.logging, UA_LOGCATEGORY_CLIENT,
+                       "Could not read the operation limits with StatusCode %s",
+                       UA_StatusCode_name(res));
+}
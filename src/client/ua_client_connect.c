@@ -838,6 +838,10 @@ responseActivateSession(UA_Client *client, void *userdata,
     if(!client->haveNamespaces)
         readNamespacesArrayAsync(client);
 
+    /* Read the operation limits of the server to size the batches */
+    if(client->config.batchingWindow > 0.0)
+        __Client_Batch_readOperationLimits(client);
+
     /* Immediately check if publish requests are outstanding - for example when
      * an existing Session has been reattached / activated. */
 #ifdef UA_ENABLE_SUBSCRIPTIONS
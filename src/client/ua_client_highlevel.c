@@ -385,6 +385,404 @@ UA_Client_translateBrowsePathToNodeIds(UA_Client *client,
     return res;
 }
 
+/************/
+/* Crawling */
+/************/
+
+#define UA_CRAWL_DEFAULT_NODESPERREQUEST 100
+#define UA_CRAWL_DEFAULT_REQUESTSINFLIGHT 4
+
+/* Open-addressing hash set of the visited NodeIds. Empty slots have a null
+ * NodeId. Null NodeIds are never added. */
+typedef struct {
+    UA_UInt32 hash;
+    UA_NodeId nodeId;
+} CrawlVisitedEntry;
+
+typedef struct {
+    CrawlVisitedEntry *entries;
+    size_t size;
+    size_t count;
+} CrawlVisitedSet;
+
+/* A request in flight. Owns the NodeIds of the nodes that are browsed. The
+ * continuation points are moved out of the results. The indices point to the
+ * nodes of the continuation points. */
+typedef struct {
+    struct Crawl *crawl;
+    size_t nodesSize;
+    UA_NodeId *nodes;
+    size_t cpsSize;
+    size_t *indices;
+    UA_ByteString *cps;
+} CrawlRequest;
+
+typedef struct Crawl {
+    UA_Client *client;
+    UA_ClientCrawlSettings settings;
+    UA_ClientCrawlCallback callback;
+    void *context;
+    CrawlVisitedSet visited;
+
+    /* FIFO queue of the nodes that remain to be browsed */
+    UA_NodeId *queue;
+    size_t queueBegin;
+    size_t queueEnd;
+    size_t queueCapacity;
+
+    size_t pending; /* Requests in flight */
+    UA_Boolean stopped;
+    UA_StatusCode status;
+} Crawl;
+
+static UA_StatusCode
+CrawlVisitedSet_resize(CrawlVisitedSet *set, size_t size) {
+    CrawlVisitedEntry *entries = (CrawlVisitedEntry*)
+        UA_calloc(size, sizeof(CrawlVisitedEntry));
+    if(!entries)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < set->size; i++) {
+        CrawlVisitedEntry *e = &set->entries[i];
+        if(UA_NodeId_isNull(&e->nodeId))
+            continue;
+        size_t pos = e->hash % size;
+        while(!UA_NodeId_isNull(&entries[pos].nodeId))
+            pos = (pos + 1) % size;
+        entries[pos] = *e;
+    }
+    UA_free(set->entries);
+    set->entries = entries;
+    set->size = size;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Returns UA_STATUSCODE_BADNODEIDEXISTS if the NodeId was already added */
+static UA_StatusCode
+CrawlVisitedSet_add(CrawlVisitedSet *set, const UA_NodeId *nodeId) {
+    /* Keep the load factor below 1/2 */
+    if((set->count + 1) * 2 > set->size) {
+        UA_StatusCode res = CrawlVisitedSet_resize(set, (set->size) ? set->size * 2 : 64);
+        UA_CHECK_STATUS(res, return res);
+    }
+
+    UA_UInt32 hash = UA_NodeId_hash(nodeId);
+    size_t pos = hash % set->size;
+    while(!UA_NodeId_isNull(&set->entries[pos].nodeId)) {
+        CrawlVisitedEntry *e = &set->entries[pos];
+        if(e->hash == hash && UA_NodeId_equal(&e->nodeId, nodeId))
+            return UA_STATUSCODE_BADNODEIDEXISTS;
+        pos = (pos + 1) % set->size;
+    }
+
+    UA_StatusCode res = UA_NodeId_copy(nodeId, &set->entries[pos].nodeId);
+    UA_CHECK_STATUS(res, return res);
+    set->entries[pos].hash = hash;
+    set->count++;
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+CrawlVisitedSet_clear(CrawlVisitedSet *set) {
+    for(size_t i = 0; i < set->size; i++)
+        UA_NodeId_clear(&set->entries[i].nodeId);
+    UA_free(set->entries);
+    memset(set, 0, sizeof(CrawlVisitedSet));
+}
+
+/* Add the node to the queue if it was not visited before */
+static void
+crawlEnqueue(Crawl *crawl, const UA_NodeId *nodeId) {
+    if(UA_NodeId_isNull(nodeId))
+        return;
+    UA_StatusCode res = CrawlVisitedSet_add(&crawl->visited, nodeId);
+    if(res == UA_STATUSCODE_BADNODEIDEXISTS)
+        return;
+    if(res != UA_STATUSCODE_GOOD) {
+        crawl->status = res;
+        crawl->stopped = true;
+        return;
+    }
+
+    /* Make room in the queue. Move the elements to the beginning or grow. */
+    if(crawl->queueEnd == crawl->queueCapacity) {
+        size_t queued = crawl->queueEnd - crawl->queueBegin;
+        if(crawl->queueBegin > 0 && crawl->queueBegin >= crawl->queueCapacity / 2) {
+            memmove(crawl->queue, &crawl->queue[crawl->queueBegin],
+                    queued * sizeof(UA_NodeId));
+        } else {
+            size_t capacity = (crawl->queueCapacity) ? crawl->queueCapacity * 2 : 64;
+            UA_NodeId *queue = (UA_NodeId*)
+                UA_realloc(crawl->queue, capacity * sizeof(UA_NodeId));
+            if(!queue) {
+                crawl->status = UA_STATUSCODE_BADOUTOFMEMORY;
+                crawl->stopped = true;
+                return;
+            }
+            crawl->queue = queue;
+            crawl->queueCapacity = capacity;
+        }
+        crawl->queueBegin = 0;
+        crawl->queueEnd = queued;
+    }
+
+    res = UA_NodeId_copy(nodeId, &crawl->queue[crawl->queueEnd]);
+    if(res != UA_STATUSCODE_GOOD) {
+        crawl->status = res;
+        crawl->stopped = true;
+        return;
+    }
+    crawl->queueEnd++;
+}
+
+static void
+CrawlRequest_delete(CrawlRequest *cr) {
+    UA_Array_delete(cr->nodes, cr->nodesSize, &UA_TYPES[UA_TYPES_NODEID]);
+    for(size_t i = 0; i < cr->cpsSize; i++)
+        UA_ByteString_clear(&cr->cps[i]);
+    UA_free(cr->indices);
+    UA_free(cr->cps);
+    UA_free(cr);
+}
+
+static void
+crawlFinishRequest(CrawlRequest *cr) {
+    cr->crawl->pending--;
+    CrawlRequest_delete(cr);
+}
+
+static void
+crawlSendRequests(UA_Client *client, Crawl *crawl);
+
+static void
+crawlBrowseNextCallback(UA_Client *client, void *userdata,
+                        UA_UInt32 requestId, void *r);
+
+/* Report the results and queue the targets of the references. The
+ * continuation points are moved into the request. For the results of a
+ * BrowseNext, the indices map to the browsed nodes. */
+static void
+crawlProcessResults(CrawlRequest *cr, UA_StatusCode serviceResult,
+                    UA_BrowseResult *results, size_t resultsSize,
+                    const size_t *indices, size_t indicesSize) {
+    Crawl *crawl = cr->crawl;
+    size_t count = (indices) ? indicesSize : cr->nodesSize;
+    cr->cpsSize = 0;
+    for(size_t i = 0; i < count; i++) {
+        UA_BrowseResult err;
+        UA_BrowseResult *br = &err;
+        if(serviceResult != UA_STATUSCODE_GOOD || i >= resultsSize) {
+            UA_BrowseResult_init(&err);
+            err.statusCode = (serviceResult != UA_STATUSCODE_GOOD) ?
+                serviceResult : UA_STATUSCODE_BADUNEXPECTEDERROR;
+        } else {
+            br = &results[i];
+        }
+
+        size_t node = (indices) ? indices[i] : i;
+        if(!crawl->stopped) {
+            for(size_t j = 0; j < br->referencesSize; j++) {
+                const UA_ExpandedNodeId *target = &br->references[j].nodeId;
+                if(target->serverIndex == 0)
+                    crawlEnqueue(crawl, &target->nodeId);
+            }
+            if(!crawl->callback(crawl->client, crawl->context, &cr->nodes[node], br))
+                crawl->stopped = true;
+        }
+
+        /* Keep the continuation point. Also if stopped, to release it. */
+        if(br->continuationPoint.length > 0) {
+            cr->indices[cr->cpsSize] = node;
+            cr->cps[cr->cpsSize] = br->continuationPoint;
+            UA_ByteString_init(&br->continuationPoint);
+            cr->cpsSize++;
+        }
+    }
+}
+
+/* Follow (or release) the continuation points. Finishes the request when no
+ * continuation point remains. */
+static void
+crawlBrowseNext(UA_Client *client, CrawlRequest *cr) {
+    Crawl *crawl = cr->crawl;
+    if(cr->cpsSize == 0) {
+        crawlFinishRequest(cr);
+        return;
+    }
+
+    UA_BrowseNextRequest request;
+    UA_BrowseNextRequest_init(&request);
+    request.releaseContinuationPoints = crawl->stopped;
+    request.continuationPoints = cr->cps;
+    request.continuationPointsSize = cr->cpsSize;
+
+    /* Release the continuation points without waiting for the response */
+    if(crawl->stopped) {
+        __Client_AsyncService(client, &request,
+                              &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST], NULL,
+                              &UA_TYPES[UA_TYPES_BROWSENEXTRESPONSE], NULL, NULL);
+        crawlFinishRequest(cr);
+        return;
+    }
+
+    UA_StatusCode res =
+        __Client_AsyncService(client, &request,
+                              &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST],
+                              crawlBrowseNextCallback,
+                              &UA_TYPES[UA_TYPES_BROWSENEXTRESPONSE], cr, NULL);
+    if(res != UA_STATUSCODE_GOOD) {
+        crawl->status = res;
+        crawl->stopped = true;
+        crawlFinishRequest(cr);
+    }
+}
+
+static void
+crawlBrowseNextCallback(UA_Client *client, void *userdata,
+                        UA_UInt32 requestId, void *r) {
+    CrawlRequest *cr = (CrawlRequest*)userdata;
+    Crawl *crawl = cr->crawl;
+    UA_BrowseNextResponse *response = (UA_BrowseNextResponse*)r;
+
+    /* The continuation points of the request are overwritten with the new
+     * ones. Clean up the old ones and keep the indices for the mapping. */
+    size_t indicesSize = cr->cpsSize;
+    size_t *indices = (size_t*)UA_malloc(sizeof(size_t) * indicesSize);
+    if(!indices) {
+        crawl->status = UA_STATUSCODE_BADOUTOFMEMORY;
+        crawl->stopped = true;
+        crawlFinishRequest(cr);
+        return;
+    }
+    memcpy(indices, cr->indices, sizeof(size_t) * indicesSize);
+    for(size_t i = 0; i < cr->cpsSize; i++)
+        UA_ByteString_clear(&cr->cps[i]);
+
+    crawlProcessResults(cr, response->responseHeader.serviceResult,
+                        response->results, response->resultsSize,
+                        indices, indicesSize);
+    UA_free(indices);
+    crawlBrowseNext(client, cr);
+    crawlSendRequests(client, crawl);
+}
+
+static void
+crawlBrowseCallback(UA_Client *client, void *userdata,
+                    UA_UInt32 requestId, void *r) {
+    CrawlRequest *cr = (CrawlRequest*)userdata;
+    Crawl *crawl = cr->crawl;
+    UA_BrowseResponse *response = (UA_BrowseResponse*)r;
+    crawlProcessResults(cr, response->responseHeader.serviceResult,
+                        response->results, response->resultsSize, NULL, 0);
+    crawlBrowseNext(client, cr);
+    crawlSendRequests(client, crawl);
+}
+
+/* Send Browse requests for the queued nodes until the maximum number of
+ * requests is in flight */
+static void
+crawlSendRequests(UA_Client *client, Crawl *crawl) {
+    UA_LOCK_ASSERT(&client->clientMutex);
+    const UA_ClientCrawlSettings *settings = &crawl->settings;
+    while(!crawl->stopped && crawl->queueBegin < crawl->queueEnd &&
+          crawl->pending < settings->maxRequestsInFlight) {
+        size_t nodesSize = crawl->queueEnd - crawl->queueBegin;
+        if(nodesSize > settings->maxNodesPerRequest)
+            nodesSize = settings->maxNodesPerRequest;
+
+        /* Move the nodes from the queue into the request */
+        CrawlRequest *cr = (CrawlRequest*)UA_calloc(1, sizeof(CrawlRequest));
+        UA_BrowseDescription *bd = (UA_BrowseDescription*)
+            UA_calloc(nodesSize, sizeof(UA_BrowseDescription));
+        UA_NodeId *nodes = (UA_NodeId*)UA_malloc(nodesSize * sizeof(UA_NodeId));
+        size_t *indices = (size_t*)UA_malloc(nodesSize * sizeof(size_t));
+        UA_ByteString *cps = (UA_ByteString*)
+            UA_malloc(nodesSize * sizeof(UA_ByteString));
+        if(!cr || !bd || !nodes || !indices || !cps) {
+            UA_free(cr);
+            UA_free(bd);
+            UA_free(nodes);
+            UA_free(indices);
+            UA_free(cps);
+            crawl->status = UA_STATUSCODE_BADOUTOFMEMORY;
+            crawl->stopped = true;
+            return;
+        }
+        memcpy(nodes, &crawl->queue[crawl->queueBegin], nodesSize * sizeof(UA_NodeId));
+        crawl->queueBegin += nodesSize;
+        cr->crawl = crawl;
+        cr->nodes = nodes;
+        cr->nodesSize = nodesSize;
+        cr->indices = indices;
+        cr->cps = cps;
+
+        for(size_t i = 0; i < nodesSize; i++) {
+            bd[i] = settings->browseDescription;
+            bd[i].nodeId = nodes[i];
+        }
+
+        UA_BrowseRequest request;
+        UA_BrowseRequest_init(&request);
+        request.view = settings->view;
+        request.requestedMaxReferencesPerNode = settings->requestedMaxReferencesPerNode;
+        request.nodesToBrowse = bd;
+        request.nodesToBrowseSize = nodesSize;
+        UA_StatusCode res =
+            __Client_AsyncService(client, &request, &UA_TYPES[UA_TYPES_BROWSEREQUEST],
+                                  crawlBrowseCallback, &UA_TYPES[UA_TYPES_BROWSERESPONSE],
+                                  cr, NULL);
+        UA_free(bd);
+        crawl->pending++;
+        if(res != UA_STATUSCODE_GOOD) {
+            /* Report the error for the nodes. Then stop, as the client is not
+             * connected anymore. */
+            crawlProcessResults(cr, res, NULL, 0, NULL, 0);
+            crawlFinishRequest(cr);
+            crawl->status = res;
+            crawl->stopped = true;
+        }
+    }
+}
+
+UA_StatusCode
+UA_Client_crawl(UA_Client *client, const UA_ClientCrawlSettings *settings,
+                size_t startNodesSize, const UA_NodeId *startNodes,
+                UA_ClientCrawlCallback callback, void *context) {
+    if(!settings || !callback)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    Crawl crawl;
+    memset(&crawl, 0, sizeof(Crawl));
+    crawl.settings = *settings;
+    if(crawl.settings.maxNodesPerRequest == 0)
+        crawl.settings.maxNodesPerRequest = UA_CRAWL_DEFAULT_NODESPERREQUEST;
+    if(crawl.settings.maxRequestsInFlight == 0)
+        crawl.settings.maxRequestsInFlight = UA_CRAWL_DEFAULT_REQUESTSINFLIGHT;
+    crawl.client = client;
+    crawl.callback = callback;
+    crawl.context = context;
+
+    lockClient(client);
+    if(client->sessionState != UA_SESSIONSTATE_ACTIVATED) {
+        unlockClient(client);
+        return UA_STATUSCODE_BADSERVERNOTCONNECTED;
+    }
+    for(size_t i = 0; i < startNodesSize; i++)
+        crawlEnqueue(&crawl, &startNodes[i]);
+    crawlSendRequests(client, &crawl);
+    unlockClient(client);
+
+    /* Run until all requests have returned. If the connection is lost, the
+     * outstanding requests are cancelled with an error. */
+    while(crawl.pending > 0)
+        UA_Client_run_iterate(client, 100);
+
+    for(size_t i = crawl.queueBegin; i < crawl.queueEnd; i++)
+        UA_NodeId_clear(&crawl.queue[i]);
+    UA_free(crawl.queue);
+    CrawlVisitedSet_clear(&crawl.visited);
+    return crawl.status;
+}
+
 /********************/
 /* Write Attributes */
 /********************/
@@ -902,6 +1300,26 @@ cleanup:
 /* Async Functions */
 /*******************/
 
+/* Send a request with a single operation. If batching is enabled, the operation
+ * is added to the batch of the service instead. */
+static UA_StatusCode
+asyncOperation(UA_Client *client, const void *request,
+               const UA_DataType *requestType, const void *operation,
+               UA_TimestampsToReturn timestampsToReturn,
+               UA_ClientAsyncServiceCallback callback,
+               const UA_DataType *responseType,
+               void *userdata, UA_UInt32 *requestId) {
+    if(client->config.batchingWindow <= 0.0)
+        return __UA_Client_AsyncService(client, request, requestType, callback,
+                                        responseType, userdata, requestId);
+    lockClient(client);
+    UA_StatusCode res =
+        __Client_Batch_add(client, requestType, operation, timestampsToReturn,
+                           callback, userdata, requestId);
+    unlockClient(client);
+    return res;
+}
+
 static UA_StatusCode
 __UA_Client_writeAttribute_async(UA_Client *client, const UA_NodeId *nodeId,
                                  UA_AttributeId attributeId, const void *in,
@@ -927,9 +1345,9 @@ __UA_Client_writeAttribute_async(UA_Client *client, const UA_NodeId *nodeId,
     wReq.nodesToWrite = &wValue;
     wReq.nodesToWriteSize = 1;
 
-    return __UA_Client_AsyncService(client, &wReq,
-                                    &UA_TYPES[UA_TYPES_WRITEREQUEST], callback,
-                                    &UA_TYPES[UA_TYPES_WRITERESPONSE], userdata, reqId);
+    return asyncOperation(client, &wReq, &UA_TYPES[UA_TYPES_WRITEREQUEST], &wValue,
+                          UA_TIMESTAMPSTORETURN_SOURCE, callback,
+                          &UA_TYPES[UA_TYPES_WRITERESPONSE], userdata, reqId);
 }
 
 UA_StatusCode
@@ -948,9 +1366,10 @@ UA_Client_call_async(UA_Client *client, const UA_NodeId objectId,
     item.inputArgumentsSize = inputSize;
     request.methodsToCall = &item;
     request.methodsToCallSize = 1;
-    return __UA_Client_AsyncService(client, &request,
-            &UA_TYPES[UA_TYPES_CALLREQUEST], (UA_ClientAsyncServiceCallback)callback,
-            &UA_TYPES[UA_TYPES_CALLRESPONSE], userdata, reqId);
+    return asyncOperation(client, &request, &UA_TYPES[UA_TYPES_CALLREQUEST], &item,
+                          UA_TIMESTAMPSTORETURN_SOURCE,
+                          (UA_ClientAsyncServiceCallback)callback,
+                          &UA_TYPES[UA_TYPES_CALLRESPONSE], userdata, reqId);
 }
 
 /*************************/
@@ -1056,9 +1475,10 @@ readAttribute_async(UA_Client *client, const UA_ReadValueId *rvi,
     request.timestampsToReturn = timestampsToReturn;
 
     UA_StatusCode res =
-        __UA_Client_AsyncService(client, &request, &UA_TYPES[UA_TYPES_READREQUEST],
-                                 (UA_ClientAsyncServiceCallback)AttributeReadCallback,
-                                 &UA_TYPES[UA_TYPES_READRESPONSE], ctx, requestId);
+        asyncOperation(client, &request, &UA_TYPES[UA_TYPES_READREQUEST], rvi,
+                       timestampsToReturn,
+                       (UA_ClientAsyncServiceCallback)AttributeReadCallback,
+                       &UA_TYPES[UA_TYPES_READRESPONSE], ctx, requestId);
     if(res != UA_STATUSCODE_GOOD)
         UA_free(ctx);
     return res;
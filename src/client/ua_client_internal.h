@@ -81,25 +81,92 @@ __Client_Subscriptions_backgroundPublishInactivityCheck(UA_Client *client);
 /**********/
 
 typedef struct AsyncServiceCall {
-    LIST_ENTRY(AsyncServiceCall) pointers;
+    ZIP_ENTRY(AsyncServiceCall) idTreeEntry;      /* Indexed by the requestId */
+    ZIP_ENTRY(AsyncServiceCall) timeoutTreeEntry; /* Ordered by the timeout */
     UA_UInt32 requestId;     /* Unique id */
     UA_UInt32 requestHandle; /* Potentially non-unique if manually defined in
                               * the request header*/
     UA_ClientAsyncServiceCallback callback;
     const UA_DataType *responseType;
     void *userdata;
-    UA_DateTime start;
-    UA_UInt32 timeout;
+    UA_DateTime timeout;       /* Monotonic time when the request times out */
     UA_Response *syncResponse; /* If non-null, then this is the synchronous
                                 * response to be filled. Set back to null to
                                 * indicate that the response was filled. */
 } AsyncServiceCall;
 
-typedef LIST_HEAD(UA_AsyncServiceList, AsyncServiceCall) UA_AsyncServiceList;
+/* The pending service calls are indexed by their requestId to look up the
+ * callback for a response. The second tree orders them by their timeout. */
+ZIP_HEAD(UA_AsyncServiceIdTree, AsyncServiceCall);
+typedef struct UA_AsyncServiceIdTree UA_AsyncServiceIdTree;
+ZIP_HEAD(UA_AsyncServiceTimeoutTree, AsyncServiceCall);
+typedef struct UA_AsyncServiceTimeoutTree UA_AsyncServiceTimeoutTree;
 
 void
 __Client_AsyncService_removeAll(UA_Client *client, UA_StatusCode statusCode);
 
+/************/
+/* Batching */
+/************/
+
+/* The single-operation async Read, Write and Call functions collect their
+ * operations in a batch per service if batching is enabled in the config. The
+ * requestId of the batch is reserved when its first operation is added. */
+
+typedef struct {
+    UA_ClientAsyncServiceCallback callback;
+    void *userdata;
+} UA_ClientBatchCallback;
+
+typedef struct {
+    UA_UInt32 requestId;
+    UA_TimestampsToReturn timestampsToReturn; /* Only for the Read batch */
+    UA_UInt32 maxOperations; /* Operation limit of the server (0 -> none) */
+    size_t operationsSize;
+    size_t operationsCapacity;
+    void *operations; /* Array of ReadValueId, WriteValue or CallMethodRequest */
+    UA_ClientBatchCallback *callbacks;
+} UA_ClientBatch;
+
+#define UA_CLIENT_BATCHES 3 /* Read, Write, Call */
+
+/* Adds the operation to the batch of the service. The operation is copied. The
+ * callback receives a response with only the result of the operation. */
+UA_StatusCode
+__Client_Batch_add(UA_Client *client, const UA_DataType *requestType,
+                   const void *operation, UA_TimestampsToReturn timestampsToReturn,
+                   UA_ClientAsyncServiceCallback callback, void *userdata,
+                   UA_UInt32 *requestId);
+
+/* Sends all pending batches */
+void
+__Client_Batch_flush(UA_Client *client);
+
+/* Cancels the pending operations with the StatusCode */
+void
+__Client_Batch_removeAll(UA_Client *client, UA_StatusCode statusCode);
+
+/* Reads the operation limits of the server for the size of the batches */
+void
+__Client_Batch_readOperationLimits(UA_Client *client);
+
+/* Reusable memory for decoding responses without heap allocations. What does
+ * not fit into the arena is allocated on the heap. The arena then grows to the
+ * required size when it is reset. */
+typedef union UA_ClientArenaOverflow {
+    union UA_ClientArenaOverflow *next;
+    UA_UInt64 align; /* The payload follows with 8-byte alignment */
+} UA_ClientArenaOverflow;
+
+typedef struct {
+    UA_Byte *data;
+    size_t size;
+    size_t used;
+    size_t overflowSize;
+    UA_ClientArenaOverflow *overflow;
+    UA_Boolean inUse; /* Nested responses are decoded to the heap */
+} UA_ClientArena;
+
 typedef struct CustomCallback {
     UA_UInt32 callbackId;
 
@@ -161,13 +228,19 @@ struct UA_Client {
     UA_Boolean pendingConnectivityCheck;
 
     /* Async Service */
-    UA_AsyncServiceList asyncServiceCalls;
+    UA_AsyncServiceIdTree asyncServiceCalls;
+    UA_AsyncServiceTimeoutTree asyncServiceTimeouts;
+
+    /* Batching of async operations */
+    UA_ClientBatch batches[UA_CLIENT_BATCHES];
+    UA_UInt64 batchCallbackId; /* Sends the batches when the window ends */
 
     /* Subscriptions */
     LIST_HEAD(, UA_Client_NotificationsAckNumber) pendingNotificationsAcks;
     LIST_HEAD(, UA_Client_Subscription) subscriptions;
     UA_UInt32 monitoredItemHandles;
     UA_UInt16 currentlyOutStandingPublishRequests;
+    UA_ClientArena notificationArena; /* For config.zeroCopyNotifications */
 
     /* Internal namespaces. The table maps the namespace Uri to its index. This
      * is used for the automatic namespace mapping in de/encoding. */
@@ -197,6 +270,15 @@ __Client_AsyncService(UA_Client *client, const void *request,
                       const UA_DataType *responseType,
                       void *userdata, UA_UInt32 *requestId);
 
+/* Same as __Client_AsyncService, but uses a requestId that was reserved before
+ * by incrementing client->requestId */
+UA_StatusCode
+__Client_AsyncServiceWithId(UA_Client *client, const void *request,
+                            const UA_DataType *requestType,
+                            UA_ClientAsyncServiceCallback callback,
+                            const UA_DataType *responseType,
+                            void *userdata, UA_UInt32 requestId);
+
 void
 __Client_Service(UA_Client *client, const void *request,
                  const UA_DataType *requestType, void *response,
@@ -0,0 +1,708 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/client_pool.h>
+
+#include "ua_client_internal.h"
+
+struct UA_ClientPool {
+    size_t maxOperationsPerRequest;
+    size_t clientsSize;
+    UA_Client **clients;
+    size_t *pending; /* Outstanding chunks per client */
+};
+
+typedef enum {
+    UA_CLIENTPOOL_READ,
+    UA_CLIENTPOOL_BROWSE,
+    UA_CLIENTPOOL_HISTORYREAD
+} UA_ClientPoolService;
+
+/* A request of the pool that is split up into chunks */
+typedef struct {
+    UA_ClientPool *pool;
+    UA_ClientPoolService service;
+    const void *request;
+    const UA_DataType *resultType;
+    void *results;
+    size_t pending; /* Outstanding chunks */
+    UA_Boolean succeeded;
+    UA_StatusCode firstError;
+} PoolCall;
+
+/* The chunk is a consecutive range of operations of the request. After the
+ * first response, the indices point to the results where a continuation point
+ * is followed. */
+typedef struct {
+    PoolCall *call;
+    size_t clientIndex;
+    size_t offset;
+    size_t size;
+    size_t indicesSize;
+    size_t *indices;
+} PoolChunk;
+
+/*****************/
+/* Pool Handling */
+/*****************/
+
+UA_ClientPool *
+UA_ClientPool_new(size_t maxOperationsPerRequest) {
+    UA_ClientPool *pool = (UA_ClientPool*)UA_calloc(1, sizeof(UA_ClientPool));
+    if(!pool)
+        return NULL;
+    pool->maxOperationsPerRequest = maxOperationsPerRequest;
+    return pool;
+}
+
+UA_StatusCode
+UA_ClientPool_addClient(UA_ClientPool *pool, UA_Client *client) {
+    if(!pool || !client)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    /* All clients are run from the same EventLoop */
+    if(pool->clientsSize > 0 &&
+       pool->clients[0]->config.eventLoop != client->config.eventLoop)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    UA_Client **clients = (UA_Client**)
+        UA_realloc(pool->clients, sizeof(UA_Client*) * (pool->clientsSize + 1));
+    if(!clients)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    pool->clients = clients;
+
+    size_t *pending = (size_t*)
+        UA_realloc(pool->pending, sizeof(size_t) * (pool->clientsSize + 1));
+    if(!pending)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    pool->pending = pending;
+
+    pool->clients[pool->clientsSize] = client;
+    pool->pending[pool->clientsSize] = 0;
+    pool->clientsSize++;
+    return UA_STATUSCODE_GOOD;
+}
+
+void
+UA_ClientPool_delete(UA_ClientPool *pool) {
+    if(!pool)
+        return;
+    /* Delete the first client last. It may own the EventLoop. */
+    for(size_t i = pool->clientsSize; i > 0; i--)
+        UA_Client_delete(pool->clients[i-1]);
+    UA_free(pool->clients);
+    UA_free(pool->pending);
+    UA_free(pool);
+}
+
+size_t
+UA_ClientPool_getSize(const UA_ClientPool *pool) {
+    return pool->clientsSize;
+}
+
+UA_Client *
+UA_ClientPool_getClient(UA_ClientPool *pool, size_t index) {
+    if(index >= pool->clientsSize)
+        return NULL;
+    return pool->clients[index];
+}
+
+UA_StatusCode
+UA_ClientPool_connect(UA_ClientPool *pool, const char *endpointUrl) {
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < pool->clientsSize; i++) {
+        UA_StatusCode res2 = UA_Client_connect(pool->clients[i], endpointUrl);
+        if(res == UA_STATUSCODE_GOOD)
+            res = res2;
+    }
+    return res;
+}
+
+void
+UA_ClientPool_disconnect(UA_ClientPool *pool) {
+    for(size_t i = 0; i < pool->clientsSize; i++)
+        UA_Client_disconnect(pool->clients[i]);
+}
+
+static UA_Boolean
+isConnected(UA_Client *client) {
+    lockClient(client);
+    UA_Boolean connected = (client->sessionState == UA_SESSIONSTATE_ACTIVATED);
+    unlockClient(client);
+    return connected;
+}
+
+/*******************/
+/* Result Handling */
+/*******************/
+
+static void *
+resultAt(PoolCall *call, size_t index) {
+    return (void*)((uintptr_t)call->results + (index * call->resultType->memSize));
+}
+
+static void
+setResultStatus(PoolCall *call, size_t index, UA_StatusCode statusCode) {
+    void *result = resultAt(call, index);
+    switch(call->service) {
+    case UA_CLIENTPOOL_READ: {
+        UA_DataValue *dv = (UA_DataValue*)result;
+        UA_DataValue_clear(dv);
+        dv->hasStatus = true;
+        dv->status = statusCode;
+        break;
+    }
+    case UA_CLIENTPOOL_BROWSE: {
+        UA_BrowseResult *br = (UA_BrowseResult*)result;
+        UA_ByteString_clear(&br->continuationPoint);
+        br->statusCode = statusCode;
+        break;
+    }
+    default: {
+        UA_HistoryReadResult *hr = (UA_HistoryReadResult*)result;
+        UA_ByteString_clear(&hr->continuationPoint);
+        hr->statusCode = statusCode;
+        break;
+    }
+    }
+}
+
+/* Set the status for the outstanding operations of the chunk */
+static void
+setChunkStatus(PoolChunk *chunk, UA_StatusCode statusCode) {
+    PoolCall *call = chunk->call;
+    if(call->firstError == UA_STATUSCODE_GOOD)
+        call->firstError = statusCode;
+    if(chunk->indices) {
+        for(size_t i = 0; i < chunk->indicesSize; i++)
+            setResultStatus(call, chunk->indices[i], statusCode);
+    } else {
+        for(size_t i = 0; i < chunk->size; i++)
+            setResultStatus(call, chunk->offset + i, statusCode);
+    }
+}
+
+static void
+finishChunk(PoolChunk *chunk) {
+    chunk->call->pool->pending[chunk->clientIndex]--;
+    chunk->call->pending--;
+    UA_free(chunk->indices);
+    UA_free(chunk);
+}
+
+/* Move the elements of src to the end of dst */
+static UA_StatusCode
+appendArray(void **dst, size_t *dstSize, void **src, size_t *srcSize,
+            const UA_DataType *type) {
+    if(*srcSize == 0)
+        return UA_STATUSCODE_GOOD;
+    if(*dstSize == 0) {
+        UA_Array_delete(*dst, 0, type);
+        *dst = *src;
+        *dstSize = *srcSize;
+        *src = NULL;
+        *srcSize = 0;
+        return UA_STATUSCODE_GOOD;
+    }
+    void *merged = UA_realloc(*dst, type->memSize * (*dstSize + *srcSize));
+    if(!merged)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    memcpy((void*)((uintptr_t)merged + (type->memSize * *dstSize)),
+           *src, type->memSize * *srcSize);
+    *dst = merged;
+    *dstSize += *srcSize;
+    UA_free(*src);
+    *src = NULL;
+    *srcSize = 0;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Collect the results of the chunk with a continuation point. Returns false if
+ * no continuation point remains. */
+static UA_Boolean
+collectContinuationPoints(PoolChunk *chunk) {
+    PoolCall *call = chunk->call;
+    size_t count = chunk->indices ? chunk->indicesSize : chunk->size;
+    if(!chunk->indices) {
+        chunk->indices = (size_t*)UA_malloc(sizeof(size_t) * chunk->size);
+        if(!chunk->indices) {
+            setChunkStatus(chunk, UA_STATUSCODE_BADOUTOFMEMORY);
+            return false;
+        }
+        for(size_t i = 0; i < chunk->size; i++)
+            chunk->indices[i] = chunk->offset + i;
+    }
+
+    size_t pos = 0;
+    for(size_t i = 0; i < count; i++) {
+        const UA_ByteString *cp;
+        if(call->service == UA_CLIENTPOOL_BROWSE)
+            cp = &((UA_BrowseResult*)resultAt(call, chunk->indices[i]))->continuationPoint;
+        else
+            cp = &((UA_HistoryReadResult*)resultAt(call, chunk->indices[i]))->continuationPoint;
+        if(cp->length > 0)
+            chunk->indices[pos++] = chunk->indices[i];
+    }
+    chunk->indicesSize = pos;
+    return (pos > 0);
+}
+
+/*********************/
+/* Service Callbacks */
+/*********************/
+
+static void
+readCallback(UA_Client *client, void *userdata,
+             UA_UInt32 requestId, void *r) {
+    PoolChunk *chunk = (PoolChunk*)userdata;
+    PoolCall *call = chunk->call;
+    UA_ReadResponse *response = (UA_ReadResponse*)r;
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        setChunkStatus(chunk, response->responseHeader.serviceResult);
+        finishChunk(chunk);
+        return;
+    }
+
+    /* Move the results into place */
+    call->succeeded = true;
+    UA_DataValue *results = (UA_DataValue*)call->results;
+    for(size_t i = 0; i < chunk->size; i++) {
+        if(i >= response->resultsSize) {
+            setResultStatus(call, chunk->offset + i, UA_STATUSCODE_BADUNEXPECTEDERROR);
+            continue;
+        }
+        results[chunk->offset + i] = response->results[i];
+        UA_DataValue_init(&response->results[i]);
+    }
+    finishChunk(chunk);
+}
+
+static void
+browseNextCallback(UA_Client *client, void *userdata,
+                   UA_UInt32 requestId, void *r);
+
+/* Follow the continuation points on the client that created them. Called from
+ * the callback with the client lock held. */
+static void
+sendBrowseNext(UA_Client *client, PoolChunk *chunk) {
+    if(!collectContinuationPoints(chunk)) {
+        finishChunk(chunk);
+        return;
+    }
+
+    PoolCall *call = chunk->call;
+    UA_ByteString *cps = (UA_ByteString*)
+        UA_malloc(sizeof(UA_ByteString) * chunk->indicesSize);
+    if(!cps) {
+        setChunkStatus(chunk, UA_STATUSCODE_BADOUTOFMEMORY);
+        finishChunk(chunk);
+        return;
+    }
+    for(size_t i = 0; i < chunk->indicesSize; i++)
+        cps[i] = ((UA_BrowseResult*)resultAt(call, chunk->indices[i]))->continuationPoint;
+
+    UA_BrowseNextRequest request;
+    UA_BrowseNextRequest_init(&request);
+    request.continuationPoints = cps;
+    request.continuationPointsSize = chunk->indicesSize;
+    UA_StatusCode res =
+        __Client_AsyncService(client, &request, &UA_TYPES[UA_TYPES_BROWSENEXTREQUEST],
+                              browseNextCallback, &UA_TYPES[UA_TYPES_BROWSENEXTRESPONSE],
+                              chunk, NULL);
+    UA_free(cps);
+    if(res != UA_STATUSCODE_GOOD) {
+        setChunkStatus(chunk, res);
+        finishChunk(chunk);
+    }
+}
+
+static void
+browseNextCallback(UA_Client *client, void *userdata,
+                   UA_UInt32 requestId, void *r) {
+    PoolChunk *chunk = (PoolChunk*)userdata;
+    PoolCall *call = chunk->call;
+    UA_BrowseNextResponse *response = (UA_BrowseNextResponse*)r;
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        setChunkStatus(chunk, response->responseHeader.serviceResult);
+        finishChunk(chunk);
+        return;
+    }
+
+    /* Append the references */
+    for(size_t i = 0; i < chunk->indicesSize; i++) {
+        UA_BrowseResult *br = (UA_BrowseResult*)resultAt(call, chunk->indices[i]);
+        if(i >= response->resultsSize) {
+            setResultStatus(call, chunk->indices[i], UA_STATUSCODE_BADUNEXPECTEDERROR);
+            continue;
+        }
+        UA_BrowseResult *next = &response->results[i];
+        UA_ByteString_clear(&br->continuationPoint);
+        br->statusCode = next->statusCode;
+        br->continuationPoint = next->continuationPoint;
+        UA_ByteString_init(&next->continuationPoint);
+        UA_StatusCode res =
+            appendArray((void**)&br->references, &br->referencesSize,
+                        (void**)&next->references, &next->referencesSize,
+                        &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]);
+        if(res != UA_STATUSCODE_GOOD)
+            setResultStatus(call, chunk->indices[i], res);
+    }
+
+    sendBrowseNext(client, chunk);
+}
+
+static void
+browseCallback(UA_Client *client, void *userdata,
+               UA_UInt32 requestId, void *r) {
+    PoolChunk *chunk = (PoolChunk*)userdata;
+    PoolCall *call = chunk->call;
+    UA_BrowseResponse *response = (UA_BrowseResponse*)r;
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        setChunkStatus(chunk, response->responseHeader.serviceResult);
+        finishChunk(chunk);
+        return;
+    }
+
+    /* Move the results into place */
+    call->succeeded = true;
+    UA_BrowseResult *results = (UA_BrowseResult*)call->results;
+    for(size_t i = 0; i < chunk->size; i++) {
+        if(i >= response->resultsSize) {
+            setResultStatus(call, chunk->offset + i, UA_STATUSCODE_BADUNEXPECTEDERROR);
+            continue;
+        }
+        results[chunk->offset + i] = response->results[i];
+        UA_BrowseResult_init(&response->results[i]);
+    }
+
+    sendBrowseNext(client, chunk);
+}
+
+/* Append the history of a follow-up response to the result */
+static UA_StatusCode
+mergeHistoryData(UA_ExtensionObject *dst, UA_ExtensionObject *src) {
+    if(src->encoding < UA_EXTENSIONOBJECT_DECODED)
+        return UA_STATUSCODE_GOOD; /* Nothing to append */
+    if(dst->encoding < UA_EXTENSIONOBJECT_DECODED) {
+        UA_ExtensionObject_clear(dst);
+        *dst = *src;
+        UA_ExtensionObject_init(src);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    const UA_DataType *type = dst->content.decoded.type;
+    if(type != src->content.decoded.type)
+        return UA_STATUSCODE_BADUNEXPECTEDERROR;
+
+    if(type == &UA_TYPES[UA_TYPES_HISTORYDATA]) {
+        UA_HistoryData *d = (UA_HistoryData*)dst->content.decoded.data;
+        UA_HistoryData *s = (UA_HistoryData*)src->content.decoded.data;
+        return appendArray((void**)&d->dataValues, &d->dataValuesSize,
+                           (void**)&s->dataValues, &s->dataValuesSize,
+                           &UA_TYPES[UA_TYPES_DATAVALUE]);
+    }
+
+    if(type == &UA_TYPES[UA_TYPES_HISTORYMODIFIEDDATA]) {
+        UA_HistoryModifiedData *d = (UA_HistoryModifiedData*)dst->content.decoded.data;
+        UA_HistoryModifiedData *s = (UA_HistoryModifiedData*)src->content.decoded.data;
+        UA_StatusCode res =
+            appendArray((void**)&d->dataValues, &d->dataValuesSize,
+                        (void**)&s->dataValues, &s->dataValuesSize,
+                        &UA_TYPES[UA_TYPES_DATAVALUE]);
+        res |= appendArray((void**)&d->modificationInfos, &d->modificationInfosSize,
+                           (void**)&s->modificationInfos, &s->modificationInfosSize,
+                           &UA_TYPES[UA_TYPES_MODIFICATIONINFO]);
+        return res;
+    }
+
+    if(type == &UA_TYPES[UA_TYPES_HISTORYEVENT]) {
+        UA_HistoryEvent *d = (UA_HistoryEvent*)dst->content.decoded.data;
+        UA_HistoryEvent *s = (UA_HistoryEvent*)src->content.decoded.data;
+        return appendArray((void**)&d->events, &d->eventsSize,
+                           (void**)&s->events, &s->eventsSize,
+                           &UA_TYPES[UA_TYPES_HISTORYEVENTFIELDLIST]);
+    }
+
+    return UA_STATUSCODE_BADNOTSUPPORTED;
+}
+
+static void
+historyReadCallback(UA_Client *client, void *userdata,
+                    UA_UInt32 requestId, void *r);
+
+/* Follow the continuation points with the original details of the request */
+static void
+sendHistoryReadNext(UA_Client *client, PoolChunk *chunk) {
+    if(!collectContinuationPoints(chunk)) {
+        finishChunk(chunk);
+        return;
+    }
+
+    PoolCall *call = chunk->call;
+    const UA_HistoryReadRequest *orig = (const UA_HistoryReadRequest*)call->request;
+    UA_HistoryReadValueId *ids = (UA_HistoryReadValueId*)
+        UA_malloc(sizeof(UA_HistoryReadValueId) * chunk->indicesSize);
+    if(!ids) {
+        setChunkStatus(chunk, UA_STATUSCODE_BADOUTOFMEMORY);
+        finishChunk(chunk);
+        return;
+    }
+    for(size_t i = 0; i < chunk->indicesSize; i++) {
+        size_t index = chunk->indices[i];
+        ids[i] = orig->nodesToRead[index];
+        ids[i].continuationPoint =
+            ((UA_HistoryReadResult*)resultAt(call, index))->continuationPoint;
+    }
+
+    UA_HistoryReadRequest request = *orig;
+    request.requestHeader.requestHandle = 0;
+    request.releaseContinuationPoints = false;
+    request.nodesToRead = ids;
+    request.nodesToReadSize = chunk->indicesSize;
+    UA_StatusCode res =
+        __Client_AsyncService(client, &request, &UA_TYPES[UA_TYPES_HISTORYREADREQUEST],
+                              historyReadCallback, &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE],
+                              chunk, NULL);
+    UA_free(ids);
+    if(res != UA_STATUSCODE_GOOD) {
+        setChunkStatus(chunk, res);
+        finishChunk(chunk);
+    }
+}
+
+static void
+historyReadCallback(UA_Client *client, void *userdata,
+                    UA_UInt32 requestId, void *r) {
+    PoolChunk *chunk = (PoolChunk*)userdata;
+    PoolCall *call = chunk->call;
+    UA_HistoryReadResponse *response = (UA_HistoryReadResponse*)r;
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        setChunkStatus(chunk, response->responseHeader.serviceResult);
+        finishChunk(chunk);
+        return;
+    }
+
+    /* Move the results of the first response into place */
+    if(!chunk->indices) {
+        call->succeeded = true;
+        UA_HistoryReadResult *results = (UA_HistoryReadResult*)call->results;
+        for(size_t i = 0; i < chunk->size; i++) {
+            if(i >= response->resultsSize) {
+                setResultStatus(call, chunk->offset + i,
+                                UA_STATUSCODE_BADUNEXPECTEDERROR);
+                continue;
+            }
+            results[chunk->offset + i] = response->results[i];
+            UA_HistoryReadResult_init(&response->results[i]);
+        }
+        sendHistoryReadNext(client, chunk);
+        return;
+    }
+
+    /* Append the results of a follow-up response */
+    for(size_t i = 0; i < chunk->indicesSize; i++) {
+        UA_HistoryReadResult *hr = (UA_HistoryReadResult*)resultAt(call, chunk->indices[i]);
+        if(i >= response->resultsSize) {
+            setResultStatus(call, chunk->indices[i], UA_STATUSCODE_BADUNEXPECTEDERROR);
+            continue;
+        }
+        UA_HistoryReadResult *next = &response->results[i];
+        UA_ByteString_clear(&hr->continuationPoint);
+        hr->statusCode = next->statusCode;
+        hr->continuationPoint = next->continuationPoint;
+        UA_ByteString_init(&next->continuationPoint);
+        UA_StatusCode res = mergeHistoryData(&hr->historyData, &next->historyData);
+        if(res != UA_STATUSCODE_GOOD)
+            setResultStatus(call, chunk->indices[i], res);
+    }
+
+    sendHistoryReadNext(client, chunk);
+}
+
+/******************/
+/* Chunk Handling */
+/******************/
+
+static UA_StatusCode
+sendChunk(PoolCall *call, PoolChunk *chunk) {
+    UA_Client *client = call->pool->clients[chunk->clientIndex];
+    switch(call->service) {
+    case UA_CLIENTPOOL_READ: {
+        UA_ReadRequest request = *(const UA_ReadRequest*)call->request;
+        request.nodesToRead = &request.nodesToRead[chunk->offset];
+        request.nodesToReadSize = chunk->size;
+        return __UA_Client_AsyncService(client, &request,
+                                        &UA_TYPES[UA_TYPES_READREQUEST],
+                                        readCallback,
+                                        &UA_TYPES[UA_TYPES_READRESPONSE],
+                                        chunk, NULL);
+    }
+    case UA_CLIENTPOOL_BROWSE: {
+        UA_BrowseRequest request = *(const UA_BrowseRequest*)call->request;
+        request.nodesToBrowse = &request.nodesToBrowse[chunk->offset];
+        request.nodesToBrowseSize = chunk->size;
+        return __UA_Client_AsyncService(client, &request,
+                                        &UA_TYPES[UA_TYPES_BROWSEREQUEST],
+                                        browseCallback,
+                                        &UA_TYPES[UA_TYPES_BROWSERESPONSE],
+                                        chunk, NULL);
+    }
+    default: {
+        UA_HistoryReadRequest request = *(const UA_HistoryReadRequest*)call->request;
+        request.nodesToRead = &request.nodesToRead[chunk->offset];
+        request.nodesToReadSize = chunk->size;
+        return __UA_Client_AsyncService(client, &request,
+                                        &UA_TYPES[UA_TYPES_HISTORYREADREQUEST],
+                                        historyReadCallback,
+                                        &UA_TYPES[UA_TYPES_HISTORYREADRESPONSE],
+                                        chunk, NULL);
+    }
+    }
+}
+
+/* Split the operations into chunks, send them over the connected clients and
+ * wait until all chunks are processed */
+static UA_StatusCode
+poolService(UA_ClientPool *pool, PoolCall *call, size_t operationsSize) {
+    if(operationsSize == 0)
+        return UA_STATUSCODE_BADNOTHINGTODO;
+
+    /* Count the connected clients */
+    size_t connected = 0;
+    for(size_t i = 0; i < pool->clientsSize; i++) {
+        if(isConnected(pool->clients[i]))
+            connected++;
+    }
+    if(connected == 0)
+        return UA_STATUSCODE_BADSERVERNOTCONNECTED;
+
+    call->results = UA_Array_new(operationsSize, call->resultType);
+    if(!call->results)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    /* Split up the operations evenly over the connected clients */
+    size_t chunkSize = (operationsSize + connected - 1) / connected;
+    if(pool->maxOperationsPerRequest > 0 &&
+       chunkSize > pool->maxOperationsPerRequest)
+        chunkSize = pool->maxOperationsPerRequest;
+
+    for(size_t offset = 0; offset < operationsSize; offset += chunkSize) {
+        size_t size = chunkSize;
+        if(offset + size > operationsSize)
+            size = operationsSize - offset;
+
+        PoolChunk *chunk = (PoolChunk*)UA_calloc(1, sizeof(PoolChunk));
+        if(!chunk) {
+            call->firstError = UA_STATUSCODE_BADOUTOFMEMORY;
+            for(size_t i = 0; i < size; i++)
+                setResultStatus(call, offset + i, UA_STATUSCODE_BADOUTOFMEMORY);
+            continue;
+        }
+        chunk->call = call;
+        chunk->offset = offset;
+        chunk->size = size;
+
+        /* Use the connected client with the least outstanding chunks */
+        UA_Boolean found = false;
+        for(size_t i = 0; i < pool->clientsSize; i++) {
+            if(found && pool->pending[i] >= pool->pending[chunk->clientIndex])
+                continue;
+            if(!isConnected(pool->clients[i]))
+                continue;
+            chunk->clientIndex = i;
+            found = true;
+        }
+
+        UA_StatusCode res = (found) ? sendChunk(call, chunk) :
+            UA_STATUSCODE_BADSERVERNOTCONNECTED;
+        if(res != UA_STATUSCODE_GOOD) {
+            setChunkStatus(chunk, res);
+            UA_free(chunk);
+            continue;
+        }
+        pool->pending[chunk->clientIndex]++;
+        call->pending++;
+    }
+
+    /* Run the EventLoop until all chunks are processed. If the EventLoop
+     * fails, disconnecting the clients cancels the outstanding requests. */
+    UA_EventLoop *el = pool->clients[0]->config.eventLoop;
+    while(call->pending > 0) {
+        UA_StatusCode res = el->run(el, 100);
+        if(res != UA_STATUSCODE_GOOD)
+            UA_ClientPool_disconnect(pool);
+    }
+
+    return (call->succeeded) ? UA_STATUSCODE_GOOD : call->firstError;
+}
+
+UA_ReadResponse
+UA_ClientPool_read(UA_ClientPool *pool, const UA_ReadRequest *request) {
+    PoolCall call;
+    memset(&call, 0, sizeof(PoolCall));
+    call.pool = pool;
+    call.service = UA_CLIENTPOOL_READ;
+    call.request = request;
+    call.resultType = &UA_TYPES[UA_TYPES_DATAVALUE];
+
+    UA_ReadResponse response;
+    UA_ReadResponse_init(&response);
+    response.responseHeader.serviceResult =
+        poolService(pool, &call, request->nodesToReadSize);
+    if(response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        if(call.results)
+            UA_Array_delete(call.results, request->nodesToReadSize, call.resultType);
+        return response;
+    }
+    response.results = (UA_DataValue*)call.results;
+    response.resultsSize = request->nodesToReadSize;
+    return response;
+}
+
+UA_BrowseResponse
+UA_ClientPool_browse(UA_ClientPool *pool, const UA_BrowseRequest *request) {
+    PoolCall call;
+    memset(&call, 0, sizeof(PoolCall));
+    call.pool = pool;
+    call.service = UA_CLIENTPOOL_BROWSE;
+    call.request = request;
+    call.resultType = &UA_TYPES[UA_TYPES_BROWSERESULT];
+
+    UA_BrowseResponse response;
+    UA_BrowseResponse_init(&response);
+    response.responseHeader.serviceResult =
+        poolService(pool, &call, request->nodesToBrowseSize);
+    if(response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        if(call.results)
+            UA_Array_delete(call.results, request->nodesToBrowseSize, call.resultType);
+        return response;
+    }
+    response.results = (UA_BrowseResult*)call.results;
+    response.resultsSize = request->nodesToBrowseSize;
+    return response;
+}
+
+UA_HistoryReadResponse
+UA_ClientPool_historyRead(UA_ClientPool *pool, const UA_HistoryReadRequest *request) {
+    PoolCall call;
+    memset(&call, 0, sizeof(PoolCall));
+    call.pool = pool;
+    call.service = UA_CLIENTPOOL_HISTORYREAD;
+    call.request = request;
+    call.resultType = &UA_TYPES[UA_TYPES_HISTORYREADRESULT];
+
+    UA_HistoryReadResponse response;
+    UA_HistoryReadResponse_init(&response);
+    response.responseHeader.serviceResult =
+        poolService(pool, &call, request->nodesToReadSize);
+    if(response.responseHeader.serviceResult != UA_STATUSCODE_GOOD) {
+        if(call.results)
+            UA_Array_delete(call.results, request->nodesToReadSize, call.resultType);
+        return response;
+    }
+    response.results = (UA_HistoryReadResult*)call.results;
+    response.resultsSize = request->nodesToReadSize;
+    return response;
+}
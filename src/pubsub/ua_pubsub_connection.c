@@ -28,80 +28,75 @@ UA_PubSubConnection_process(UA_PubSubManager *psm, UA_PubSubConnection *c,
 static void
 UA_PubSubConnection_disconnect(UA_PubSubConnection *c);
 
-UA_StatusCode
-UA_PubSubConnection_decodeNetworkMessage(UA_PubSubManager *psm,
-                                         UA_PubSubConnection *connection,
-                                         UA_ByteString buffer,
-                                         UA_NetworkMessage *nm) {
+/* Decode the headers and select the ReaderGroup that verifies and decrypts the
+ * message (there could be multiple) */
+static UA_StatusCode
+decodeNetworkMessageHeaders(UA_PubSubManager *psm, UA_PubSubConnection *connection,
+                            UA_ByteString buffer, Ctx *ctx, UA_NetworkMessage *nm,
+                            UA_ReaderGroup **outRg) {
 #ifdef UA_DEBUG_DUMP_PKGS
-    UA_dump_hex_pkg(buffer->data, buffer->length);
+    UA_dump_hex_pkg(buffer.data, buffer.length);
 #endif
 
     /* Set up the decoding context */
-    Ctx ctx;
-    ctx.pos = buffer.data;
-    ctx.end = buffer.data + buffer.length;
-    ctx.depth = 0;
-    memset(&ctx.opts, 0, sizeof(UA_DecodeBinaryOptions));
-    ctx.opts.customTypes = psm->sc.server->config.customDataTypes;
+    ctx->pos = buffer.data;
+    ctx->end = buffer.data + buffer.length;
+    ctx->depth = 0;
+    memset(&ctx->opts, 0, sizeof(UA_DecodeBinaryOptions));
+    ctx->opts.customTypes = psm->sc.server->config.customDataTypes;
 
     /* Decode the headers */
-    UA_StatusCode rv = UA_NetworkMessage_decodeHeaders(&ctx, nm);
+    UA_StatusCode rv = UA_NetworkMessage_decodeHeaders(ctx, nm);
     if(rv != UA_STATUSCODE_GOOD) {
         UA_LOG_WARNING_PUBSUB(psm->logging, connection,
                               "PubSub receive. decoding headers failed");
-        UA_NetworkMessage_clear(nm);
         return rv;
     }
 
     /* Choose a correct readergroup for decrypt/verify this message
      * (there could be multiple) */
-    UA_Boolean processed = false;
     UA_ReaderGroup *rg;
     LIST_FOREACH(rg, &connection->readerGroups, listEntry) {
-        UA_DataSetReader *reader;
-        LIST_FOREACH(reader, &rg->readers, listEntry) {
-            UA_StatusCode res = UA_DataSetReader_checkIdentifier(psm, reader, nm);
-            if(res != UA_STATUSCODE_GOOD)
-                continue;
-            processed = true;
-            rv = verifyAndDecryptNetworkMessage(psm->logging, buffer, &ctx, nm, rg);
-            if(rv != UA_STATUSCODE_GOOD) {
-                UA_NetworkMessage_clear(nm);
-                return rv;
-            }
-
-            /* break out of all loops when first verify & decrypt was successful */
-            goto loops_exit;
-        }
+        if(!UA_ReaderGroup_hasMatchingReader(psm, rg, nm))
+            continue;
+        *outRg = rg;
+        return UA_STATUSCODE_GOOD;
     }
 
-loops_exit:
-    if(!processed) {
-        UA_DateTime nowM = UA_DateTime_nowMonotonic();
-        if(connection->silenceErrorUntil < nowM) {
-            UA_LOG_WARNING_PUBSUB(psm->logging, connection,
-                                  "Could not decode the received NetworkMessage "
-                                  "-- No matching ReaderGroup");
-            connection->silenceErrorUntil = nowM + (UA_DateTime)(10.0 * UA_DATETIME_SEC);
-        }
-        UA_NetworkMessage_clear(nm);
-        return UA_STATUSCODE_BADINTERNALERROR;
+    UA_DateTime nowM = UA_DateTime_nowMonotonic();
+    if(connection->silenceErrorUntil < nowM) {
+        UA_LOG_WARNING_PUBSUB(psm->logging, connection,
+                              "Could not decode the received NetworkMessage "
+                              "-- No matching ReaderGroup");
+        connection->silenceErrorUntil = nowM + (UA_DateTime)(10.0 * UA_DATETIME_SEC);
     }
+    return UA_STATUSCODE_BADINTERNALERROR;
+}
 
-    rv = UA_NetworkMessage_decodePayload(&ctx, nm);
-    if(rv != UA_STATUSCODE_GOOD) {
-        UA_NetworkMessage_clear(nm);
+static UA_StatusCode
+decodeNetworkMessagePayload(Ctx *ctx, UA_NetworkMessage *nm) {
+    UA_StatusCode rv = UA_NetworkMessage_decodePayload(ctx, nm);
+    if(rv != UA_STATUSCODE_GOOD)
         return rv;
-    }
+    return UA_NetworkMessage_decodeFooters(ctx, nm);
+}
 
-    rv = UA_NetworkMessage_decodeFooters(&ctx, nm);
-    if(rv != UA_STATUSCODE_GOOD) {
+UA_StatusCode
+UA_PubSubConnection_decodeNetworkMessage(UA_PubSubManager *psm,
+                                         UA_PubSubConnection *connection,
+                                         UA_ByteString buffer,
+                                         UA_NetworkMessage *nm) {
+    Ctx ctx;
+    UA_ReaderGroup *rg = NULL;
+    UA_StatusCode rv =
+        decodeNetworkMessageHeaders(psm, connection, buffer, &ctx, nm, &rg);
+    if(rv == UA_STATUSCODE_GOOD)
+        rv = verifyAndDecryptNetworkMessage(psm->logging, buffer, &ctx, nm, rg);
+    if(rv == UA_STATUSCODE_GOOD)
+        rv = decodeNetworkMessagePayload(&ctx, nm);
+    if(rv != UA_STATUSCODE_GOOD)
         UA_NetworkMessage_clear(nm);
-        return rv;
-    }
-
-    return UA_STATUSCODE_GOOD;
+    return rv;
 }
 
 UA_StatusCode
@@ -298,19 +293,66 @@ UA_PubSubConnection_delete(UA_PubSubManager *psm, UA_PubSubConnection *c) {
     return UA_STATUSCODE_GOOD;
 }
 
+/* Forward the decoded message to the ReaderGroups. With skipFixedLayout, the
+ * ReaderGroups that have already processed the message with their fixed layout
+ * are skipped. */
+static UA_Boolean
+UA_PubSubConnection_processNetworkMessage(UA_PubSubManager *psm,
+                                          UA_PubSubConnection *c,
+                                          UA_NetworkMessage *nm,
+                                          UA_Boolean skipFixedLayout) {
+    UA_Boolean processed = false;
+    UA_ReaderGroup *rg;
+    LIST_FOREACH(rg, &c->readerGroups, listEntry) {
+        if(rg->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
+           rg->head.state != UA_PUBSUBSTATE_PREOPERATIONAL)
+            continue;
+        if(skipFixedLayout && rg->fixedLayoutProcessed)
+            continue;
+        processed |= UA_ReaderGroup_process(psm, rg, nm);
+    }
+    return processed;
+}
+
 static void
-UA_PubSubConnection_process(UA_PubSubManager *psm, UA_PubSubConnection *c,
-                            const UA_ByteString msg) {
-    UA_LOG_TRACE_PUBSUB(psm->logging, c, "Processing a received buffer");
+UA_PubSubConnection_warnNotProcessed(UA_PubSubManager *psm, UA_PubSubConnection *c) {
+    UA_DateTime nowM = UA_DateTime_nowMonotonic();
+    if(c->silenceErrorUntil < nowM) {
+        UA_LOG_WARNING_PUBSUB(psm->logging, c,
+                              "Message received that could not be processed. "
+                              "Check PublisherID, WriterGroupID and DatasetWriterID.");
+        c->silenceErrorUntil = nowM + (UA_DateTime)(10.0 * UA_DATETIME_SEC);
+    }
+}
 
-    /* Process RT ReaderGroups */
-    UA_Boolean processed = false;
+/* Try the precomputed fixed layouts of the ReaderGroups before decoding. The
+ * ReaderGroups that processed the message are marked with fixedLayoutProcessed.
+ * Returns whether other enabled ReaderGroups still need the decoded message. */
+static UA_Boolean
+UA_PubSubConnection_processFixedLayout(UA_PubSubManager *psm, UA_PubSubConnection *c,
+                                       const UA_ByteString *msg, UA_Boolean *processed) {
+    UA_Boolean decode = false;
+    UA_ReaderGroup *rg;
+    LIST_FOREACH(rg, &c->readerGroups, listEntry) {
+        rg->fixedLayoutProcessed = UA_ReaderGroup_processFixedLayout(psm, rg, msg);
+        if(rg->fixedLayoutProcessed)
+            *processed = true;
+        else if(rg->head.state == UA_PUBSUBSTATE_OPERATIONAL ||
+                rg->head.state == UA_PUBSUBSTATE_PREOPERATIONAL)
+            decode = true;
+    }
+    return decode;
+}
+
+/* Decode the message for the ReaderGroups that have not processed it with
+ * their fixed layout */
+static UA_Boolean
+UA_PubSubConnection_decodeAndProcess(UA_PubSubManager *psm, UA_PubSubConnection *c,
+                                     const UA_ByteString msg) {
     UA_ReaderGroup *rg = LIST_FIRST(&c->readerGroups);
-    /* Any interested ReaderGroups? */
     if(!rg)
-        goto finish;
+        return false;
 
-    /* Decode the received message for the non-RT ReaderGroups */
     UA_StatusCode res;
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
@@ -331,25 +373,115 @@ UA_PubSubConnection_process(UA_PubSubManager *psm, UA_PubSubConnection *c,
     }
 
     if(res != UA_STATUSCODE_GOOD)
-        return;
+        return true; /* Not reported as an unprocessed message */
 
-    /* Process the received message for the non-RT ReaderGroups */
-    LIST_FOREACH(rg, &c->readerGroups, listEntry) {
-        if(rg->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
-           rg->head.state != UA_PUBSUBSTATE_PREOPERATIONAL)
-            continue;
-        processed |= UA_ReaderGroup_process(psm, rg, &nm);
-    }
+    /* Process the received message for the ReaderGroups without a matching
+     * fixed layout */
+    UA_Boolean processed = UA_PubSubConnection_processNetworkMessage(psm, c, &nm, true);
     UA_NetworkMessage_clear(&nm);
+    return processed;
+}
 
- finish:
-    if(!processed) {
-        UA_DateTime nowM = UA_DateTime_nowMonotonic();
-        if(c->silenceErrorUntil < nowM) {
-            UA_LOG_WARNING_PUBSUB(psm->logging, c,
-                                  "Message received that could not be processed. "
-                                  "Check PublisherID, WriterGroupID and DatasetWriterID.");
-            c->silenceErrorUntil = nowM + (UA_DateTime)(10.0 * UA_DATETIME_SEC);
+static void
+UA_PubSubConnection_process(UA_PubSubManager *psm, UA_PubSubConnection *c,
+                            const UA_ByteString msg) {
+    UA_LOG_TRACE_PUBSUB(psm->logging, c, "Processing a received buffer");
+
+    /* Process the ReaderGroups with a fixed layout first. Decode the message
+     * only if it is needed for the other ReaderGroups. */
+    UA_Boolean processed = false;
+    if(UA_PubSubConnection_processFixedLayout(psm, c, &msg, &processed))
+        processed |= UA_PubSubConnection_decodeAndProcess(psm, c, msg);
+    if(!processed)
+        UA_PubSubConnection_warnNotProcessed(psm, c);
+}
+
+/* Process several received UADP messages at once. The headers of all messages
+ * are decoded first. Then the messages are verified and decrypted with a single
+ * call into the SecurityPolicy of each ReaderGroup. */
+#define UA_PUBSUB_RECV_BATCHSIZE 16
+
+static void
+UA_PubSubConnection_processBatch(UA_PubSubManager *psm, UA_PubSubConnection *c,
+                                 size_t packetsSize, UA_ByteString *packets) {
+    UA_ReaderGroup *rg = LIST_FIRST(&c->readerGroups);
+    if(!rg || rg->config.encodingMimeType != UA_PUBSUB_ENCODING_UADP) {
+        for(size_t i = 0; i < packetsSize; i++)
+            UA_PubSubConnection_process(psm, c, packets[i]);
+        return;
+    }
+
+    Ctx ctx[UA_PUBSUB_RECV_BATCHSIZE];
+    UA_NetworkMessage nm[UA_PUBSUB_RECV_BATCHSIZE];
+    UA_ReaderGroup *rgs[UA_PUBSUB_RECV_BATCHSIZE];
+    UA_StatusCode res[UA_PUBSUB_RECV_BATCHSIZE];
+
+    /* Messages of the batch that belong to the same ReaderGroup */
+    UA_ByteString rgBuffers[UA_PUBSUB_RECV_BATCHSIZE];
+    Ctx *rgCtx[UA_PUBSUB_RECV_BATCHSIZE];
+    UA_NetworkMessage *rgNm[UA_PUBSUB_RECV_BATCHSIZE];
+    UA_StatusCode rgRes[UA_PUBSUB_RECV_BATCHSIZE];
+    size_t rgIndex[UA_PUBSUB_RECV_BATCHSIZE];
+
+    for(size_t offset = 0; offset < packetsSize; offset += UA_PUBSUB_RECV_BATCHSIZE) {
+        size_t batchSize = packetsSize - offset;
+        if(batchSize > UA_PUBSUB_RECV_BATCHSIZE)
+            batchSize = UA_PUBSUB_RECV_BATCHSIZE;
+
+        /* Decode the headers */
+        memset(nm, 0, sizeof(UA_NetworkMessage) * batchSize);
+        for(size_t i = 0; i < batchSize; i++) {
+            rgs[i] = NULL;
+            UA_Boolean processed = false;
+            if(!UA_PubSubConnection_processFixedLayout(psm, c, &packets[offset + i],
+                                                       &processed)) {
+                if(!processed)
+                    UA_PubSubConnection_warnNotProcessed(psm, c);
+                res[i] = UA_STATUSCODE_BADNOTHINGTODO; /* Already processed */
+                continue;
+            }
+            if(processed) {
+                /* Some ReaderGroups processed the message with their fixed
+                 * layout. Decode it right away for the others. The markers of
+                 * the ReaderGroups are only valid for the current message. */
+                UA_PubSubConnection_decodeAndProcess(psm, c, packets[offset + i]);
+                res[i] = UA_STATUSCODE_BADNOTHINGTODO;
+                continue;
+            }
+            res[i] = decodeNetworkMessageHeaders(psm, c, packets[offset + i],
+                                                 &ctx[i], &nm[i], &rgs[i]);
+        }
+
+        /* Verify and decrypt grouped by the ReaderGroup */
+        for(size_t i = 0; i < batchSize; i++) {
+            if(res[i] != UA_STATUSCODE_GOOD || !rgs[i])
+                continue;
+            UA_ReaderGroup *current = rgs[i];
+            size_t rgSize = 0;
+            for(size_t j = i; j < batchSize; j++) {
+                if(res[j] != UA_STATUSCODE_GOOD || rgs[j] != current)
+                    continue;
+                rgBuffers[rgSize] = packets[offset + j];
+                rgCtx[rgSize] = &ctx[j];
+                rgNm[rgSize] = &nm[j];
+                rgIndex[rgSize] = j;
+                rgs[j] = NULL; /* Mark as done */
+                rgSize++;
+            }
+            verifyAndDecryptNetworkMessages(psm->logging, current, rgSize,
+                                            rgBuffers, rgCtx, rgNm, rgRes);
+            for(size_t j = 0; j < rgSize; j++)
+                res[rgIndex[j]] = rgRes[j];
+        }
+
+        /* Decode the payload and process */
+        for(size_t i = 0; i < batchSize; i++) {
+            if(res[i] == UA_STATUSCODE_GOOD)
+                res[i] = decodeNetworkMessagePayload(&ctx[i], &nm[i]);
+            if(res[i] == UA_STATUSCODE_GOOD &&
+               !UA_PubSubConnection_processNetworkMessage(psm, c, &nm[i], false))
+                UA_PubSubConnection_warnNotProcessed(psm, c);
+            UA_NetworkMessage_clear(&nm[i]);
         }
     }
 }
@@ -969,6 +1101,32 @@ UA_Server_processPubSubConnectionReceive(UA_Server *server,
     return res;
 }
 
+UA_StatusCode
+UA_Server_processPubSubConnectionReceiveBatch(UA_Server *server,
+                                              const UA_NodeId connectionId,
+                                              size_t packetsSize,
+                                              UA_ByteString *packets) {
+    if(!server || (packetsSize > 0 && !packets))
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    lockServer(server);
+    UA_StatusCode res = UA_STATUSCODE_BADINTERNALERROR;
+    UA_PubSubManager *psm = getPSM(server);
+    if(psm) {
+        UA_PubSubConnection *c = UA_PubSubConnection_find(psm, connectionId);
+        if(c) {
+            res = UA_STATUSCODE_GOOD;
+            UA_PubSubConnection_processBatch(psm, c, packetsSize, packets);
+        } else {
+            res = UA_STATUSCODE_BADCONNECTIONCLOSED;
+            UA_LOG_WARNING_PUBSUB(psm->logging, c,
+                                  "Cannot process a packet if the "
+                                  "PubSubConnection is not operational");
+        }
+    }
+    unlockServer(server);
+    return res;
+}
+
 UA_StatusCode
 UA_Server_updatePubSubConnectionConfig(UA_Server *server,
                                        const UA_NodeId connectionId,
@@ -474,6 +474,55 @@ UA_PubSubDataSetField_sampleValue(UA_PubSubManager *psm, UA_DataSetField *field,
                              &rvid, UA_TIMESTAMPSTORETURN_BOTH);
 }
 
+UA_Boolean
+UA_PubSubDataSetField_sampleValueInPlace(UA_PubSubManager *psm,
+                                         UA_DataSetField *field,
+                                         UA_DataValue *value) {
+    UA_Server *server = psm->sc.server;
+    UA_PublishedVariableDataType *params = &field->config.field.variable.publishParameters;
+    if(params->attributeId != UA_ATTRIBUTEID_VALUE || params->indexRange.length > 0) {
+        UA_PubSubDataSetField_sampleValue(psm, field, value);
+        return true;
+    }
+
+    const UA_Node *node = UA_NODESTORE_GET(server, &params->publishedVariable);
+    if(!node) {
+        UA_PubSubDataSetField_sampleValue(psm, field, value);
+        return true;
+    }
+
+    UA_Boolean done = false;
+    const UA_ValueBackend *vb = &node->variableNode.valueBackend;
+    if(node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+       vb->backendType == UA_VALUEBACKENDTYPE_EXTERNAL &&
+       vb->backend.external.value && *vb->backend.external.value) {
+        UA_StatusCode res = UA_STATUSCODE_GOOD;
+        if(vb->backend.external.callback.notificationRead)
+            res = vb->backend.external.callback.
+                notificationRead(server, &server->adminSession.sessionId,
+                                 server->adminSession.context,
+                                 &node->head.nodeId, node->head.context, NULL);
+        if(res == UA_STATUSCODE_GOOD) {
+            /* Same timestamps as for the Read-Service */
+            UA_EventLoop *el = server->config.eventLoop;
+            *value = **vb->backend.external.value;
+            if(!value->hasSourceTimestamp) {
+                value->sourceTimestamp = el->dateTime_now(el);
+                value->hasSourceTimestamp = true;
+            }
+            value->serverTimestamp = el->dateTime_now(el);
+            value->hasServerTimestamp = true;
+            value->hasServerPicoseconds = false;
+            done = true;
+        }
+    }
+    UA_NODESTORE_RELEASE(server, node);
+
+    if(!done)
+        UA_PubSubDataSetField_sampleValue(psm, field, value);
+    return !done;
+}
+
 UA_AddPublishedDataSetResult
 UA_PublishedDataSet_create(UA_PubSubManager *psm,
                            const UA_PublishedDataSetConfig *publishedDataSetConfig,
@@ -320,6 +320,12 @@ UA_StatusCode
 UA_DataSetWriter_setPubSubState(UA_PubSubManager *psm, UA_DataSetWriter *dsw,
                                 UA_PubSubState targetState);
 
+/* Remove the DataValue content that is deactivated in the
+ * DataSetFieldContentMask of the writer */
+void
+UA_DataSetWriter_applyFieldContentMask(const UA_DataSetWriter *dsw,
+                                       UA_DataValue *dfv);
+
 UA_StatusCode
 UA_DataSetWriter_generateDataSetMessage(UA_PubSubManager *psm,
                                         UA_DataSetWriter *dsw,
@@ -338,6 +344,25 @@ UA_DataSetWriter_remove(UA_PubSubManager *psm, UA_DataSetWriter *dsw);
 /*               WriterGroup                  */
 /**********************************************/
 
+/* Content of the fixed-layout NetworkMessage that changes between publish
+ * cycles. The DataSetMessage entries mark the beginning of the
+ * DataSetMessages. */
+typedef struct {
+    UA_PubSubOffsetType offsetType;
+    size_t offset;                 /* Offset in the NetworkMessage */
+    UA_DataSetWriter *writer;      /* For the DataSetMessage entries */
+    struct UA_DataSetField *field; /* For the DataSetField entries */
+    UA_Byte dataValueMask;         /* Encoding mask for DataValue fields */
+    const UA_DataType *type;       /* Fixed-size (pointerFree) scalar type */
+} UA_FixedLayoutPatch;
+
+/* Encoded NetworkMessage of a WriterGroup that is patched in place */
+typedef struct {
+    UA_ByteString networkMessage;
+    size_t patchesSize;
+    UA_FixedLayoutPatch *patches;
+} UA_WriterGroupFixedLayout;
+
 struct UA_WriterGroup {
     UA_PubSubComponentHead head;
     LIST_ENTRY(UA_WriterGroup) listEntry;
@@ -351,6 +376,11 @@ struct UA_WriterGroup {
     UA_UInt16 sequenceNumber; /* Increased after every sent message */
     UA_DateTime lastPublishTimeStamp;
 
+    /* Computed on demand if config.fixedLayout is set. Reset whenever the
+     * writers change. NULL if the layout is not fixed. */
+    UA_Boolean fixedLayoutComputed;
+    UA_WriterGroupFixedLayout *fixedLayout;
+
     /* The ConnectionManager pointer is stored in the Connection. The channels
      * are either stored here or in the Connection, but never both. */
     UA_PubSubConnection *linkedConnection;
@@ -401,6 +431,11 @@ UA_WriterGroup_setPubSubState(UA_PubSubManager *psm, UA_WriterGroup *wg,
 void
 UA_WriterGroup_publishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg);
 
+/* Discard the encoded fixed-layout NetworkMessage. Call when the configuration
+ * of the WriterGroup or its writers changes. */
+void
+UA_WriterGroup_resetFixedLayout(UA_WriterGroup *wg);
+
 /**********************************************/
 /*               DataSetField                 */
 /**********************************************/
@@ -435,10 +470,26 @@ UA_PubSubDataSetField_sampleValue(UA_PubSubManager *psm,
                                   UA_DataSetField *field,
                                   UA_DataValue *value);
 
+/* Variables with an external value backend are read in place and the value is
+ * a shallow copy. Otherwise the value is sampled via the Read-Service. Returns
+ * true if the value has to be cleared afterwards. */
+UA_Boolean
+UA_PubSubDataSetField_sampleValueInPlace(UA_PubSubManager *psm,
+                                         UA_DataSetField *field,
+                                         UA_DataValue *value);
+
 /**********************************************/
 /*               DataSetReader                */
 /**********************************************/
 
+/* Key of the DataSetReader index in the ReaderGroup. The PublisherId points
+ * into the reader config (or into the NetworkMessage for a lookup). */
+typedef struct {
+    const UA_PublisherId *publisherId;
+    UA_UInt16 writerGroupId;
+    UA_UInt16 dataSetWriterId;
+} UA_DataSetReaderKey;
+
 struct UA_DataSetReader {
     UA_PubSubComponentHead head;
     LIST_ENTRY(UA_DataSetReader) listEntry;
@@ -446,6 +497,12 @@ struct UA_DataSetReader {
     UA_DataSetReaderConfig config;
     UA_ReaderGroup *linkedReaderGroup;
 
+    /* Index of the ReaderGroup. Readers with an identical key are chained
+     * behind the reader that is contained in the tree. */
+    UA_DataSetReaderKey indexKey;
+    ZIP_ENTRY(UA_DataSetReader) indexEntry;
+    UA_DataSetReader *indexNext;
+
     /* MessageReceiveTimeout handling */
     UA_UInt64 msgRcvTimeoutTimerId;
 };
@@ -459,6 +516,24 @@ UA_DataSetReader_process(UA_PubSubManager *psm,
                          UA_DataSetReader *dataSetReader,
                          UA_DataSetMessage *dataSetMsg);
 
+/* Field of a DataSetReader at a fixed position in the received message */
+typedef struct {
+    size_t fieldIndex;              /* Index in the TargetVariables */
+    UA_PubSubOffsetType offsetType; /* DATASETFIELD_RAW/_VARIANT/_DATAVALUE */
+    size_t offset;                  /* Offset in the NetworkMessage */
+    UA_Byte dataValueMask;          /* Encoding mask for DataValue fields */
+    const UA_DataType *type;        /* Fixed-size (pointerFree) scalar type */
+} UA_FixedLayoutField;
+
+/* Process the fields of a received message that matches the fixed layout of
+ * the ReaderGroup. The values are decoded from the buffer without allocations
+ * and written to the TargetVariables. */
+void
+UA_DataSetReader_processFixedLayout(UA_PubSubManager *psm, UA_DataSetReader *dsr,
+                                    const UA_ByteString *buffer,
+                                    const UA_FixedLayoutField *fields,
+                                    size_t fieldsSize);
+
 UA_StatusCode
 UA_DataSetReader_checkIdentifier(UA_PubSubManager *psm, UA_DataSetReader *dsr,
                                  UA_NetworkMessage *msg);
@@ -484,6 +559,33 @@ UA_DataSetReader_setPubSubState(UA_PubSubManager *psm, UA_DataSetReader *dsr,
 /*                ReaderGroup                 */
 /**********************************************/
 
+typedef ZIP_HEAD(UA_DataSetReaderIndex, UA_DataSetReader) UA_DataSetReaderIndex;
+
+typedef struct {
+    size_t offset;
+    size_t length;
+} UA_FixedLayoutRange;
+
+typedef struct {
+    UA_DataSetReader *reader;
+    size_t fieldsSize;
+    UA_FixedLayoutField *fields;
+} UA_FixedLayoutReader;
+
+/* Precomputed template of a fixed-size NetworkMessage for a ReaderGroup */
+typedef struct {
+    UA_ByteString networkMessage; /* Encoded template */
+
+    /* Byte ranges that must be identical to the template. The remaining bytes
+     * are sequence numbers, timestamps and the field values. */
+    size_t staticRangesSize;
+    UA_FixedLayoutRange *staticRanges;
+
+    /* The DataSetMessages in the order of the readers */
+    size_t readersSize;
+    UA_FixedLayoutReader *readers;
+} UA_ReaderGroupFixedLayout;
+
 struct UA_ReaderGroup {
     UA_PubSubComponentHead head;
     LIST_ENTRY(UA_ReaderGroup) listEntry;
@@ -493,6 +595,19 @@ struct UA_ReaderGroup {
     LIST_HEAD(, UA_DataSetReader) readers;
     UA_UInt32 readersCount;
 
+    /* Readers indexed by (PublisherId, WriterGroupId, DataSetWriterId) to
+     * route the received DataSetMessages without scanning all readers */
+    UA_DataSetReaderIndex readerIndex;
+
+    /* Computed on demand if config.fixedLayout is set. Reset whenever the
+     * readers change. NULL if the layout is not fixed. */
+    UA_Boolean fixedLayoutComputed;
+    UA_ReaderGroupFixedLayout *fixedLayout;
+
+    /* The current received message was processed with the fixed layout. Then
+     * the ReaderGroup is skipped when the decoded message is forwarded. */
+    UA_Boolean fixedLayoutProcessed;
+
     UA_Boolean hasReceived; /* Received a message since the last _connect */
 
     /* The ConnectionManager pointer is stored in the Connection. The channels 
@@ -550,6 +665,36 @@ UA_Boolean
 UA_ReaderGroup_process(UA_PubSubManager *psm, UA_ReaderGroup *rg,
                        UA_NetworkMessage *nm);
 
+/* Add/remove the reader to/from the index. Call when the identifiers in the
+ * reader config change. */
+void
+UA_ReaderGroup_indexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr);
+
+void
+UA_ReaderGroup_unindexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr);
+
+/* Discard the precomputed fixed layout. Call when the configuration of the
+ * ReaderGroup or its readers changes. */
+void
+UA_ReaderGroup_resetFixedLayout(UA_ReaderGroup *rg);
+
+/* Size of the encoded field content that changes between messages with a
+ * fixed layout. Returns 0 if the type is not supported. */
+size_t
+UA_FixedLayout_fieldSize(const UA_DataType *type, UA_PubSubOffsetType offsetType);
+
+/* Process a received buffer on the fixed-layout path. Returns false if the
+ * ReaderGroup has no fixed layout or the message does not match. */
+UA_Boolean
+UA_ReaderGroup_processFixedLayout(UA_PubSubManager *psm, UA_ReaderGroup *rg,
+                                  const UA_ByteString *buffer);
+
+/* Returns true if at least one DataSetReader of the ReaderGroup matches the
+ * identifiers of the NetworkMessage (regardless of the reader state) */
+UA_Boolean
+UA_ReaderGroup_hasMatchingReader(UA_PubSubManager *psm, UA_ReaderGroup *rg,
+                                 UA_NetworkMessage *nm);
+
 /* The buffer is the entire message. The ctx->pos points after the decoded
  * header. The ctx->end is modified to remove padding, etc. */
 UA_StatusCode
@@ -557,6 +702,15 @@ verifyAndDecryptNetworkMessage(const UA_Logger *logger, UA_ByteString buffer,
                                Ctx *ctx, UA_NetworkMessage *nm,
                                UA_ReaderGroup *rg);
 
+/* Verify and decrypt several messages for the same ReaderGroup with a single
+ * call into the SecurityPolicy. The result for each message is written to the
+ * results array. */
+void
+verifyAndDecryptNetworkMessages(const UA_Logger *logger, UA_ReaderGroup *rg,
+                                size_t messagesSize, const UA_ByteString *buffers,
+                                Ctx **ctxs, UA_NetworkMessage **nms,
+                                UA_StatusCode *results);
+
 #ifdef UA_ENABLE_PUBSUB_SKS
 
 /*********************************************************/
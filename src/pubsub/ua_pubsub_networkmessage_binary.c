@@ -1390,6 +1390,10 @@ UA_DataSetMessage_deltaFrame_decodeBinary(Ctx *ctx, UA_DataSetMessage* dst) {
     UA_StatusCode rv = DECODE_BINARY(&dfd->fieldCount, UINT16);
     UA_CHECK_STATUS(rv, return rv);
 
+    /* No field has changed */
+    if(dfd->fieldCount == 0)
+        return UA_STATUSCODE_GOOD;
+
     dfd->deltaFrameFields = (UA_DataSetMessage_DeltaFrameField *)
         ctxCalloc(ctx, dfd->fieldCount, sizeof(UA_DataSetMessage_DeltaFrameField));
     if(!dst->data.deltaFrameData.deltaFrameFields) {
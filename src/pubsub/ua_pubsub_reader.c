@@ -253,8 +253,8 @@ UA_DataSetReader_create(UA_PubSubManager *psm, UA_NodeId readerGroupIdentifier,
 
     /* Add the new reader to the group. Add to the end of the linked list to
      * ensure the order for the realtime offsets is as expected. The received
-     * DataSetMessages are matched via UA_DataSetReader_checkIdentifier for the
-     * non-RT path. */
+     * DataSetMessages are matched via the reader index of the ReaderGroup (or
+     * UA_DataSetReader_checkIdentifier as a fallback) for the non-RT path. */
     UA_DataSetReader *after = LIST_FIRST(&rg->readers);
     if(!after) {
         LIST_INSERT_HEAD(&rg->readers, dsr, listEntry);
@@ -272,6 +272,8 @@ UA_DataSetReader_create(UA_PubSubManager *psm, UA_NodeId readerGroupIdentifier,
         UA_DataSetReader_remove(psm, dsr);
         return retVal;
     }
+    UA_ReaderGroup_indexReader(rg, dsr);
+    UA_ReaderGroup_resetFixedLayout(rg);
 
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
     retVal = addDataSetReaderRepresentation(psm->sc.server, dsr);
@@ -372,6 +374,8 @@ UA_DataSetReader_remove(UA_PubSubManager *psm, UA_DataSetReader *dsr) {
         sds->connectedReader = NULL;
 
     /* Remove DataSetReader from group */
+    UA_ReaderGroup_unindexReader(rg, dsr);
+    UA_ReaderGroup_resetFixedLayout(rg);
     LIST_REMOVE(dsr, listEntry);
     rg->readersCount--;
 
@@ -523,6 +527,7 @@ DataSetReader_createTargetVariables(UA_PubSubManager *psm, UA_DataSetReader *dsr
 
     UA_TargetVariablesDataType_clear(&dsr->config.subscribedDataSet.target);
     dsr->config.subscribedDataSet.target = newVars;
+    UA_ReaderGroup_resetFixedLayout(dsr->linkedReaderGroup);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -648,16 +653,10 @@ UA_DataSetReader_handleMessageReceiveTimeout(UA_PubSubManager *psm,
     unlockServer(psm->sc.server);
 }
 
-void
-UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
-                         UA_DataSetMessage *msg) {
-    if(!dsr || !msg || !psm)
-        return;
-
-    UA_LOG_DEBUG_PUBSUB(psm->logging, dsr, "Received a network message");
-
-    /* Received a (first) message for the Reader.
-     * Transition from PreOperational to Operational. */
+/* Received a (first) message for the Reader. Transition from PreOperational to
+ * Operational. Returns false if the reader is not operational. */
+static UA_Boolean
+UA_DataSetReader_checkReceiveState(UA_PubSubManager *psm, UA_DataSetReader *dsr) {
     if(dsr->head.state == UA_PUBSUBSTATE_PREOPERATIONAL)
         UA_DataSetReader_setPubSubState(psm, dsr, dsr->head.state, UA_STATUSCODE_GOOD);
 
@@ -665,8 +664,76 @@ UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
        dsr->head.state != UA_PUBSUBSTATE_PREOPERATIONAL) {
         UA_LOG_WARNING_PUBSUB(psm->logging, dsr,
                               "Received a network message but not operational");
+        return false;
+    }
+    return true;
+}
+
+/* Configure / Update the timeout callback */
+static void
+UA_DataSetReader_updateReceiveTimeout(UA_PubSubManager *psm, UA_DataSetReader *dsr) {
+    if(dsr->config.messageReceiveTimeout <= 0.0)
         return;
+    UA_EventLoop *el = psm->sc.server->config.eventLoop;
+    if(dsr->msgRcvTimeoutTimerId == 0) {
+        el->addTimer(el, (UA_Callback)UA_DataSetReader_handleMessageReceiveTimeout,
+                     psm, dsr, dsr->config.messageReceiveTimeout, NULL,
+                     UA_TIMERPOLICY_CURRENTTIME, &dsr->msgRcvTimeoutTimerId);
+    } else {
+        /* Reset the next execution time to now + interval */
+        el->modifyTimer(el, dsr->msgRcvTimeoutTimerId,
+                        dsr->config.messageReceiveTimeout, NULL,
+                        UA_TIMERPOLICY_CURRENTTIME);
     }
+}
+
+/* Only the changed fields are contained in a DeltaFrame. They are identified
+ * by their index in the DataSetMetaData. */
+static void
+DataSetReader_processDeltaFrame(UA_PubSubManager *psm, UA_DataSetReader *dsr,
+                                UA_DataSetMessage *msg) {
+    UA_TargetVariablesDataType *tvs = &dsr->config.subscribedDataSet.target;
+    UA_DataSetMessage_DataDeltaFrameData *dfd = &msg->data.deltaFrameData;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < dfd->fieldCount; i++) {
+        UA_DataSetMessage_DeltaFrameField *dff = &dfd->deltaFrameFields[i];
+        if(dff->fieldIndex >= tvs->targetVariablesSize) {
+            UA_LOG_WARNING_PUBSUB(psm->logging, dsr,
+                                  "DeltaFrame field index %u does not match the "
+                                  "TargetVariables configuration",
+                                  (unsigned)dff->fieldIndex);
+            return;
+        }
+        if(!dff->fieldValue.hasValue)
+            continue;
+
+        /* Write via the Write-Service */
+        UA_FieldTargetDataType *tv = &tvs->targetVariables[dff->fieldIndex];
+        UA_WriteValue writeVal;
+        UA_WriteValue_init(&writeVal);
+        writeVal.attributeId = tv->attributeId;
+        writeVal.indexRange = tv->receiverIndexRange;
+        writeVal.nodeId = tv->targetNodeId;
+        writeVal.value = dff->fieldValue;
+        Operation_Write(psm->sc.server, &psm->sc.server->adminSession,
+                        NULL, &writeVal, &res);
+        if(res != UA_STATUSCODE_GOOD)
+            UA_LOG_INFO_PUBSUB(psm->logging, dsr,
+                               "Error writing DeltaFrame field %u: %s",
+                               (unsigned)dff->fieldIndex, UA_StatusCode_name(res));
+    }
+}
+
+void
+UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
+                         UA_DataSetMessage *msg) {
+    if(!dsr || !msg || !psm)
+        return;
+
+    UA_LOG_DEBUG_PUBSUB(psm->logging, dsr, "Received a network message");
+
+    if(!UA_DataSetReader_checkReceiveState(psm, dsr))
+        return;
 
     if(!msg->header.dataSetMessageValid) {
         UA_LOG_INFO_PUBSUB(psm->logging, dsr,
@@ -685,25 +752,20 @@ UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
      *     }
      * } */
 
-    if(msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME) {
+    if(msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATAKEYFRAME &&
+       msg->header.dataSetMessageType != UA_DATASETMESSAGE_DATADELTAFRAME) {
         UA_LOG_WARNING_PUBSUB(psm->logging, dsr,
-                              "DataSetMessage is discarded: Only keyframes are supported");
+                              "DataSetMessage is discarded: Only keyframes "
+                              "and deltaframes are supported");
         return;
     }
 
-    /* Configure / Update the timeout callback */
-    if(dsr->config.messageReceiveTimeout > 0.0) {
-        UA_EventLoop *el = psm->sc.server->config.eventLoop;
-        if(dsr->msgRcvTimeoutTimerId == 0) {
-            el->addTimer(el, (UA_Callback)UA_DataSetReader_handleMessageReceiveTimeout,
-                         psm, dsr, dsr->config.messageReceiveTimeout, NULL,
-                         UA_TIMERPOLICY_CURRENTTIME, &dsr->msgRcvTimeoutTimerId);
-        } else {
-            /* Reset the next execution time to now + interval */
-            el->modifyTimer(el, dsr->msgRcvTimeoutTimerId,
-                            dsr->config.messageReceiveTimeout, NULL,
-                            UA_TIMERPOLICY_CURRENTTIME);
-        }
+    UA_DataSetReader_updateReceiveTimeout(psm, dsr);
+
+    /* Process the changed fields of a DeltaFrame */
+    if(msg->header.dataSetMessageType == UA_DATASETMESSAGE_DATADELTAFRAME) {
+        DataSetReader_processDeltaFrame(psm, dsr, msg);
+        return;
     }
 
     /* Process message with raw encoding. We have no field-count information for
@@ -758,6 +820,125 @@ UA_DataSetReader_process(UA_PubSubManager *psm, UA_DataSetReader *dsr,
     }
 }
 
+/* Write the value directly into an external value backend if the type
+ * matches. Otherwise the value is written via the Write-Service. */
+static UA_Boolean
+writeExternalInPlace(UA_Server *server, const UA_FieldTargetDataType *tv,
+                     const UA_DataValue *dv) {
+    if(tv->attributeId != UA_ATTRIBUTEID_VALUE || tv->receiverIndexRange.length > 0)
+        return false;
+    const UA_Node *node = UA_NODESTORE_GET(server, &tv->targetNodeId);
+    if(!node)
+        return false;
+    UA_Boolean done = false;
+    const UA_ValueBackend *vb = &node->variableNode.valueBackend;
+    if(node->head.nodeClass == UA_NODECLASS_VARIABLE &&
+       vb->backendType == UA_VALUEBACKENDTYPE_EXTERNAL &&
+       !vb->backend.external.callback.userWrite &&
+       vb->backend.external.value && *vb->backend.external.value) {
+        UA_DataValue *target = *vb->backend.external.value;
+        if(target->hasValue && target->value.type == dv->value.type &&
+           UA_Variant_isScalar(&target->value) && target->value.data) {
+            memcpy(target->value.data, dv->value.data, dv->value.type->memSize);
+            target->hasStatus = dv->hasStatus;
+            target->status = dv->status;
+            target->hasSourceTimestamp = dv->hasSourceTimestamp;
+            target->sourceTimestamp = dv->sourceTimestamp;
+            target->hasSourcePicoseconds = dv->hasSourcePicoseconds;
+            target->sourcePicoseconds = dv->sourcePicoseconds;
+            done = true;
+        }
+    }
+    UA_NODESTORE_RELEASE(server, node);
+    return done;
+}
+
+void
+UA_DataSetReader_processFixedLayout(UA_PubSubManager *psm, UA_DataSetReader *dsr,
+                                    const UA_ByteString *buffer,
+                                    const UA_FixedLayoutField *fields,
+                                    size_t fieldsSize) {
+    if(!UA_DataSetReader_checkReceiveState(psm, dsr))
+        return;
+
+    UA_DataSetReader_updateReceiveTimeout(psm, dsr);
+
+    UA_Server *server = psm->sc.server;
+    UA_TargetVariablesDataType *tvs = &dsr->config.subscribedDataSet.target;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < fieldsSize; i++) {
+        const UA_FixedLayoutField *f = &fields[i];
+        UA_FieldTargetDataType *tv = &tvs->targetVariables[f->fieldIndex];
+
+        /* Decode into stack memory. The types are pointerFree. */
+        UA_STACKARRAY(UA_Byte, value, f->type->memSize);
+        memset(value, 0, f->type->memSize);
+        UA_DataValue dv;
+        UA_DataValue_init(&dv);
+        UA_Variant_setScalar(&dv.value, value, f->type);
+        dv.hasValue = true;
+
+        size_t offset = f->offset;
+        if(f->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT)
+            offset += 1; /* Skip the variant encoding byte */
+        else if(f->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE)
+            offset += 2; /* Skip the DataValue and variant encoding bytes */
+        res = UA_decodeBinaryInternal(buffer, &offset, value, f->type, NULL);
+
+        if(f->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE) {
+            UA_Byte mask = f->dataValueMask;
+            if(mask & 0x02u) {
+                dv.hasStatus = true;
+                res |= UA_decodeBinaryInternal(buffer, &offset, &dv.status,
+                                               &UA_TYPES[UA_TYPES_STATUSCODE], NULL);
+            }
+            if(mask & 0x04u) {
+                dv.hasSourceTimestamp = true;
+                res |= UA_decodeBinaryInternal(buffer, &offset, &dv.sourceTimestamp,
+                                               &UA_TYPES[UA_TYPES_DATETIME], NULL);
+            }
+            if(mask & 0x10u) {
+                dv.hasSourcePicoseconds = true;
+                res |= UA_decodeBinaryInternal(buffer, &offset, &dv.sourcePicoseconds,
+                                               &UA_TYPES[UA_TYPES_UINT16], NULL);
+            }
+            if(mask & 0x08u) {
+                dv.hasServerTimestamp = true;
+                res |= UA_decodeBinaryInternal(buffer, &offset, &dv.serverTimestamp,
+                                               &UA_TYPES[UA_TYPES_DATETIME], NULL);
+            }
+            if(mask & 0x20u) {
+                dv.hasServerPicoseconds = true;
+                res |= UA_decodeBinaryInternal(buffer, &offset, &dv.serverPicoseconds,
+                                               &UA_TYPES[UA_TYPES_UINT16], NULL);
+            }
+        }
+
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_INFO_PUBSUB(psm->logging, dsr,
+                               "Error decoding KeyFrame field %u: %s",
+                               (unsigned)f->fieldIndex, UA_StatusCode_name(res));
+            continue;
+        }
+
+        if(writeExternalInPlace(server, tv, &dv))
+            continue;
+
+        /* Write via the Write-Service */
+        UA_WriteValue writeVal;
+        UA_WriteValue_init(&writeVal);
+        writeVal.attributeId = tv->attributeId;
+        writeVal.indexRange = tv->receiverIndexRange;
+        writeVal.nodeId = tv->targetNodeId;
+        writeVal.value = dv;
+        Operation_Write(server, &server->adminSession, NULL, &writeVal, &res);
+        if(res != UA_STATUSCODE_GOOD)
+            UA_LOG_INFO_PUBSUB(psm->logging, dsr,
+                               "Error writing KeyFrame field %u: %s",
+                               (unsigned)f->fieldIndex, UA_StatusCode_name(res));
+    }
+}
+
 /**************/
 /* Server API */
 /**************/
@@ -892,10 +1073,15 @@ UA_Server_updateDataSetReaderConfig(UA_Server *server, const UA_NodeId dsrId,
     /* Store the old config */
     UA_DataSetReaderConfig oldConfig = dsr->config;
 
+    /* The index key points into the config. Re-index after the update. */
+    UA_ReaderGroup_unindexReader(dsr->linkedReaderGroup, dsr);
+    UA_ReaderGroup_resetFixedLayout(dsr->linkedReaderGroup);
+
     /* Copy the config into the new dataSetReader */
     UA_StatusCode retVal = UA_DataSetReaderConfig_copy(config, &dsr->config);
     if(retVal != UA_STATUSCODE_GOOD)
         goto errout;
+    UA_ReaderGroup_indexReader(dsr->linkedReaderGroup, dsr);
 
     /* Change the connection to a StandaloneSubscribedDataSet */
     if(!UA_String_equal(&dsr->config.linkedStandaloneSubscribedDataSetName,
@@ -923,8 +1109,10 @@ UA_Server_updateDataSetReaderConfig(UA_Server *server, const UA_NodeId dsrId,
 
     /* Fall back to the old config */
  errout:
+    UA_ReaderGroup_unindexReader(dsr->linkedReaderGroup, dsr);
     UA_DataSetReaderConfig_clear(&dsr->config);
     dsr->config = oldConfig;
+    UA_ReaderGroup_indexReader(dsr->linkedReaderGroup, dsr);
     unlockServer(server);
     return retVal;
 }
@@ -248,6 +248,7 @@ UA_ReaderGroup_remove(UA_PubSubManager *psm, UA_ReaderGroup *rg) {
 
         UA_LOG_INFO_PUBSUB(psm->logging, rg, "ReaderGroup deleted");
 
+        UA_ReaderGroup_resetFixedLayout(rg);
         UA_ReaderGroupConfig_clear(&rg->config);
         UA_PubSubComponentHead_clear(&rg->head);
         UA_free(rg);
@@ -300,6 +301,7 @@ UA_ReaderGroup_setPubSubState(UA_PubSubManager *psm, UA_ReaderGroup *rg,
     case UA_PUBSUBSTATE_ERROR:
         rg->head.state = targetState;
         UA_ReaderGroup_disconnect(rg);
+        UA_ReaderGroup_resetFixedLayout(rg);
         rg->hasReceived = false;
         break;
 
@@ -418,6 +420,159 @@ UA_ReaderGroup_setEncryptionKeys(UA_PubSubManager *psm, UA_ReaderGroup *rg,
                         &encryptingKey, &keyNonce);
 }
 
+/***********************/
+/* DataSetReader Index */
+/***********************/
+
+static enum ZIP_CMP
+cmpPublisherId(const UA_PublisherId *a, const UA_PublisherId *b) {
+    if(a->idType != b->idType)
+        return (a->idType < b->idType) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    UA_UInt64 aa, bb;
+    switch(a->idType) {
+    case UA_PUBLISHERIDTYPE_BYTE:   aa = a->id.byte;   bb = b->id.byte;   break;
+    case UA_PUBLISHERIDTYPE_UINT16: aa = a->id.uint16; bb = b->id.uint16; break;
+    case UA_PUBLISHERIDTYPE_UINT32: aa = a->id.uint32; bb = b->id.uint32; break;
+    case UA_PUBLISHERIDTYPE_UINT64: aa = a->id.uint64; bb = b->id.uint64; break;
+    case UA_PUBLISHERIDTYPE_STRING:
+        return (enum ZIP_CMP)UA_order(&a->id.string, &b->id.string,
+                                      &UA_TYPES[UA_TYPES_STRING]);
+    default: return ZIP_CMP_EQ;
+    }
+    if(aa == bb)
+        return ZIP_CMP_EQ;
+    return (aa < bb) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+static enum ZIP_CMP
+cmpDataSetReaderKey(const void *a, const void *b) {
+    const UA_DataSetReaderKey *aa = (const UA_DataSetReaderKey*)a;
+    const UA_DataSetReaderKey *bb = (const UA_DataSetReaderKey*)b;
+    if(aa->dataSetWriterId != bb->dataSetWriterId)
+        return (aa->dataSetWriterId < bb->dataSetWriterId) ?
+            ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(aa->writerGroupId != bb->writerGroupId)
+        return (aa->writerGroupId < bb->writerGroupId) ?
+            ZIP_CMP_LESS : ZIP_CMP_MORE;
+    return cmpPublisherId(aa->publisherId, bb->publisherId);
+}
+
+ZIP_FUNCTIONS(UA_DataSetReaderIndex, UA_DataSetReader, indexEntry,
+              UA_DataSetReaderKey, indexKey, cmpDataSetReaderKey)
+
+void
+UA_ReaderGroup_indexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr) {
+    dsr->indexKey.publisherId = &dsr->config.publisherId;
+    dsr->indexKey.writerGroupId = dsr->config.writerGroupId;
+    dsr->indexKey.dataSetWriterId = dsr->config.dataSetWriterId;
+    dsr->indexNext = NULL;
+
+    /* Append to the chain of readers with the same key. This retains the order
+     * in which the readers were added. */
+    UA_DataSetReader *head =
+        ZIP_FIND(UA_DataSetReaderIndex, &rg->readerIndex, &dsr->indexKey);
+    if(!head) {
+        ZIP_INSERT(UA_DataSetReaderIndex, &rg->readerIndex, dsr);
+        return;
+    }
+    while(head->indexNext)
+        head = head->indexNext;
+    head->indexNext = dsr;
+}
+
+void
+UA_ReaderGroup_unindexReader(UA_ReaderGroup *rg, UA_DataSetReader *dsr) {
+    if(!dsr->indexKey.publisherId)
+        return; /* Not indexed */
+    UA_DataSetReader *head =
+        ZIP_FIND(UA_DataSetReaderIndex, &rg->readerIndex, &dsr->indexKey);
+    if(!head)
+        return;
+
+    /* The reader is in the tree. Replace with the next reader in the chain. */
+    if(head == dsr) {
+        ZIP_REMOVE(UA_DataSetReaderIndex, &rg->readerIndex, dsr);
+        if(dsr->indexNext)
+            ZIP_INSERT(UA_DataSetReaderIndex, &rg->readerIndex, dsr->indexNext);
+        dsr->indexNext = NULL;
+        dsr->indexKey.publisherId = NULL;
+        return;
+    }
+
+    /* Remove from the chain */
+    for(; head->indexNext; head = head->indexNext) {
+        if(head->indexNext != dsr)
+            continue;
+        head->indexNext = dsr->indexNext;
+        dsr->indexNext = NULL;
+        dsr->indexKey.publisherId = NULL;
+        return;
+    }
+}
+
+/* The index can be used if the NetworkMessage contains all identifiers.
+ * Otherwise the readers are matched with UA_DataSetReader_checkIdentifier. */
+static UA_Boolean
+canUseReaderIndex(const UA_ReaderGroup *rg, const UA_NetworkMessage *nm) {
+    return (rg->config.encodingMimeType == UA_PUBSUB_ENCODING_UADP &&
+            nm->publisherIdEnabled && nm->groupHeaderEnabled &&
+            nm->groupHeader.writerGroupIdEnabled && nm->payloadHeaderEnabled);
+}
+
+UA_Boolean
+UA_ReaderGroup_hasMatchingReader(UA_PubSubManager *psm, UA_ReaderGroup *rg,
+                                 UA_NetworkMessage *nm) {
+    if(canUseReaderIndex(rg, nm)) {
+        UA_DataSetReaderKey key;
+        key.publisherId = &nm->publisherId;
+        key.writerGroupId = nm->groupHeader.writerGroupId;
+        size_t count = nm->payload.dataSetPayload.dataSetMessagesSize;
+        for(size_t i = 0; i < count; i++) {
+            key.dataSetWriterId =
+                nm->payload.dataSetPayload.dataSetMessages[i].dataSetWriterId;
+            if(ZIP_FIND(UA_DataSetReaderIndex, &rg->readerIndex, &key))
+                return true;
+        }
+        return false;
+    }
+
+    UA_DataSetReader *reader;
+    LIST_FOREACH(reader, &rg->readers, listEntry) {
+        if(UA_DataSetReader_checkIdentifier(psm, reader, nm) == UA_STATUSCODE_GOOD)
+            return true;
+    }
+    return false;
+}
+
+/* Route every DataSetMessage to the readers with a matching key */
+static UA_Boolean
+UA_ReaderGroup_processIndexed(UA_PubSubManager *psm, UA_ReaderGroup *rg,
+                              UA_NetworkMessage *nm) {
+    UA_Boolean processed = false;
+    UA_DataSetReaderKey key;
+    key.publisherId = &nm->publisherId;
+    key.writerGroupId = nm->groupHeader.writerGroupId;
+    size_t count = nm->payload.dataSetPayload.dataSetMessagesSize;
+    for(size_t i = 0; i < count; i++) {
+        UA_DataSetMessage *dsm = &nm->payload.dataSetPayload.dataSetMessages[i];
+        key.dataSetWriterId = dsm->dataSetWriterId;
+        UA_DataSetReader *reader =
+            ZIP_FIND(UA_DataSetReaderIndex, &rg->readerIndex, &key);
+        UA_DataSetReader *reader_tmp;
+        for(; reader; reader = reader_tmp) {
+            /* The reader might be deleted during processing */
+            reader_tmp = reader->indexNext;
+            if(reader->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
+               reader->head.state != UA_PUBSUBSTATE_PREOPERATIONAL)
+                continue;
+            processed = true;
+            UA_LOG_TRACE_PUBSUB(psm->logging, rg, "Processing a NetworkMessage");
+            UA_DataSetReader_process(psm, reader, dsm);
+        }
+    }
+    return processed;
+}
+
 UA_Boolean
 UA_ReaderGroup_process(UA_PubSubManager *psm, UA_ReaderGroup *rg,
                        UA_NetworkMessage *nm) {
@@ -430,6 +585,10 @@ UA_ReaderGroup_process(UA_PubSubManager *psm, UA_ReaderGroup *rg,
     rg->hasReceived = true;
     UA_ReaderGroup_setPubSubState(psm, rg, rg->head.state);
 
+    /* Direct lookup of the readers for each DataSetMessage */
+    if(canUseReaderIndex(rg, nm))
+        return UA_ReaderGroup_processIndexed(psm, rg, nm);
+
     /* Safe iteration. The current Reader might be deleted in the ReaderGroup
      * _setPubSubState callback. */
     UA_Boolean processed = false;
@@ -544,66 +703,127 @@ UA_StatusCode
 verifyAndDecryptNetworkMessage(const UA_Logger *logger, UA_ByteString buffer,
                                Ctx *ctx, UA_NetworkMessage *nm,
                                UA_ReaderGroup *rg) {
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    verifyAndDecryptNetworkMessages(logger, rg, 1, &buffer, &ctx, &nm, &res);
+    return res;
+}
+
+void
+verifyAndDecryptNetworkMessages(const UA_Logger *logger, UA_ReaderGroup *rg,
+                                size_t messagesSize, const UA_ByteString *buffers,
+                                Ctx **ctxs, UA_NetworkMessage **nms,
+                                UA_StatusCode *results) {
     UA_MessageSecurityMode securityMode = rg->config.securityMode;
-    UA_Boolean doValidate = false;
-    UA_Boolean doDecrypt = false;
+    void *channelContext = rg->securityPolicyContext;
+    UA_PubSubSecurityPolicy *securityPolicy = rg->config.securityPolicy;
 
-    UA_StatusCode rv = needsValidation(logger, nm, securityMode, &doValidate);
-    UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SECURITYPOLICY,
-                         "PubSub receive. Validation security mode error");
+    /* Prepare the secured message ranges. Only the messages that need to be
+     * verified or decrypted are forwarded to the SecurityPolicy. */
+    size_t securedSize = 0;
+    UA_STACKARRAY(UA_PubSubSecuredMessage, secured, messagesSize);
+    UA_STACKARRAY(size_t, securedIndex, messagesSize);
+    for(size_t i = 0; i < messagesSize; i++) {
+        UA_Boolean doValidate = false;
+        UA_Boolean doDecrypt = false;
+        results[i] = needsValidation(logger, nms[i], securityMode, &doValidate);
+        if(results[i] != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                           "PubSub receive. Validation security mode error");
+            continue;
+        }
 
-    rv = needsDecryption(logger, nm, securityMode, &doDecrypt);
-    UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SECURITYPOLICY,
-                         "PubSub receive. Decryption security mode error");
+        results[i] = needsDecryption(logger, nms[i], securityMode, &doDecrypt);
+        if(results[i] != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                           "PubSub receive. Decryption security mode error");
+            continue;
+        }
 
-    if(!doValidate && !doDecrypt)
-        return UA_STATUSCODE_GOOD;
+        if(!doValidate && !doDecrypt)
+            continue;
 
-    void *channelContext = rg->securityPolicyContext;
-    UA_PubSubSecurityPolicy *securityPolicy = rg->config.securityPolicy;
-    UA_CHECK_MEM_ERROR(channelContext, return UA_STATUSCODE_BADINVALIDARGUMENT,
-                       logger, UA_LOGCATEGORY_PUBSUB,
-                       "PubSub receive. securityPolicyContext must be initialized "
-                       "when security mode is enabled to sign and/or encrypt");
-    UA_CHECK_MEM_ERROR(securityPolicy, return UA_STATUSCODE_BADINVALIDARGUMENT,
-                       logger, UA_LOGCATEGORY_PUBSUB,
-                       "PubSub receive. securityPolicy must be set when security mode"
-                       "is enabled to sign and/or encrypt");
-
-    /* Validate the signature */
-    if(doValidate) {
-        size_t sigSize = securityPolicy->symmetricModule.cryptoModule.
-            signatureAlgorithm.getLocalSignatureSize(channelContext);
-        UA_ByteString toBeVerified = {buffer.length - sigSize, buffer.data};
-        UA_ByteString signature = {sigSize, buffer.data + buffer.length - sigSize};
-
-        rv = securityPolicy->symmetricModule.cryptoModule.signatureAlgorithm.
-            verify(channelContext, &toBeVerified, &signature);
-        UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SECURITYPOLICY,
-                             "PubSub receive. Signature invalid");
-
-        /* Remove the signature from the ctx->end. We do not want to decode that. */
-        ctx->end -= sigSize;
-    }
-
-    /* Decrypt the content */
-    if(doDecrypt) {
-        const UA_ByteString nonce = {
-            (size_t)nm->securityHeader.messageNonceSize,
-            (UA_Byte*)(uintptr_t)nm->securityHeader.messageNonce
-        };
-        rv = securityPolicy->setMessageNonce(channelContext, &nonce);
-        UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SECURITYPOLICY,
-                             "PubSub receive. Faulty Nonce set");
-
-        UA_ByteString toBeDecrypted = {(uintptr_t)(ctx->end - ctx->pos), ctx->pos};
-        rv = securityPolicy->symmetricModule.cryptoModule
-            .encryptionAlgorithm.decrypt(channelContext, &toBeDecrypted);
-        UA_CHECK_STATUS_WARN(rv, return rv, logger, UA_LOGCATEGORY_SECURITYPOLICY,
-                             "PubSub receive. Faulty Decryption");
+        if(!channelContext || !securityPolicy) {
+            UA_LOG_WARNING(logger, UA_LOGCATEGORY_PUBSUB,
+                           "PubSub receive. securityPolicy and securityPolicyContext "
+                           "must be set when security mode is enabled to sign "
+                           "and/or encrypt");
+            results[i] = UA_STATUSCODE_BADINVALIDARGUMENT;
+            continue;
+        }
+
+        UA_PubSubSecuredMessage *sm = &secured[securedSize];
+        memset(sm, 0, sizeof(UA_PubSubSecuredMessage));
+        const UA_Byte *end = ctxs[i]->end;
+        if(doValidate) {
+            size_t sigSize = securityPolicy->symmetricModule.cryptoModule.
+                signatureAlgorithm.getLocalSignatureSize(channelContext);
+            if(buffers[i].length < sigSize ||
+               (uintptr_t)(end - ctxs[i]->pos) < sigSize) {
+                UA_LOG_WARNING(logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                               "PubSub receive. Message too short for the signature");
+                results[i] = UA_STATUSCODE_BADSECURITYCHECKSFAILED;
+                continue;
+            }
+            sm->signedPart.data = buffers[i].data;
+            sm->signedPart.length = buffers[i].length - sigSize;
+            sm->signature.data = buffers[i].data + sm->signedPart.length;
+            sm->signature.length = sigSize;
+            end -= sigSize;
+        }
+        if(doDecrypt) {
+            sm->messageNonce.data = (UA_Byte*)(uintptr_t)nms[i]->securityHeader.messageNonce;
+            sm->messageNonce.length = (size_t)nms[i]->securityHeader.messageNonceSize;
+            sm->encryptedPart.data = ctxs[i]->pos;
+            sm->encryptedPart.length = (uintptr_t)(end - ctxs[i]->pos);
+        }
+        securedIndex[securedSize] = i;
+        securedSize++;
     }
 
-    return UA_STATUSCODE_GOOD;
+    if(securedSize == 0)
+        return;
+
+    /* Verify and decrypt in one call if the SecurityPolicy supports it.
+     * Otherwise process the messages one by one. */
+    if(securityPolicy->verifyAndDecryptBatch) {
+        securityPolicy->verifyAndDecryptBatch(channelContext, securedSize, secured);
+    } else {
+        for(size_t i = 0; i < securedSize; i++) {
+            UA_PubSubSecuredMessage *sm = &secured[i];
+            sm->status = UA_STATUSCODE_GOOD;
+            if(sm->signature.length > 0) {
+                sm->status = securityPolicy->symmetricModule.cryptoModule.
+                    signatureAlgorithm.verify(channelContext, &sm->signedPart,
+                                              &sm->signature);
+                if(sm->status != UA_STATUSCODE_GOOD)
+                    continue;
+            }
+            if(sm->encryptedPart.length > 0) {
+                sm->status = securityPolicy->setMessageNonce(channelContext,
+                                                             &sm->messageNonce);
+                if(sm->status != UA_STATUSCODE_GOOD)
+                    continue;
+                sm->status = securityPolicy->symmetricModule.cryptoModule.
+                    encryptionAlgorithm.decrypt(channelContext, &sm->encryptedPart);
+            }
+        }
+    }
+
+    /* Forward the results. Remove the signature from the ctx->end. We do not
+     * want to decode that. */
+    for(size_t i = 0; i < securedSize; i++) {
+        UA_PubSubSecuredMessage *sm = &secured[i];
+        size_t index = securedIndex[i];
+        results[index] = sm->status;
+        if(sm->status != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(logger, UA_LOGCATEGORY_SECURITYPOLICY,
+                           "PubSub receive. Invalid signature or faulty decryption "
+                           "(StatusCode: %s)", UA_StatusCode_name(sm->status));
+            continue;
+        }
+        if(sm->signature.length > 0)
+            ctxs[index]->end -= sm->signature.length;
+    }
 }
 
 /***********************/
@@ -735,6 +955,12 @@ ReaderGroupChannelCallback(UA_ConnectionManager *cm, uintptr_t connectionId,
         return;
     }
 
+    /* Fixed-layout fast path */
+    if(UA_ReaderGroup_processFixedLayout(psm, rg, &msg)) {
+        unlockServer(server);
+        return;
+    }
+
     /* Decode message */
     UA_NetworkMessage nm;
     memset(&nm, 0, sizeof(UA_NetworkMessage));
@@ -1296,24 +1522,15 @@ readerGroupGenerateNetworkMessage(UA_ReaderGroup *wg, UA_DataSetReader **dsr,
     return UA_STATUSCODE_GOOD;
 }
 
-UA_StatusCode
-UA_Server_computeReaderGroupOffsetTable(UA_Server *server,
-                                        const UA_NodeId readerGroupId,
-                                        UA_PubSubOffsetTable *ot) {
-    if(!server || !ot)
-        return UA_STATUSCODE_BADINVALIDARGUMENT;
-
-    lockServer(server);
-
-    /* Get the ReaderGroup */
-    UA_PubSubManager *psm = getPSM(server);
-    UA_ReaderGroup *rg = (psm) ? UA_ReaderGroup_find(psm, readerGroupId) : NULL;
-    if(!rg) {
-        unlockServer(server);
-        return UA_STATUSCODE_BADNOTFOUND;
-    }
+static UA_StatusCode
+computeReaderGroupOffsetTable(UA_PubSubManager *psm, UA_ReaderGroup *rg,
+                              UA_PubSubOffsetTable *ot) {
+    UA_Server *server = psm->sc.server;
+    UA_LOCK_ASSERT(&server->serviceMutex);
 
     memset(ot, 0, sizeof(UA_PubSubOffsetTable));
+    if(rg->readersCount == 0)
+        return UA_STATUSCODE_BADNOTFOUND;
 
     /* Define variables here to allow the goto cleanup later on */
     size_t msgSize;
@@ -1404,9 +1621,296 @@ UA_Server_computeReaderGroupOffsetTable(UA_Server *server,
     for(size_t i = 0; i < dsmCount; i++) {
         UA_DataSetMessage_clear(&dsmStore[i]);
     }
+    return res;
+}
+
+UA_StatusCode
+UA_Server_computeReaderGroupOffsetTable(UA_Server *server,
+                                        const UA_NodeId readerGroupId,
+                                        UA_PubSubOffsetTable *ot) {
+    if(!server || !ot)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    lockServer(server);
 
+    /* Get the ReaderGroup */
+    UA_PubSubManager *psm = getPSM(server);
+    UA_ReaderGroup *rg = (psm) ? UA_ReaderGroup_find(psm, readerGroupId) : NULL;
+    if(!rg) {
+        unlockServer(server);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+
+    UA_StatusCode res = computeReaderGroupOffsetTable(psm, rg, ot);
     unlockServer(server);
     return res;
 }
 
+/****************/
+/* Fixed Layout */
+/****************/
+
+void
+UA_ReaderGroup_resetFixedLayout(UA_ReaderGroup *rg) {
+    rg->fixedLayoutComputed = false;
+    UA_ReaderGroupFixedLayout *fl = rg->fixedLayout;
+    if(!fl)
+        return;
+    for(size_t i = 0; i < fl->readersSize; i++)
+        UA_free(fl->readers[i].fields);
+    UA_free(fl->readers);
+    UA_free(fl->staticRanges);
+    UA_ByteString_clear(&fl->networkMessage);
+    UA_free(fl);
+    rg->fixedLayout = NULL;
+}
+
+size_t
+UA_FixedLayout_fieldSize(const UA_DataType *type, UA_PubSubOffsetType offsetType) {
+    if(!type->pointerFree)
+        return 0;
+
+    /* In a Variant the type is encoded as the builtin type id */
+    if(offsetType != UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW &&
+       type->typeKind > UA_DATATYPEKIND_DOUBLE &&
+       type->typeKind != UA_DATATYPEKIND_DATETIME &&
+       type->typeKind != UA_DATATYPEKIND_GUID &&
+       type->typeKind != UA_DATATYPEKIND_STATUSCODE)
+        return 0;
+
+    UA_STACKARRAY(UA_Byte, value, type->memSize);
+    memset(value, 0, type->memSize);
+    return UA_calcSizeBinary(value, type, NULL);
+}
+
+static UA_Boolean
+isStaticOffset(UA_PubSubOffsetType offsetType) {
+    return (offsetType == UA_PUBSUBOFFSETTYPE_DATASETMESSAGE ||
+            offsetType == UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_GROUPVERSION);
+}
+
+static size_t
+offsetContentSize(UA_PubSubOffsetType offsetType) {
+    switch(offsetType) {
+    case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_TIMESTAMP:
+    case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_TIMESTAMP:
+        return 8;
+    default:
+        return 2; /* Sequence numbers, status and picoseconds */
+    }
+}
+
+/* Validate the fields of the template against the reader configuration and
+ * compute the ranges that change between messages. The layout is discarded if
+ * a field does not have a fixed size. */
+static UA_StatusCode
+computeFixedLayout(UA_PubSubManager *psm, UA_ReaderGroup *rg,
+                   const UA_PubSubOffsetTable *ot, UA_ReaderGroupFixedLayout *fl) {
+    fl->readers = (UA_FixedLayoutReader*)
+        UA_calloc(rg->readersCount, sizeof(UA_FixedLayoutReader));
+    fl->staticRanges = (UA_FixedLayoutRange*)
+        UA_calloc(ot->offsetsSize + 1, sizeof(UA_FixedLayoutRange));
+    if(!fl->readers || !fl->staticRanges)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+
+    const UA_ByteString *nm = &ot->networkMessage;
+    UA_DataSetReader *dsr = NULL;
+    size_t pos = 0; /* Start of the current static range */
+    for(size_t i = 0; i < ot->offsetsSize; i++) {
+        const UA_PubSubOffset *o = &ot->offsets[i];
+        if(isStaticOffset(o->offsetType)) {
+            if(o->offsetType != UA_PUBSUBOFFSETTYPE_DATASETMESSAGE)
+                continue;
+            dsr = (dsr == NULL) ? LIST_FIRST(&rg->readers) : LIST_NEXT(dsr, listEntry);
+            if(!dsr)
+                return UA_STATUSCODE_BADINTERNALERROR;
+            fl->readers[fl->readersSize].reader = dsr;
+            size_t fieldsSize = dsr->config.dataSetMetaData.fieldsSize;
+            if(fieldsSize != dsr->config.subscribedDataSet.target.targetVariablesSize)
+                return UA_STATUSCODE_BADCONFIGURATIONERROR;
+            if(fieldsSize > 0) {
+                fl->readers[fl->readersSize].fields = (UA_FixedLayoutField*)
+                    UA_calloc(fieldsSize, sizeof(UA_FixedLayoutField));
+                if(!fl->readers[fl->readersSize].fields)
+                    return UA_STATUSCODE_BADOUTOFMEMORY;
+            }
+            fl->readersSize++;
+            continue;
+        }
+
+        /* Variable content of the NetworkMessage and DataSetMessage headers */
+        size_t start = o->offset;
+        size_t end = start + offsetContentSize(o->offsetType);
+        if(o->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW ||
+           o->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT ||
+           o->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE) {
+            if(!dsr)
+                return UA_STATUSCODE_BADINTERNALERROR;
+            size_t idx = fl->readers[fl->readersSize - 1].fieldsSize;
+            if(idx >= dsr->config.dataSetMetaData.fieldsSize)
+                return UA_STATUSCODE_BADCONFIGURATIONERROR;
+
+            /* Fixed-size scalar fields only */
+            const UA_FieldMetaData *fmd = &dsr->config.dataSetMetaData.fields[idx];
+            const UA_DataType *type =
+                UA_findDataTypeWithCustom(&fmd->dataType,
+                                          psm->sc.server->config.customDataTypes);
+            if(!type || fmd->valueRank >= 0 || fmd->arrayDimensionsSize > 0)
+                return UA_STATUSCODE_BADNOTSUPPORTED;
+            size_t size = UA_FixedLayout_fieldSize(type, o->offsetType);
+            if(size == 0)
+                return UA_STATUSCODE_BADNOTSUPPORTED;
+
+            /* The field ends at the next offset or at the end of the message */
+            size_t fieldEnd = (i + 1 < ot->offsetsSize) ?
+                ot->offsets[i + 1].offset : nm->length;
+
+            UA_FixedLayoutField *f = &fl->readers[fl->readersSize - 1].fields[idx];
+            f->fieldIndex = idx;
+            f->offsetType = o->offsetType;
+            f->offset = start;
+            f->type = type;
+            if(o->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT) {
+                /* The variant encoding byte remains in the static range */
+                if(nm->data[start] != type->typeKind + 1)
+                    return UA_STATUSCODE_BADNOTSUPPORTED;
+                start += 1;
+                if(start + size != fieldEnd)
+                    return UA_STATUSCODE_BADNOTSUPPORTED;
+            } else if(o->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE) {
+                /* The encoding masks remain in the static range */
+                f->dataValueMask = nm->data[start];
+                if(!(f->dataValueMask & 0x01u) ||
+                   nm->data[start + 1] != type->typeKind + 1)
+                    return UA_STATUSCODE_BADNOTSUPPORTED;
+                start += 2;
+                UA_Byte mask = f->dataValueMask;
+                if(mask & 0x02u) size += 4; /* Status */
+                if(mask & 0x04u) size += 8; /* SourceTimestamp */
+                if(mask & 0x08u) size += 8; /* ServerTimestamp */
+                if(mask & 0x10u) size += 2; /* SourcePicoseconds */
+                if(mask & 0x20u) size += 2; /* ServerPicoseconds */
+                if(start + size != fieldEnd)
+                    return UA_STATUSCODE_BADNOTSUPPORTED;
+            } else if(start + size != fieldEnd) {
+                return UA_STATUSCODE_BADNOTSUPPORTED;
+            }
+            end = fieldEnd;
+            fl->readers[fl->readersSize - 1].fieldsSize++;
+        }
+
+        if(start > pos) {
+            fl->staticRanges[fl->staticRangesSize].offset = pos;
+            fl->staticRanges[fl->staticRangesSize].length = start - pos;
+            fl->staticRangesSize++;
+        }
+        pos = end;
+    }
+
+    if(nm->length > pos) {
+        fl->staticRanges[fl->staticRangesSize].offset = pos;
+        fl->staticRanges[fl->staticRangesSize].length = nm->length - pos;
+        fl->staticRangesSize++;
+    }
+
+    /* All fields have an offset */
+    for(size_t i = 0; i < fl->readersSize; i++) {
+        if(fl->readers[i].fieldsSize !=
+           fl->readers[i].reader->config.dataSetMetaData.fieldsSize)
+            return UA_STATUSCODE_BADNOTSUPPORTED;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_ReaderGroupFixedLayout *
+getFixedLayout(UA_PubSubManager *psm, UA_ReaderGroup *rg) {
+    if(rg->fixedLayoutComputed)
+        return rg->fixedLayout;
+    rg->fixedLayoutComputed = true;
+
+    /* Secured messages need to be verified and decrypted first */
+    if(rg->config.encodingMimeType != UA_PUBSUB_ENCODING_UADP ||
+       rg->config.securityMode == UA_MESSAGESECURITYMODE_SIGN ||
+       rg->config.securityMode == UA_MESSAGESECURITYMODE_SIGNANDENCRYPT) {
+        UA_LOG_INFO_PUBSUB(psm->logging, rg, "The fixed layout is only "
+                           "available for unsecured UADP messages");
+        return NULL;
+    }
+
+    UA_PubSubOffsetTable ot;
+    UA_StatusCode res = computeReaderGroupOffsetTable(psm, rg, &ot);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_PubSubOffsetTable_clear(&ot);
+        UA_LOG_INFO_PUBSUB(psm->logging, rg, "Cannot compute the fixed layout "
+                           "of the NetworkMessage (%s)", UA_StatusCode_name(res));
+        return NULL;
+    }
+
+    UA_ReaderGroupFixedLayout *fl = (UA_ReaderGroupFixedLayout*)
+        UA_calloc(1, sizeof(UA_ReaderGroupFixedLayout));
+    if(!fl) {
+        UA_PubSubOffsetTable_clear(&ot);
+        return NULL;
+    }
+    rg->fixedLayout = fl;
+
+    res = computeFixedLayout(psm, rg, &ot, fl);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_INFO_PUBSUB(psm->logging, rg, "The NetworkMessage has no fixed "
+                           "layout (%s)", UA_StatusCode_name(res));
+        UA_PubSubOffsetTable_clear(&ot);
+        UA_ReaderGroup_resetFixedLayout(rg);
+        rg->fixedLayoutComputed = true;
+        return NULL;
+    }
+
+    /* Take over the encoded template */
+    fl->networkMessage = ot.networkMessage;
+    UA_ByteString_init(&ot.networkMessage);
+    UA_PubSubOffsetTable_clear(&ot);
+
+    UA_LOG_DEBUG_PUBSUB(psm->logging, rg, "Computed the fixed layout of the "
+                        "NetworkMessage with %u bytes", (unsigned)fl->networkMessage.length);
+    return fl;
+}
+
+UA_Boolean
+UA_ReaderGroup_processFixedLayout(UA_PubSubManager *psm, UA_ReaderGroup *rg,
+                                  const UA_ByteString *buffer) {
+    if(!rg->config.fixedLayout ||
+       (rg->head.state != UA_PUBSUBSTATE_OPERATIONAL &&
+        rg->head.state != UA_PUBSUBSTATE_PREOPERATIONAL))
+        return false;
+
+    UA_ReaderGroupFixedLayout *fl = getFixedLayout(psm, rg);
+    if(!fl)
+        return false;
+
+    /* Validate the message against the template */
+    if(buffer->length != fl->networkMessage.length)
+        return false;
+    for(size_t i = 0; i < fl->staticRangesSize; i++) {
+        if(memcmp(&buffer->data[fl->staticRanges[i].offset],
+                  &fl->networkMessage.data[fl->staticRanges[i].offset],
+                  fl->staticRanges[i].length) != 0)
+            return false;
+    }
+
+    /* Set to operational if required */
+    rg->hasReceived = true;
+    UA_ReaderGroup_setPubSubState(psm, rg, rg->head.state);
+
+    UA_LOG_TRACE_PUBSUB(psm->logging, rg,
+                        "Processing a NetworkMessage with the fixed layout");
+    for(size_t i = 0; i < fl->readersSize; i++) {
+        UA_DataSetReader_processFixedLayout(psm, fl->readers[i].reader, buffer,
+                                            fl->readers[i].fields,
+                                            fl->readers[i].fieldsSize);
+        /* The layout was reset in a state change callback */
+        if(rg->fixedLayout != fl)
+            break;
+    }
+    return true;
+}
+
 #endif /* UA_ENABLE_PUBSUB */
@@ -141,6 +141,8 @@ UA_DataSetWriter_setPubSubState(UA_PubSubManager *psm, UA_DataSetWriter *dsw,
 
     /* Inform application about state change */
     if(dsw->head.state != oldState) {
+        /* The enabled writers are part of the fixed layout */
+        UA_WriterGroup_resetFixedLayout(wg);
         UA_LOG_INFO_PUBSUB(psm->logging, dsw, "%s -> %s",
                            UA_PubSubState_name(oldState),
                            UA_PubSubState_name(dsw->head.state));
@@ -248,6 +250,7 @@ UA_DataSetWriter_create(UA_PubSubManager *psm,
     else
         LIST_INSERT_HEAD(&wg->writers, dsw, listEntry);
     wg->writersCount++;
+    UA_WriterGroup_resetFixedLayout(wg);
 
     /* Add to the information model */
 #ifdef UA_ENABLE_PUBSUB_INFORMATIONMODEL
@@ -319,6 +322,7 @@ UA_DataSetWriter_remove(UA_PubSubManager *psm, UA_DataSetWriter *dsw) {
 #endif
 
     /* Remove DataSetWriter from group */
+    UA_WriterGroup_resetFixedLayout(wg);
     LIST_REMOVE(dsw, listEntry);
     wg->writersCount--;
 
@@ -345,57 +349,27 @@ UA_DataSetWriter_remove(UA_PubSubManager *psm, UA_DataSetWriter *dsw) {
 /*               PublishValues handling                  */
 /*********************************************************/
 
-/* Compare two variants. Internally used for value change detection. */
-static UA_Boolean
-valueChangedVariant(UA_Variant *oldValue, UA_Variant *newValue) {
-    if(!oldValue || !newValue)
-        return false;
-
-    size_t oldValueEncodingSize = UA_calcSizeBinary(oldValue, &UA_TYPES[UA_TYPES_VARIANT], NULL);
-    size_t newValueEncodingSize = UA_calcSizeBinary(newValue, &UA_TYPES[UA_TYPES_VARIANT], NULL);
-    if(oldValueEncodingSize == 0 || newValueEncodingSize == 0)
-        return false;
-
-    if(oldValueEncodingSize != newValueEncodingSize)
-        return true;
-
-    UA_ByteString oldValueEncoding = UA_BYTESTRING_NULL;
-    UA_StatusCode res = UA_ByteString_allocBuffer(&oldValueEncoding, oldValueEncodingSize);
-    if(res != UA_STATUSCODE_GOOD)
-        return false;
-
-    UA_ByteString newValueEncoding = UA_BYTESTRING_NULL;
-    res = UA_ByteString_allocBuffer(&newValueEncoding, newValueEncodingSize);
-    if(res != UA_STATUSCODE_GOOD) {
-        UA_ByteString_clear(&oldValueEncoding);
-        return false;
-    }
-
-    UA_Byte *bufPosOldValue = oldValueEncoding.data;
-    const UA_Byte *bufEndOldValue = &oldValueEncoding.data[oldValueEncoding.length];
-    UA_Byte *bufPosNewValue = newValueEncoding.data;
-    const UA_Byte *bufEndNewValue = &newValueEncoding.data[newValueEncoding.length];
-
-    UA_Boolean compareResult = false; /* default */
-
-    res = UA_encodeBinaryInternal(oldValue, &UA_TYPES[UA_TYPES_VARIANT],
-                                  &bufPosOldValue, &bufEndOldValue, NULL, NULL, NULL);
-    if(res != UA_STATUSCODE_GOOD)
-        goto cleanup;
-
-    res = UA_encodeBinaryInternal(newValue, &UA_TYPES[UA_TYPES_VARIANT],
-                                  &bufPosNewValue, &bufEndNewValue, NULL, NULL, NULL);
-    if(res != UA_STATUSCODE_GOOD)
-        goto cleanup;
-
-    oldValueEncoding.length = (uintptr_t)bufPosOldValue - (uintptr_t)oldValueEncoding.data;
-    newValueEncoding.length = (uintptr_t)bufPosNewValue - (uintptr_t)newValueEncoding.data;
-    compareResult = !UA_ByteString_equal(&oldValueEncoding, &newValueEncoding);
-
- cleanup:
-    UA_ByteString_clear(&oldValueEncoding);
-    UA_ByteString_clear(&newValueEncoding);
-    return compareResult;
+void
+UA_DataSetWriter_applyFieldContentMask(const UA_DataSetWriter *dsw,
+                                       UA_DataValue *dfv) {
+    /* Deactivate statuscode? */
+    if(((u64)dsw->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
+        dfv->hasStatus = false;
+
+    /* Deactivate timestamps */
+    if(((u64)dsw->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
+        dfv->hasSourceTimestamp = false;
+    if(((u64)dsw->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
+        dfv->hasSourcePicoseconds = false;
+    if(((u64)dsw->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
+        dfv->hasServerTimestamp = false;
+    if(((u64)dsw->config.dataSetFieldContentMask &
+        (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
+        dfv->hasServerPicoseconds = false;
 }
 
 static UA_StatusCode
@@ -438,25 +412,7 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_PubSubManager *psm,
         /* Sample the value */
         UA_DataValue *dfv = &dataSetMessage->data.keyFrameData.dataSetFields[counter];
         UA_PubSubDataSetField_sampleValue(psm, dsf, dfv);
-
-        /* Deactivate statuscode? */
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
-            dfv->hasStatus = false;
-
-        /* Deactivate timestamps */
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
-            dfv->hasSourceTimestamp = false;
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dfv->hasSourcePicoseconds = false;
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
-            dfv->hasServerTimestamp = false;
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
-            dfv->hasServerPicoseconds = false;
+        UA_DataSetWriter_applyFieldContentMask(dsw, dfv);
 
         if(psm->sc.server->config.pubSubConfig.enableDeltaFrames) {
             /* Update lastValue store */
@@ -468,8 +424,9 @@ UA_PubSubDataSetWriter_generateKeyFrameMessage(UA_PubSubManager *psm,
     return UA_STATUSCODE_GOOD;
 }
 
-/* the input message is already initialized and that the method 
- * must not be called twice for the same message */
+/* The input message is already initialized. The method must not be called
+ * twice for the same message. Only the fields whose value changed since the
+ * last sample are added to the DeltaFrame. */
 static UA_StatusCode
 UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
                                                  UA_DataSetMessage *dsm,
@@ -484,40 +441,42 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
     if(pds->fieldSize == 0)
         return UA_STATUSCODE_GOOD;
 
+    /* Sample the values and compare with the last sample. External value
+     * backends are compared in place and only copied if the value changed. */
     UA_DataSetField *dsf;
-    UA_UInt16 counter = 0;
+    size_t counter = 0;
+    UA_UInt16 changed = 0;
     TAILQ_FOREACH(dsf, &pds->fields, listEntry) {
-        /* Sample the value */
         UA_DataValue value;
-        UA_DataValue_init(&value);
-        UA_PubSubDataSetField_sampleValue(psm, dsf, &value);
-
-        /* Check if the value has changed */
+        UA_Boolean clear = UA_PubSubDataSetField_sampleValueInPlace(psm, dsf, &value);
         UA_DataSetWriterSample *ls = &dsw->lastSamples[counter];
-        if(valueChangedVariant(&ls->value.value, &value.value)) {
-            /* increase fieldCount for current delta message */
-            dsm->data.deltaFrameData.fieldCount++;
-            ls->valueChanged = true;
-
-            /* Update last stored sample */
+        ls->valueChanged = !UA_equal(&ls->value.value, &value.value,
+                                     &UA_TYPES[UA_TYPES_VARIANT]);
+        if(ls->valueChanged) {
+            changed++;
             UA_DataValue_clear(&ls->value);
-            ls->value = value;
-        } else {
+            if(clear)
+                ls->value = value; /* Move */
+            else
+                UA_DataValue_copy(&value, &ls->value);
+        } else if(clear) {
             UA_DataValue_clear(&value);
-            ls->valueChanged = false;
         }
-
         counter++;
     }
 
+    /* Nothing changed */
+    if(changed == 0)
+        return UA_STATUSCODE_GOOD;
+
     /* Allocate DeltaFrameFields */
     UA_DataSetMessage_DeltaFrameField *deltaFields = (UA_DataSetMessage_DeltaFrameField *)
-        UA_calloc(counter, sizeof(UA_DataSetMessage_DeltaFrameField));
+        UA_calloc(changed, sizeof(UA_DataSetMessage_DeltaFrameField));
     if(!deltaFields)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     dsm->data.deltaFrameData.deltaFrameFields = deltaFields;
-    dsm->data.deltaFrameData.fieldCount = counter;
+    dsm->data.deltaFrameData.fieldCount = changed;
 
     size_t currentDeltaField = 0;
     for(size_t i = 0; i < pds->fieldSize; i++) {
@@ -525,32 +484,12 @@ UA_PubSubDataSetWriter_generateDeltaFrameMessage(UA_PubSubManager *psm,
             continue;
 
         UA_DataSetMessage_DeltaFrameField *dff = &deltaFields[currentDeltaField];
-
         dff->fieldIndex = (UA_UInt16) i;
         UA_DataValue_copy(&dsw->lastSamples[i].value, &dff->fieldValue);
+        UA_DataSetWriter_applyFieldContentMask(dsw, &dff->fieldValue);
 
         /* Reset the changed flag */
         dsw->lastSamples[i].valueChanged = false;
-
-        /* Deactivate statuscode? */
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_STATUSCODE) == 0)
-            dff->fieldValue.hasStatus = false;
-
-        /* Deactivate timestamps? */
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP) == 0)
-            dff->fieldValue.hasSourceTimestamp = false;
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SOURCEPICOSECONDS) == 0)
-            dff->fieldValue.hasServerPicoseconds = false;
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERTIMESTAMP) == 0)
-            dff->fieldValue.hasServerTimestamp = false;
-        if(((u64)dsw->config.dataSetFieldContentMask &
-            (u64)UA_DATASETFIELDCONTENTMASK_SERVERPICOSECONDS) == 0)
-            dff->fieldValue.hasServerPicoseconds = false;
-
         currentDeltaField++;
     }
     return UA_STATUSCODE_GOOD;
@@ -748,9 +687,12 @@ UA_DataSetWriter_generateDataSetMessage(UA_PubSubManager *psm,
 
         /* The standard defines: if a PDS contains only one fields no delta messages
          * should be generated because they need more memory than a keyframe with 1
-         * field. */
+         * field. The KeyFrameCount is the number of messages from one KeyFrame
+         * to the next, including the KeyFrame itself. RawData has no
+         * DeltaFrame encoding. */
         if(pds->fieldSize > 1 && dsw->deltaFrameCounter > 0 &&
-           dsw->deltaFrameCounter <= dsw->config.keyFrameCount) {
+           dsw->deltaFrameCounter < dsw->config.keyFrameCount &&
+           dataSetMessage->header.fieldEncoding != UA_FIELDENCODING_RAWDATA) {
             UA_PubSubDataSetWriter_generateDeltaFrameMessage(psm, dataSetMessage, dsw);
             dsw->deltaFrameCounter++;
             return UA_STATUSCODE_GOOD;
@@ -38,6 +38,10 @@ generateNetworkMessage(UA_PubSubConnection *connection, UA_WriterGroup *wg,
 static void
 UA_WriterGroup_disconnect(UA_WriterGroup *wg);
 
+static UA_Boolean
+publishFixedLayout(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                   UA_PubSubConnection *connection);
+
 static UA_StatusCode
 UA_WriterGroup_connect(UA_PubSubManager *psm, UA_WriterGroup *wg,
                        UA_Boolean validate);
@@ -307,6 +311,7 @@ UA_WriterGroup_remove(UA_PubSubManager *psm, UA_WriterGroup *wg) {
 
         UA_LOG_INFO_PUBSUB(psm->logging, wg, "WriterGroup deleted");
 
+        UA_WriterGroup_resetFixedLayout(wg);
         UA_WriterGroupConfig_clear(&wg->config);
         UA_PubSubComponentHead_clear(&wg->head);
         UA_free(wg);
@@ -442,6 +447,7 @@ UA_WriterGroup_setPubSubState(UA_PubSubManager *psm, UA_WriterGroup *wg,
         wg->head.state = targetState;
         UA_WriterGroup_disconnect(wg);
         UA_WriterGroup_removePublishCallback(psm, wg);
+        UA_WriterGroup_resetFixedLayout(wg);
         break;
 
         /* Enabled */
@@ -499,6 +505,7 @@ UA_WriterGroup_setPubSubState(UA_PubSubManager *psm, UA_WriterGroup *wg,
         wg->head.state = UA_PUBSUBSTATE_ERROR;;
         UA_WriterGroup_disconnect(wg);
         UA_WriterGroup_removePublishCallback(psm, wg);
+        UA_WriterGroup_resetFixedLayout(wg);
     }
 
  finalize_state_machine:
@@ -868,6 +875,12 @@ UA_WriterGroup_publishCallback(UA_PubSubManager *psm, UA_WriterGroup *wg) {
         return;
     }
 
+    /* Patch the encoded NetworkMessage if the layout is fixed */
+    if(wg->config.fixedLayout && publishFixedLayout(psm, wg, connection)) {
+        unlockServer(psm->sc.server);
+        return;
+    }
+
     /* How many DSM can be sent in one NM? */
     UA_Byte maxDSM = (UA_Byte)wg->config.maxEncapsulatedDataSetMessageCount;
     if(wg->config.maxEncapsulatedDataSetMessageCount > UA_BYTE_MAX)
@@ -1490,22 +1503,10 @@ UA_Server_updateWriterGroupConfig(UA_Server *server, const UA_NodeId wgId,
     return res;
 }
 
-UA_StatusCode
-UA_Server_computeWriterGroupOffsetTable(UA_Server *server,
-                                        const UA_NodeId writerGroupId,
-                                        UA_PubSubOffsetTable *ot) {
-    if(!server || !ot)
-        return UA_STATUSCODE_BADINVALIDARGUMENT;
-
-    lockServer(server);
-
-    /* Get the Writer Group */
-    UA_PubSubManager *psm = getPSM(server);
-    UA_WriterGroup *wg = (psm) ? UA_WriterGroup_find(psm, writerGroupId) : NULL;
-    if(!wg) {
-        unlockServer(server);
-        return UA_STATUSCODE_BADNOTFOUND;
-    }
+static UA_StatusCode
+computeWriterGroupOffsetTable(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                              UA_PubSubOffsetTable *ot) {
+    UA_LOCK_ASSERT(&psm->sc.server->serviceMutex);
 
     /* Initialize variables so we can goto cleanup below */
     UA_DataSetField *field = NULL;
@@ -1595,9 +1596,28 @@ UA_Server_computeWriterGroupOffsetTable(UA_Server *server,
     for(size_t i = 0; i < dsmCount; i++) {
         UA_DataSetMessage_clear(&dsmStore[i]);
     }
+    return res;
+}
 
-    unlockServer(server);
+UA_StatusCode
+UA_Server_computeWriterGroupOffsetTable(UA_Server *server,
+                                        const UA_NodeId writerGroupId,
+                                        UA_PubSubOffsetTable *ot) {
+    if(!server || !ot)
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+
+    lockServer(server);
 
+    /* Get the Writer Group */
+    UA_PubSubManager *psm = getPSM(server);
+    UA_WriterGroup *wg = (psm) ? UA_WriterGroup_find(psm, writerGroupId) : NULL;
+    if(!wg) {
+        unlockServer(server);
+        return UA_STATUSCODE_BADNOTFOUND;
+    }
+
+    UA_StatusCode res = computeWriterGroupOffsetTable(psm, wg, ot);
+    unlockServer(server);
     return res;
 }
 
@@ -1611,4 +1631,368 @@ UA_PubSubOffsetTable_clear(UA_PubSubOffsetTable *ot) {
     memset(ot, 0, sizeof(UA_PubSubOffsetTable));
 }
 
+/****************/
+/* Fixed Layout */
+/****************/
+
+void
+UA_WriterGroup_resetFixedLayout(UA_WriterGroup *wg) {
+    wg->fixedLayoutComputed = false;
+    UA_WriterGroupFixedLayout *fl = wg->fixedLayout;
+    if(!fl)
+        return;
+    UA_free(fl->patches);
+    UA_ByteString_clear(&fl->networkMessage);
+    UA_free(fl);
+    wg->fixedLayout = NULL;
+}
+
+static UA_Byte
+dataValueEncodingMask(const UA_DataValue *dv) {
+    UA_Byte mask = 0;
+    if(dv->hasValue) mask |= 0x01u;
+    if(dv->hasStatus) mask |= 0x02u;
+    if(dv->hasSourceTimestamp) mask |= 0x04u;
+    if(dv->hasServerTimestamp) mask |= 0x08u;
+    if(dv->hasSourcePicoseconds) mask |= 0x10u;
+    if(dv->hasServerPicoseconds) mask |= 0x20u;
+    return mask;
+}
+
+static UA_Boolean
+sampleFixedLayoutField(UA_PubSubManager *psm, UA_DataSetWriter *dsw,
+                       UA_DataSetField *dsf, UA_DataValue *dv) {
+    UA_Boolean clear = UA_PubSubDataSetField_sampleValueInPlace(psm, dsf, dv);
+    UA_DataSetWriter_applyFieldContentMask(dsw, dv);
+    return clear;
+}
+
+/* Encode the sampled field value into the NetworkMessage */
+static UA_StatusCode
+patchFixedLayoutField(UA_PubSubManager *psm, const UA_FixedLayoutPatch *p,
+                      UA_Byte *pos, const UA_Byte *end) {
+    UA_DataValue dv;
+    UA_Boolean clear = sampleFixedLayoutField(psm, p->writer, p->field, &dv);
+
+    /* The value must have the type of the template */
+    UA_StatusCode res = UA_STATUSCODE_BADTYPEMISMATCH;
+    if(!dv.hasValue || dv.value.type != p->type || !UA_Variant_isScalar(&dv.value))
+        goto cleanup;
+
+    if(p->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT) {
+        pos += 1; /* Skip the variant encoding byte */
+    } else if(p->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE) {
+        if(dataValueEncodingMask(&dv) != p->dataValueMask)
+            goto cleanup;
+        pos += 2; /* Skip the DataValue and variant encoding bytes */
+    }
+
+    res = UA_encodeBinaryInternal(dv.value.data, p->type, &pos, &end,
+                                  NULL, NULL, NULL);
+    if(p->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE) {
+        if(dv.hasStatus)
+            res |= UA_StatusCode_encodeBinary(&dv.status, &pos, end);
+        if(dv.hasSourceTimestamp)
+            res |= UA_DateTime_encodeBinary(&dv.sourceTimestamp, &pos, end);
+        if(dv.hasSourcePicoseconds)
+            res |= UA_UInt16_encodeBinary(&dv.sourcePicoseconds, &pos, end);
+        if(dv.hasServerTimestamp)
+            res |= UA_DateTime_encodeBinary(&dv.serverTimestamp, &pos, end);
+        if(dv.hasServerPicoseconds)
+            res |= UA_UInt16_encodeBinary(&dv.serverPicoseconds, &pos, end);
+    }
+
+ cleanup:
+    if(clear)
+        UA_DataValue_clear(&dv);
+    return res;
+}
+
+/* Validate a field of the encoded message. The encoding bytes of the field
+ * must not change between publish cycles. */
+static UA_StatusCode
+computeFixedLayoutField(UA_PubSubManager *psm, UA_FixedLayoutPatch *p,
+                        const UA_ByteString *nm, size_t fieldEnd) {
+    UA_DataValue dv;
+    UA_Boolean clear = sampleFixedLayoutField(psm, p->writer, p->field, &dv);
+    UA_StatusCode res = UA_STATUSCODE_BADNOTSUPPORTED;
+    const UA_DataType *type = dv.value.type;
+    if(!dv.hasValue || !type || !UA_Variant_isScalar(&dv.value))
+        goto cleanup;
+    size_t size = UA_FixedLayout_fieldSize(type, p->offsetType);
+    if(size == 0)
+        goto cleanup;
+
+    size_t start = p->offset;
+    if(p->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT) {
+        if(start + 1 > fieldEnd || nm->data[start] != type->typeKind + 1)
+            goto cleanup;
+        start += 1;
+    } else if(p->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE) {
+        p->dataValueMask = dataValueEncodingMask(&dv);
+        if(start + 2 > fieldEnd || nm->data[start] != p->dataValueMask ||
+           nm->data[start + 1] != type->typeKind + 1)
+            goto cleanup;
+        start += 2;
+        UA_Byte mask = p->dataValueMask;
+        if(mask & 0x02u) size += 4; /* Status */
+        if(mask & 0x04u) size += 8; /* SourceTimestamp */
+        if(mask & 0x08u) size += 8; /* ServerTimestamp */
+        if(mask & 0x10u) size += 2; /* SourcePicoseconds */
+        if(mask & 0x20u) size += 2; /* ServerPicoseconds */
+    }
+
+    /* Padding after the field remains static */
+    if(start + size > fieldEnd)
+        goto cleanup;
+    p->type = type;
+    res = UA_STATUSCODE_GOOD;
+
+ cleanup:
+    if(clear)
+        UA_DataValue_clear(&dv);
+    return res;
+}
+
+static UA_StatusCode
+computeFixedLayout(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                   const UA_PubSubOffsetTable *ot, UA_WriterGroupFixedLayout *fl) {
+    if(ot->offsetsSize > 0) {
+        fl->patches = (UA_FixedLayoutPatch*)
+            UA_calloc(ot->offsetsSize, sizeof(UA_FixedLayoutPatch));
+        if(!fl->patches)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+
+    UA_DataSetWriter *dsw = NULL;
+    UA_DataSetField *dsf = NULL;
+    for(size_t i = 0; i < ot->offsetsSize; i++) {
+        const UA_PubSubOffset *o = &ot->offsets[i];
+        UA_FixedLayoutPatch *p = &fl->patches[fl->patchesSize];
+        p->offsetType = o->offsetType;
+        p->offset = o->offset;
+        switch(o->offsetType) {
+        case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_TIMESTAMP:
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE:
+            dsw = (dsw == NULL) ? LIST_FIRST(&wg->writers) : LIST_NEXT(dsw, listEntry);
+            if(!dsw)
+                return UA_STATUSCODE_BADINTERNALERROR;
+            dsf = NULL;
+            p->writer = dsw;
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_TIMESTAMP:
+            if(!dsw)
+                return UA_STATUSCODE_BADINTERNALERROR;
+            p->writer = dsw;
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE:
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT:
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW: {
+            if(!dsw || !dsw->connectedDataSet)
+                return UA_STATUSCODE_BADINTERNALERROR;
+            dsf = (dsf == NULL) ?
+                TAILQ_FIRST(&dsw->connectedDataSet->fields) : TAILQ_NEXT(dsf, listEntry);
+            if(!dsf)
+                return UA_STATUSCODE_BADINTERNALERROR;
+            p->writer = dsw;
+            p->field = dsf;
+            /* The field ends at the next offset or at the end of the message */
+            size_t fieldEnd = (i + 1 < ot->offsetsSize) ?
+                ot->offsets[i + 1].offset : ot->networkMessage.length;
+            UA_StatusCode res =
+                computeFixedLayoutField(psm, p, &ot->networkMessage, fieldEnd);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+            break;
+        }
+        default:
+            /* The GroupVersion, status and picoseconds remain static */
+            continue;
+        }
+        fl->patchesSize++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+static UA_WriterGroupFixedLayout *
+getFixedLayout(UA_PubSubManager *psm, UA_WriterGroup *wg) {
+    if(wg->fixedLayoutComputed)
+        return wg->fixedLayout;
+    wg->fixedLayoutComputed = true;
+
+    /* Secured messages need a new nonce and signature for every message */
+    if(wg->config.encodingMimeType != UA_PUBSUB_ENCODING_UADP ||
+       wg->config.securityMode > UA_MESSAGESECURITYMODE_NONE) {
+        UA_LOG_INFO_PUBSUB(psm->logging, wg, "The fixed layout is only "
+                           "available for unsecured UADP messages");
+        return NULL;
+    }
+
+    /* All DataSetMessages in a single NetworkMessage with a fixed content */
+    UA_UInt16 maxDSM = wg->config.maxEncapsulatedDataSetMessageCount;
+    if(maxDSM == 0)
+        maxDSM = 1;
+    if(maxDSM > UA_BYTE_MAX)
+        maxDSM = UA_BYTE_MAX;
+    if(wg->writersCount == 0 || wg->writersCount > maxDSM) {
+        UA_LOG_INFO_PUBSUB(psm->logging, wg, "The fixed layout requires all "
+                           "DataSetMessages in one NetworkMessage");
+        return NULL;
+    }
+
+    /* Only KeyFrames without promoted fields. See the conditions for DeltaFrames
+     * in UA_DataSetWriter_generateDataSetMessage. */
+    UA_DataSetWriter *dsw;
+    UA_Boolean deltaFrames = psm->sc.server->config.pubSubConfig.enableDeltaFrames;
+    LIST_FOREACH(dsw, &wg->writers, listEntry) {
+        UA_PublishedDataSet *pds = dsw->connectedDataSet;
+        if(!pds)
+            continue;
+        if(pds->promotedFieldsCount > 0 ||
+           (deltaFrames && pds->fieldSize > 1 && dsw->config.keyFrameCount > 1)) {
+            UA_LOG_INFO_PUBSUB(psm->logging, wg, "The fixed layout is not "
+                               "available with promoted fields or DeltaFrames");
+            return NULL;
+        }
+    }
+
+    /* Encoding the template must not consume sequence numbers */
+    size_t i = 0;
+    UA_STACKARRAY(UA_UInt16, sequenceCounts, wg->writersCount);
+    LIST_FOREACH(dsw, &wg->writers, listEntry)
+        sequenceCounts[i++] = dsw->actualDataSetMessageSequenceCount;
+    UA_PubSubOffsetTable ot;
+    UA_StatusCode res = computeWriterGroupOffsetTable(psm, wg, &ot);
+    i = 0;
+    LIST_FOREACH(dsw, &wg->writers, listEntry)
+        dsw->actualDataSetMessageSequenceCount = sequenceCounts[i++];
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_PubSubOffsetTable_clear(&ot);
+        UA_LOG_INFO_PUBSUB(psm->logging, wg, "Cannot compute the fixed layout "
+                           "of the NetworkMessage (%s)", UA_StatusCode_name(res));
+        return NULL;
+    }
+
+    UA_WriterGroupFixedLayout *fl = (UA_WriterGroupFixedLayout*)
+        UA_calloc(1, sizeof(UA_WriterGroupFixedLayout));
+    if(!fl) {
+        UA_PubSubOffsetTable_clear(&ot);
+        return NULL;
+    }
+    wg->fixedLayout = fl;
+
+    res = computeFixedLayout(psm, wg, &ot, fl);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_INFO_PUBSUB(psm->logging, wg, "The NetworkMessage has no fixed "
+                           "layout (%s)", UA_StatusCode_name(res));
+        UA_PubSubOffsetTable_clear(&ot);
+        UA_WriterGroup_resetFixedLayout(wg);
+        wg->fixedLayoutComputed = true;
+        return NULL;
+    }
+
+    /* Take over the encoded message */
+    fl->networkMessage = ot.networkMessage;
+    UA_ByteString_init(&ot.networkMessage);
+    UA_PubSubOffsetTable_clear(&ot);
+
+    UA_LOG_DEBUG_PUBSUB(psm->logging, wg, "Computed the fixed layout of the "
+                        "NetworkMessage with %u bytes", (unsigned)fl->networkMessage.length);
+    return fl;
+}
+
+/* Returns false if the WriterGroup has no fixed layout. Then the NetworkMessage
+ * is generated and encoded in the normal way. */
+static UA_Boolean
+publishFixedLayout(UA_PubSubManager *psm, UA_WriterGroup *wg,
+                   UA_PubSubConnection *connection) {
+    /* The layout contains all writers */
+    UA_DataSetWriter *dsw;
+    LIST_FOREACH(dsw, &wg->writers, listEntry) {
+        if(dsw->head.state != UA_PUBSUBSTATE_OPERATIONAL)
+            return false;
+    }
+
+    UA_WriterGroupFixedLayout *fl = getFixedLayout(psm, wg);
+    if(!fl)
+        return false;
+
+    /* Patch the changing content into the encoded message */
+    UA_EventLoop *el = psm->sc.server->config.eventLoop;
+    UA_DateTime now = el->dateTime_now(el);
+    UA_Byte *data = fl->networkMessage.data;
+    const UA_Byte *end = &data[fl->networkMessage.length];
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    for(size_t i = 0; i < fl->patchesSize; i++) {
+        const UA_FixedLayoutPatch *p = &fl->patches[i];
+        UA_Byte *pos = &data[p->offset];
+        switch(p->offsetType) {
+        case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER:
+            res = UA_UInt16_encodeBinary(&wg->sequenceNumber, &pos, end);
+            break;
+        case UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_TIMESTAMP:
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_TIMESTAMP:
+            res = UA_DateTime_encodeBinary(&now, &pos, end);
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER:
+            res = UA_UInt16_encodeBinary(&p->writer->actualDataSetMessageSequenceCount,
+                                         &pos, end);
+            break;
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE:
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT:
+        case UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW:
+            res = patchFixedLayoutField(psm, p, pos, end);
+            /* The layout was reset in a callback during sampling */
+            if(wg->fixedLayout != fl)
+                return false;
+            break;
+        default:
+            break;
+        }
+        if(res != UA_STATUSCODE_GOOD) {
+            UA_LOG_INFO_PUBSUB(psm->logging, wg, "The NetworkMessage does not "
+                               "match the fixed layout (%s)", UA_StatusCode_name(res));
+            UA_WriterGroup_resetFixedLayout(wg);
+            return false;
+        }
+    }
+
+    /* Select the wg sendchannel if configured */
+    uintptr_t sendChannel = connection->sendChannel;
+    if(wg->sendChannel != 0)
+        sendChannel = wg->sendChannel;
+    UA_ConnectionManager *cm = connection->cm;
+    if(!cm || sendChannel == 0) {
+        UA_LOG_ERROR_PUBSUB(psm->logging, wg, "Cannot send, no open connection");
+        UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
+        return true;
+    }
+
+    /* Copy into the network buffer. This does not allocate if the
+     * ConnectionManager has a static send buffer. */
+    UA_ByteString buf = UA_BYTESTRING_NULL;
+    res = cm->allocNetworkBuffer(cm, sendChannel, &buf, fl->networkMessage.length);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_LOG_ERROR_PUBSUB(psm->logging, wg,
+                            "PubSub Publish: Could not allocate the network "
+                            "buffer with status code %s", UA_StatusCode_name(res));
+        UA_WriterGroup_setPubSubState(psm, wg, UA_PUBSUBSTATE_ERROR);
+        return true;
+    }
+    memcpy(buf.data, fl->networkMessage.data, fl->networkMessage.length);
+
+    /* The DataSetMessages are sent */
+    for(size_t i = 0; i < fl->patchesSize; i++) {
+        if(fl->patches[i].offsetType == UA_PUBSUBOFFSETTYPE_DATASETMESSAGE)
+            fl->patches[i].writer->actualDataSetMessageSequenceCount++;
+    }
+
+    wg->lastPublishTimeStamp = el->dateTime_nowMonotonic(el);
+    sendNetworkMessageBuffer(psm, wg, connection, sendChannel, &buf);
+    return true;
+}
+
 #endif /* UA_ENABLE_PUBSUB */
@@ -252,11 +252,12 @@ UA_NodePointer_toExpandedNodeId(UA_NodePointer np) {
 
 static UA_StatusCode
 addReferenceTarget(UA_NodeReferenceKind *refs, UA_NodePointer target,
-                   UA_UInt32 targetNameHash);
+                   UA_UInt32 targetNameHash, UA_NodeClass targetNodeClass);
 
 static UA_StatusCode
 addReferenceTargetToTree(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
-                         UA_UInt32 targetIdHash, UA_UInt32 targetNameHash);
+                         UA_UInt32 targetIdHash, UA_UInt32 targetNameHash,
+                         UA_NodeClass targetNodeClass);
 
 enum ZIP_CMP
 cmpRefTargetId(const void *a, const void *b) {
@@ -327,7 +328,8 @@ UA_NodeReferenceKind_switch(UA_NodeReferenceKind *rk) {
     for(size_t i = 0; i < rk->targetsSize; i++) {
         UA_StatusCode res =
             addReferenceTarget(&newRk, rk->targets.array[i].targetId,
-                               rk->targets.array[i].targetNameHash);
+                               rk->targets.array[i].targetNameHash,
+                               rk->targets.array[i].targetNodeClass);
         if(res != UA_STATUSCODE_GOOD) {
             ZIP_ITER(UA_ReferenceIdTree,
                      (UA_ReferenceIdTree*)&newRk.targets.tree.idRoot,
@@ -532,7 +534,8 @@ copyTarget(void *context, UA_ReferenceTargetTreeElem *elm) {
     return (void*)(uintptr_t)
         addReferenceTargetToTree(drefs, elm->target.targetId,
                                  elm->targetIdHash,
-                                 elm->target.targetNameHash);
+                                 elm->target.targetNameHash,
+                                 elm->target.targetNodeClass);
 }
 
 UA_StatusCode
@@ -616,6 +619,8 @@ UA_Node_copy(const UA_Node *src, UA_Node *dst) {
                 for(size_t j = 0; j < srefs->targetsSize; j++) {
                     drefs->targets.array[j].targetNameHash =
                         srefs->targets.array[j].targetNameHash;
+                    drefs->targets.array[j].targetNodeClass =
+                        srefs->targets.array[j].targetNodeClass;
                     retval = UA_NodePointer_copy(srefs->targets.array[j].targetId,
                                                  &drefs->targets.array[j].targetId);
                     drefs->targetsSize++; /* avoid that targetsSize == 0 in error case */
@@ -895,7 +900,8 @@ UA_Node_setAttributes(UA_Node *node, const void *attributes, const UA_DataType *
 
 static UA_StatusCode
 addReferenceTargetToTree(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
-                         UA_UInt32 targetIdHash, UA_UInt32 targetNameHash) {
+                         UA_UInt32 targetIdHash, UA_UInt32 targetNameHash,
+                         UA_NodeClass targetNodeClass) {
     UA_ReferenceTargetTreeElem *entry = (UA_ReferenceTargetTreeElem*)
         UA_malloc(sizeof(UA_ReferenceTargetTreeElem));
     if(!entry)
@@ -909,6 +915,7 @@ addReferenceTargetToTree(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
 
     entry->targetIdHash = targetIdHash;
     entry->target.targetNameHash = targetNameHash;
+    entry->target.targetNodeClass = targetNodeClass;
 
     ZIP_INSERT(UA_ReferenceIdTree,
                (UA_ReferenceIdTree*)&rk->targets.tree.idRoot, entry);
@@ -921,12 +928,12 @@ addReferenceTargetToTree(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
 
 static UA_StatusCode
 addReferenceTarget(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
-                   UA_UInt32 targetNameHash) {
+                   UA_UInt32 targetNameHash, UA_NodeClass targetNodeClass) {
     /* Insert into tree */
     if(rk->hasRefTree) {
         UA_ExpandedNodeId en = UA_NodePointer_toExpandedNodeId(targetId);
         return addReferenceTargetToTree(rk, targetId, UA_ExpandedNodeId_hash(&en),
-                                        targetNameHash);
+                                        targetNameHash, targetNodeClass);
     }
 
     /* Insert to the array */
@@ -941,6 +948,7 @@ addReferenceTarget(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
         UA_NodePointer_copy(targetId,
                             &rk->targets.array[rk->targetsSize].targetId);
     rk->targets.array[rk->targetsSize].targetNameHash = targetNameHash;
+    rk->targets.array[rk->targetsSize].targetNodeClass = targetNodeClass;
     if(retval != UA_STATUSCODE_GOOD) {
         if(rk->targetsSize == 0) {
             UA_free(rk->targets.array);
@@ -955,7 +963,8 @@ addReferenceTarget(UA_NodeReferenceKind *rk, UA_NodePointer targetId,
 
 static UA_StatusCode
 addReferenceKind(UA_NodeHead *head, UA_Byte refTypeIndex, UA_Boolean isForward,
-                 const UA_NodePointer target, UA_UInt32 targetBrowseNameHash) {
+                 const UA_NodePointer target, UA_UInt32 targetBrowseNameHash,
+                 UA_NodeClass targetNodeClass) {
     UA_NodeReferenceKind *refs = (UA_NodeReferenceKind*)
         UA_realloc(head->references,
                    sizeof(UA_NodeReferenceKind) * (head->referencesSize+1));
@@ -967,7 +976,8 @@ addReferenceKind(UA_NodeHead *head, UA_Byte refTypeIndex, UA_Boolean isForward,
     memset(newRef, 0, sizeof(UA_NodeReferenceKind));
     newRef->referenceTypeIndex = refTypeIndex;
     newRef->isInverse = !isForward;
-    UA_StatusCode res = addReferenceTarget(newRef, target, targetBrowseNameHash);
+    UA_StatusCode res = addReferenceTarget(newRef, target, targetBrowseNameHash,
+                                           targetNodeClass);
     if(res != UA_STATUSCODE_GOOD) {
         if(head->referencesSize == 0) {
             UA_free(head->references);
@@ -984,6 +994,15 @@ UA_StatusCode
 UA_Node_addReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
                      const UA_ExpandedNodeId *targetNodeId,
                      UA_UInt32 targetBrowseNameHash) {
+    return UA_Node_addReference_ex(node, refTypeIndex, isForward, targetNodeId,
+                                   targetBrowseNameHash, UA_NODECLASS_UNSPECIFIED);
+}
+
+UA_StatusCode
+UA_Node_addReference_ex(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
+                        const UA_ExpandedNodeId *targetNodeId,
+                        UA_UInt32 targetBrowseNameHash,
+                        UA_NodeClass targetNodeClass) {
     /* Find the matching reference kind */
     for(size_t i = 0; i < node->head.referencesSize; ++i) {
         UA_NodeReferenceKind *refs = &node->head.references[i];
@@ -1004,13 +1023,13 @@ UA_Node_addReference(UA_Node *node, UA_Byte refTypeIndex, UA_Boolean isForward,
 
         /* Add to existing ReferenceKind */
         return addReferenceTarget(refs, UA_NodePointer_fromExpandedNodeId(targetNodeId),
-                                  targetBrowseNameHash);
+                                  targetBrowseNameHash, targetNodeClass);
     }
 
     /* Add new ReferenceKind for the target */
     return addReferenceKind(&node->head, refTypeIndex, isForward,
                             UA_NodePointer_fromExpandedNodeId(targetNodeId),
-                            targetBrowseNameHash);
+                            targetBrowseNameHash, targetNodeClass);
 
 }
 
@@ -440,6 +440,7 @@ UA_Server_delete(UA_Server *server) {
         UA_Server_removeSession(server, current, UA_SHUTDOWNREASON_CLOSE);
     }
     UA_Array_delete(server->namespaces, server->namespacesSize, &UA_TYPES[UA_TYPES_STRING]);
+    clearBrowsePathCache(server);
 
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* Remove subscriptions without a session */
@@ -452,6 +453,10 @@ UA_Server_delete(UA_Server *server) {
     UA_ConditionList_delete(server);
 #endif
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    clearEventSourceCache(server);
+#endif
+
 #endif
 
 #if UA_MULTITHREADING >= 100
@@ -557,6 +562,9 @@ UA_Server_init(UA_Server *server) {
     LIST_INIT(&server->sessions);
     server->sessionCount = 0;
 
+    /* Initialize the cache of resolved browse paths */
+    TAILQ_INIT(&server->browsePathCache.lru);
+
     /* Initialize SecureChannel */
     TAILQ_INIT(&server->channels);
     /* TODO: use an ID that is likely to be unique after a restart */
@@ -1082,6 +1090,7 @@ UA_Server_getStatistics(UA_Server *server) {
     stat.ss.rejectedSessionCount = sds->rejectedSessionCount;
     stat.ss.sessionTimeoutCount = sds->sessionTimeoutCount;
     stat.ss.sessionAbortCount = sds->sessionAbortCount;
+    stat.bpcs = server->browsePathCache.stats;
     return stat;
 }
 
@@ -188,6 +188,70 @@ typedef struct session_list_entry {
     UA_Session session;
 } session_list_entry;
 
+/* Cache of resolved browse paths. The entries are found in a tree by the hash
+ * of the BrowsePath and evicted in the LRU order. Every entry remembers the
+ * nodes visited during the resolution together with their generation. Changes
+ * of a node or of its references increment the generation of the node. Changes
+ * of the ReferenceType hierarchy increment the generation of the cache. Entries
+ * with an outdated generation are removed when they are found. */
+
+/* Node visited by cached entries */
+typedef struct UA_BrowsePathCacheNode {
+    ZIP_ENTRY(UA_BrowsePathCacheNode) treeEntry;
+    UA_NodeId nodeId;
+    UA_UInt64 generation;
+    size_t refCount; /* Number of entries that visited the node */
+} UA_BrowsePathCacheNode;
+
+enum ZIP_CMP
+cmpBrowsePathCacheNode(const UA_NodeId *a, const UA_NodeId *b);
+
+typedef ZIP_HEAD(UA_BrowsePathCacheNodeTree, UA_BrowsePathCacheNode)
+    UA_BrowsePathCacheNodeTree;
+ZIP_FUNCTIONS(UA_BrowsePathCacheNodeTree, UA_BrowsePathCacheNode, treeEntry,
+              UA_NodeId, nodeId, cmpBrowsePathCacheNode)
+
+typedef struct {
+    UA_BrowsePathCacheNode *node;
+    UA_UInt64 generation; /* Generation of the node when visited */
+} UA_BrowsePathCacheVisit;
+
+typedef struct {
+    UA_UInt32 hash;
+    UA_UInt32 nodeClassMask;
+    const UA_BrowsePath *browsePath;
+} UA_BrowsePathCacheKey;
+
+typedef struct UA_BrowsePathCacheEntry {
+    ZIP_ENTRY(UA_BrowsePathCacheEntry) treeEntry;
+    TAILQ_ENTRY(UA_BrowsePathCacheEntry) lruEntry;
+    UA_BrowsePathCacheKey key; /* Points to the browsePath member */
+    UA_BrowsePath browsePath;
+    UA_BrowsePathResult result;
+    UA_UInt64 generation;
+    size_t visitsSize;
+    UA_BrowsePathCacheVisit *visits;
+} UA_BrowsePathCacheEntry;
+
+enum ZIP_CMP
+cmpBrowsePathCacheKey(const UA_BrowsePathCacheKey *a,
+                      const UA_BrowsePathCacheKey *b);
+
+typedef ZIP_HEAD(UA_BrowsePathCacheTree, UA_BrowsePathCacheEntry) UA_BrowsePathCacheTree;
+ZIP_FUNCTIONS(UA_BrowsePathCacheTree, UA_BrowsePathCacheEntry, treeEntry,
+              UA_BrowsePathCacheKey, key, cmpBrowsePathCacheKey)
+
+typedef TAILQ_HEAD(UA_BrowsePathCacheLRU, UA_BrowsePathCacheEntry)
+    UA_BrowsePathCacheLRU;
+
+typedef struct {
+    UA_BrowsePathCacheTree tree;
+    UA_BrowsePathCacheLRU lru; /* Most recently used first */
+    UA_BrowsePathCacheNodeTree nodes;
+    UA_UInt64 generation;
+    UA_BrowsePathCacheStatistics stats;
+} UA_BrowsePathCache;
+
 struct UA_Server {
     /* Config */
     UA_ServerConfig config;
@@ -229,6 +293,9 @@ struct UA_Server {
      * the parent and member instantiation */
     UA_Boolean bootstrapNS0;
 
+    /* Resolved browse paths */
+    UA_BrowsePathCache browsePathCache;
+
     /* Subscriptions */
 #ifdef UA_ENABLE_SUBSCRIPTIONS
     /* The admin session is initialized with a special subscription. This
@@ -243,6 +310,18 @@ struct UA_Server {
                                                  * from a session. */
     UA_UInt32 lastSubscriptionId; /* To generate unique SubscriptionIds */
 
+# ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Cache of the objects that emit the events of a source node. Changes of
+     * the references in eventSourceRefTypes invalidate the cache. */
+    UA_EventSourceCache eventSourceCache;
+    UA_ReferenceTypeSet eventSourceRefTypes;
+
+    /* EventFilters shared between MonitoredItems. The counter identifies the
+     * current event for the cached evaluation results. */
+    UA_SharedEventFilterTree eventFilters;
+    UA_UInt64 eventCounter;
+# endif
+
 # ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
     LIST_HEAD(, UA_ConditionSource) conditionSources;
     UA_NodeId refreshEvents[2];
@@ -571,12 +650,27 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
              const UA_NodeId origin, UA_ByteString *outEventId,
              const UA_Boolean deleteEventNode);
 
-/* Filters the given event with the given filter and writes the results into a
- * notification */
+/* Invalidate the cached event notifier hierarchy if the ReferenceType is
+ * relevant for the event propagation */
+void
+invalidateEventSourceCache(UA_Server *server, UA_Byte refTypeIndex);
+
+void
+clearEventSourceCache(UA_Server *server);
+
+UA_StatusCode
+emitEvent(UA_Server *server, const UA_NodeId eventType,
+          const UA_NodeId origin, const UA_KeyValueMap *eventFields,
+          UA_ByteString *outEventId);
+
+/* Filters the given event with the compiled filter and writes the results into
+ * a notification. The event is either given by its node representation or as a
+ * node-less event (the other argument is NULL). */
 UA_StatusCode
 filterEvent(UA_Server *server, UA_Session *session,
-            const UA_NodeId *eventNode, UA_EventFilter *filter,
-            UA_EventFieldList *efl, UA_EventFilterResult *result);
+            const UA_EventFilterProgram *program,
+            const UA_NodeId *eventNode, const UA_NodelessEvent *nodelessEvent,
+            UA_EventFieldList *efl);
 
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
 
@@ -596,6 +690,17 @@ UA_BrowsePathResult
 browseSimplifiedBrowsePath(UA_Server *server, const UA_NodeId origin,
                            size_t browsePathSize, const UA_QualifiedName *browsePath);
 
+/* Invalidate all cached browse paths in constant time */
+void
+invalidateBrowsePathCache(UA_Server *server);
+
+/* Invalidate the cached browse paths that visited the node */
+void
+invalidateBrowsePathCacheNode(UA_Server *server, const UA_NodeId *nodeId);
+
+void
+clearBrowsePathCache(UA_Server *server);
+
 UA_StatusCode
 writeObjectProperty(UA_Server *server, const UA_NodeId objectId,
                     const UA_QualifiedName propertyName, const UA_Variant value);
@@ -640,32 +745,36 @@ securityPolicyUriPostfix(const UA_String uri);
 /* RefTree */
 /***********/
 
-/* A RefTree is a sorted set of NodeIds that ensures we consider each node just
- * once. It holds a single array for both the ExpandedNodeIds and the entries of
- * a tree-structure for fast lookup. A single realloc operation (with some
- * pointer repairing) can be used to increase the capacity of the RefTree.
+/* A RefTree is a set of NodeIds that ensures we consider each node just once.
+ * It holds a single array for both the ExpandedNodeIds and an open-addressing
+ * hash index for fast lookup. A single realloc operation (with a rehash of the
+ * index) can be used to increase the capacity of the RefTree.
  *
- * When the RefTree is complete, the tree-part at the end of the targets array
+ * When the RefTree is complete, the index-part at the end of the targets array
  * can be ignored / cut away to use it as a simple ExpandedNodeId array.
  *
  * The layout of the targets array is as follows:
  *
- * | Targets [ExpandedNodeId, n times] | Tree [RefEntry, n times] | */
+ * | Targets [ExpandedNodeId, n times] | Index [RefSlot, 2n times] |
+ *
+ * The index has twice as many slots as there are targets. So it is at most
+ * half full and the linear probing stays short. */
 
 #define UA_REFTREE_INITIAL_SIZE 16
 
-typedef struct RefEntry {
-    ZIP_ENTRY(RefEntry) zipfields;
-    const UA_ExpandedNodeId *target;
+typedef struct {
     UA_UInt32 targetHash; /* Hash of the target nodeid */
-} RefEntry;
+    UA_UInt32 index;      /* Position in the targets array + 1. Zero if empty. */
+} RefSlot;
 
-ZIP_HEAD(RefHead, RefEntry);
-typedef struct RefHead RefHead;
+/* RefTree_double rehashes from the old index without a copy. The old index
+ * (2n slots behind n targets) must end before the new index (behind 2n
+ * targets) begins. */
+UA_STATIC_ASSERT(2 * sizeof(RefSlot) <= sizeof(UA_ExpandedNodeId),
+                 reftree_index_fits_into_the_targets);
 
 typedef struct {
     UA_ExpandedNodeId *targets;
-    RefHead head;
     size_t capacity; /* available space */
     size_t size;     /* used space */
 } RefTree;
@@ -829,6 +938,11 @@ readDiagnostics(UA_Server *server, const UA_NodeId *sessionId, void *sessionCont
                 const UA_NodeId *nodeId, void *nodeContext, UA_Boolean sourceTimestamp,
                 const UA_NumericRange *range, UA_DataValue *value);
 
+/* Vendor-specific variables for the browse path cache statistics below
+ * Server/VendorServerInfo */
+UA_StatusCode
+addBrowsePathCacheDiagnostics(UA_Server *server);
+
 UA_StatusCode
 readSubscriptionDiagnosticsArray(UA_Server *server,
                                  const UA_NodeId *sessionId, void *sessionContext,
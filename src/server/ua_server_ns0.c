@@ -1196,6 +1196,9 @@ initNS0(UA_Server *server) {
     UA_DataSource sessionSecDiagSummary = {readSessionSecurityDiagnostics, NULL};
     retVal |= setVariableNode_dataSource(server, UA_NS0ID(SERVER_SERVERDIAGNOSTICS_SESSIONSDIAGNOSTICSSUMMARY_SESSIONSECURITYDIAGNOSTICSARRAY), sessionSecDiagSummary);
 
+    /* VendorServerInfo - Browse path cache statistics */
+    retVal |= addBrowsePathCacheDiagnostics(server);
+
 #else
     /* Removing these NodeIds make Server Object to be non-complaint with UA
      * 1.03 in CTT (Base Inforamtion/Base Info Core Structure/ 001.js) In the
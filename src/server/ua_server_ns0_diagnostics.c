@@ -605,4 +605,78 @@ readDiagnostics(UA_Server *server, const UA_NodeId *sessionId, void *sessionCont
     return res;
 }
 
+/*********************************/
+/* Browse Path Cache Diagnostics */
+/*********************************/
+
+static const struct {
+    char *name;
+    size_t offset;
+} browsePathCacheDiagnostics[4] = {
+    {"BrowsePathCacheEntries", offsetof(UA_BrowsePathCacheStatistics, currentEntries)},
+    {"BrowsePathCacheHits", offsetof(UA_BrowsePathCacheStatistics, hitCount)},
+    {"BrowsePathCacheMisses", offsetof(UA_BrowsePathCacheStatistics, missCount)},
+    {"BrowsePathCacheInvalidations",
+     offsetof(UA_BrowsePathCacheStatistics, invalidationCount)}
+};
+
+/* The node context is the offset of the counter in the statistics */
+static UA_StatusCode
+readBrowsePathCacheDiagnostics(UA_Server *server,
+                               const UA_NodeId *sessionId, void *sessionContext,
+                               const UA_NodeId *nodeId, void *nodeContext,
+                               UA_Boolean sourceTimestamp,
+                               const UA_NumericRange *range, UA_DataValue *value) {
+    if(range) {
+        value->hasStatus = true;
+        value->status = UA_STATUSCODE_BADINDEXRANGEINVALID;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    if(sourceTimestamp) {
+        UA_EventLoop *el = server->config.eventLoop;
+        value->hasSourceTimestamp = true;
+        value->sourceTimestamp = el->dateTime_now(el);
+    }
+
+    lockServer(server);
+    const UA_Byte *stats = (const UA_Byte*)&server->browsePathCache.stats;
+    UA_UInt64 count = *(const size_t*)&stats[(uintptr_t)nodeContext];
+    unlockServer(server);
+
+    UA_StatusCode res =
+        UA_Variant_setScalarCopy(&value->value, &count, &UA_TYPES[UA_TYPES_UINT64]);
+    if(res == UA_STATUSCODE_GOOD)
+        value->hasValue = true;
+    return res;
+}
+
+UA_StatusCode
+addBrowsePathCacheDiagnostics(UA_Server *server) {
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    UA_DataSource ds = {readBrowsePathCacheDiagnostics, NULL};
+    for(size_t i = 0; i < 4; i++) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        attr.displayName = UA_LOCALIZEDTEXT("", browsePathCacheDiagnostics[i].name);
+        attr.dataType = UA_TYPES[UA_TYPES_UINT64].typeId;
+        attr.valueRank = UA_VALUERANK_SCALAR;
+        /* Assign a random free NodeId. The variables are found by their
+         * BrowseName below VendorServerInfo. */
+        UA_NodeId id;
+        res = addNode(server, UA_NODECLASS_VARIABLE, UA_NODEID_NUMERIC(1, 0),
+                      UA_NS0ID(SERVER_VENDORSERVERINFO), UA_NS0ID(HASCOMPONENT),
+                      UA_QUALIFIEDNAME(1, browsePathCacheDiagnostics[i].name),
+                      UA_NS0ID(BASEDATAVARIABLETYPE), &attr,
+                      &UA_TYPES[UA_TYPES_VARIABLEATTRIBUTES],
+                      (void*)(uintptr_t)browsePathCacheDiagnostics[i].offset, &id);
+        if(res != UA_STATUSCODE_GOOD)
+            break;
+        res = setVariableNode_dataSource(server, id, ds);
+        UA_NodeId_clear(&id);
+        if(res != UA_STATUSCODE_GOOD)
+            break;
+    }
+    return res;
+}
+
 #endif /* UA_ENABLE_DIAGNOSTICS */
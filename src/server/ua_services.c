@@ -262,6 +262,15 @@ processServiceInternal(UA_Server *server, UA_SecureChannel *channel, UA_Session
     }
 #endif
 
+    /* Browse results without a limit for the references per node can become
+     * very large. Large results are encoded directly into the message chunks. */
+    if(sd->requestType == &UA_TYPES[UA_TYPES_BROWSEREQUEST] &&
+       request->browseRequest.requestedMaxReferencesPerNode == 0 &&
+       server->config.maxReferencesPerNode == 0 &&
+       Service_BrowseStreaming(server, channel, session,
+                               &request->browseRequest, requestId))
+        return true;
+
     /* An async call request might not be answered immediately */
 #if UA_MULTITHREADING >= 100 && defined(UA_ENABLE_METHODCALLS)
     if(sd->requestType == &UA_TYPES[UA_TYPES_CALLREQUEST]) {
@@ -115,6 +115,16 @@ void Service_Browse(UA_Server *server, UA_Session *session,
                     const UA_BrowseRequest *request,
                     UA_BrowseResponse *response);
 
+/* Special variant of the Browse service for large responses. The results are
+ * encoded into the message chunks while browsing and the response is sent
+ * internally. If streaming fails after the first chunk, an abort chunk answers
+ * the request. Returns false if nothing was sent. Then the request is answered
+ * with the regular Browse service. */
+UA_Boolean
+Service_BrowseStreaming(UA_Server *server, UA_SecureChannel *channel,
+                        UA_Session *session, const UA_BrowseRequest *request,
+                        UA_UInt32 requestId);
+
 void Service_BrowseNext(UA_Server *server, UA_Session *session,
                         const UA_BrowseNextRequest *request,
                         UA_BrowseNextResponse *response);
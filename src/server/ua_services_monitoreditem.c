@@ -461,6 +461,12 @@ Operation_CreateMonitoredItem(UA_Server *server, UA_Session *session,
     result->statusCode |= checkAdjustMonitoredItemParams(server, session, newMon,
                                                          valueType, &newMon->parameters,
                                                          &result->filterResult);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    if(result->statusCode == UA_STATUSCODE_GOOD &&
+       newMon->itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER)
+        result->statusCode =
+            UA_MonitoredItem_compileEventFilter(server, newMon, &newMon->parameters);
+#endif
     if(result->statusCode != UA_STATUSCODE_GOOD) {
         UA_LOG_INFO_SUBSCRIPTION(server->config.logging, cmc->sub,
                                  "Could not create a MonitoredItem "
@@ -720,6 +726,14 @@ Operation_ModifyMonitoredItem(UA_Server *server, UA_Session *session, UA_Subscri
         checkAdjustMonitoredItemParams(server, session, mon, v.value.type,
                                        &params, &result->filterResult);
     UA_DataValue_clear(&v);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Compile the new filter. This replaces the program of the MonitoredItem
+     * only if successful. The program points into the heap-allocated filter
+     * that is moved into the MonitoredItem below. */
+    if(result->statusCode == UA_STATUSCODE_GOOD &&
+       mon->itemToMonitor.attributeId == UA_ATTRIBUTEID_EVENTNOTIFIER)
+        result->statusCode = UA_MonitoredItem_compileEventFilter(server, mon, &params);
+#endif
     if(result->statusCode != UA_STATUSCODE_GOOD) {
         UA_MonitoringParameters_clear(&params);
         return;
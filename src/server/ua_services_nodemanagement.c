@@ -713,6 +713,7 @@ copyChild(UA_Server *server, UA_Session *session,
         /* node = NULL; The pointer is no longer valid */
         if(retval != UA_STATUSCODE_GOOD)
             return retval;
+        invalidateBrowsePathCacheNode(server, &newNodeId);
 
         /* Add the node references */
         retval = addNode_addRefs(server, session, &newNodeId, destinationNodeId,
@@ -1094,6 +1095,9 @@ addNode_raw(UA_Server *server, UA_Session *session, void *nodeContext,
         return retval;
     }
 
+    /* A cached browse path might have considered the (missing) NodeId */
+    invalidateBrowsePathCacheNode(server, outNewNodeId);
+
     if(outNewNodeId == &tmpOutId)
         UA_NodeId_clear(&tmpOutId);
 
@@ -1356,6 +1360,9 @@ setReferenceTypeSubtypes(UA_Server *server, const UA_ReferenceTypeNode *node) {
     }
 
     UA_Array_delete(parents, parentsSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+
+    /* Paths with includeSubtypes can now match the new ReferenceType */
+    invalidateBrowsePathCache(server);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -1924,6 +1931,13 @@ deleteNodeSet(UA_Server *server, UA_Session *session,
         if(!member)
             continue;
         UA_NODESTORE_RELEASE(server, member);
+        invalidateBrowsePathCacheNode(server, &refTree->targets[i-1].nodeId);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+        /* The removed references can change the propagation of events */
+        for(size_t j = 0; j < member->head.referencesSize; j++)
+            invalidateEventSourceCache(server,
+                                       member->head.references[j].referenceTypeIndex);
+#endif
         if(removeTargetRefs)
             removeIncomingReferences(server, session, &member->head);
         UA_NODESTORE_REMOVE(server, &member->head.nodeId);
@@ -2092,6 +2106,16 @@ Operation_addReference(UA_Server *server, UA_Session *session, void *context,
     UA_Byte refTypeIndex = refType->referenceTypeNode.referenceTypeIndex;
     UA_NODESTORE_RELEASE(server, refType);
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* The reference can change the propagation of events */
+    invalidateEventSourceCache(server, refTypeIndex);
+#endif
+
+    /* The reference can change the resolution of browse paths */
+    invalidateBrowsePathCacheNode(server, &item->sourceNodeId);
+    if(UA_ExpandedNodeId_isLocal(&item->targetNodeId))
+        invalidateBrowsePathCacheNode(server, &item->targetNodeId.nodeId);
+
     /* Get the source and target node (editable). Include only the BrowseName
      * and the relevant ReferenceType and direction. Don't modify the target
      * node if it lives on a different server. */
@@ -2132,10 +2156,17 @@ Operation_addReference(UA_Server *server, UA_Session *session, void *context,
         return;
     }
 
-    /* Add the first direction */
-    UA_UInt32 targetNameHash = UA_QualifiedName_hash(&targetNode->head.browseName);
-    *retval = UA_Node_addReference(sourceNode, refTypeIndex, item->isForward,
-                                   &item->targetNodeId, targetNameHash);
+    /* Add the first direction. The BrowseName hash of remote targets is
+     * zero and their NodeClass is unknown. */
+    UA_UInt32 targetNameHash = 0;
+    UA_NodeClass targetNodeClass = UA_NODECLASS_UNSPECIFIED;
+    if(targetNode) {
+        targetNameHash = UA_QualifiedName_hash(&targetNode->head.browseName);
+        targetNodeClass = targetNode->head.nodeClass;
+    }
+    *retval = UA_Node_addReference_ex(sourceNode, refTypeIndex, item->isForward,
+                                      &item->targetNodeId, targetNameHash,
+                                      targetNodeClass);
     UA_Boolean firstExisted = false;
     if(*retval == UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED) {
         *retval = UA_STATUSCODE_GOOD;
@@ -2150,8 +2181,9 @@ Operation_addReference(UA_Server *server, UA_Session *session, void *context,
         UA_ExpandedNodeId_init(&expSourceId);
         expSourceId.nodeId = item->sourceNodeId;
         UA_UInt32 sourceNameHash = UA_QualifiedName_hash(&sourceNode->head.browseName);
-        *retval = UA_Node_addReference(targetNode, refTypeIndex, !item->isForward,
-                                       &expSourceId, sourceNameHash);
+        *retval = UA_Node_addReference_ex(targetNode, refTypeIndex, !item->isForward,
+                                          &expSourceId, sourceNameHash,
+                                          sourceNode->head.nodeClass);
 
         /* Second direction existed already */
         if(*retval == UA_STATUSCODE_BADDUPLICATEREFERENCENOTALLOWED) {
@@ -2254,6 +2286,16 @@ Operation_deleteReference(UA_Server *server, UA_Session *session, void *context,
     UA_Byte refTypeIndex = refType->referenceTypeNode.referenceTypeIndex;
     UA_NODESTORE_RELEASE(server, refType);
 
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* The reference can change the propagation of events */
+    invalidateEventSourceCache(server, refTypeIndex);
+#endif
+
+    /* The reference can change the resolution of browse paths */
+    invalidateBrowsePathCacheNode(server, &item->sourceNodeId);
+    if(UA_ExpandedNodeId_isLocal(&item->targetNodeId))
+        invalidateBrowsePathCacheNode(server, &item->targetNodeId.nodeId);
+
     // TODO: Check consistency constraints, remove the references.
 
     /* Delete the reference in this direction */
@@ -22,6 +22,11 @@
 
 #define UA_MAX_TREE_RECURSE 50 /* How deep up/down the tree do we recurse at most? */
 
+/* Browse responses are streamed above this estimated size. The estimate assumes
+ * an average encoded size for the ReferenceDescriptions. */
+#define UA_BROWSESTREAMING_MINSIZE (256 * 1024)
+#define UA_BROWSESTREAMING_REFSIZE 64
+
 static UA_UInt32
 resultMask2AttributesMask(UA_UInt32 resultMask) {
     UA_UInt32 result = 0;
@@ -184,29 +189,21 @@ isNodeInTree_singleRef(UA_Server *server, const UA_NodeId *leafNode,
     return isNodeInTree(server, leafNode, nodeToFind, &reftypes);
 }
 
-static enum ZIP_CMP
-cmpTarget(const void *a, const void *b) {
-    const RefEntry *aa = (const RefEntry*)a;
-    const RefEntry *bb = (const RefEntry*)b;
-    if(aa->targetHash < bb->targetHash)
-        return ZIP_CMP_LESS;
-    if(aa->targetHash > bb->targetHash)
-        return ZIP_CMP_MORE;
-    return (enum ZIP_CMP)UA_ExpandedNodeId_order(aa->target, bb->target);
-}
-
-ZIP_FUNCTIONS(RefHead, RefEntry, zipfields, RefEntry, zipfields, cmpTarget)
+#define REFTREE_SLOTS(rt)                                               \
+    ((RefSlot*)((uintptr_t)(rt)->targets +                              \
+                (sizeof(UA_ExpandedNodeId) * (rt)->capacity)))
 
 UA_StatusCode
 RefTree_init(RefTree *rt) {
     rt->size = 0;
     rt->capacity = 0;
-    ZIP_INIT(&rt->head);
-    size_t space = (sizeof(UA_ExpandedNodeId) + sizeof(RefEntry)) * UA_REFTREE_INITIAL_SIZE;
+    size_t space = (sizeof(UA_ExpandedNodeId) + (2 * sizeof(RefSlot))) *
+        UA_REFTREE_INITIAL_SIZE;
     rt->targets = (UA_ExpandedNodeId*)UA_malloc(space);
     if(!rt->targets)
         return UA_STATUSCODE_BADOUTOFMEMORY;
     rt->capacity = UA_REFTREE_INITIAL_SIZE;
+    memset(REFTREE_SLOTS(rt), 0, 2 * sizeof(RefSlot) * rt->capacity);
     return UA_STATUSCODE_GOOD;
 }
 
@@ -218,33 +215,54 @@ RefTree_clear(RefTree *rt) {
         UA_free(rt->targets);
 }
 
+/* Returns the slot with the target or the empty slot where it can be inserted.
+ * The capacity is a power of two and the index is never full. */
+static RefSlot *
+RefTree_findSlot(const RefTree *rt, const UA_ExpandedNodeId *target,
+                 UA_UInt32 targetHash) {
+    RefSlot *slots = REFTREE_SLOTS(rt);
+    size_t mask = (2 * rt->capacity) - 1;
+    for(size_t i = targetHash & mask; ; i = (i + 1) & mask) {
+        RefSlot *slot = &slots[i];
+        if(slot->index == 0)
+            return slot;
+        if(slot->targetHash == targetHash &&
+           UA_ExpandedNodeId_equal(&rt->targets[slot->index - 1], target))
+            return slot;
+    }
+}
+
 /* Double the capacity of the reftree */
 static UA_StatusCode UA_FUNC_ATTR_WARN_UNUSED_RESULT
 RefTree_double(RefTree *rt) {
     size_t capacity = rt->capacity * 2;
     UA_assert(capacity > 0);
-    size_t space = (sizeof(UA_ExpandedNodeId) + sizeof(RefEntry)) * capacity;
+    if(capacity > UA_UINT32_MAX)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    size_t space = (sizeof(UA_ExpandedNodeId) + (2 * sizeof(RefSlot))) * capacity;
     UA_ExpandedNodeId *newTargets = (UA_ExpandedNodeId*)UA_realloc(rt->targets, space);
     if(!newTargets)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
-    /* Move the entries to the new location  */
-    RefEntry *reArray = (RefEntry*)
-        ((uintptr_t)newTargets + (capacity * sizeof(UA_ExpandedNodeId)));
-    RefEntry *oldReArray = (RefEntry*)
+    /* The old index lies behind the old targets and ends before the new index
+     * begins. So the entries can be rehashed from their stored hash without
+     * an intermediate copy. */
+    size_t oldSlotsSize = 2 * rt->capacity;
+    RefSlot *oldSlots = (RefSlot*)
         ((uintptr_t)newTargets + (rt->capacity * sizeof(UA_ExpandedNodeId)));
-    memmove(reArray, oldReArray, rt->size * sizeof(RefEntry));
-
-    /* Reinsert all entries into the tree. The new pointer location has changed
-     * their ziptree rank. */
-    rt->head.root = NULL;
-    for(size_t i = 0; i < rt->size; i++) {
-        reArray[i].target = &newTargets[i];
-        ZIP_INSERT(RefHead, &rt->head, &reArray[i]);
-    }
-
-    rt->capacity = capacity;
     rt->targets = newTargets;
+    rt->capacity = capacity;
+    RefSlot *slots = REFTREE_SLOTS(rt);
+    memset(slots, 0, 2 * sizeof(RefSlot) * capacity);
+    size_t mask = (2 * capacity) - 1;
+    for(size_t i = 0; i < oldSlotsSize; i++) {
+        if(oldSlots[i].index == 0)
+            continue;
+        size_t j = oldSlots[i].targetHash & mask;
+        while(slots[j].index != 0)
+            j = (j + 1) & mask;
+        slots[j] = oldSlots[i];
+    }
     return UA_STATUSCODE_GOOD;
 }
 
@@ -253,32 +271,28 @@ RefTree_add(RefTree *rt, UA_NodePointer target, UA_Boolean *duplicate) {
     UA_ExpandedNodeId en = UA_NodePointer_toExpandedNodeId(target);
 
     /* Is the target already in the tree? */
-    RefEntry dummy;
-    memset(&dummy, 0, sizeof(RefEntry));
-    dummy.target = &en;
-    dummy.targetHash = UA_ExpandedNodeId_hash(&en);
-    if(ZIP_FIND(RefHead, &rt->head, &dummy)) {
+    UA_UInt32 targetHash = UA_ExpandedNodeId_hash(&en);
+    RefSlot *slot = RefTree_findSlot(rt, &en, targetHash);
+    if(slot->index != 0) {
         if(duplicate)
             *duplicate = true;
         return UA_STATUSCODE_GOOD;
     }
 
+    /* Grow the tree. This invalidates the slot. */
     UA_StatusCode s = UA_STATUSCODE_GOOD;
     if(rt->capacity <= rt->size) {
         s = RefTree_double(rt);
         if(s != UA_STATUSCODE_GOOD)
             return s;
+        slot = RefTree_findSlot(rt, &en, targetHash);
     }
     s = UA_ExpandedNodeId_copy(&en, &rt->targets[rt->size]);
     if(s != UA_STATUSCODE_GOOD)
         return s;
-    RefEntry *re = (RefEntry*)((uintptr_t)rt->targets +
-                               (sizeof(UA_ExpandedNodeId) * rt->capacity) +
-                               (sizeof(RefEntry) * rt->size));
-    re->target = &rt->targets[rt->size];
-    re->targetHash = dummy.targetHash;
-    ZIP_INSERT(RefHead, &rt->head, re);
     rt->size++;
+    slot->targetHash = targetHash;
+    slot->index = (UA_UInt32)rt->size;
     return UA_STATUSCODE_GOOD;
 }
 
@@ -290,10 +304,8 @@ RefTree_addNodeId(RefTree *rt, const UA_NodeId *target,
 
 UA_Boolean
 RefTree_contains(RefTree *rt, const UA_ExpandedNodeId *target) {
-    RefEntry dummy;
-    dummy.target = target;
-    dummy.targetHash = UA_ExpandedNodeId_hash(target);
-    return !!ZIP_FIND(RefHead, &rt->head, &dummy);
+    UA_UInt32 targetHash = UA_ExpandedNodeId_hash(target);
+    return (RefTree_findSlot(rt, target, targetHash)->index != 0);
 }
 
 UA_Boolean
@@ -335,6 +347,17 @@ browseRecursiveCallback(void *context, UA_ReferenceTarget *t) {
         return (brc->status == UA_STATUSCODE_GOOD) ? NULL : (void*)0x01;
     }
 
+    /* The target was already added and expanded. The NodeClass stored in the
+     * reference shows whether it would be added again. Then we can skip it
+     * without getting the node from the NodeStore. */
+    if(brc->depth > 0 && t->targetNodeClass != UA_NODECLASS_UNSPECIFIED &&
+       (brc->nodeClassMask == UA_NODECLASS_UNSPECIFIED ||
+        (t->targetNodeClass & brc->nodeClassMask) != 0)) {
+        UA_ExpandedNodeId en = UA_NodePointer_toExpandedNodeId(t->targetId);
+        if(RefTree_contains(brc->rt, &en))
+            return NULL;
+    }
+
     /* We only look at the NodeClass attribute and a subset of the references.
      * Get a node with only these elements if the NodeStore supports that. */
     const UA_Node *node =
@@ -402,6 +425,7 @@ browseRecursive(UA_Server *server, size_t startNodesSize, const UA_NodeId *start
 
     for(size_t i = 0; i < startNodesSize && brc.status == UA_STATUSCODE_GOOD; i++) {
         UA_ReferenceTarget target;
+        memset(&target, 0, sizeof(UA_ReferenceTarget));
         target.targetId = UA_NodePointer_fromNodeId(&startNodes[i]);
 
         /* Call the inner recursive browse separately for the search direction.
@@ -534,25 +558,61 @@ struct BrowseContext {
     RefResult rr;
     UA_StatusCode status;
     UA_Boolean done;
+
+    /* Streaming mode (see Service_BrowseStreaming). The references are only
+     * counted or encoded directly into the message. rr.size is the number of
+     * references and rr.descr is not used. */
+    UA_Boolean countOnly;
+    UA_MessageContext *mc;
 };
 
-/* Target node on top of the stack */
+static void *
+returnFirstTarget(void *context, UA_ReferenceTarget *t) {
+    (void)context;
+    return UA_NodePointer_isLocal(t->targetId) ? t : NULL;
+}
+
+/* Copy the target of the HasTypeDefinition reference. The type node itself is
+ * not looked up. */
+static UA_StatusCode
+copyTypeDefinitionId(const UA_NodeHead *head, UA_ExpandedNodeId *typeDefinition) {
+    for(size_t i = 0; i < head->referencesSize; ++i) {
+        UA_NodeReferenceKind *rk = &head->references[i];
+        if(rk->isInverse ||
+           rk->referenceTypeIndex != UA_REFERENCETYPEINDEX_HASTYPEDEFINITION)
+            continue;
+        const UA_ReferenceTarget *t = (const UA_ReferenceTarget*)
+            UA_NodeReferenceKind_iterate(rk, returnFirstTarget, NULL);
+        if(!t)
+            continue;
+        UA_NodeId typeId = UA_NodePointer_toNodeId(t->targetId);
+        return UA_NodeId_copy(&typeId, &typeDefinition->nodeId);
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
 static UA_StatusCode
 addReferenceDescription(struct BrowseContext *bc, UA_NodePointer nodeP,
                         const UA_Node *curr) {
     UA_assert(curr);
     UA_BrowseDescription *bd = &bc->cp->browseDescription;
 
-    /* Ensure capacity is left */
+    /* Ensure capacity is left. In streaming mode the description is encoded
+     * and cleared right away. */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    if(bc->rr.size >= bc->rr.capacity) {
-        res = RefResult_double(&bc->rr);
-        if(res != UA_STATUSCODE_GOOD)
-           return res;
+    UA_ReferenceDescription streamDescr;
+    UA_ReferenceDescription *descr = &streamDescr;
+    if(bc->mc) {
+        UA_ReferenceDescription_init(&streamDescr);
+    } else {
+        if(bc->rr.size >= bc->rr.capacity) {
+            res = RefResult_double(&bc->rr);
+            if(res != UA_STATUSCODE_GOOD)
+                return res;
+        }
+        descr = &bc->rr.descr[bc->rr.size];
     }
 
-    UA_ReferenceDescription *descr = &bc->rr.descr[bc->rr.size];
-
     /* Fields without access to the actual node */
     UA_ExpandedNodeId en = UA_NodePointer_toExpandedNodeId(nodeP);
     res = UA_ExpandedNodeId_copy(&en, &descr->nodeId);
@@ -580,21 +640,20 @@ addReferenceDescription(struct BrowseContext *bc, UA_NodePointer nodeP,
 
     if(bd->resultMask & UA_BROWSERESULTMASK_TYPEDEFINITION) {
         if(curr->head.nodeClass == UA_NODECLASS_OBJECT ||
-           curr->head.nodeClass == UA_NODECLASS_VARIABLE) {
-            const UA_Node *type = getNodeType(bc->server, &curr->head);
-            if(type) {
-                res |= UA_NodeId_copy(&type->head.nodeId,
-                                      &descr->typeDefinition.nodeId);
-                UA_NODESTORE_RELEASE(bc->server, type);
-            }
-        }
+           curr->head.nodeClass == UA_NODECLASS_VARIABLE)
+            res |= copyTypeDefinitionId(&curr->head, &descr->typeDefinition);
     }
 
+    /* Encode into the message */
+    if(bc->mc && res == UA_STATUSCODE_GOOD)
+        res = UA_MessageContext_encode(bc->mc, descr,
+                                       &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]);
+
     /* Clean up and return */
-    if(res != UA_STATUSCODE_GOOD) {
+    if(res != UA_STATUSCODE_GOOD || bc->mc)
         UA_ReferenceDescription_clear(descr);
+    if(res != UA_STATUSCODE_GOOD)
         return res;
-    }
     bc->rr.size++;
     return UA_STATUSCODE_GOOD;
 }
@@ -608,23 +667,30 @@ browseReferencTargetCallback(void *context, UA_ReferenceTarget *t) {
     /* Remote references are ignored */
     if(!UA_NodePointer_isLocal(t->targetId))
         return NULL;
-    
-    /* Get the node. Include only the ReferenceTypes we are interested in,
-     * including those for figuring out the TypeDefinition (if that was
-     * requested). */
+
+    /* Filter with the NodeClass stored in the reference target. Targets that
+     * do not match are skipped without getting them from the Nodestore. */
+    if(t->targetNodeClass != UA_NODECLASS_UNSPECIFIED && bd->nodeClassMask != 0 &&
+       (t->targetNodeClass & bd->nodeClassMask) == 0)
+        return NULL;
+
+    /* Get the node. This also skips references to nodes that were deleted
+     * without their references. Include only the ReferenceTypes we are
+     * interested in, including those for figuring out the TypeDefinition (if
+     * that was requested). */
     const UA_Node *target =
         UA_NODESTORE_GETFROMREF_SELECTIVE(bc->server, t->targetId,
                                           resultMask2AttributesMask(bd->resultMask),
                                           bc->resultRefs, bd->browseDirection);
     if(!target)
         return NULL;
-    
+
     /* The node class has to match */
     if(!matchClassMask(target, bd->nodeClassMask)) {
         UA_NODESTORE_RELEASE(bc->server, target);
         return NULL;
     }
-    
+
     /* Reached maxrefs. Return the "abort" signal. */
     if(bc->rr.size >= cp->maxReferences) {
         UA_NODESTORE_RELEASE(bc->server, target);
@@ -632,7 +698,10 @@ browseReferencTargetCallback(void *context, UA_ReferenceTarget *t) {
     }
 
     /* Create the reference description */
-    bc->status = addReferenceDescription(bc, t->targetId, target);
+    if(bc->countOnly)
+        bc->rr.size++;
+    else
+        bc->status = addReferenceDescription(bc, t->targetId, target);
 
     /* Release the node */
     UA_NODESTORE_RELEASE(bc->server, target);
@@ -823,78 +892,61 @@ browse(struct BrowseContext *bc) {
     }
 }
 
-/* Start to browse with no previous cp */
-void
-Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxrefs,
-                 const UA_BrowseDescription *descr, UA_BrowseResult *result) {
-    /* Stack-allocate a temporary cp */
-    ContinuationPoint cp;
-    memset(&cp, 0, sizeof(ContinuationPoint));
-    cp.maxReferences = *maxrefs;
-    cp.browseDescription = *descr; /* Shallow copy. Deep-copy later if we persist the cp. */
+/* Prepare the temporary cp and the context to start browsing */
+static UA_StatusCode
+initBrowse(UA_Server *server, UA_Session *session, UA_UInt32 maxrefs,
+           const UA_BrowseDescription *descr, ContinuationPoint *cp,
+           struct BrowseContext *bc) {
+    memset(cp, 0, sizeof(ContinuationPoint));
+    cp->maxReferences = maxrefs;
+    cp->browseDescription = *descr; /* Shallow copy. Deep-copy later if we
+                                     * persist the cp. */
 
     /* How many references can we return at most? */
-    if(cp.maxReferences == 0) {
+    if(cp->maxReferences == 0) {
         if(server->config.maxReferencesPerNode != 0) {
-            cp.maxReferences = server->config.maxReferencesPerNode;
+            cp->maxReferences = server->config.maxReferencesPerNode;
         } else {
-            cp.maxReferences = UA_INT32_MAX;
+            cp->maxReferences = UA_INT32_MAX;
         }
     } else {
         if(server->config.maxReferencesPerNode != 0 &&
-           cp.maxReferences > server->config.maxReferencesPerNode) {
-            cp.maxReferences= server->config.maxReferencesPerNode;
+           cp->maxReferences > server->config.maxReferencesPerNode) {
+            cp->maxReferences= server->config.maxReferencesPerNode;
         }
     }
 
     /* Get the list of relevant reference types */
-    result->statusCode =
+    UA_StatusCode res =
         referenceTypeIndices(server, &descr->referenceTypeId,
-                             &cp.relevantReferences, descr->includeSubtypes);
-    if(result->statusCode != UA_STATUSCODE_GOOD)
-        return;
+                             &cp->relevantReferences, descr->includeSubtypes);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
 
     /* Prepare the context */
-    struct BrowseContext bc;
-    bc.cp = &cp;
-    bc.server = server;
-    bc.session = session;
-    bc.status = UA_STATUSCODE_GOOD;
-    bc.done = false;
-    bc.activeCP = false;
-    bc.resultRefs = cp.relevantReferences;
-    if(cp.browseDescription.resultMask & UA_BROWSERESULTMASK_TYPEDEFINITION) {
+    memset(bc, 0, sizeof(struct BrowseContext));
+    bc->cp = cp;
+    bc->server = server;
+    bc->session = session;
+    bc->status = UA_STATUSCODE_GOOD;
+    bc->resultRefs = cp->relevantReferences;
+    if(cp->browseDescription.resultMask & UA_BROWSERESULTMASK_TYPEDEFINITION) {
         /* Get the node with additional reference types if we need to lookup the
          * TypeDefinition */
-        bc.resultRefs = UA_ReferenceTypeSet_union(bc.resultRefs,
+        bc->resultRefs = UA_ReferenceTypeSet_union(bc->resultRefs,
               UA_ReferenceTypeSet_union(UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASTYPEDEFINITION),
                                         UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE)));
     }
-    result->statusCode = RefResult_init(&bc.rr);
-    if(result->statusCode != UA_STATUSCODE_GOOD)
-        return;
-
-    /* Perform the browse */
-    browse(&bc);
-
-    if(bc.status != UA_STATUSCODE_GOOD || bc.rr.size == 0) {
-        /* No relevant references, return array of length zero */
-        RefResult_clear(&bc.rr);
-        result->references = (UA_ReferenceDescription*)UA_EMPTY_ARRAY_SENTINEL;
-        result->statusCode = bc.status;
-        return;
-    }
-
-    /* Move results */
-    result->references = bc.rr.descr;
-    result->referencesSize = bc.rr.size;
-
-    /* Exit early if done */
-    if(bc.done)
-        return;
-
-    /* Persist the continuation point */
+    return UA_STATUSCODE_GOOD;
+}
 
+/* Persist the continuation point in the session after the browse was stopped at
+ * cp->lastTarget. The deep copy of the lastTarget is moved into the persisted
+ * cp. */
+static UA_StatusCode
+persistContinuationPoint(UA_Session *session, ContinuationPoint *cp,
+                         const UA_BrowseDescription *descr,
+                         UA_ByteString *identifier) {
     ContinuationPoint *cp2 = NULL;
     UA_Guid *ident = NULL;
     UA_StatusCode retval = UA_STATUSCODE_GOOD;
@@ -916,12 +968,12 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     retval = UA_BrowseDescription_copy(descr, &cp2->browseDescription);
     if(retval != UA_STATUSCODE_GOOD)
         goto cleanup;
-    cp2->maxReferences = cp.maxReferences;
-    cp2->relevantReferences = cp.relevantReferences;
-    cp2->lastTarget = cp.lastTarget; /* Move the (deep) copy */
-    UA_NodePointer_init(&cp.lastTarget); /* No longer clear below (cleanup) */
-    cp2->lastRefKindIndex = cp.lastRefKindIndex;
-    cp2->lastRefInverse = cp.lastRefInverse;
+    cp2->maxReferences = cp->maxReferences;
+    cp2->relevantReferences = cp->relevantReferences;
+    cp2->lastTarget = cp->lastTarget; /* Move the (deep) copy */
+    UA_NodePointer_init(&cp->lastTarget); /* No longer clear below (cleanup) */
+    cp2->lastRefKindIndex = cp->lastRefKindIndex;
+    cp2->lastRefInverse = cp->lastRefInverse;
 
     /* Create a random bytestring via a Guid */
     ident = UA_Guid_new();
@@ -934,7 +986,7 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     cp2->identifier.length = sizeof(UA_Guid);
 
     /* Return the cp identifier */
-    retval = UA_ByteString_copy(&cp2->identifier, &result->continuationPoint);
+    retval = UA_ByteString_copy(&cp2->identifier, identifier);
     if(retval != UA_STATUSCODE_GOOD)
         goto cleanup;
 
@@ -942,35 +994,81 @@ Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxref
     cp2->next = session->continuationPoints;
     session->continuationPoints = cp2;
     --session->availableContinuationPoints;
-    return;
+    return UA_STATUSCODE_GOOD;
 
  cleanup:
     if(cp2) {
         ContinuationPoint_clear(cp2);
         UA_free(cp2);
     }
-    UA_NodePointer_clear(&cp.lastTarget);
-    UA_BrowseResult_clear(result);
-    result->statusCode = retval;
+    UA_NodePointer_clear(&cp->lastTarget);
+    return retval;
 }
 
-void Service_Browse(UA_Server *server, UA_Session *session,
-                    const UA_BrowseRequest *request, UA_BrowseResponse *response) {
-    UA_LOG_DEBUG_SESSION(server->config.logging, session, "Processing BrowseRequest");
-    UA_LOCK_ASSERT(&server->serviceMutex);
+/* Start to browse with no previous cp */
+void
+Operation_Browse(UA_Server *server, UA_Session *session, const UA_UInt32 *maxrefs,
+                 const UA_BrowseDescription *descr, UA_BrowseResult *result) {
+    /* Stack-allocate a temporary cp */
+    ContinuationPoint cp;
+    struct BrowseContext bc;
+    result->statusCode = initBrowse(server, session, *maxrefs, descr, &cp, &bc);
+    if(result->statusCode != UA_STATUSCODE_GOOD)
+        return;
+    result->statusCode = RefResult_init(&bc.rr);
+    if(result->statusCode != UA_STATUSCODE_GOOD)
+        return;
 
-    /* Test the number of operations in the request */
-    if(server->config.maxNodesPerBrowse != 0 &&
-       request->nodesToBrowseSize > server->config.maxNodesPerBrowse) {
-        response->responseHeader.serviceResult = UA_STATUSCODE_BADTOOMANYOPERATIONS;
+    /* Perform the browse */
+    browse(&bc);
+
+    if(bc.status != UA_STATUSCODE_GOOD || bc.rr.size == 0) {
+        /* No relevant references, return array of length zero */
+        RefResult_clear(&bc.rr);
+        result->references = (UA_ReferenceDescription*)UA_EMPTY_ARRAY_SENTINEL;
+        result->statusCode = bc.status;
         return;
     }
 
-    /* No views supported at the moment */
-    if(!UA_NodeId_isNull(&request->view.viewId)) {
-        response->responseHeader.serviceResult = UA_STATUSCODE_BADVIEWIDUNKNOWN;
+    /* Move results */
+    result->references = bc.rr.descr;
+    result->referencesSize = bc.rr.size;
+
+    /* Exit early if done */
+    if(bc.done)
         return;
+
+    /* Persist the continuation point */
+    UA_StatusCode retval =
+        persistContinuationPoint(session, &cp, descr, &result->continuationPoint);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_BrowseResult_clear(result);
+        result->statusCode = retval;
     }
+}
+
+static UA_StatusCode
+checkBrowseRequest(UA_Server *server, const UA_BrowseRequest *request) {
+    /* Test the number of operations in the request */
+    if(server->config.maxNodesPerBrowse != 0 &&
+       request->nodesToBrowseSize > server->config.maxNodesPerBrowse)
+        return UA_STATUSCODE_BADTOOMANYOPERATIONS;
+
+    /* No views supported at the moment */
+    if(!UA_NodeId_isNull(&request->view.viewId))
+        return UA_STATUSCODE_BADVIEWIDUNKNOWN;
+
+    return UA_STATUSCODE_GOOD;
+}
+
+void Service_Browse(UA_Server *server, UA_Session *session,
+                    const UA_BrowseRequest *request, UA_BrowseResponse *response) {
+    UA_LOG_DEBUG_SESSION(server->config.logging, session, "Processing BrowseRequest");
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    response->responseHeader.serviceResult = checkBrowseRequest(server, request);
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+        return;
 
     response->responseHeader.serviceResult =
         UA_Server_processServiceOperations(server, session,
@@ -982,6 +1080,210 @@ void Service_Browse(UA_Server *server, UA_Session *session,
                                            &UA_TYPES[UA_TYPES_BROWSERESULT]);
 }
 
+/* Encode the BrowseResult fields before the references */
+static UA_StatusCode
+encodeBrowseResultHead(UA_MessageContext *mc, UA_StatusCode status,
+                       const UA_ByteString *continuationPoint,
+                       UA_Int32 referencesSize) {
+    UA_StatusCode res =
+        UA_MessageContext_encode(mc, &status, &UA_TYPES[UA_TYPES_STATUSCODE]);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    res = UA_MessageContext_encode(mc, continuationPoint, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    return UA_MessageContext_encode(mc, &referencesSize, &UA_TYPES[UA_TYPES_INT32]);
+}
+
+/* Upper bound for the number of references in the BrowseResult. Only the
+ * sizes of the matching ReferenceKinds are added up. The targets are not
+ * visited. */
+static size_t
+browseResultUpperBound(UA_Server *server, const UA_BrowseDescription *descr) {
+    UA_ReferenceTypeSet refs;
+    UA_StatusCode res = referenceTypeIndices(server, &descr->referenceTypeId,
+                                             &refs, descr->includeSubtypes);
+    if(res != UA_STATUSCODE_GOOD)
+        return 0;
+    const UA_Node *node =
+        UA_NODESTORE_GET_SELECTIVE(server, &descr->nodeId, UA_NODEATTRIBUTESMASK_NONE,
+                                   refs, descr->browseDirection);
+    if(!node)
+        return 0;
+    size_t bound = 0;
+    for(size_t i = 0; i < node->head.referencesSize; i++) {
+        const UA_NodeReferenceKind *rk = &node->head.references[i];
+        if(rk->isInverse && descr->browseDirection == UA_BROWSEDIRECTION_FORWARD)
+            continue;
+        if(!rk->isInverse && descr->browseDirection == UA_BROWSEDIRECTION_INVERSE)
+            continue;
+        if(!UA_ReferenceTypeSet_contains(&refs, rk->referenceTypeIndex))
+            continue;
+        bound += rk->targetsSize;
+    }
+    UA_NODESTORE_RELEASE(server, node);
+    return bound;
+}
+
+/* Result of the counting pass for one BrowseDescription */
+typedef struct {
+    UA_StatusCode status;
+    UA_Int32 referencesSize;
+} BrowseCount;
+
+/* Count the references without creating the ReferenceDescriptions. Returns
+ * false if the result would need a continuation point. */
+static UA_Boolean
+countBrowseResult(UA_Server *server, UA_Session *session, UA_UInt32 maxrefs,
+                  const UA_BrowseDescription *descr, BrowseCount *count) {
+    ContinuationPoint cp;
+    struct BrowseContext bc;
+    count->referencesSize = -1;
+    count->status = initBrowse(server, session, maxrefs, descr, &cp, &bc);
+    if(count->status != UA_STATUSCODE_GOOD)
+        return true;
+    bc.countOnly = true;
+    browse(&bc);
+    UA_NodePointer_clear(&cp.lastTarget);
+    count->status = bc.status;
+    count->referencesSize = 0;
+    if(bc.status != UA_STATUSCODE_GOOD || bc.rr.size == 0)
+        return true;
+    count->referencesSize = (UA_Int32)bc.rr.size;
+    return bc.done;
+}
+
+/* Encode the BrowseResult with the references as they are created. The
+ * counting pass used the same filter and the server is locked in between. So
+ * both passes see the same references. */
+static UA_StatusCode
+encodeBrowseResult(UA_Server *server, UA_Session *session, UA_UInt32 maxrefs,
+                   const UA_BrowseDescription *descr, const BrowseCount *count,
+                   UA_MessageContext *mc) {
+    UA_StatusCode res = encodeBrowseResultHead(mc, count->status, &UA_BYTESTRING_NULL,
+                                               count->referencesSize);
+    if(res != UA_STATUSCODE_GOOD || count->referencesSize <= 0)
+        return res;
+
+    /* Encode the references. Stop after the counted references. */
+    ContinuationPoint cp;
+    struct BrowseContext bc;
+    res = initBrowse(server, session, maxrefs, descr, &cp, &bc);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    cp.maxReferences = (UA_UInt32)count->referencesSize;
+    bc.mc = mc;
+    browse(&bc);
+    UA_NodePointer_clear(&cp.lastTarget);
+    if(bc.status != UA_STATUSCODE_GOOD)
+        return bc.status;
+    return (bc.rr.size == (size_t)count->referencesSize) ?
+        UA_STATUSCODE_GOOD : UA_STATUSCODE_BADINTERNALERROR;
+}
+
+UA_Boolean
+Service_BrowseStreaming(UA_Server *server, UA_SecureChannel *channel,
+                        UA_Session *session, const UA_BrowseRequest *request,
+                        UA_UInt32 requestId) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    /* Errors in the request are answered by the regular Browse service */
+    if(checkBrowseRequest(server, request) != UA_STATUSCODE_GOOD ||
+       request->nodesToBrowseSize == 0 ||
+       request->nodesToBrowseSize > UA_INT32_MAX)
+        return false;
+
+    /* Streaming walks the references twice and sends the chunks while the
+     * server is locked. Only stream if the estimated response is large. First
+     * check an upper bound that does not visit the targets. */
+    size_t estimate = 0;
+    for(size_t i = 0; i < request->nodesToBrowseSize; i++)
+        estimate += browseResultUpperBound(server, &request->nodesToBrowse[i]) *
+            UA_BROWSESTREAMING_REFSIZE;
+    if(estimate < UA_BROWSESTREAMING_MINSIZE)
+        return false;
+
+    BrowseCount *counts = (BrowseCount*)
+        UA_malloc(sizeof(BrowseCount) * request->nodesToBrowseSize);
+    if(!counts)
+        return false;
+
+    /* Count the references. Do not stream if a continuation point is needed. */
+    UA_MessageContext mc;
+    UA_Boolean sent = false;
+    UA_StatusCode res = UA_STATUSCODE_GOOD;
+    estimate = 0;
+    for(size_t i = 0; i < request->nodesToBrowseSize; i++) {
+        if(!countBrowseResult(server, session, request->requestedMaxReferencesPerNode,
+                              &request->nodesToBrowse[i], &counts[i]))
+            goto cleanup;
+        if(counts[i].referencesSize > 0)
+            estimate += (size_t)counts[i].referencesSize * UA_BROWSESTREAMING_REFSIZE;
+    }
+    if(estimate < UA_BROWSESTREAMING_MINSIZE)
+        goto cleanup;
+
+    UA_LOG_DEBUG_SESSION(server->config.logging, session,
+                         "Processing BrowseRequest (streaming)");
+
+    /* Start the message context */
+    res = UA_MessageContext_begin(&mc, channel, requestId, UA_MESSAGETYPE_MSG);
+    if(res != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
+    /* Encode the response type and the ResponseHeader */
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_ResponseHeader rh;
+    UA_ResponseHeader_init(&rh);
+    rh.requestHandle = request->requestHeader.requestHandle;
+    rh.timestamp = el->dateTime_now(el);
+    res = UA_MessageContext_encode(&mc, &UA_TYPES[UA_TYPES_BROWSERESPONSE].binaryEncodingId,
+                                   &UA_TYPES[UA_TYPES_NODEID]);
+    if(res != UA_STATUSCODE_GOOD)
+        goto error;
+    res = UA_MessageContext_encode(&mc, &rh, &UA_TYPES[UA_TYPES_RESPONSEHEADER]);
+    if(res != UA_STATUSCODE_GOOD)
+        goto error;
+
+    /* Encode the results while browsing */
+    UA_Int32 resultsSize = (UA_Int32)request->nodesToBrowseSize;
+    res = UA_MessageContext_encode(&mc, &resultsSize, &UA_TYPES[UA_TYPES_INT32]);
+    if(res != UA_STATUSCODE_GOOD)
+        goto error;
+    for(size_t i = 0; i < request->nodesToBrowseSize; i++) {
+        res = encodeBrowseResult(server, session, request->requestedMaxReferencesPerNode,
+                                 &request->nodesToBrowse[i], &counts[i], &mc);
+        if(res != UA_STATUSCODE_GOOD)
+            goto error;
+    }
+
+    /* No DiagnosticInfos */
+    UA_Int32 diagnosticInfosSize = -1;
+    res = UA_MessageContext_encode(&mc, &diagnosticInfosSize, &UA_TYPES[UA_TYPES_INT32]);
+    if(res != UA_STATUSCODE_GOOD)
+        goto error;
+
+    /* Send out the last chunk. The context is cleaned up also if this fails.
+     * Then the channel is closing and nothing more can be sent. */
+    UA_MessageContext_finish(&mc);
+    sent = true;
+    goto cleanup;
+
+ error:
+    /* If chunks were sent, the abort chunk is the final answer to the request.
+     * Otherwise the response is created in memory and sent instead. */
+    sent = (mc.chunksSoFar > 0);
+    UA_LOG_WARNING_SESSION(server->config.logging, session,
+                           "Could not stream the BrowseResponse with StatusCode %s",
+                           UA_StatusCode_name(res));
+    UA_String reason = UA_STRING("Streaming the BrowseResponse failed");
+    UA_MessageContext_sendAbort(&mc, res, &reason);
+
+ cleanup:
+    UA_free(counts);
+    return sent;
+}
+
 UA_BrowseResult
 UA_Server_browse(UA_Server *server, UA_UInt32 maxReferences,
                  const UA_BrowseDescription *bd) {
@@ -1020,6 +1322,7 @@ Operation_BrowseNext(UA_Server *server, UA_Session *session,
 
     /* Prepare the context */
     struct BrowseContext bc;
+    memset(&bc, 0, sizeof(struct BrowseContext));
     bc.cp = cp;
     bc.server = server;
     bc.session = session;
@@ -1115,6 +1418,24 @@ addBrowseHashTarget(void *context, UA_ReferenceTargetTreeElem *elem) {
     return (void*)(uintptr_t)RefTree_add(next, elem->target.targetId, NULL);
 }
 
+/* Remote targets have the BrowseName hash zero. They cannot be filtered by
+ * their BrowseName and are added in addition to the hash matches. */
+static void *
+addRemoteHashTarget(void *context, UA_ReferenceTargetTreeElem *elem) {
+    if(UA_NodePointer_isLocal(elem->target.targetId))
+        return NULL;
+    RefTree *next = (RefTree*)context;
+    return (void*)(uintptr_t)RefTree_add(next, elem->target.targetId, NULL);
+}
+
+/* Remote targets are always candidates. Their BrowseName is unknown. */
+static UA_Boolean
+matchBrowseNameHash(const UA_ReferenceTarget *target, UA_UInt32 browseNameHash) {
+    if(target->targetNameHash == browseNameHash)
+        return true;
+    return (target->targetNameHash == 0 && !UA_NodePointer_isLocal(target->targetId));
+}
+
 static UA_StatusCode
 walkBrowsePathElement(UA_Server *server, UA_Session *session,
                       const UA_RelativePath *path, const size_t pathIndex,
@@ -1184,6 +1505,8 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
         /* Loop over the ReferenceKinds */
         UA_ReferenceTarget targetHashKey;
         targetHashKey.targetNameHash = browseNameHash;
+        UA_ReferenceTarget remoteHashKey;
+        remoteHashKey.targetNameHash = 0;
         for(size_t j = 0; j < node->head.referencesSize; j++) {
             UA_NodeReferenceKind *rk = &node->head.references[j];
 
@@ -1207,12 +1530,19 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
                                  &targetHashKey, addBrowseHashTarget, next);
                 if(res != UA_STATUSCODE_GOOD)
                     break;
+                if(browseNameHash != 0) {
+                    res = (UA_StatusCode)(uintptr_t)
+                        ZIP_ITER_KEY(UA_ReferenceNameTree,
+                                     (UA_ReferenceNameTree*)&rk->targets.tree.nameRoot,
+                                     &remoteHashKey, addRemoteHashTarget, next);
+                    if(res != UA_STATUSCODE_GOOD)
+                        break;
+                }
             } else {
-                /* The array entries don't have a BrowseName hash. Add all of
-                 * them at this level to be checked with a full string
-                 * comparison. */
+                /* Linear search in the array. The full BrowseName is checked
+                 * in the next iteration. */
                 for(size_t k = 0; k < rk->targetsSize; k++) {
-                    if(rk->targets.array[k].targetNameHash != browseNameHash)
+                    if(!matchBrowseNameHash(&rk->targets.array[k], browseNameHash))
                         continue;
                     res = RefTree_add(next, rk->targets.array[k].targetId, NULL);
                     if(res != UA_STATUSCODE_GOOD)
@@ -1228,13 +1558,200 @@ walkBrowsePathElement(UA_Server *server, UA_Session *session,
     return res;
 }
 
+/* Browse Path Cache
+ * ~~~~~~~~~~~~~~~~~
+ * The resolved browse paths are cached with the generation of every visited
+ * node. Adding and deleting nodes or references increments the generation of
+ * the affected nodes if they were visited. Nodes that were not visited are not
+ * tracked. So the bulk creation of nodes stays fast and unrelated changes (e.g.
+ * the temporary event nodes) do not invalidate the cache. The outdated entries
+ * are removed when they are found or evicted. */
+
+enum ZIP_CMP
+cmpBrowsePathCacheNode(const UA_NodeId *a, const UA_NodeId *b) {
+    return (enum ZIP_CMP)UA_NodeId_order(a, b);
+}
+
+enum ZIP_CMP
+cmpBrowsePathCacheKey(const UA_BrowsePathCacheKey *a,
+                      const UA_BrowsePathCacheKey *b) {
+    if(a->hash != b->hash)
+        return (a->hash < b->hash) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(a->nodeClassMask != b->nodeClassMask)
+        return (a->nodeClassMask < b->nodeClassMask) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    return (enum ZIP_CMP)UA_order(a->browsePath, b->browsePath,
+                                  &UA_TYPES[UA_TYPES_BROWSEPATH]);
+}
+
+static UA_UInt32
+hashBrowsePath(const UA_BrowsePath *path) {
+    UA_UInt32 h = UA_NodeId_hash(&path->startingNode);
+    for(size_t i = 0; i < path->relativePath.elementsSize; i++) {
+        const UA_RelativePathElement *elem = &path->relativePath.elements[i];
+        UA_UInt32 e[3];
+        e[0] = UA_NodeId_hash(&elem->referenceTypeId);
+        e[1] = UA_QualifiedName_hash(&elem->targetName);
+        e[2] = ((UA_UInt32)elem->isInverse << 1) | (UA_UInt32)elem->includeSubtypes;
+        h = UA_ByteString_hash(h, (const UA_Byte*)e, sizeof(e));
+    }
+    return h;
+}
+
 static void
-Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
-                                       const UA_UInt32 *nodeClassMask,
-                                       const UA_BrowsePath *path,
-                                       UA_BrowsePathResult *result) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+releaseBrowsePathCacheNode(UA_BrowsePathCache *cache, UA_BrowsePathCacheNode *node) {
+    node->refCount--;
+    if(node->refCount > 0)
+        return;
+    ZIP_REMOVE(UA_BrowsePathCacheNodeTree, &cache->nodes, node);
+    UA_NodeId_clear(&node->nodeId);
+    UA_free(node);
+}
+
+static void
+removeBrowsePathCacheEntry(UA_BrowsePathCache *cache,
+                           UA_BrowsePathCacheEntry *entry) {
+    ZIP_REMOVE(UA_BrowsePathCacheTree, &cache->tree, entry);
+    TAILQ_REMOVE(&cache->lru, entry, lruEntry);
+    for(size_t i = 0; i < entry->visitsSize; i++)
+        releaseBrowsePathCacheNode(cache, entry->visits[i].node);
+    UA_free(entry->visits);
+    UA_BrowsePath_clear(&entry->browsePath);
+    UA_BrowsePathResult_clear(&entry->result);
+    UA_free(entry);
+    cache->stats.currentEntries--;
+}
+
+void
+clearBrowsePathCache(UA_Server *server) {
+    UA_BrowsePathCache *cache = &server->browsePathCache;
+    UA_BrowsePathCacheEntry *entry, *entry_tmp;
+    TAILQ_FOREACH_SAFE(entry, &cache->lru, lruEntry, entry_tmp) {
+        removeBrowsePathCacheEntry(cache, entry);
+    }
+}
+
+void
+invalidateBrowsePathCache(UA_Server *server) {
+    server->browsePathCache.generation++;
+}
+
+void
+invalidateBrowsePathCacheNode(UA_Server *server, const UA_NodeId *nodeId) {
+    UA_BrowsePathCacheNode *node =
+        ZIP_FIND(UA_BrowsePathCacheNodeTree, &server->browsePathCache.nodes, nodeId);
+    if(node)
+        node->generation++;
+}
+
+/* Is any of the visited nodes outdated? */
+static UA_Boolean
+isBrowsePathCacheEntryOutdated(const UA_BrowsePathCache *cache,
+                               const UA_BrowsePathCacheEntry *entry) {
+    if(entry->generation != cache->generation)
+        return true;
+    for(size_t i = 0; i < entry->visitsSize; i++) {
+        if(entry->visits[i].generation != entry->visits[i].node->generation)
+            return true;
+    }
+    return false;
+}
+
+/* Local nodes visited during the resolution of a browse path */
+typedef struct {
+    size_t size;
+    UA_NodeId *nodes;
+} BrowsePathVisited;
+
+/* Record the local nodes of the RefTree */
+static UA_StatusCode
+recordVisited(BrowsePathVisited *visited, const RefTree *rt) {
+    if(rt->size == 0)
+        return UA_STATUSCODE_GOOD;
+    UA_NodeId *nodes = (UA_NodeId*)
+        UA_realloc(visited->nodes, sizeof(UA_NodeId) * (visited->size + rt->size));
+    if(!nodes)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    visited->nodes = nodes;
+    for(size_t i = 0; i < rt->size; i++) {
+        if(!UA_ExpandedNodeId_isLocal(&rt->targets[i]))
+            continue;
+        UA_StatusCode res = UA_NodeId_copy(&rt->targets[i].nodeId,
+                                           &visited->nodes[visited->size]);
+        if(res != UA_STATUSCODE_GOOD)
+            return res;
+        visited->size++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Track the visited nodes of the entry with their current generation. NodeIds
+ * that are not tracked yet are moved out of the visited array. */
+static UA_StatusCode
+addBrowsePathCacheVisits(UA_BrowsePathCache *cache, UA_BrowsePathCacheEntry *entry,
+                         BrowsePathVisited *visited) {
+    if(visited->size == 0)
+        return UA_STATUSCODE_GOOD;
+    entry->visits = (UA_BrowsePathCacheVisit*)
+        UA_malloc(sizeof(UA_BrowsePathCacheVisit) * visited->size);
+    if(!entry->visits)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    for(size_t i = 0; i < visited->size; i++) {
+        UA_BrowsePathCacheNode *node =
+            ZIP_FIND(UA_BrowsePathCacheNodeTree, &cache->nodes, &visited->nodes[i]);
+        if(!node) {
+            node = (UA_BrowsePathCacheNode*)UA_calloc(1, sizeof(UA_BrowsePathCacheNode));
+            if(!node)
+                return UA_STATUSCODE_BADOUTOFMEMORY;
+            node->nodeId = visited->nodes[i];
+            UA_NodeId_init(&visited->nodes[i]);
+            ZIP_INSERT(UA_BrowsePathCacheNodeTree, &cache->nodes, node);
+        }
+        node->refCount++;
+        entry->visits[i].node = node;
+        entry->visits[i].generation = node->generation;
+        entry->visitsSize++;
+    }
+    return UA_STATUSCODE_GOOD;
+}
 
+static void
+addBrowsePathCacheEntry(UA_Server *server, const UA_BrowsePathCacheKey *key,
+                        const UA_BrowsePathResult *result,
+                        BrowsePathVisited *visited) {
+    UA_BrowsePathCache *cache = &server->browsePathCache;
+    UA_BrowsePathCacheEntry *entry = (UA_BrowsePathCacheEntry*)
+        UA_calloc(1, sizeof(UA_BrowsePathCacheEntry));
+    if(!entry)
+        return;
+    UA_StatusCode res = UA_BrowsePath_copy(key->browsePath, &entry->browsePath);
+    res |= UA_BrowsePathResult_copy(result, &entry->result);
+    res |= addBrowsePathCacheVisits(cache, entry, visited);
+    if(res != UA_STATUSCODE_GOOD) {
+        for(size_t i = 0; i < entry->visitsSize; i++)
+            releaseBrowsePathCacheNode(cache, entry->visits[i].node);
+        UA_free(entry->visits);
+        UA_BrowsePath_clear(&entry->browsePath);
+        UA_BrowsePathResult_clear(&entry->result);
+        UA_free(entry);
+        return;
+    }
+    entry->key = *key;
+    entry->key.browsePath = &entry->browsePath;
+    entry->generation = cache->generation;
+    ZIP_INSERT(UA_BrowsePathCacheTree, &cache->tree, entry);
+    TAILQ_INSERT_HEAD(&cache->lru, entry, lruEntry);
+    cache->stats.currentEntries++;
+
+    /* Evict the least recently used entries */
+    while(cache->stats.currentEntries > server->config.browsePathCacheSize)
+        removeBrowsePathCacheEntry(cache, TAILQ_LAST(&cache->lru, UA_BrowsePathCacheLRU));
+}
+
+/* The visited nodes are recorded if the pointer is non-NULL */
+static void
+translateBrowsePath(UA_Server *server, UA_Session *session,
+                    const UA_UInt32 *nodeClassMask, const UA_BrowsePath *path,
+                    UA_BrowsePathResult *result, BrowsePathVisited *visited) {
     if(path->relativePath.elementsSize == 0) {
         result->statusCode = UA_STATUSCODE_BADNOTHINGTODO;
         return;
@@ -1290,12 +1807,18 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
         for(size_t j = 0; j < next->size; j++)
             UA_ExpandedNodeId_clear(&next->targets[j]);
         next->size = 0;
-        ZIP_INIT(&next->head);
+        memset(REFTREE_SLOTS(next), 0, 2 * sizeof(RefSlot) * next->capacity);
 
         /* Do this check after next->size has been set to zero */
         if(current->size == 0)
             break;
 
+        if(visited) {
+            result->statusCode = recordVisited(visited, current);
+            if(result->statusCode != UA_STATUSCODE_GOOD)
+                goto cleanup;
+        }
+
         /* Walk element for all NodeIds in the "current" tree.
          * Puts new results in the "next" tree. */
         result->statusCode =
@@ -1307,6 +1830,13 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
         browseNameFilter = &path->relativePath.elements[i].targetName;
     }
 
+    /* The candidates are checked for their BrowseName below */
+    if(visited) {
+        result->statusCode = recordVisited(visited, next);
+        if(result->statusCode != UA_STATUSCODE_GOOD)
+            goto cleanup;
+    }
+
     /* Allocate space for the results array */
     tmpResults = (UA_BrowsePathTarget*)
         UA_realloc(result->targets, sizeof(UA_BrowsePathTarget) *
@@ -1357,6 +1887,79 @@ Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
     }
 }
 
+/* Is the node an instance of an EventType? */
+static UA_Boolean
+isEventNode(UA_Server *server, const UA_NodeId *nodeId) {
+    const UA_Node *node =
+        UA_NODESTORE_GET_SELECTIVE(server, nodeId, UA_NODEATTRIBUTESMASK_NONE,
+                                   UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASTYPEDEFINITION),
+                                   UA_BROWSEDIRECTION_FORWARD);
+    if(!node)
+        return false;
+    UA_Boolean res = false;
+    if(node->head.nodeClass == UA_NODECLASS_OBJECT) {
+        const UA_Node *type = getNodeType(server, &node->head);
+        if(type) {
+            UA_NodeId baseEventTypeId = UA_NS0ID(BASEEVENTTYPE);
+            res = isNodeInTree_singleRef(server, &type->head.nodeId, &baseEventTypeId,
+                                         UA_REFERENCETYPEINDEX_HASSUBTYPE);
+            UA_NODESTORE_RELEASE(server, type);
+        }
+    }
+    UA_NODESTORE_RELEASE(server, node);
+    return res;
+}
+
+static void
+Operation_TranslateBrowsePathToNodeIds(UA_Server *server, UA_Session *session,
+                                       const UA_UInt32 *nodeClassMask,
+                                       const UA_BrowsePath *path,
+                                       UA_BrowsePathResult *result) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    if(server->config.browsePathCacheSize == 0) {
+        translateBrowsePath(server, session, nodeClassMask, path, result, NULL);
+        return;
+    }
+
+    /* Return the cached result */
+    UA_BrowsePathCache *cache = &server->browsePathCache;
+    UA_BrowsePathCacheKey key;
+    key.hash = hashBrowsePath(path);
+    key.nodeClassMask = *nodeClassMask;
+    key.browsePath = path;
+    UA_BrowsePathCacheEntry *entry =
+        ZIP_FIND(UA_BrowsePathCacheTree, &cache->tree, &key);
+    if(entry && isBrowsePathCacheEntryOutdated(cache, entry)) {
+        removeBrowsePathCacheEntry(cache, entry);
+        cache->stats.invalidationCount++;
+        entry = NULL;
+    }
+    if(entry) {
+        UA_StatusCode res = UA_BrowsePathResult_copy(&entry->result, result);
+        if(res != UA_STATUSCODE_GOOD)
+            result->statusCode = res;
+        TAILQ_REMOVE(&cache->lru, entry, lruEntry);
+        TAILQ_INSERT_HEAD(&cache->lru, entry, lruEntry);
+        cache->stats.hitCount++;
+        return;
+    }
+    cache->stats.missCount++;
+
+    /* Resolve and cache the result. Errors other than BadNoMatch (e.g. an
+     * unknown starting node) are not cached. Paths starting at an event are
+     * not cached either. The event nodes are deleted after the event was
+     * triggered. */
+    BrowsePathVisited visited;
+    memset(&visited, 0, sizeof(BrowsePathVisited));
+    translateBrowsePath(server, session, nodeClassMask, path, result, &visited);
+    if((result->statusCode == UA_STATUSCODE_GOOD ||
+        result->statusCode == UA_STATUSCODE_BADNOMATCH) &&
+       !isEventNode(server, &path->startingNode))
+        addBrowsePathCacheEntry(server, &key, result, &visited);
+    UA_Array_delete(visited.nodes, visited.size, &UA_TYPES[UA_TYPES_NODEID]);
+}
+
 UA_BrowsePathResult
 translateBrowsePathToNodeIds(UA_Server *server,
                              const UA_BrowsePath *browsePath) {
@@ -1409,6 +1409,9 @@ UA_MonitoredItem_delete(UA_Server *server, UA_MonitoredItem *mon) {
     /* Remove the settings */
     UA_ReadValueId_clear(&mon->itemToMonitor);
     UA_MonitoringParameters_clear(&mon->parameters);
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    UA_MonitoredItem_releaseEventFilter(server, mon);
+#endif
 
     /* Remove the last samples */
     UA_DataValue_clear(&mon->lastValue);
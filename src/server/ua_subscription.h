@@ -24,6 +24,7 @@
 
 #include "ua_session.h"
 #include "../util/ua_util_internal.h"
+#include "ziptree.h"
 
 _UA_BEGIN_DECLS
 
@@ -147,6 +148,12 @@ struct UA_MonitoredItem {
      * TODO: Store the percentage deadband to recompute when the UARange is
      * changed at runtime of the MonitoredItem */
     UA_MonitoringParameters parameters;
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Compiled from the EventFilter in the parameters. Only set for
+     * Event-MonitoredItems. Shared with MonitoredItems that use the same
+     * EventFilter. */
+    struct UA_SharedEventFilter *eventFilter;
+#endif
 
     /* Sampling */
     UA_MonitoredItemSamplingType samplingType;
@@ -347,6 +354,142 @@ typedef struct UA_ConditionSource UA_ConditionSource;
 #define UA_EVENTFILTER_MAXOPERANDS 64 /* Max operands per operator */
 #define UA_EVENTFILTER_MAXSELECT   64 /* Max select clauses */
 
+/* Event without a node representation. The fields are looked up in the map
+ * instead of the information model. The key is the BrowsePath of the field
+ * relative to the event. The elements of the path are separated by a slash
+ * and share the namespace index of the key. The standard fields EventId,
+ * EventType and SourceNode are set by the server. Time and ReceiveTime are
+ * taken from the map if present. Otherwise the time of emitting the event is
+ * used for both. */
+typedef struct {
+    UA_NodeId eventType;
+    UA_NodeId sourceNode;
+    UA_ByteString eventId;
+    UA_DateTime emitTime;
+    const UA_KeyValueMap *fields;
+} UA_NodelessEvent;
+
+/* Cached notifier hierarchy of an event source. These are the objects that
+ * emit the events of the source. Reference changes in the information model
+ * invalidate the cache. */
+typedef struct UA_EventSourceCacheEntry {
+    ZIP_ENTRY(UA_EventSourceCacheEntry) treeEntry;
+    UA_NodeId sourceNode;
+    size_t emitNodesSize;
+    UA_NodeId *emitNodes;
+} UA_EventSourceCacheEntry;
+
+enum ZIP_CMP
+cmpEventSource(const UA_NodeId *a, const UA_NodeId *b);
+
+typedef ZIP_HEAD(UA_EventSourceCache, UA_EventSourceCacheEntry) UA_EventSourceCache;
+ZIP_FUNCTIONS(UA_EventSourceCache, UA_EventSourceCacheEntry, treeEntry,
+              UA_NodeId, sourceNode, cmpEventSource)
+
+/* Compiled Event Filter
+ * ~~~~~~~~~~~~~~~~~~~~~
+ * The EventFilter of a MonitoredItem is compiled once when the filter is set.
+ * Equal SimpleAttributeOperands from the select and where clauses share a
+ * field slot. The slots of each event are resolved on demand and at most once
+ * into a field vector. The where clause is lowered to instructions whose
+ * operands point to a slot, to the result of another element or to a literal.
+ * Literals in comparisons are pre-cast to the target type if the type of the
+ * other operands is known from the event type definition. The program points
+ * into the EventFilter and must not outlive it. */
+
+typedef enum {
+    UA_EVENTOPERAND_INVALID = 0, /* Evaluates to BadFilterOperatorUnsupported */
+    UA_EVENTOPERAND_FIELD,
+    UA_EVENTOPERAND_ELEMENT,
+    UA_EVENTOPERAND_LITERAL
+} UA_EventOperandKind;
+
+typedef struct {
+    UA_EventOperandKind kind;
+    size_t index;                /* Field slot or element index */
+    const UA_Variant *literal;   /* Points into the filter */
+    const UA_DataType *castType; /* If set, the literal pre-cast to castType */
+    UA_Variant cast;
+} UA_EventOperand;
+
+typedef struct {
+    UA_FilterOperator filterOperator;
+    size_t operandsSize;
+    UA_EventOperand *operands;
+} UA_EventFilterInstruction;
+
+typedef struct {
+    size_t field;
+    UA_Boolean checkEventType; /* The TypeDefinition is not BaseEventType */
+    UA_Boolean move;           /* Last use of the field. Move instead of copy. */
+} UA_EventSelectClause;
+
+typedef struct UA_EventFilterProgram {
+    const UA_EventFilter *filter;
+
+    /* Slot 0 is always the EventType */
+    size_t fieldsSize;
+    const UA_SimpleAttributeOperand **fields;
+
+    UA_EventSelectClause *selectClauses; /* Same size as in the filter */
+
+    size_t instructionsSize;
+    UA_EventFilterInstruction *instructions;
+} UA_EventFilterProgram;
+
+UA_StatusCode
+UA_EventFilterProgram_compile(UA_Server *server, const UA_EventFilter *filter,
+                              UA_EventFilterProgram *program);
+
+void
+UA_EventFilterProgram_clear(UA_EventFilterProgram *program);
+
+/* Shared Event Filter
+ * ~~~~~~~~~~~~~~~~~~~
+ * MonitoredItems with the same EventFilter (equal binary encoding) share one
+ * compiled program. The shared filter caches the result of the last
+ * evaluation. So an event is filtered only once for all MonitoredItems of the
+ * same Session. The fields of nodeless events are resolved without the Session
+ * and their evaluation is shared across Sessions. */
+
+typedef struct {
+    UA_UInt32 hash;
+    UA_ByteString encoding;
+} UA_SharedEventFilterKey;
+
+typedef struct UA_SharedEventFilter {
+    ZIP_ENTRY(UA_SharedEventFilter) treeEntry;
+    UA_SharedEventFilterKey key;
+    size_t refCount;
+    UA_EventFilter filter; /* The program points into the filter */
+    UA_EventFilterProgram program;
+
+    /* Result of the last evaluation */
+    UA_UInt64 evalEvent; /* Matches server->eventCounter if current */
+    const UA_Session *evalSession;
+    UA_StatusCode evalResult;
+    UA_EventFieldList evalFields;
+} UA_SharedEventFilter;
+
+enum ZIP_CMP
+cmpSharedEventFilter(const UA_SharedEventFilterKey *a,
+                     const UA_SharedEventFilterKey *b);
+
+typedef ZIP_HEAD(UA_SharedEventFilterTree, UA_SharedEventFilter)
+    UA_SharedEventFilterTree;
+ZIP_FUNCTIONS(UA_SharedEventFilterTree, UA_SharedEventFilter, treeEntry,
+              UA_SharedEventFilterKey, key, cmpSharedEventFilter)
+
+/* Get the shared filter for the EventFilter of the MonitoredItem parameters.
+ * Replaces a previously used filter only if successful. */
+UA_StatusCode
+UA_MonitoredItem_compileEventFilter(UA_Server *server, UA_MonitoredItem *mon,
+                                    const UA_MonitoringParameters *params);
+
+/* Release the shared filter. Deleted when it is no longer used. */
+void
+UA_MonitoredItem_releaseEventFilter(UA_Server *server, UA_MonitoredItem *mon);
+
 UA_StatusCode
 UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
                           const UA_NodeId *event);
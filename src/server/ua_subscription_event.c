@@ -173,16 +173,42 @@ eventSetStandardFields(UA_Server *server, const UA_NodeId *event,
     return UA_STATUSCODE_GOOD;
 }
 
+/* Evaluate the shared filter once per event and Session. The result is cached
+ * in the shared filter and copied for every MonitoredItem. */
+static UA_StatusCode
+filterSharedEvent(UA_Server *server, UA_Session *session, UA_SharedEventFilter *sf,
+                  const UA_NodeId *event, const UA_NodelessEvent *nodelessEvent,
+                  UA_EventFieldList *values) {
+    /* Not shared. Evaluate directly into the output. */
+    if(sf->refCount == 1)
+        return filterEvent(server, session, &sf->program,
+                           event, nodelessEvent, values);
+
+    /* Evaluate if there is no current result. The fields of nodeless events
+     * don't depend on the Session. */
+    const UA_Session *evalSession = (nodelessEvent) ? NULL : session;
+    if(sf->evalEvent != server->eventCounter || sf->evalSession != evalSession) {
+        UA_EventFieldList_clear(&sf->evalFields);
+        sf->evalResult = filterEvent(server, session, &sf->program,
+                                     event, nodelessEvent, &sf->evalFields);
+        sf->evalEvent = server->eventCounter;
+        sf->evalSession = evalSession;
+    }
+
+    UA_EventFieldList_init(values);
+    if(sf->evalResult != UA_STATUSCODE_GOOD)
+        return sf->evalResult;
+    return UA_EventFieldList_copy(&sf->evalFields, values);
+}
+
 /* Filters an event according to the filter specified by mon and then adds it to
  * mons notification queue */
-UA_StatusCode
-UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
-                          const UA_NodeId *event) {
-    /* Get the filter */
-    if(mon->parameters.filter.content.decoded.type != &UA_TYPES[UA_TYPES_EVENTFILTER])
+static UA_StatusCode
+addEvent(UA_Server *server, UA_MonitoredItem *mon, const UA_NodeId *event,
+         const UA_NodelessEvent *nodelessEvent) {
+    /* Get the compiled filter */
+    if(!mon->eventFilter)
         return UA_STATUSCODE_BADFILTERNOTALLOWED;
-    UA_EventFilter *eventFilter = (UA_EventFilter*)
-        mon->parameters.filter.content.decoded.data;
 
     /* A MonitoredItem is always attached to a (local) Subscription.
      * A Subscription may not be attached to a Session. */
@@ -191,16 +217,10 @@ UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
 
     /* Values to be returned when the filter matches */
     UA_EventFieldList values;
-    UA_EventFieldList_init(&values);
-
-    UA_EventFilterResult efr; /* FilterResult contains only statuscodes. Ignored
-                               * outside the initial setup/validation. */
-    UA_EventFilterResult_init(&efr);
 
     /* Evaluate the filter. Return if it doesn't match. */
-    UA_StatusCode ret = filterEvent(server, sub->session, event,
-                                    eventFilter, &values, &efr);
-    UA_EventFilterResult_clear(&efr);
+    UA_StatusCode ret = filterSharedEvent(server, sub->session, mon->eventFilter,
+                                          event, nodelessEvent, &values);
     if(ret != UA_STATUSCODE_GOOD) {
         UA_EventFieldList_clear(&values);
         if(ret == UA_STATUSCODE_BADNOMATCH)
@@ -223,10 +243,18 @@ UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
     return UA_STATUSCODE_GOOD;
 }
 
+UA_StatusCode
+UA_MonitoredItem_addEvent(UA_Server *server, UA_MonitoredItem *mon,
+                          const UA_NodeId *event) {
+    server->eventCounter++; /* Invalidate cached evaluation results */
+    return addEvent(server, mon, event, NULL);
+}
+
 #ifdef UA_ENABLE_HISTORIZING
 static void
 setHistoricalEvent(UA_Server *server, const UA_NodeId *origin,
-                   const UA_NodeId *emitNodeId, const UA_NodeId *eventNodeId) {
+                   const UA_NodeId *emitNodeId, const UA_NodeId *eventNodeId,
+                   const UA_NodelessEvent *nodelessEvent) {
     UA_Variant historicalEventFilterValue;
     UA_Variant_init(&historicalEventFilterValue);
 
@@ -258,13 +286,19 @@ setHistoricalEvent(UA_Server *server, const UA_NodeId *origin,
 
     /* Finally, if found and valid then filter */
     UA_EventFilter *filter = (UA_EventFilter*) historicalEventFilterValue.data;
+    UA_EventFilterProgram program;
+    retval = UA_EventFilterProgram_compile(server, filter, &program);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_Variant_clear(&historicalEventFilterValue);
+        return;
+    }
     UA_EventFieldList efl;
-    UA_EventFilterResult result;
-    retval = filterEvent(server, &server->adminSession, eventNodeId, filter, &efl, &result);
+    retval = filterEvent(server, &server->adminSession, &program,
+                         eventNodeId, nodelessEvent, &efl);
     if(retval == UA_STATUSCODE_GOOD)
         server->config.historyDatabase.setEvent(server, server->config.historyDatabase.context,
                                                 origin, emitNodeId, filter, &efl);
-    UA_EventFilterResult_clear(&result);
+    UA_EventFilterProgram_clear(&program);
     UA_Variant_clear(&historicalEventFilterValue);
     UA_EventFieldList_clear(&efl);
 }
@@ -282,29 +316,11 @@ static const UA_NodeId isInFolderReferences[2] =
     {{0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_ORGANIZES}},
      {0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_HASCOMPONENT}}};
 
-UA_StatusCode
-triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
-             const UA_NodeId origin, UA_ByteString *outEventId,
-             const UA_Boolean deleteEventNode) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
-
-    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
-                 "Events: An event is triggered on node %N", origin);
-
-#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
-    UA_Boolean isCallerAC = false;
-    if(isConditionOrBranch(server, &eventNodeId, &origin, &isCallerAC)) {
-        if(!isCallerAC) {
-          UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
-                                 "Condition Events: Please use A&C API to trigger Condition Events 0x%08X",
-                                  UA_STATUSCODE_BADINVALIDARGUMENT);
-          return UA_STATUSCODE_BADINVALIDARGUMENT;
-        }
-    }
-#endif /* UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS */
-
+/* Check that the origin node exists and is in the ObjectsFolder */
+static UA_StatusCode
+checkEventOrigin(UA_Server *server, const UA_NodeId *origin) {
     /* Check that the origin node exists */
-    const UA_Node *originNode = UA_NODESTORE_GET(server, &origin);
+    const UA_Node *originNode = UA_NODESTORE_GET(server, origin);
     if(!originNode) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_USERLAND,
                      "Origin node for event does not exist.");
@@ -314,12 +330,12 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
 
     /* Make sure the origin is in the ObjectsFolder (TODO: or in the ViewsFolder) */
     /* Only use Organizes and HasComponent to check if we are below the ObjectsFolder */
-    UA_StatusCode retval;
     UA_ReferenceTypeSet refTypes;
     UA_ReferenceTypeSet_init(&refTypes);
     for(int i = 0; i < 2; ++i) {
         UA_ReferenceTypeSet tmpRefTypes;
-        retval = referenceTypeIndices(server, &isInFolderReferences[i], &tmpRefTypes, true);
+        UA_StatusCode retval =
+            referenceTypeIndices(server, &isInFolderReferences[i], &tmpRefTypes, true);
         if(retval != UA_STATUSCODE_GOOD) {
             UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                            "Events: Could not create the list of references and their subtypes "
@@ -328,25 +344,92 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         refTypes = UA_ReferenceTypeSet_union(refTypes, tmpRefTypes);
     }
 
-    if(!isNodeInTree(server, &origin, &objectsFolderId, &refTypes)) {
+    if(!isNodeInTree(server, origin, &objectsFolderId, &refTypes)) {
         UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_USERLAND,
                      "Node for event must be in ObjectsFolder!");
         return UA_STATUSCODE_BADINVALIDARGUMENT;
     }
+    return UA_STATUSCODE_GOOD;
+}
 
-    /* Update the standard fields of the event */
-    retval = eventSetStandardFields(server, &eventNodeId, &origin, outEventId);
-    if(retval != UA_STATUSCODE_GOOD) {
-        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
-                       "Events: Could not set the standard event fields with StatusCode %s",
-                       UA_StatusCode_name(retval));
-        return retval;
+/* Event Source Cache
+ * ~~~~~~~~~~~~~~~~~~
+ * Events propagate upwards (bubble up) in the node hierarchy. The objects that
+ * emit the events of a source node are computed with a recursive browse when
+ * the source is first used. The result is cached until a reference of a type
+ * that is relevant for the propagation (or a HasSubtype reference that changes
+ * the set of relevant types) is added or removed. */
+
+enum ZIP_CMP
+cmpEventSource(const UA_NodeId *a, const UA_NodeId *b) {
+    return (enum ZIP_CMP)UA_NodeId_order(a, b);
+}
+
+static void *
+deleteEventSourceEntry(void *context, UA_EventSourceCacheEntry *entry) {
+    UA_NodeId_clear(&entry->sourceNode);
+    UA_Array_delete(entry->emitNodes, entry->emitNodesSize, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_free(entry);
+    return NULL;
+}
+
+void
+clearEventSourceCache(UA_Server *server) {
+    ZIP_ITER(UA_EventSourceCache, &server->eventSourceCache,
+             deleteEventSourceEntry, NULL);
+    ZIP_INIT(&server->eventSourceCache);
+}
+
+void
+invalidateEventSourceCache(UA_Server *server, UA_Byte refTypeIndex) {
+    if(!ZIP_ROOT(&server->eventSourceCache))
+        return;
+    if(!UA_ReferenceTypeSet_contains(&server->eventSourceRefTypes, refTypeIndex))
+        return;
+    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
+                 "Events: Reference change invalidates the event source cache");
+    clearEventSourceCache(server);
+}
+
+/* Compute the ReferenceTypes over which the events propagate */
+static UA_StatusCode
+getEventSourceRefTypes(UA_Server *server, UA_ReferenceTypeSet *emitRefTypes) {
+    UA_ReferenceTypeSet_init(emitRefTypes);
+    for(size_t i = 0; i < EMIT_REFS_ROOT_COUNT; i++) {
+        UA_ReferenceTypeSet tmpRefTypes;
+        UA_StatusCode retval =
+            referenceTypeIndices(server, &emitReferencesRoots[i], &tmpRefTypes, true);
+        if(retval != UA_STATUSCODE_GOOD) {
+            UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                           "Events: Could not create the list of references for event "
+                           "propagation with StatusCode %s", UA_StatusCode_name(retval));
+            return retval;
+        }
+        *emitRefTypes = UA_ReferenceTypeSet_union(*emitRefTypes, tmpRefTypes);
     }
+    return UA_STATUSCODE_GOOD;
+}
 
-    /* List of nodes that emit the node. Events propagate upwards (bubble up) in
-     * the node hierarchy. */
-    UA_ExpandedNodeId *emitNodes = NULL;
-    size_t emitNodesSize = 0;
+static UA_StatusCode
+addEventSourceEntry(UA_Server *server, const UA_NodeId *origin,
+                    UA_EventSourceCacheEntry **outEntry) {
+    /* Not cached if the origin is invalid */
+    UA_StatusCode retval = checkEventOrigin(server, origin);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Recompute the relevant ReferenceTypes for the empty cache. They change
+     * only together with HasSubtype references. */
+    UA_ReferenceTypeSet emitRefTypes;
+    retval = getEventSourceRefTypes(server, &emitRefTypes);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+    if(!ZIP_ROOT(&server->eventSourceCache)) {
+        server->eventSourceRefTypes = emitRefTypes;
+        server->eventSourceRefTypes =
+            UA_ReferenceTypeSet_union(server->eventSourceRefTypes,
+                                      UA_REFTYPESET(UA_REFERENCETYPEINDEX_HASSUBTYPE));
+    }
 
     /* Add the server node to the list of nodes from which the event is emitted.
      * The server node emits all events.
@@ -356,25 +439,12 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
      * a Server and as such has implied HasEventSource References to every event
      * source in a Server. */
     UA_NodeId emitStartNodes[2];
-    emitStartNodes[0] = origin;
+    emitStartNodes[0] = *origin;
     emitStartNodes[1] = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
 
-    /* Get all ReferenceTypes over which the events propagate */
-    UA_ReferenceTypeSet emitRefTypes;
-    UA_ReferenceTypeSet_init(&emitRefTypes);
-    for(size_t i = 0; i < EMIT_REFS_ROOT_COUNT; i++) {
-        UA_ReferenceTypeSet tmpRefTypes;
-        retval = referenceTypeIndices(server, &emitReferencesRoots[i], &tmpRefTypes, true);
-        if(retval != UA_STATUSCODE_GOOD) {
-            UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
-                           "Events: Could not create the list of references for event "
-                           "propagation with StatusCode %s", UA_StatusCode_name(retval));
-            goto cleanup;
-        }
-        emitRefTypes = UA_ReferenceTypeSet_union(emitRefTypes, tmpRefTypes);
-    }
-
     /* Get the list of nodes in the hierarchy that emits the event. */
+    UA_ExpandedNodeId *emitNodes = NULL;
+    size_t emitNodesSize = 0;
     retval = browseRecursive(server, 2, emitStartNodes, UA_BROWSEDIRECTION_INVERSE,
                              &emitRefTypes, UA_NODECLASS_UNSPECIFIED, true,
                              &emitNodesSize, &emitNodes);
@@ -382,21 +452,73 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                        "Events: Could not create the list of nodes listening on the "
                        "event with StatusCode %s", UA_StatusCode_name(retval));
-        goto cleanup;
+        return retval;
     }
 
-    /* Add the event to the listening MonitoredItems at each relevant node */
+    /* Create the cache entry */
+    UA_EventSourceCacheEntry *entry = (UA_EventSourceCacheEntry*)
+        UA_calloc(1, sizeof(UA_EventSourceCacheEntry));
+    if(!entry) {
+        UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    if(emitNodesSize > 0) {
+        entry->emitNodes = (UA_NodeId*)
+            UA_Array_new(emitNodesSize, &UA_TYPES[UA_TYPES_NODEID]);
+        if(!entry->emitNodes) {
+            UA_free(entry);
+            UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+        }
+    }
     for(size_t i = 0; i < emitNodesSize; i++) {
-        /* Get the node */
+        /* Only consider objects */
         const UA_Node *node = UA_NODESTORE_GET(server, &emitNodes[i].nodeId);
         if(!node)
             continue;
+        UA_NodeClass nodeClass = node->head.nodeClass;
+        UA_NODESTORE_RELEASE(server, node);
+        if(nodeClass != UA_NODECLASS_OBJECT)
+            continue;
+        entry->emitNodes[entry->emitNodesSize++] = emitNodes[i].nodeId; /* Move */
+        UA_NodeId_init(&emitNodes[i].nodeId);
+    }
+    UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+    retval = UA_NodeId_copy(origin, &entry->sourceNode);
+    if(retval != UA_STATUSCODE_GOOD) {
+        deleteEventSourceEntry(NULL, entry);
+        return retval;
+    }
 
-        /* Only consider objects */
-        if(node->head.nodeClass != UA_NODECLASS_OBJECT) {
-            UA_NODESTORE_RELEASE(server, node);
+    ZIP_INSERT(UA_EventSourceCache, &server->eventSourceCache, entry);
+    *outEntry = entry;
+    return UA_STATUSCODE_GOOD;
+}
+
+/* Get the cached list of nodes that emit the events of the origin */
+static UA_StatusCode
+getEventSource(UA_Server *server, const UA_NodeId *origin,
+               UA_EventSourceCacheEntry **outEntry) {
+    *outEntry = ZIP_FIND(UA_EventSourceCache, &server->eventSourceCache, origin);
+    if(*outEntry)
+        return UA_STATUSCODE_GOOD;
+    return addEventSourceEntry(server, origin, outEntry);
+}
+
+/* Add the event to the MonitoredItems of the origin node and of all nodes
+ * that emit events from it */
+static void
+propagateEvent(UA_Server *server, const UA_EventSourceCacheEntry *entry,
+               const UA_NodeId *eventNode, const UA_NodelessEvent *nodelessEvent) {
+    /* Invalidate the evaluation results cached in the shared filters */
+    server->eventCounter++;
+
+    /* Add the event to the listening MonitoredItems at each relevant node */
+    for(size_t i = 0; i < entry->emitNodesSize; i++) {
+        /* Get the node */
+        const UA_Node *node = UA_NODESTORE_GET(server, &entry->emitNodes[i]);
+        if(!node)
             continue;
-        }
 
         /* Add event to monitoreditems */
         UA_MonitoredItem *mon = node->head.monitoredItems;
@@ -404,12 +526,12 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
             /* Is this an Event-MonitoredItem? */
             if(mon->itemToMonitor.attributeId != UA_ATTRIBUTEID_EVENTNOTIFIER)
                 continue;
-            retval = UA_MonitoredItem_addEvent(server, mon, &eventNodeId);
+            UA_StatusCode retval = addEvent(server, mon, eventNode, nodelessEvent);
             if(retval != UA_STATUSCODE_GOOD) {
+                /* Only log problems with individual emit nodes */
                 UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
                                "Events: Could not add the event to a listening "
                                "node with StatusCode %s", UA_StatusCode_name(retval));
-                retval = UA_STATUSCODE_GOOD; /* Only log problems with individual emit nodes */
             }
         }
 
@@ -418,9 +540,49 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         /* Add event entry in the historical database */
 #ifdef UA_ENABLE_HISTORIZING
         if(server->config.historyDatabase.setEvent)
-            setHistoricalEvent(server, &origin, &emitNodes[i].nodeId, &eventNodeId);
+            setHistoricalEvent(server, &entry->sourceNode, &entry->emitNodes[i],
+                               eventNode, nodelessEvent);
 #endif
     }
+}
+
+UA_StatusCode
+triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
+             const UA_NodeId origin, UA_ByteString *outEventId,
+             const UA_Boolean deleteEventNode) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
+                 "Events: An event is triggered on node %N", origin);
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS
+    UA_Boolean isCallerAC = false;
+    if(isConditionOrBranch(server, &eventNodeId, &origin, &isCallerAC)) {
+        if(!isCallerAC) {
+          UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                                 "Condition Events: Please use A&C API to trigger Condition Events 0x%08X",
+                                  UA_STATUSCODE_BADINVALIDARGUMENT);
+          return UA_STATUSCODE_BADINVALIDARGUMENT;
+        }
+    }
+#endif /* UA_ENABLE_SUBSCRIPTIONS_ALARMS_CONDITIONS */
+
+    UA_EventSourceCacheEntry *source;
+    UA_StatusCode retval = getEventSource(server, &origin, &source);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Update the standard fields of the event */
+    retval = eventSetStandardFields(server, &eventNodeId, &origin, outEventId);
+    if(retval != UA_STATUSCODE_GOOD) {
+        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                       "Events: Could not set the standard event fields with StatusCode %s",
+                       UA_StatusCode_name(retval));
+        return retval;
+    }
+
+    /* Add the event to the MonitoredItems */
+    propagateEvent(server, source, &eventNodeId, NULL);
 
     /* Delete the node representation of the event */
     if(deleteEventNode) {
@@ -432,8 +594,6 @@ triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
         }
     }
 
- cleanup:
-    UA_Array_delete(emitNodes, emitNodesSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
     return retval;
 }
 
@@ -448,4 +608,69 @@ UA_Server_triggerEvent(UA_Server *server, const UA_NodeId eventNodeId,
     return res;
 }
 
+UA_StatusCode
+emitEvent(UA_Server *server, const UA_NodeId eventType,
+          const UA_NodeId origin, const UA_KeyValueMap *eventFields,
+          UA_ByteString *outEventId) {
+    UA_LOCK_ASSERT(&server->serviceMutex);
+
+    UA_LOG_DEBUG(server->config.logging, UA_LOGCATEGORY_SERVER,
+                 "Events: A node-less event is emitted on node %N", origin);
+
+    /* Make sure the eventType is a subtype of BaseEventType */
+    UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+    if(!isNodeInTree_singleRef(server, &eventType, &baseEventTypeId,
+                               UA_REFERENCETYPEINDEX_HASSUBTYPE)) {
+        UA_LOG_ERROR(server->config.logging, UA_LOGCATEGORY_USERLAND,
+                     "Event type must be a subtype of BaseEventType!");
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+
+    /* Conditions have a node representation */
+    UA_NodeId conditionTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE);
+    if(isNodeInTree_singleRef(server, &eventType, &conditionTypeId,
+                              UA_REFERENCETYPEINDEX_HASSUBTYPE)) {
+        UA_LOG_WARNING(server->config.logging, UA_LOGCATEGORY_SERVER,
+                       "Condition Events: Please use A&C API to trigger "
+                       "Condition Events");
+        return UA_STATUSCODE_BADINVALIDARGUMENT;
+    }
+
+    UA_EventSourceCacheEntry *source;
+    UA_StatusCode retval = getEventSource(server, &origin, &source);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Set the standard fields of the event */
+    UA_EventLoop *el = server->config.eventLoop;
+    UA_NodelessEvent event;
+    event.eventType = eventType;
+    event.sourceNode = origin;
+    event.emitTime = el->dateTime_now(el);
+    event.fields = eventFields;
+    retval = generateEventId(&event.eventId);
+    if(retval != UA_STATUSCODE_GOOD)
+        return retval;
+
+    /* Add the event to the MonitoredItems */
+    propagateEvent(server, source, NULL, &event);
+
+    /* Return the EventId */
+    if(outEventId)
+        *outEventId = event.eventId;
+    else
+        UA_ByteString_clear(&event.eventId);
+    return retval;
+}
+
+UA_StatusCode
+UA_Server_emitEvent(UA_Server *server, const UA_NodeId eventType,
+                    const UA_NodeId origin, const UA_KeyValueMap *eventFields,
+                    UA_ByteString *outEventId) {
+    lockServer(server);
+    UA_StatusCode res = emitEvent(server, eventType, origin, eventFields, outEventId);
+    unlockServer(server);
+    return res;
+}
+
 #endif /* UA_ENABLE_SUBSCRIPTIONS_EVENTS */
@@ -449,12 +449,24 @@ castImplicit(const UA_Variant *in, const UA_DataType *outType, UA_Variant *out)
 /* Filter Evaluation
  * ----------------- */
 
+/* Entry of the field vector. Resolved on demand. */
+typedef struct {
+    UA_Boolean resolved;
+    UA_StatusCode status;
+    UA_Variant value;
+} UA_EventField;
+
+/* Use the stack for the field vector up to this number of slots */
+#define UA_EVENTFILTER_STACKFIELDS 32
+
 typedef struct {
     UA_Server *server;
     UA_Session *session;
     const UA_NodeId *eventNode;
-    const UA_ContentFilter *filter;
-    UA_ContentFilterResult *filterResult;
+    const UA_NodelessEvent *nodelessEvent;
+    const UA_EventFilterProgram *program;
+    UA_ContentFilterResult *filterResult; /* Can be NULL */
+    UA_EventField *fields;
     UA_Variant results[UA_EVENTFILTER_MAXELEMENTS];
 
     /* The stack contains temporary variants. Cleaned up after the evaluation of
@@ -463,6 +475,12 @@ typedef struct {
     UA_Variant stack[UA_EVENTFILTER_MAXOPERANDS];
 } UA_FilterEvalContext;
 
+static const UA_String eventIdName = UA_STRING_STATIC("EventId");
+static const UA_String eventTypeName = UA_STRING_STATIC("EventType");
+static const UA_String sourceNodeName = UA_STRING_STATIC("SourceNode");
+static const UA_String timeName = UA_STRING_STATIC("Time");
+static const UA_String receiveTimeName = UA_STRING_STATIC("ReceiveTime");
+
 /* Operand Resolving
  * ~~~~~~~~~~~~~~~~~
  * Methods that all resolve an operator operand to a Variant. */
@@ -533,37 +551,132 @@ resolveSimpleAttributeOperand(UA_Server *server, UA_Session *session,
     return UA_STATUSCODE_GOOD;
 }
 
-static UA_StatusCode
-resolveOperand(UA_FilterEvalContext *ctx, UA_ExtensionObject *op, UA_Variant *out) {
-    if(op->encoding != UA_EXTENSIONOBJECT_DECODED &&
-       op->encoding != UA_EXTENSIONOBJECT_DECODED_NODELETE)
-        return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
-
-    /* Result of an operator that was evaluated prior */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
-        UA_ElementOperand *eo = (UA_ElementOperand*)op->content.decoded.data;
-        *out = ctx->results[eo->index];
-        out->storageType = UA_VARIANT_DATA_NODELETE;
-        return UA_STATUSCODE_GOOD;
+/* Does the key of the field map match the BrowsePath? The path elements are
+ * separated by a slash in the key. */
+static UA_Boolean
+matchEventFieldKey(const UA_QualifiedName *key, size_t browsePathSize,
+                   const UA_QualifiedName *browsePath) {
+    const UA_Byte *pos = key->name.data;
+    const UA_Byte *end = pos + key->name.length;
+    for(size_t i = 0; i < browsePathSize; i++) {
+        if(browsePath[i].namespaceIndex != key->namespaceIndex)
+            return false;
+        if(i > 0) {
+            if(pos == end || *pos != '/')
+                return false;
+            pos++;
+        }
+        size_t len = browsePath[i].name.length;
+        if((size_t)(end - pos) < len)
+            return false;
+        if(len > 0 && memcmp(pos, browsePath[i].name.data, len) != 0)
+            return false;
+        pos += len;
     }
+    return (pos == end);
+}
 
-    /* Literal value */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
-        UA_LiteralOperand *lo = (UA_LiteralOperand*)op->content.decoded.data;
-        *out = lo->value;
-        out->storageType = UA_VARIANT_DATA_NODELETE;
-        return UA_STATUSCODE_GOOD;
+/* Resolve the SimpleAttributeOperand from the fields of a node-less event.
+ * Only the value attribute of the fields is available. */
+static UA_StatusCode
+resolveNodelessEventField(const UA_NodelessEvent *nle,
+                          const UA_SimpleAttributeOperand *sao,
+                          UA_Variant *value) {
+    UA_Variant_init(value);
+    if(sao->attributeId != UA_ATTRIBUTEID_VALUE || sao->browsePathSize == 0)
+        return UA_STATUSCODE_BADNOTSUPPORTED;
+
+    /* The standard fields set by the server */
+    UA_Variant field;
+    UA_Variant_init(&field);
+    const UA_QualifiedName *bn = &sao->browsePath[0];
+    if(sao->browsePathSize == 1 && bn->namespaceIndex == 0) {
+        if(UA_String_equal(&bn->name, &eventIdName))
+            UA_Variant_setScalar(&field, (void*)(uintptr_t)&nle->eventId,
+                                 &UA_TYPES[UA_TYPES_BYTESTRING]);
+        else if(UA_String_equal(&bn->name, &eventTypeName))
+            UA_Variant_setScalar(&field, (void*)(uintptr_t)&nle->eventType,
+                                 &UA_TYPES[UA_TYPES_NODEID]);
+        else if(UA_String_equal(&bn->name, &sourceNodeName))
+            UA_Variant_setScalar(&field, (void*)(uintptr_t)&nle->sourceNode,
+                                 &UA_TYPES[UA_TYPES_NODEID]);
     }
 
-    /* SimpleAttributeOperand with a BrowsePath */
-    if(op->content.decoded.type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
-        UA_SimpleAttributeOperand *sao =
-            (UA_SimpleAttributeOperand*)op->content.decoded.data;
-        return resolveSimpleAttributeOperand(ctx->server, ctx->session,
-                                             ctx->eventNode, sao, out);
+    /* Look up the field map */
+    if(!field.type && nle->fields) {
+        for(size_t i = 0; i < nle->fields->mapSize; i++) {
+            const UA_KeyValuePair *kv = &nle->fields->map[i];
+            if(!matchEventFieldKey(&kv->key, sao->browsePathSize, sao->browsePath))
+                continue;
+            field = kv->value;
+            break;
+        }
     }
 
-    return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
+    /* The mandatory time fields default to the time of emitting the event */
+    if(!field.type && sao->browsePathSize == 1 && bn->namespaceIndex == 0 &&
+       (UA_String_equal(&bn->name, &timeName) ||
+        UA_String_equal(&bn->name, &receiveTimeName)))
+        UA_Variant_setScalar(&field, (void*)(uintptr_t)&nle->emitTime,
+                             &UA_TYPES[UA_TYPES_UTCTIME]);
+
+    if(!field.type)
+        return UA_STATUSCODE_BADNOMATCH;
+
+    /* Copy the value (range) */
+    if(sao->indexRange.length == 0)
+        return UA_Variant_copy(&field, value);
+    UA_NumericRange range;
+    UA_StatusCode res = UA_NumericRange_parse(&range, sao->indexRange);
+    if(res != UA_STATUSCODE_GOOD)
+        return UA_STATUSCODE_BADINDEXRANGEINVALID;
+    res = UA_Variant_copyRange(&field, value, range);
+    UA_free(range.dimensions);
+    return res;
+}
+
+/* Resolve the field slot of the event once. The value remains owned by the
+ * field vector. */
+static const UA_EventField *
+resolveField(UA_FilterEvalContext *ctx, size_t slot) {
+    UA_EventField *f = &ctx->fields[slot];
+    if(f->resolved)
+        return f;
+    const UA_SimpleAttributeOperand *sao = ctx->program->fields[slot];
+    if(ctx->nodelessEvent)
+        f->status = resolveNodelessEventField(ctx->nodelessEvent, sao, &f->value);
+    else
+        f->status = resolveSimpleAttributeOperand(ctx->server, ctx->session,
+                                                  ctx->eventNode, sao, &f->value);
+    f->resolved = true;
+    return f;
+}
+
+static UA_StatusCode
+resolveOperand(UA_FilterEvalContext *ctx, const UA_EventOperand *op, UA_Variant *out) {
+    switch(op->kind) {
+    case UA_EVENTOPERAND_ELEMENT:
+        /* Result of an operator that was evaluated prior */
+        *out = ctx->results[op->index];
+        break;
+    case UA_EVENTOPERAND_LITERAL:
+        *out = *op->literal;
+        break;
+    case UA_EVENTOPERAND_FIELD: {
+        const UA_EventField *f = resolveField(ctx, op->index);
+        if(f->status != UA_STATUSCODE_GOOD) {
+            UA_Variant_init(out);
+            return f->status;
+        }
+        *out = f->value;
+        break;
+    }
+    default:
+        UA_Variant_init(out);
+        return UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
+    }
+    out->storageType = UA_VARIANT_DATA_NODELETE;
+    return UA_STATUSCODE_GOOD;
 }
 
 /* The operandIndex is within the operator arguments, not the operand index for
@@ -571,6 +684,8 @@ resolveOperand(UA_FilterEvalContext *ctx, UA_ExtensionObject *op, UA_Variant *ou
 static UA_StatusCode
 setOperandError(UA_FilterEvalContext *ctx, size_t elementIndex,
                 size_t operandIndex, UA_StatusCode statusCode) {
+    if(!ctx->filterResult)
+        return statusCode;
     UA_ContentFilterElementResult *res = &ctx->filterResult->elementResults[elementIndex];
     res->operandStatusCodes[operandIndex] = statusCode;
     /* The operator status is set globally in a single location upwards the call chain
@@ -583,48 +698,43 @@ setOperandError(UA_FilterEvalContext *ctx, size_t elementIndex,
 
 static UA_StatusCode
 ofTypeOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+    const UA_EventFilterInstruction *ins = &ctx->program->instructions[index];
+    UA_assert(ins->operandsSize == 1);
 
     /* Get the operand. Must be a literal NodeId */
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     if(res != UA_STATUSCODE_GOOD || !UA_Variant_hasScalarType(op0, &UA_TYPES[UA_TYPES_NODEID]))
         return setOperandError(ctx, index, 0, UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED);
 
-    /* Read the event type */
-    UA_Variant eventTypeVar;
-    UA_Variant_init(&eventTypeVar);
-    const UA_NodeId *operandTypeId = (const UA_NodeId *)op0->data;
-    res = readObjectProperty(ctx->server, *ctx->eventNode,
-                             UA_QUALIFIEDNAME(0, "EventType"), &eventTypeVar);
-    UA_CHECK_STATUS(res, return res);
-
-    if(!UA_Variant_hasScalarType(&eventTypeVar, &UA_TYPES[UA_TYPES_NODEID])) {
+    /* The EventType is always in the first field slot */
+    const UA_EventField *et = resolveField(ctx, 0);
+    if(et->status != UA_STATUSCODE_GOOD)
+        return et->status;
+    if(!UA_Variant_hasScalarType(&et->value, &UA_TYPES[UA_TYPES_NODEID])) {
         UA_LOG_WARNING(ctx->server->config.logging, UA_LOGCATEGORY_SERVER,
                        "EventType has an invalid type.");
-        UA_Variant_clear(&eventTypeVar);
         return UA_STATUSCODE_BADINTERNALERROR;
     }
 
     /* Check if the eventtype is equal to the operand or a subtype of it */
-    const UA_NodeId *eventTypeId = (UA_NodeId*)eventTypeVar.data;
+    const UA_NodeId *operandTypeId = (const UA_NodeId *)op0->data;
+    const UA_NodeId *eventTypeId = (const UA_NodeId *)et->value.data;
     UA_Boolean ofType = isNodeInTree_singleRef(ctx->server, eventTypeId, operandTypeId,
                                                UA_REFERENCETYPEINDEX_HASSUBTYPE);
     ctx->results[index] = t2v(ofType ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
-    UA_Variant_clear(&eventTypeVar);
     return UA_STATUSCODE_GOOD;
 }
 
 static UA_StatusCode
 andOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 2);
+    const UA_EventFilterInstruction *ins = &ctx->program->instructions[index];
+    UA_assert(ins->operandsSize == 2);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     UA_Variant *op1 = &ctx->stack[ctx->top++];
-    res = resolveOperand(ctx, &elm->filterOperands[1], op1);
+    res = resolveOperand(ctx, &ins->operands[1], op1);
     UA_CHECK_STATUS(res, return res);
     ctx->results[index] = t2v(UA_Ternary_and(v2t(op0), v2t(op1)));
     return UA_STATUSCODE_GOOD;
@@ -632,13 +742,13 @@ andOperator(UA_FilterEvalContext *ctx, size_t index) {
 
 static UA_StatusCode
 orOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 2);
+    const UA_EventFilterInstruction *ins = &ctx->program->instructions[index];
+    UA_assert(ins->operandsSize == 2);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     UA_Variant *op1 = &ctx->stack[ctx->top++];
-    res = resolveOperand(ctx, &elm->filterOperands[1], op1);
+    res = resolveOperand(ctx, &ins->operands[1], op1);
     UA_CHECK_STATUS(res, return res);
     ctx->results[index] = t2v(UA_Ternary_or(v2t(op0), v2t(op1)));
     return UA_STATUSCODE_GOOD;
@@ -646,10 +756,10 @@ orOperator(UA_FilterEvalContext *ctx, size_t index) {
 
 static UA_StatusCode
 notOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+    const UA_EventFilterInstruction *ins = &ctx->program->instructions[index];
+    UA_assert(ins->operandsSize == 1);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     ctx->results[index] = t2v(UA_Ternary_not(v2t(op0)));
     return UA_STATUSCODE_GOOD;
@@ -660,15 +770,15 @@ notOperator(UA_FilterEvalContext *ctx, size_t index) {
 static UA_StatusCode
 castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError) {
     /* Enough space on the stack left? */
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    if(ctx->top + elm->filterOperandsSize > UA_EVENTFILTER_MAXOPERANDS)
+    const UA_EventFilterInstruction *ins = &ctx->program->instructions[index];
+    if(ctx->top + ins->operandsSize > UA_EVENTFILTER_MAXOPERANDS)
         return UA_STATUSCODE_BADOUTOFMEMORY;
 
     /* Resolve all operands */
     UA_assert(ctx->top == 0); /* Assume the stack is empty */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    for(size_t i = 0; i < elm->filterOperandsSize; i++) {
-        res = resolveOperand(ctx, &elm->filterOperands[i], &ctx->stack[ctx->top++]);
+    for(size_t i = 0; i < ins->operandsSize; i++) {
+        res = resolveOperand(ctx, &ins->operands[i], &ctx->stack[ctx->top++]);
         UA_CHECK_STATUS(res, return res);
     }
     UA_assert(ctx->top > 0); /* Assume the stack is no longer empty */
@@ -684,6 +794,13 @@ castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError
 
     /* Cast the operands. Put the result in the same location on the stack. */
     for(size_t pos = 0; pos < ctx->top; pos++) {
+        /* Use the literal that was cast during the compilation */
+        const UA_EventOperand *op = &ins->operands[pos];
+        if(op->castType && op->castType == targetType) {
+            ctx->stack[pos] = op->cast;
+            ctx->stack[pos].storageType = UA_VARIANT_DATA_NODELETE;
+            continue;
+        }
         UA_Variant orig = ctx->stack[pos];
         res = castImplicit(&orig, targetType, &ctx->stack[pos]);
         if(res != UA_STATUSCODE_GOOD)
@@ -702,7 +819,7 @@ castResolveOperands(UA_FilterEvalContext *ctx, size_t index, UA_Boolean setError
 
 static UA_StatusCode
 compareOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
-    UA_assert(ctx->filter->elements[index].filterOperandsSize == 2);
+    UA_assert(ctx->program->instructions[index].operandsSize == 2);
 
     /* Resolve and cast the operands. A failed casting results in FALSE. Note
      * that operands could cast to NULL. */
@@ -783,7 +900,7 @@ lteOperator(UA_FilterEvalContext *ctx, size_t index) {
 
 static UA_StatusCode
 bitwiseOperator(UA_FilterEvalContext *ctx, size_t index, UA_FilterOperator op) {
-    UA_assert(ctx->filter->elements[index].filterOperandsSize == 2);
+    UA_assert(ctx->program->instructions[index].operandsSize == 2);
 
     /* Resolve and cast the operands. Note that operands could cast to NULL. */
     UA_assert(ctx->top == 0); /* Assume the stack is empty */
@@ -825,7 +942,7 @@ bitwiseOrOperator(UA_FilterEvalContext *ctx, size_t index) {
 
 static UA_StatusCode
 betweenOperator(UA_FilterEvalContext *ctx, size_t index) {
-    UA_assert(ctx->filter->elements[index].filterOperandsSize == 3);
+    UA_assert(ctx->program->instructions[index].operandsSize == 3);
 
     /* If no implicit conversion is available and the operands are of different
      * types, the particular result is FALSE. */
@@ -855,15 +972,15 @@ betweenOperator(UA_FilterEvalContext *ctx, size_t index) {
 
 static UA_StatusCode
 inListOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize >= 2);
+    const UA_EventFilterInstruction *ins = &ctx->program->instructions[index];
+    UA_assert(ins->operandsSize >= 2);
     UA_Boolean found = false;
     UA_Variant *op0 = &ctx->stack[ctx->top++];
     UA_Variant *op1 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
-    for(size_t i = 1; i < elm->filterOperandsSize && !found; i++) {
-        res = resolveOperand(ctx, &elm->filterOperands[i], op1);
+    for(size_t i = 1; i < ins->operandsSize && !found; i++) {
+        res = resolveOperand(ctx, &ins->operands[i], op1);
         if(res != UA_STATUSCODE_GOOD)
             continue;
         if(op0->type == op1->type && UA_equal(op0->data, op1->data, op0->type))
@@ -876,10 +993,10 @@ inListOperator(UA_FilterEvalContext *ctx, size_t index) {
 
 static UA_StatusCode
 isNullOperator(UA_FilterEvalContext *ctx, size_t index) {
-    const UA_ContentFilterElement *elm = &ctx->filter->elements[index];
-    UA_assert(elm->filterOperandsSize == 1);
+    const UA_EventFilterInstruction *ins = &ctx->program->instructions[index];
+    UA_assert(ins->operandsSize == 1);
     UA_Variant *op0 = &ctx->stack[ctx->top++];
-    UA_StatusCode res = resolveOperand(ctx, &elm->filterOperands[0], op0);
+    UA_StatusCode res = resolveOperand(ctx, &ins->operands[0], op0);
     UA_CHECK_STATUS(res, return res);
     ctx->results[index] = t2v(UA_Variant_isEmpty(op0) ? UA_TERNARY_TRUE : UA_TERNARY_FALSE);
     return UA_STATUSCODE_GOOD;
@@ -920,193 +1037,494 @@ static const UA_FilterOperatorJumptableElement operatorJumptable[18] = {
     {bitwiseOrOperator, 2, 2}
 };
 
-UA_StatusCode
-evaluateWhereClause(UA_Server *server, UA_Session *session, const UA_NodeId *eventNode,
-                    const UA_ContentFilter *contentFilter,
-                    UA_ContentFilterResult *contentFilterResult) {
-    UA_LOCK_ASSERT(&server->serviceMutex);
+/* Evaluate the where clause. Iterate backwards over the instructions and
+ * resolve each. This ensures that all element-index operands point to an
+ * evaluated element. */
+static UA_StatusCode
+evaluateInstructions(UA_FilterEvalContext *ctx) {
+    const UA_EventFilterProgram *program = ctx->program;
 
     /* An empty filter always succeeds */
-    if(contentFilter->elementsSize == 0)
+    if(program->instructionsSize == 0)
         return UA_STATUSCODE_GOOD;
 
-    /* Prepare the context */
-    UA_FilterEvalContext ctx;
-    ctx.filterResult = contentFilterResult;
-    ctx.filter = contentFilter;
-    ctx.server = server;
-    ctx.session = session;
-    ctx.eventNode = eventNode;
-    ctx.top = 0;
-
     /* Pacify some compilers by initializing the first result */
-    UA_Variant_init(&ctx.results[0]);
+    UA_Variant_init(&ctx->results[0]);
 
-    /* Evaluate the filter. Iterate backwards over the filter elements and
-     * resolve each. This ensures that all element-index operands point to an
-     * evaluated element. */
     UA_StatusCode res = UA_STATUSCODE_GOOD;
-    int i = (int)contentFilter->elementsSize - 1;
+    int i = (int)program->instructionsSize - 1;
     for(; i >= 0; i--) {
-        UA_ContentFilterElement *cfe = &contentFilter->elements[i];
-        res = operatorJumptable[cfe->filterOperator].operatorMethod(&ctx, (size_t)i);
-        for(size_t j = 0; j < ctx.top; j++)
-            UA_Variant_clear(&ctx.stack[j]); /* clean up the stack */
-        ctx.top = 0;
+        UA_FilterOperator op = program->instructions[i].filterOperator;
+        if(op < 0 || op > UA_FILTEROPERATOR_BITWISEOR)
+            res = UA_STATUSCODE_BADFILTEROPERATORUNSUPPORTED;
+        else
+            res = operatorJumptable[op].operatorMethod(ctx, (size_t)i);
+        for(size_t j = 0; j < ctx->top; j++)
+            UA_Variant_clear(&ctx->stack[j]); /* clean up the stack */
+        ctx->top = 0;
         if(res != UA_STATUSCODE_GOOD)
             break;
     }
 
     /* The filter matches if the operator at the first position evaluates to TRUE */
-    if(res == UA_STATUSCODE_GOOD && v2t(&ctx.results[0]) != UA_TERNARY_TRUE)
+    if(res == UA_STATUSCODE_GOOD && v2t(&ctx->results[0]) != UA_TERNARY_TRUE)
         res = UA_STATUSCODE_BADNOMATCH;
 
     /* Clean up the element result variants */
-    for(int j = (int)contentFilter->elementsSize - 1; j > i; j--)
-        UA_Variant_clear(&ctx.results[j]);
+    for(int j = (int)program->instructionsSize - 1; j > i; j--)
+        UA_Variant_clear(&ctx->results[j]);
     return res;
 }
 
-static UA_Boolean
-isValidEvent(UA_Server *server, const UA_NodeId *validEventParent,
-             const UA_NodeId *eventId) {
+static UA_StatusCode
+initEvalContext(UA_FilterEvalContext *ctx, UA_EventField *stackFields,
+                UA_Server *server, UA_Session *session,
+                const UA_EventFilterProgram *program, const UA_NodeId *eventNode,
+                const UA_NodelessEvent *nodelessEvent) {
+    ctx->server = server;
+    ctx->session = session;
+    ctx->eventNode = eventNode;
+    ctx->nodelessEvent = nodelessEvent;
+    ctx->program = program;
+    ctx->filterResult = NULL;
+    ctx->top = 0;
+
+    /* Prepare the field vector. Use the stack unless there are many slots. */
+    ctx->fields = stackFields;
+    if(program->fieldsSize > UA_EVENTFILTER_STACKFIELDS) {
+        ctx->fields = (UA_EventField*)
+            UA_malloc(program->fieldsSize * sizeof(UA_EventField));
+        if(!ctx->fields)
+            return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    memset(ctx->fields, 0, program->fieldsSize * sizeof(UA_EventField));
+    return UA_STATUSCODE_GOOD;
+}
+
+static void
+clearEvalContext(UA_FilterEvalContext *ctx, UA_EventField *stackFields) {
+    for(size_t i = 0; i < ctx->program->fieldsSize; i++)
+        UA_Variant_clear(&ctx->fields[i].value);
+    if(ctx->fields != stackFields)
+        UA_free(ctx->fields);
+}
+
+UA_StatusCode
+evaluateWhereClause(UA_Server *server, UA_Session *session, const UA_NodeId *eventNode,
+                    const UA_ContentFilter *contentFilter,
+                    UA_ContentFilterResult *contentFilterResult) {
     UA_LOCK_ASSERT(&server->serviceMutex);
 
-    /* Find the eventType variableNode */
-    UA_QualifiedName findName = UA_QUALIFIEDNAME(0, "EventType");
-    UA_BrowsePathResult bpr = browseSimplifiedBrowsePath(server, *eventId, 1, &findName);
-    if(bpr.statusCode != UA_STATUSCODE_GOOD || bpr.targetsSize < 1) {
-        UA_BrowsePathResult_clear(&bpr);
-        return false;
-    }
+    /* Compile a filter with only the where clause */
+    UA_EventFilter filter;
+    UA_EventFilter_init(&filter);
+    filter.whereClause = *contentFilter;
+    UA_EventFilterProgram program;
+    UA_StatusCode res = UA_EventFilterProgram_compile(server, &filter, &program);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
 
-    /* Get the EventType Property Node */
-    UA_Variant tOutVariant;
-    UA_Variant_init(&tOutVariant);
-    /* Read the Value of EventType Property Node (the Value should be a NodeId) */
-    UA_StatusCode retval = readWithReadValue(server, &bpr.targets[0].targetId.nodeId,
-                                             UA_ATTRIBUTEID_VALUE, &tOutVariant);
-    if(retval != UA_STATUSCODE_GOOD ||
-       !UA_Variant_hasScalarType(&tOutVariant, &UA_TYPES[UA_TYPES_NODEID])) {
-        UA_BrowsePathResult_clear(&bpr);
-        return false;
+    UA_FilterEvalContext ctx;
+    UA_EventField stackFields[UA_EVENTFILTER_STACKFIELDS];
+    res = initEvalContext(&ctx, stackFields, server, session,
+                          &program, eventNode, NULL);
+    if(res == UA_STATUSCODE_GOOD) {
+        ctx.filterResult = contentFilterResult;
+        res = evaluateInstructions(&ctx);
+        clearEvalContext(&ctx, stackFields);
     }
+    UA_EventFilterProgram_clear(&program);
+    return res;
+}
 
-    const UA_NodeId *tEventType = (UA_NodeId*)tOutVariant.data;
-
+static UA_Boolean
+isValidEventType(UA_Server *server, const UA_NodeId *validEventParent,
+                 const UA_NodeId *eventType) {
     /* Check whether the EventType is a Subtype of CondtionType (Part 9 first
      * implementation) */
     UA_NodeId conditionTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE);
     if(UA_NodeId_equal(validEventParent, &conditionTypeId) &&
-       isNodeInTree_singleRef(server, tEventType, &conditionTypeId,
-                              UA_REFERENCETYPEINDEX_HASSUBTYPE)) {
-        UA_BrowsePathResult_clear(&bpr);
-        UA_Variant_clear(&tOutVariant);
+       isNodeInTree_singleRef(server, eventType, &conditionTypeId,
+                              UA_REFERENCETYPEINDEX_HASSUBTYPE))
         return true;
-    }
 
     /* EventType is not a Subtype of CondtionType (ConditionId Clause won't be
      * present in Events, which are not Conditions) */
     /* Check whether Valid Event other than Conditions */
     UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
-    UA_Boolean isSubtypeOfBaseEvent =
-        isNodeInTree_singleRef(server, tEventType, &baseEventTypeId,
-                               UA_REFERENCETYPEINDEX_HASSUBTYPE);
-
-    UA_BrowsePathResult_clear(&bpr);
-    UA_Variant_clear(&tOutVariant);
-    return isSubtypeOfBaseEvent;
+    return isNodeInTree_singleRef(server, eventType, &baseEventTypeId,
+                                  UA_REFERENCETYPEINDEX_HASSUBTYPE);
 }
 
 UA_StatusCode
 filterEvent(UA_Server *server, UA_Session *session,
-            const UA_NodeId *eventNode, UA_EventFilter *filter,
-            UA_EventFieldList *efl, UA_EventFilterResult *result) {
+            const UA_EventFilterProgram *program,
+            const UA_NodeId *eventNode, const UA_NodelessEvent *nodelessEvent,
+            UA_EventFieldList *efl) {
     UA_LOCK_ASSERT(&server->serviceMutex);
 
+    UA_EventFieldList_init(efl);
+    const UA_EventFilter *filter = program->filter;
     if(filter->selectClausesSize == 0)
         return UA_STATUSCODE_BADEVENTFILTERINVALID;
 
-    UA_EventFieldList_init(efl);
+    UA_FilterEvalContext ctx;
+    UA_EventField stackFields[UA_EVENTFILTER_STACKFIELDS];
+    UA_StatusCode res = initEvalContext(&ctx, stackFields, server, session,
+                                        program, eventNode, nodelessEvent);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+
+    /* Evaluate the where filter. Do we event need to consider the event? */
+    res = evaluateInstructions(&ctx);
+    if(res != UA_STATUSCODE_GOOD)
+        goto cleanup;
+
     efl->eventFields = (UA_Variant *)
         UA_Array_new(filter->selectClausesSize, &UA_TYPES[UA_TYPES_VARIANT]);
-    if(!efl->eventFields)
-        return UA_STATUSCODE_BADOUTOFMEMORY;
+    if(!efl->eventFields) {
+        res = UA_STATUSCODE_BADOUTOFMEMORY;
+        goto cleanup;
+    }
     efl->eventFieldsSize = filter->selectClausesSize;
 
-    /* Empty event filter result */
-    UA_EventFilterResult_init(result);
-    result->selectClauseResultsSize = filter->selectClausesSize;
-    result->selectClauseResults = (UA_StatusCode *)
-        UA_Array_new(filter->selectClausesSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
-    if(!result->selectClauseResults) {
-        UA_EventFieldList_clear(efl);
-        UA_EventFilterResult_clear(result);
-        return UA_STATUSCODE_BADOUTOFMEMORY;
-    }
+    /* Apply the select filter */
+    for(size_t i = 0; i < filter->selectClausesSize; i++) {
+        const UA_EventSelectClause *sc = &program->selectClauses[i];
+
+        /* Check if the EventType is a subtype of the TypeDefinition. Not
+         * needed for BaseEventType. */
+        if(sc->checkEventType) {
+            const UA_EventField *et = resolveField(&ctx, 0);
+            if(et->status != UA_STATUSCODE_GOOD ||
+               !UA_Variant_hasScalarType(&et->value, &UA_TYPES[UA_TYPES_NODEID]) ||
+               !isValidEventType(server, &filter->selectClauses[i].typeDefinitionId,
+                                 (const UA_NodeId*)et->value.data))
+                continue;
+        }
 
-    /* Prepare content filter result structure */
-    if(filter->whereClause.elementsSize > 0) {
-        result->whereClauseResult.elementResultsSize = filter->whereClause.elementsSize;
-        result->whereClauseResult.elementResults = (UA_ContentFilterElementResult *)
-            UA_Array_new(filter->whereClause.elementsSize,
-                         &UA_TYPES[UA_TYPES_CONTENTFILTERELEMENTRESULT]);
-        if(!result->whereClauseResult.elementResults) {
-            UA_EventFieldList_clear(efl);
-            UA_EventFilterResult_clear(result);
-            return UA_STATUSCODE_BADOUTOFMEMORY;
+        /* Lookup the field. The overall filter can succeed even if a single
+         * select-field cannot be resolved. */
+        const UA_EventField *f = resolveField(&ctx, sc->field);
+        if(f->status != UA_STATUSCODE_GOOD)
+            continue;
+        if(sc->move) {
+            efl->eventFields[i] = f->value;
+            UA_Variant_init(&ctx.fields[sc->field].value);
+        } else {
+            UA_Variant_copy(&f->value, &efl->eventFields[i]);
         }
+    }
 
-        for(size_t i = 0; i < filter->whereClause.elementsSize; ++i) {
-            UA_ContentFilterElementResult *er =
-                &result->whereClauseResult.elementResults[i];
-            UA_ContentFilterElement *cf = &filter->whereClause.elements[i];
-            er->operandStatusCodesSize = cf->filterOperandsSize;
-            er->operandStatusCodes = (UA_StatusCode *)
-                UA_Array_new(er->operandStatusCodesSize, &UA_TYPES[UA_TYPES_STATUSCODE]);
-            if(!er->operandStatusCodes) {
-                UA_EventFieldList_clear(efl);
-                UA_EventFilterResult_clear(result);
-                return UA_STATUSCODE_BADOUTOFMEMORY;
-            }
+ cleanup:
+    clearEvalContext(&ctx, stackFields);
+    return res;
+}
+
+/* Filter Compilation
+ * ~~~~~~~~~~~~~~~~~~ */
+
+static UA_QualifiedName eventTypeQN = {0, UA_STRING_STATIC("EventType")};
+static const UA_SimpleAttributeOperand eventTypeOperand =
+    {{0, UA_NODEIDTYPE_NUMERIC, {UA_NS0ID_BASEEVENTTYPE}},
+     1, &eventTypeQN, UA_ATTRIBUTEID_VALUE, {0, NULL}};
+
+/* Get the slot for the operand. Equal operands share the slot. The fields
+ * array is allocated with sufficient size during the compilation. */
+static size_t
+getFieldSlot(UA_EventFilterProgram *program, const UA_SimpleAttributeOperand *sao) {
+    for(size_t i = 0; i < program->fieldsSize; i++) {
+        if(UA_order(program->fields[i], sao,
+                    &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) == UA_ORDER_EQ)
+            return i;
+    }
+    program->fields[program->fieldsSize] = sao;
+    return program->fieldsSize++;
+}
+
+/* The DataType of the field as defined in the event type. NULL if unknown. */
+static const UA_DataType *
+declaredFieldType(UA_Server *server, const UA_SimpleAttributeOperand *sao) {
+    if(sao->attributeId != UA_ATTRIBUTEID_VALUE || sao->browsePathSize == 0 ||
+       sao->indexRange.length > 0)
+        return NULL;
+    UA_BrowsePathResult bpr =
+        browseSimplifiedBrowsePath(server, sao->typeDefinitionId,
+                                   sao->browsePathSize, sao->browsePath);
+    const UA_DataType *type = NULL;
+    if(bpr.statusCode == UA_STATUSCODE_GOOD && bpr.targetsSize > 0) {
+        const UA_Node *node = UA_NODESTORE_GET(server, &bpr.targets[0].targetId.nodeId);
+        if(node) {
+            if(node->head.nodeClass == UA_NODECLASS_VARIABLE)
+                type = UA_Server_findDataType(server, &node->variableNode.dataType);
+            UA_NODESTORE_RELEASE(server, node);
         }
     }
+    UA_BrowsePathResult_clear(&bpr);
+    return type;
+}
 
-    /* Evaluate the where filter. Do we event need to consider the event? */
-    UA_StatusCode res = evaluateWhereClause(server, session, eventNode,
-                                            &filter->whereClause,
-                                            &result->whereClauseResult);
-    if(res != UA_STATUSCODE_GOOD){
-        UA_EventFieldList_clear(efl);
-        UA_EventFilterResult_clear(result);
-        return res;
+/* Pre-cast the literals of a comparison if the target type is known in
+ * advance. Casting at runtime remains the fallback if a field value has a
+ * different type. */
+static void
+precastLiterals(UA_Server *server, UA_EventFilterProgram *program,
+                UA_EventFilterInstruction *ins) {
+    switch(ins->filterOperator) {
+    case UA_FILTEROPERATOR_EQUALS:
+    case UA_FILTEROPERATOR_GREATERTHAN:
+    case UA_FILTEROPERATOR_LESSTHAN:
+    case UA_FILTEROPERATOR_GREATERTHANOREQUAL:
+    case UA_FILTEROPERATOR_LESSTHANOREQUAL:
+    case UA_FILTEROPERATOR_BETWEEN:
+    case UA_FILTEROPERATOR_BITWISEAND:
+    case UA_FILTEROPERATOR_BITWISEOR:
+        break;
+    default:
+        return;
     }
 
-    /* Apply the select filter */
+    /* Get the target type */
+    const UA_DataType *targetType = NULL;
+    for(size_t i = 0; i < ins->operandsSize; i++) {
+        const UA_EventOperand *op = &ins->operands[i];
+        const UA_DataType *type = NULL;
+        if(op->kind == UA_EVENTOPERAND_LITERAL)
+            type = op->literal->type;
+        else if(op->kind == UA_EVENTOPERAND_FIELD)
+            type = declaredFieldType(server, program->fields[op->index]);
+        if(!type)
+            return;
+        targetType = (i == 0) ? type : implicitCastTargetType(targetType, type);
+        if(!targetType)
+            return;
+    }
+
+    /* Cast the literals */
+    for(size_t i = 0; i < ins->operandsSize; i++) {
+        UA_EventOperand *op = &ins->operands[i];
+        if(op->kind != UA_EVENTOPERAND_LITERAL || op->literal->type == targetType)
+            continue;
+        if(castImplicit(op->literal, targetType, &op->cast) == UA_STATUSCODE_GOOD)
+            op->castType = targetType;
+    }
+}
+
+static void
+compileOperand(UA_EventFilterProgram *program, const UA_ExtensionObject *eo,
+               UA_EventOperand *op) {
+    memset(op, 0, sizeof(UA_EventOperand));
+    if(eo->encoding != UA_EXTENSIONOBJECT_DECODED &&
+       eo->encoding != UA_EXTENSIONOBJECT_DECODED_NODELETE)
+        return; /* Invalid */
+    const UA_DataType *type = eo->content.decoded.type;
+    if(type == &UA_TYPES[UA_TYPES_ELEMENTOPERAND]) {
+        op->kind = UA_EVENTOPERAND_ELEMENT;
+        op->index = ((const UA_ElementOperand*)eo->content.decoded.data)->index;
+    } else if(type == &UA_TYPES[UA_TYPES_LITERALOPERAND]) {
+        op->kind = UA_EVENTOPERAND_LITERAL;
+        op->literal = &((const UA_LiteralOperand*)eo->content.decoded.data)->value;
+    } else if(type == &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]) {
+        op->kind = UA_EVENTOPERAND_FIELD;
+        op->index = getFieldSlot(program, (const UA_SimpleAttributeOperand*)
+                                 eo->content.decoded.data);
+    }
+}
+
+UA_StatusCode
+UA_EventFilterProgram_compile(UA_Server *server, const UA_EventFilter *filter,
+                              UA_EventFilterProgram *program) {
+    memset(program, 0, sizeof(UA_EventFilterProgram));
+    program->filter = filter;
+
     UA_NodeId baseEventTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE);
+    UA_EventOperand *operands = NULL;
+    const UA_ContentFilter *cf = &filter->whereClause;
+    if(cf->elementsSize > UA_EVENTFILTER_MAXELEMENTS)
+        return UA_STATUSCODE_BADEVENTFILTERINVALID;
+
+    /* Allocate for the maximum number of field slots */
+    size_t maxFields = 1 + filter->selectClausesSize;
+    size_t operandsSize = 0;
+    for(size_t i = 0; i < cf->elementsSize; i++)
+        operandsSize += cf->elements[i].filterOperandsSize;
+    maxFields += operandsSize;
+    program->fields = (const UA_SimpleAttributeOperand **)
+        UA_malloc(maxFields * sizeof(UA_SimpleAttributeOperand*));
+    if(!program->fields)
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    program->fields[0] = &eventTypeOperand;
+    program->fieldsSize = 1;
+
+    /* Select clauses */
+    if(filter->selectClausesSize > 0) {
+        program->selectClauses = (UA_EventSelectClause*)
+            UA_calloc(filter->selectClausesSize, sizeof(UA_EventSelectClause));
+        if(!program->selectClauses)
+            goto error;
+    }
+    for(size_t i = 0; i < filter->selectClausesSize; i++) {
+        const UA_SimpleAttributeOperand *sao = &filter->selectClauses[i];
+        program->selectClauses[i].field = getFieldSlot(program, sao);
+        program->selectClauses[i].checkEventType =
+            !UA_NodeId_equal(&sao->typeDefinitionId, &baseEventTypeId);
+    }
+
+    /* Move the field value for its last select clause. The EventType is always
+     * copied as it can be used to check later select clauses. */
     for(size_t i = 0; i < filter->selectClausesSize; i++) {
-        UA_SimpleAttributeOperand *sc = &filter->selectClauses[i];
-        /* Check if the browsePath is BaseEventType, in which case nothing more
-         * needs to be checked */
-        if(!UA_NodeId_equal(&sc->typeDefinitionId, &baseEventTypeId) &&
-           !isValidEvent(server, &sc->typeDefinitionId, eventNode)) {
-            UA_Variant_init(&efl->eventFields[i]);
-            /* EventFilterResult currently isn't being used
-               notification->result.selectClauseResults[i] =
-                   UA_STATUSCODE_BADTYPEDEFINITIONINVALID; */
+        UA_EventSelectClause *sc = &program->selectClauses[i];
+        if(sc->field == 0)
             continue;
+        sc->move = true;
+        for(size_t j = i + 1; j < filter->selectClausesSize && sc->move; j++)
+            sc->move = (program->selectClauses[j].field != sc->field);
+    }
+
+    /* Where clause. The operands of all instructions share one allocation. */
+    if(cf->elementsSize > 0) {
+        program->instructions = (UA_EventFilterInstruction*)
+            UA_calloc(cf->elementsSize, sizeof(UA_EventFilterInstruction));
+        if(!program->instructions)
+            goto error;
+        program->instructionsSize = cf->elementsSize;
+    }
+    if(operandsSize > 0) {
+        operands = (UA_EventOperand*)UA_calloc(operandsSize, sizeof(UA_EventOperand));
+        if(!operands)
+            goto error;
+    }
+    for(size_t i = 0; i < cf->elementsSize; i++) {
+        const UA_ContentFilterElement *elm = &cf->elements[i];
+        UA_EventFilterInstruction *ins = &program->instructions[i];
+        ins->filterOperator = elm->filterOperator;
+        ins->operandsSize = elm->filterOperandsSize;
+        ins->operands = operands;
+        operands += elm->filterOperandsSize;
+        for(size_t j = 0; j < elm->filterOperandsSize; j++)
+            compileOperand(program, &elm->filterOperands[j], &ins->operands[j]);
+        precastLiterals(server, program, ins);
+    }
+    return UA_STATUSCODE_GOOD;
+
+ error:
+    UA_EventFilterProgram_clear(program);
+    return UA_STATUSCODE_BADOUTOFMEMORY;
+}
+
+void
+UA_EventFilterProgram_clear(UA_EventFilterProgram *program) {
+    if(program->instructionsSize > 0) {
+        /* The operands of all instructions share one allocation */
+        UA_EventOperand *operands = NULL;
+        for(size_t i = 0; i < program->instructionsSize; i++) {
+            UA_EventFilterInstruction *ins = &program->instructions[i];
+            if(!operands && ins->operandsSize > 0)
+                operands = ins->operands;
+            for(size_t j = 0; j < ins->operandsSize; j++)
+                UA_Variant_clear(&ins->operands[j].cast);
         }
+        UA_free(operands);
+    }
+    UA_free(program->instructions);
+    UA_free(program->selectClauses);
+    UA_free((void*)(uintptr_t)program->fields);
+    memset(program, 0, sizeof(UA_EventFilterProgram));
+}
 
-        /* Lookup the field. The overall filter can succeed even if a single
-         * select-field cannot be resolved. */
-        result->selectClauseResults[i] =
-            resolveSimpleAttributeOperand(server, session, eventNode,
-                                          sc, &efl->eventFields[i]);
+enum ZIP_CMP
+cmpSharedEventFilter(const UA_SharedEventFilterKey *a,
+                     const UA_SharedEventFilterKey *b) {
+    if(a->hash != b->hash)
+        return (a->hash < b->hash) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    if(a->encoding.length != b->encoding.length)
+        return (a->encoding.length < b->encoding.length) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+    int cmp = memcmp(a->encoding.data, b->encoding.data, a->encoding.length);
+    if(cmp == 0)
+        return ZIP_CMP_EQ;
+    return (cmp < 0) ? ZIP_CMP_LESS : ZIP_CMP_MORE;
+}
+
+static void
+deleteSharedEventFilter(UA_SharedEventFilter *sf) {
+    UA_EventFilterProgram_clear(&sf->program);
+    UA_EventFilter_clear(&sf->filter);
+    UA_EventFieldList_clear(&sf->evalFields);
+    UA_ByteString_clear(&sf->key.encoding);
+    UA_free(sf);
+}
+
+static UA_StatusCode
+getSharedEventFilter(UA_Server *server, const UA_EventFilter *filter,
+                     UA_SharedEventFilter **outFilter) {
+    /* Identify the filter by its binary encoding */
+    UA_SharedEventFilterKey key;
+    UA_ByteString_init(&key.encoding);
+    UA_StatusCode res = UA_encodeBinary(filter, &UA_TYPES[UA_TYPES_EVENTFILTER],
+                                        &key.encoding, NULL);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    key.hash = UA_ByteString_hash(0, key.encoding.data, key.encoding.length);
+
+    /* Use the existing filter */
+    UA_SharedEventFilter *sf =
+        ZIP_FIND(UA_SharedEventFilterTree, &server->eventFilters, &key);
+    if(sf) {
+        UA_ByteString_clear(&key.encoding);
+        sf->refCount++;
+        *outFilter = sf;
+        return UA_STATUSCODE_GOOD;
+    }
+
+    /* Compile a new filter. The program points into the copied filter. */
+    sf = (UA_SharedEventFilter*)UA_calloc(1, sizeof(UA_SharedEventFilter));
+    if(!sf) {
+        UA_ByteString_clear(&key.encoding);
+        return UA_STATUSCODE_BADOUTOFMEMORY;
+    }
+    sf->key = key;
+    res = UA_EventFilter_copy(filter, &sf->filter);
+    if(res == UA_STATUSCODE_GOOD)
+        res = UA_EventFilterProgram_compile(server, &sf->filter, &sf->program);
+    if(res != UA_STATUSCODE_GOOD) {
+        deleteSharedEventFilter(sf);
+        return res;
     }
+    sf->refCount = 1;
+    ZIP_INSERT(UA_SharedEventFilterTree, &server->eventFilters, sf);
+    *outFilter = sf;
+    return UA_STATUSCODE_GOOD;
+}
 
+UA_StatusCode
+UA_MonitoredItem_compileEventFilter(UA_Server *server, UA_MonitoredItem *mon,
+                                    const UA_MonitoringParameters *params) {
+    UA_assert(params->filter.content.decoded.type == &UA_TYPES[UA_TYPES_EVENTFILTER]);
+    UA_SharedEventFilter *sf;
+    UA_StatusCode res =
+        getSharedEventFilter(server, (const UA_EventFilter*)
+                             params->filter.content.decoded.data, &sf);
+    if(res != UA_STATUSCODE_GOOD)
+        return res;
+    UA_MonitoredItem_releaseEventFilter(server, mon);
+    mon->eventFilter = sf;
     return UA_STATUSCODE_GOOD;
 }
 
+void
+UA_MonitoredItem_releaseEventFilter(UA_Server *server, UA_MonitoredItem *mon) {
+    UA_SharedEventFilter *sf = mon->eventFilter;
+    if(!sf)
+        return;
+    mon->eventFilter = NULL;
+    UA_assert(sf->refCount > 0);
+    sf->refCount--;
+    if(sf->refCount > 0)
+        return;
+    ZIP_REMOVE(UA_SharedEventFilterTree, &server->eventFilters, sf);
+    deleteSharedEventFilter(sf);
+}
+
 /*****************************************/
 /* Validation of Filters during Creation */
 /*****************************************/
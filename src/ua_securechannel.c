@@ -349,7 +349,9 @@ encodeHeadersSym(UA_MessageContext *mc, size_t totalLength) {
     UA_TcpMessageHeader header;
     header.messageTypeAndChunkType = mc->messageType;
     header.messageSize = (UA_UInt32)totalLength;
-    if(mc->final)
+    if(mc->aborted)
+        header.messageTypeAndChunkType += UA_CHUNKTYPE_ABORT;
+    else if(mc->final)
         header.messageTypeAndChunkType += UA_CHUNKTYPE_FINAL;
     else
         header.messageTypeAndChunkType += UA_CHUNKTYPE_INTERMEDIATE;
@@ -495,6 +497,7 @@ UA_MessageContext_begin(UA_MessageContext *mc, UA_SecureChannel *channel,
     mc->chunksSoFar = 0;
     mc->messageSizeSoFar = 0;
     mc->final = false;
+    mc->aborted = false;
     mc->messageBuffer = UA_BYTESTRING_NULL;
     mc->messageType = messageType;
 
@@ -538,6 +541,48 @@ UA_MessageContext_abort(UA_MessageContext *mc) {
     cm->freeNetworkBuffer(cm, mc->channel->connectionId, &mc->messageBuffer);
 }
 
+UA_StatusCode
+UA_MessageContext_sendAbort(UA_MessageContext *mc, UA_StatusCode error,
+                            const UA_String *reason) {
+    /* Nothing was sent so far */
+    if(mc->chunksSoFar == 0) {
+        UA_MessageContext_abort(mc);
+        return UA_STATUSCODE_GOOD;
+    }
+
+    UA_SecureChannel *channel = mc->channel;
+    UA_ConnectionManager *cm = channel->connectionManager;
+    if(!UA_SecureChannel_isConnected(channel))
+        return UA_STATUSCODE_BADCONNECTIONCLOSED;
+
+    /* Drop the content of the current chunk. Or get a new buffer if it was
+     * already cleaned up. */
+    if(mc->messageBuffer.length == 0) {
+        UA_StatusCode res =
+            cm->allocNetworkBuffer(cm, channel->connectionId, &mc->messageBuffer,
+                                   channel->config.sendBufferSize);
+        UA_CHECK_STATUS(res, return res);
+    }
+    setBufPos(mc);
+
+    /* The abort chunk does not count towards the limits of the message */
+    mc->chunksSoFar = 0;
+    mc->messageSizeSoFar = 0;
+    mc->aborted = true;
+
+    /* Encode the error and the reason as the body */
+    UA_StatusCode res =
+        UA_encodeBinaryInternal(&error, &UA_TYPES[UA_TYPES_STATUSCODE],
+                                &mc->buf_pos, &mc->buf_end, NULL, NULL, NULL);
+    res |= UA_encodeBinaryInternal(reason, &UA_TYPES[UA_TYPES_STRING],
+                                   &mc->buf_pos, &mc->buf_end, NULL, NULL, NULL);
+    if(res != UA_STATUSCODE_GOOD) {
+        UA_MessageContext_abort(mc);
+        return res;
+    }
+    return sendSymmetricChunk(mc);
+}
+
 UA_StatusCode
 UA_SecureChannel_sendSymmetricMessage(UA_SecureChannel *channel, UA_UInt32 requestId,
                                       UA_MessageType messageType, void *payload,
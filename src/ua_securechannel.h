@@ -247,6 +247,7 @@ typedef struct {
     const UA_Byte *buf_end;
 
     UA_Boolean final;
+    UA_Boolean aborted;
 } UA_MessageContext;
 
 /* Start the context of a new symmetric message. */
@@ -272,6 +273,15 @@ UA_MessageContext_finish(UA_MessageContext *mc);
 void
 UA_MessageContext_abort(UA_MessageContext *mc);
 
+/* Send an abort chunk with the error and the reason instead of the remaining
+ * message. The receiver discards the chunks received so far. The abort chunk
+ * is the final answer for the request. If no chunk was sent yet, the context
+ * is only cleaned up and another message can be sent. The context is cleaned
+ * up also in case of errors. */
+UA_StatusCode
+UA_MessageContext_sendAbort(UA_MessageContext *mc, UA_StatusCode error,
+                            const UA_String *reason);
+
 /**
  * Receive Message
  * --------------- */
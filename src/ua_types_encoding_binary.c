@@ -516,6 +516,23 @@ Array_decodeBinary(Ctx *ctx, void *UA_RESTRICT *UA_RESTRICT dst,
     UA_CHECK(ctx->pos + ((type->memSize * length) / 128) <= ctx->end,
              return UA_STATUSCODE_BADDECODINGERROR);
 
+    /* Point into the input buffer if the position is aligned for the type.
+     * The alignment of a type divides its size. */
+    if(type->overlayable && ctx->opts.zeroCopy && ctx->opts.calloc) {
+        size_t memSize = type->memSize;
+        size_t align = memSize & (~memSize + 1); /* Lowest set bit */
+        if(align > 8)
+            align = 8;
+        if(((uintptr_t)ctx->pos & (align - 1)) == 0) {
+            UA_CHECK(ctx->pos + (type->memSize * length) <= ctx->end,
+                     return UA_STATUSCODE_BADDECODINGERROR);
+            *dst = ctx->pos;
+            ctx->pos += type->memSize * length;
+            *out_length = length;
+            return UA_STATUSCODE_GOOD;
+        }
+    }
+
     /* Allocate memory */
     *dst = ctxCalloc(ctx, length, type->memSize);
     UA_CHECK_MEM(*dst, return UA_STATUSCODE_BADOUTOFMEMORY);
@@ -769,7 +786,7 @@ FUNC_DECODE_BINARY(ExpandedNodeId) {
                                               dst->namespaceUri,
                                               &dst->nodeId.namespaceIndex);
             if(foundNsUri == UA_STATUSCODE_GOOD)
-                UA_String_clear(&dst->namespaceUri);
+                ctxClear(ctx, &dst->namespaceUri, &UA_TYPES[UA_TYPES_STRING]);
         }
     }
 
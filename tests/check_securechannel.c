@@ -417,6 +417,58 @@ START_TEST(SecureChannel_sendSymmetricMessage_modeSignAndEncrypt)
     ck_assert_msg(fCalled.sym_enc, "Expected message to have been encrypted");
 } END_TEST
 
+START_TEST(SecureChannel_sendAbort) {
+    testChannel.securityMode = UA_MESSAGESECURITYMODE_NONE;
+
+    /* Nothing was sent. No abort chunk is needed. */
+    UA_MessageContext mc;
+    UA_StatusCode retval = UA_MessageContext_begin(&mc, &testChannel, 42, UA_MESSAGETYPE_MSG);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_UInt32 dummy = 42;
+    retval = UA_MessageContext_encode(&mc, &dummy, &UA_TYPES[UA_TYPES_UINT32]);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_String reason = UA_STRING("Aborted");
+    retval = UA_MessageContext_sendAbort(&mc, UA_STATUSCODE_BADINTERNALERROR, &reason);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(sentData.length, 0);
+
+    /* Send the first chunk of a large message. Then abort. */
+    retval = UA_MessageContext_begin(&mc, &testChannel, 42, UA_MESSAGETYPE_MSG);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_ByteString large;
+    retval = UA_ByteString_allocBuffer(&large, testChannel.config.sendBufferSize);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    memset(large.data, 0, large.length);
+    retval = UA_MessageContext_encode(&mc, &large, &UA_TYPES[UA_TYPES_BYTESTRING]);
+    UA_ByteString_clear(&large);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_gt(sentData.length, 0);
+    retval = UA_MessageContext_sendAbort(&mc, UA_STATUSCODE_BADINTERNALERROR, &reason);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* The abort chunk contains the error and the reason */
+    size_t offset = 0;
+    UA_TcpMessageHeader header;
+    retval = UA_decodeBinaryInternal(&sentData, &offset, &header,
+                                     &UA_TRANSPORT[UA_TRANSPORT_TCPMESSAGEHEADER], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(header.messageTypeAndChunkType,
+                      UA_MESSAGETYPE_MSG + UA_CHUNKTYPE_ABORT);
+    ck_assert_uint_eq(header.messageSize, sentData.length);
+    offset = UA_SECURECHANNEL_SYMMETRIC_HEADER_TOTALLENGTH;
+    UA_StatusCode error;
+    retval = UA_decodeBinaryInternal(&sentData, &offset, &error,
+                                     &UA_TYPES[UA_TYPES_STATUSCODE], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(error, UA_STATUSCODE_BADINTERNALERROR);
+    UA_String sentReason;
+    retval = UA_decodeBinaryInternal(&sentData, &offset, &sentReason,
+                                     &UA_TYPES[UA_TYPES_STRING], NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert(UA_String_equal(&sentReason, &reason));
+    UA_String_clear(&sentReason);
+} END_TEST
+
 START_TEST(SecureChannel_sendSymmetricMessage_invalidParameters) {
     // initialize dummy message
     UA_ReadRequest dummyMessage;
@@ -559,6 +611,7 @@ testSuite_SecureChannel(void) {
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeNone);
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeSign);
     tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendSymmetricMessage_modeSignAndEncrypt);
+    tcase_add_test(tc_sendSymmetricMessage, SecureChannel_sendAbort);
     suite_add_tcase(s, tc_sendSymmetricMessage);
 
     TCase *tc_processBuffer = tcase_create("Test chunk assembly");
@@ -373,6 +373,67 @@ START_TEST(UA_String_decodeShallAllocateMemoryAndCopyString) {
 }
 END_TEST
 
+/* Bump allocator for the decoding into an arena */
+static UA_UInt64 arenaMem[64];
+static size_t arenaUsed;
+
+static void *
+arenaCalloc(void *context, size_t nelem, size_t elsize) {
+    size_t words = ((nelem * elsize) + 7) / 8;
+    if(arenaUsed + words > 64)
+        return NULL;
+    void *p = &arenaMem[arenaUsed];
+    memset(p, 0, words * 8);
+    arenaUsed += words;
+    return p;
+}
+
+START_TEST(UA_decodeZeroCopyShallPointIntoBuffer) {
+    UA_DecodeBinaryOptions opt;
+    memset(&opt, 0, sizeof(UA_DecodeBinaryOptions));
+    opt.calloc = arenaCalloc;
+    opt.zeroCopy = true;
+    arenaUsed = 0;
+
+    /* The string content points into the buffer */
+    UA_Byte strData[] = { 0x08, 0x00, 0x00, 0x00, 'A', 'C', 'P', 'L', 'T', ' ', 'U', 'A' };
+    UA_ByteString src = { 12, strData };
+    UA_String str;
+    UA_StatusCode retval = UA_decodeBinary(&src, &str, &UA_TYPES[UA_TYPES_STRING], &opt);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(str.length, 8);
+    ck_assert_ptr_eq(str.data, &strData[4]);
+    ck_assert_uint_eq(arenaUsed, 0);
+
+    /* An Int32 array is only used in place if the position is aligned. The
+     * array of the variant begins after the encoding byte and the length. */
+    UA_UInt64 buf[8];
+    UA_Byte *bytes = (UA_Byte*)buf;
+    UA_Int32 values[3] = {1, -2, 3};
+    UA_Variant v;
+    UA_Variant_setArray(&v, values, 3, &UA_TYPES[UA_TYPES_INT32]);
+    UA_ByteString enc = {sizeof(buf) - 3, &bytes[3]};
+    retval = UA_encodeBinary(&v, &UA_TYPES[UA_TYPES_VARIANT], &enc, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Variant v2;
+    retval = UA_decodeBinary(&enc, &v2, &UA_TYPES[UA_TYPES_VARIANT], &opt);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(v2.data, &bytes[8]);
+    ck_assert_uint_eq(v2.arrayLength, 3);
+    ck_assert_int_eq(((UA_Int32*)v2.data)[1], -2);
+
+    /* Unaligned. The array is copied into the arena. */
+    memmove(&bytes[4], &bytes[3], enc.length);
+    enc.data = &bytes[4];
+    retval = UA_decodeBinary(&enc, &v2, &UA_TYPES[UA_TYPES_VARIANT], &opt);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_ptr_eq(v2.data, &arenaMem[0]);
+    ck_assert_int_eq(((UA_Int32*)v2.data)[2], 3);
+    ck_assert_uint_gt(arenaUsed, 0);
+}
+END_TEST
+
 START_TEST(UA_String_decodeWithNegativeSizeShallNotAllocateMemoryAndNullPtr) {
     // given
     size_t pos = 0;
@@ -1774,6 +1835,7 @@ static Suite *testSuite_builtin(void) {
     tcase_add_test(tc_decode, UA_Double_decodeShallGive2147483648);
     tcase_add_test(tc_decode, UA_Byte_encode_test);
     tcase_add_test(tc_decode, UA_String_decodeShallAllocateMemoryAndCopyString);
+    tcase_add_test(tc_decode, UA_decodeZeroCopyShallPointIntoBuffer);
     tcase_add_test(tc_decode, UA_String_decodeWithNegativeSizeShallNotAllocateMemoryAndNullPtr);
     tcase_add_test(tc_decode, UA_String_decodeWithZeroSizeShallNotAllocateMemoryAndNullPtr);
     tcase_add_test(tc_decode, UA_NodeId_decodeTwoByteShallReadTwoBytesAndSetNamespaceToZero);
@@ -0,0 +1,368 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel.h>
+#include <open62541/client_highlevel_async.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+
+#define BATCHING_WINDOW 50
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+static UA_NodeId variableId;
+static UA_NodeId methodId;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+#ifdef UA_ENABLE_METHODCALLS
+static UA_StatusCode
+doubleMethod(UA_Server *s, const UA_NodeId *sessionId, void *sessionContext,
+             const UA_NodeId *mId, void *methodContext,
+             const UA_NodeId *objectId, void *objectContext,
+             size_t inputSize, const UA_Variant *input,
+             size_t outputSize, UA_Variant *output) {
+    UA_Int32 result = *(UA_Int32*)input[0].data * 2;
+    return UA_Variant_setScalarCopy(output, &result, &UA_TYPES[UA_TYPES_INT32]);
+}
+#endif
+
+static void setup(void) {
+    running = true;
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_VariableAttributes vattr = UA_VariableAttributes_default;
+    UA_Int32 value = 42;
+    UA_Variant_setScalar(&vattr.value, &value, &UA_TYPES[UA_TYPES_INT32]);
+    vattr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_StatusCode res =
+        UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                  UA_NS0ID(OBJECTSFOLDER), UA_NS0ID(ORGANIZES),
+                                  UA_QUALIFIEDNAME(1, "Variable"),
+                                  UA_NS0ID(BASEDATAVARIABLETYPE), vattr,
+                                  NULL, &variableId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+#ifdef UA_ENABLE_METHODCALLS
+    UA_Argument inArg;
+    UA_Argument_init(&inArg);
+    inArg.dataType = UA_TYPES[UA_TYPES_INT32].typeId;
+    inArg.valueRank = UA_VALUERANK_SCALAR;
+    UA_Argument outArg = inArg;
+    UA_MethodAttributes mattr = UA_MethodAttributes_default;
+    mattr.executable = true;
+    mattr.userExecutable = true;
+    res = UA_Server_addMethodNode(server, UA_NODEID_NULL,
+                                  UA_NS0ID(OBJECTSFOLDER), UA_NS0ID(HASCOMPONENT),
+                                  UA_QUALIFIEDNAME(1, "Double"), mattr,
+                                  doubleMethod, 1, &inArg, 1, &outArg,
+                                  NULL, &methodId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+#endif
+
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_NodeId_clear(&variableId);
+    UA_NodeId_clear(&methodId);
+    UA_Server_delete(server);
+}
+
+static UA_Client *
+newBatchingClient(UA_UInt32 maxOperations) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    cc->batchingWindow = BATCHING_WINDOW;
+    cc->batchingMaxOperations = maxOperations;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    cc->outStandingPublishRequests = 0;
+#endif
+    UA_StatusCode res = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    /* Receive the operation limits of the server */
+    for(size_t i = 0; i < 10; i++)
+        UA_Client_run_iterate(client, 10);
+    return client;
+}
+
+/* Iterate until all callbacks are called */
+static void
+waitFor(UA_Client *client, size_t *counter, size_t expected) {
+    for(size_t i = 0; i < 1000 && *counter < expected; i++)
+        UA_Client_run_iterate(client, 10);
+    ck_assert_uint_eq(*counter, expected);
+}
+
+#define OPERATIONS 10
+
+typedef struct {
+    size_t received;
+    UA_UInt32 requestIds[OPERATIONS];
+    UA_StatusCode status[OPERATIONS];
+    UA_Int32 values[OPERATIONS];
+} BatchResults;
+
+typedef struct {
+    BatchResults *results;
+    size_t index;
+} OperationContext;
+
+static OperationContext contexts[OPERATIONS];
+
+static void
+readCallback(UA_Client *client, void *userdata, UA_UInt32 requestId,
+             UA_StatusCode status, UA_DataValue *value) {
+    OperationContext *ctx = (OperationContext*)userdata;
+    ctx->results->requestIds[ctx->index] = requestId;
+    ctx->results->status[ctx->index] = (status != UA_STATUSCODE_GOOD) ?
+        status : value->status;
+    if(value && value->hasValue &&
+       UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_INT32]))
+        ctx->results->values[ctx->index] = *(UA_Int32*)value->value.data;
+    ctx->results->received++;
+}
+
+static void
+writeCallback(UA_Client *client, void *userdata, UA_UInt32 requestId,
+              UA_WriteResponse *wr) {
+    OperationContext *ctx = (OperationContext*)userdata;
+    ctx->results->requestIds[ctx->index] = requestId;
+    ctx->results->status[ctx->index] = wr->responseHeader.serviceResult;
+    if(wr->resultsSize == 1)
+        ctx->results->status[ctx->index] = wr->results[0];
+    ctx->results->received++;
+}
+
+static void
+callCallback(UA_Client *client, void *userdata, UA_UInt32 requestId,
+             UA_CallResponse *cr) {
+    OperationContext *ctx = (OperationContext*)userdata;
+    ctx->results->requestIds[ctx->index] = requestId;
+    ctx->results->status[ctx->index] = cr->responseHeader.serviceResult;
+    if(cr->resultsSize == 1) {
+        ctx->results->status[ctx->index] = cr->results[0].statusCode;
+        if(cr->results[0].outputArgumentsSize == 1)
+            ctx->results->values[ctx->index] =
+                *(UA_Int32*)cr->results[0].outputArguments[0].data;
+    }
+    ctx->results->received++;
+}
+
+static void
+setContexts(BatchResults *results) {
+    memset(results, 0, sizeof(BatchResults));
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        contexts[i].results = results;
+        contexts[i].index = i;
+    }
+}
+
+START_TEST(Client_batching_read) {
+    UA_Client *client = newBatchingClient(0);
+    BatchResults results;
+    setContexts(&results);
+
+    /* The last read targets an unknown node */
+    UA_UInt32 reqIds[OPERATIONS];
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        UA_NodeId id = (i < OPERATIONS - 1) ? variableId : UA_NODEID_NUMERIC(1, 4711);
+        UA_StatusCode res =
+            UA_Client_readValueAttribute_async(client, id, readCallback,
+                                               &contexts[i], &reqIds[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(reqIds[i], reqIds[0]);
+    }
+
+    /* Nothing is sent before the window ends */
+    UA_Client_run_iterate(client, 10);
+    ck_assert_uint_eq(results.received, 0);
+
+    UA_fakeSleep(BATCHING_WINDOW + 1);
+    waitFor(client, &results.received, OPERATIONS);
+    for(size_t i = 0; i < OPERATIONS - 1; i++) {
+        ck_assert_uint_eq(results.requestIds[i], reqIds[0]);
+        ck_assert_uint_eq(results.status[i], UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(results.values[i], 42);
+    }
+    ck_assert_uint_eq(results.status[OPERATIONS - 1], UA_STATUSCODE_BADNODEIDUNKNOWN);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+START_TEST(Client_batching_maxOperations) {
+    UA_Client *client = newBatchingClient(4);
+    BatchResults results;
+    setContexts(&results);
+
+    /* Full batches are sent right away. The rest waits for the window. */
+    UA_UInt32 reqIds[OPERATIONS];
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        UA_StatusCode res =
+            UA_Client_readValueAttribute_async(client, variableId, readCallback,
+                                               &contexts[i], &reqIds[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    waitFor(client, &results.received, 8);
+
+    UA_fakeSleep(BATCHING_WINDOW + 1);
+    waitFor(client, &results.received, OPERATIONS);
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        ck_assert_uint_eq(results.requestIds[i], reqIds[i]);
+        ck_assert_uint_eq(results.requestIds[i], reqIds[(i / 4) * 4]);
+        ck_assert_uint_eq(results.status[i], UA_STATUSCODE_GOOD);
+    }
+    ck_assert_uint_ne(reqIds[0], reqIds[4]);
+    ck_assert_uint_ne(reqIds[4], reqIds[8]);
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+START_TEST(Client_batching_serverLimit) {
+    UA_Server_getConfig(server)->maxNodesPerRead = 3;
+    UA_Client *client = newBatchingClient(0);
+    BatchResults results;
+    setContexts(&results);
+
+    /* The operation limit of the server is respected */
+    UA_UInt32 reqIds[OPERATIONS];
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        UA_StatusCode res =
+            UA_Client_readValueAttribute_async(client, variableId, readCallback,
+                                               &contexts[i], &reqIds[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+    UA_fakeSleep(BATCHING_WINDOW + 1);
+    waitFor(client, &results.received, OPERATIONS);
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        ck_assert_uint_eq(results.requestIds[i], reqIds[(i / 3) * 3]);
+        ck_assert_uint_eq(results.status[i], UA_STATUSCODE_GOOD);
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+START_TEST(Client_batching_writeCall) {
+    UA_Client *client = newBatchingClient(0);
+    BatchResults writeResults;
+    setContexts(&writeResults);
+
+    /* Writes are batched */
+    UA_UInt32 reqIds[OPERATIONS];
+    for(size_t i = 0; i < 5; i++) {
+        UA_Int32 value = (UA_Int32)i;
+        UA_Variant v;
+        UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_INT32]);
+        UA_StatusCode res =
+            UA_Client_writeValueAttribute_async(client, variableId, &v, writeCallback,
+                                                &contexts[i], &reqIds[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(reqIds[i], reqIds[0]);
+    }
+    UA_fakeSleep(BATCHING_WINDOW + 1);
+    waitFor(client, &writeResults.received, 5);
+    for(size_t i = 0; i < 5; i++) {
+        ck_assert_uint_eq(writeResults.requestIds[i], reqIds[0]);
+        ck_assert_uint_eq(writeResults.status[i], UA_STATUSCODE_GOOD);
+    }
+
+    /* The operations are applied in order */
+    UA_Variant out;
+    UA_StatusCode res = UA_Client_readValueAttribute(client, variableId, &out);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(*(UA_Int32*)out.data, 4);
+    UA_Variant_clear(&out);
+
+#ifdef UA_ENABLE_METHODCALLS
+    /* Method calls are batched */
+    BatchResults callResults;
+    setContexts(&callResults);
+    for(size_t i = 0; i < 3; i++) {
+        UA_Int32 value = (UA_Int32)i + 1;
+        UA_Variant v;
+        UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_INT32]);
+        res = UA_Client_call_async(client, UA_NS0ID(OBJECTSFOLDER), methodId, 1, &v,
+                                   callCallback, &contexts[i], &reqIds[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(reqIds[i], reqIds[0]);
+    }
+    UA_fakeSleep(BATCHING_WINDOW + 1);
+    waitFor(client, &callResults.received, 3);
+    for(size_t i = 0; i < 3; i++) {
+        ck_assert_uint_eq(callResults.status[i], UA_STATUSCODE_GOOD);
+        ck_assert_int_eq(callResults.values[i], ((UA_Int32)i + 1) * 2);
+    }
+#endif
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+START_TEST(Client_batching_disconnect) {
+    UA_Client *client = newBatchingClient(0);
+    BatchResults results;
+    setContexts(&results);
+
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        UA_StatusCode res =
+            UA_Client_readValueAttribute_async(client, variableId, readCallback,
+                                               &contexts[i], NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* The pending operations are cancelled */
+    UA_Client_disconnect(client);
+    ck_assert_uint_eq(results.received, OPERATIONS);
+    for(size_t i = 0; i < OPERATIONS; i++)
+        ck_assert_uint_ne(results.status[i], UA_STATUSCODE_GOOD);
+
+    UA_Client_delete(client);
+} END_TEST
+
+static Suite* testSuite_Client(void) {
+    Suite *s = suite_create("Client Batching");
+    TCase *tc_client = tcase_create("Client Batching");
+    tcase_add_checked_fixture(tc_client, setup, teardown);
+    tcase_add_test(tc_client, Client_batching_read);
+    tcase_add_test(tc_client, Client_batching_maxOperations);
+    tcase_add_test(tc_client, Client_batching_serverLimit);
+    tcase_add_test(tc_client, Client_batching_writeCall);
+    tcase_add_test(tc_client, Client_batching_disconnect);
+    suite_add_tcase(s,tc_client);
+    return s;
+}
+
+int main(void) {
+    Suite *s = testSuite_Client();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -316,6 +316,186 @@ START_TEST(Node_Browse) {
 }
 END_TEST
 
+START_TEST(Node_BrowseStreaming) {
+    /* Enough children for a response that is streamed */
+    UA_NodeId folderId;
+    UA_ObjectAttributes oa = UA_ObjectAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "StreamingFolder"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oa, NULL, &folderId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(size_t i = 0; i < 5000; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "StreamingChild%u", (unsigned)i);
+        oa.displayName = UA_LOCALIZEDTEXT("en-US", name);
+        res = UA_Server_addObjectNode(server, UA_NODEID_NULL, folderId,
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, name),
+                                      UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                      oa, NULL, NULL);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* Without a limit for the references, the response is encoded while
+     * browsing */
+    UA_BrowseDescription bd[3];
+    for(size_t i = 0; i < 3; i++) {
+        UA_BrowseDescription_init(&bd[i]);
+        bd[i].nodeId = folderId;
+        bd[i].browseDirection = UA_BROWSEDIRECTION_BOTH;
+        bd[i].resultMask = UA_BROWSERESULTMASK_ALL;
+    }
+    bd[1].nodeId = UA_NODEID_NUMERIC(1, 123456);
+    bd[2].nodeClassMask = UA_NODECLASS_VARIABLE;
+
+    UA_BrowseRequest bReq;
+    UA_BrowseRequest_init(&bReq);
+    bReq.nodesToBrowse = bd;
+    bReq.nodesToBrowseSize = 3;
+    UA_BrowseResponse bResp = UA_Client_Service_browse(client, bReq);
+    ck_assert_uint_eq(bResp.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bResp.resultsSize, 3);
+    ck_assert_uint_eq(bResp.results[1].statusCode, UA_STATUSCODE_BADNODEIDUNKNOWN);
+    ck_assert_uint_eq(bResp.results[1].referencesSize, 0);
+    ck_assert_uint_eq(bResp.results[2].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bResp.results[2].referencesSize, 0);
+
+    /* Identical to the results collected in memory */
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd[0]);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 5002); /* With the parent and type */
+    ck_assert_uint_eq(bResp.results[0].statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bResp.results[0].continuationPoint.length, 0);
+    ck_assert_uint_eq(bResp.results[0].referencesSize, br.referencesSize);
+    for(size_t i = 0; i < br.referencesSize; i++)
+        ck_assert(UA_order(&br.references[i], &bResp.results[0].references[i],
+                           &UA_TYPES[UA_TYPES_REFERENCEDESCRIPTION]) == UA_ORDER_EQ);
+    UA_BrowseResult_clear(&br);
+    UA_BrowseResponse_clear(&bResp);
+
+    UA_Server_deleteNode(server, folderId, true);
+}
+END_TEST
+
+typedef struct {
+    UA_NodeId *nodes;
+    size_t nodesSize;
+    size_t references;
+    size_t calls;
+    size_t maxCalls;
+} CrawlContext;
+
+static UA_Boolean
+containsNodeId(const UA_NodeId *nodes, size_t nodesSize, const UA_NodeId *id) {
+    for(size_t i = 0; i < nodesSize; i++) {
+        if(UA_NodeId_equal(&nodes[i], id))
+            return true;
+    }
+    return false;
+}
+
+static void
+addNodeId(UA_NodeId **nodes, size_t *nodesSize, const UA_NodeId *id) {
+    if(containsNodeId(*nodes, *nodesSize, id))
+        return;
+    UA_StatusCode res = UA_Array_appendCopy((void**)nodes, nodesSize, id,
+                                            &UA_TYPES[UA_TYPES_NODEID]);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static UA_Boolean
+crawlCallback(UA_Client *c, void *context, const UA_NodeId *nodeId,
+              const UA_BrowseResult *result) {
+    CrawlContext *ctx = (CrawlContext*)context;
+    ck_assert_uint_eq(result->statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_le(result->referencesSize, 3);
+    addNodeId(&ctx->nodes, &ctx->nodesSize, nodeId);
+    ctx->references += result->referencesSize;
+    ctx->calls++;
+    return (ctx->maxCalls == 0 || ctx->calls < ctx->maxCalls);
+}
+
+static void
+setupCrawlSettings(UA_ClientCrawlSettings *settings) {
+    memset(settings, 0, sizeof(UA_ClientCrawlSettings));
+    settings->browseDescription.referenceTypeId =
+        UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+    settings->browseDescription.includeSubtypes = true;
+    settings->browseDescription.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    settings->browseDescription.resultMask = UA_BROWSERESULTMASK_ALL;
+    settings->requestedMaxReferencesPerNode = 3;
+    settings->maxNodesPerRequest = 5;
+}
+
+START_TEST(Node_Crawl) {
+    /* Sequential browse of the hierarchy as the reference */
+    UA_NodeId *expected = NULL;
+    size_t expectedSize = 0;
+    size_t expectedReferences = 0;
+    UA_NodeId objects = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    addNodeId(&expected, &expectedSize, &objects);
+    for(size_t i = 0; i < expectedSize; i++) {
+        UA_BrowseDescription bd;
+        UA_BrowseDescription_init(&bd);
+        bd.nodeId = expected[i];
+        bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_HIERARCHICALREFERENCES);
+        bd.includeSubtypes = true;
+        bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+        UA_BrowseResult br = UA_Client_browse(client, NULL, 0, &bd);
+        ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(br.continuationPoint.length, 0);
+        expectedReferences += br.referencesSize;
+        for(size_t j = 0; j < br.referencesSize; j++)
+            addNodeId(&expected, &expectedSize, &br.references[j].nodeId.nodeId);
+        UA_BrowseResult_clear(&br);
+    }
+    ck_assert_uint_gt(expectedSize, 100);
+
+    UA_ClientCrawlSettings settings;
+    setupCrawlSettings(&settings);
+    CrawlContext ctx;
+    memset(&ctx, 0, sizeof(CrawlContext));
+    UA_StatusCode res = UA_Client_crawl(client, &settings, 1, &objects,
+                                        crawlCallback, &ctx);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(ctx.nodesSize, expectedSize);
+    ck_assert_uint_eq(ctx.references, expectedReferences);
+    for(size_t i = 0; i < expectedSize; i++)
+        ck_assert(containsNodeId(ctx.nodes, ctx.nodesSize, &expected[i]));
+    /* Continuation points were followed */
+    ck_assert_uint_gt(ctx.calls, ctx.nodesSize);
+
+    UA_Array_delete(ctx.nodes, ctx.nodesSize, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_Array_delete(expected, expectedSize, &UA_TYPES[UA_TYPES_NODEID]);
+}
+END_TEST
+
+START_TEST(Node_CrawlStop) {
+    UA_ClientCrawlSettings settings;
+    setupCrawlSettings(&settings);
+    CrawlContext ctx;
+    memset(&ctx, 0, sizeof(CrawlContext));
+    ctx.maxCalls = 10;
+    UA_NodeId root = UA_NODEID_NUMERIC(0, UA_NS0ID_ROOTFOLDER);
+    UA_StatusCode res = UA_Client_crawl(client, &settings, 1, &root,
+                                        crawlCallback, &ctx);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(ctx.calls, 10);
+    UA_Array_delete(ctx.nodes, ctx.nodesSize, &UA_TYPES[UA_TYPES_NODEID]);
+
+    /* The client remains usable */
+    UA_Variant value;
+    res = UA_Client_readValueAttribute(client,
+              UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE), &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_Variant_clear(&value);
+}
+END_TEST
+
 START_TEST(Node_Register) {
     UA_RegisterNodesRequest req;
     UA_RegisterNodesRequest_init(&req);
@@ -1048,7 +1228,10 @@ static Suite *testSuite_Client(void) {
     tcase_add_test(tc_nodes, Node_Add);
 #endif
     tcase_add_test(tc_nodes, Node_Browse);
+    tcase_add_test(tc_nodes, Node_BrowseStreaming);
     tcase_add_test(tc_nodes, Node_Register);
+    tcase_add_test(tc_nodes, Node_Crawl);
+    tcase_add_test(tc_nodes, Node_CrawlStop);
     suite_add_tcase(s, tc_nodes);
 
 #ifdef UA_ENABLE_NODEMANAGEMENT
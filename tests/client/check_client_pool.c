@@ -0,0 +1,341 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_pool.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#ifdef UA_ENABLE_HISTORIZING
+#include <open62541/plugin/historydata/history_data_backend_memory.h>
+#include <open62541/plugin/historydata/history_data_gathering_default.h>
+#include <open62541/plugin/historydata/history_database_default.h>
+#endif
+
+#include <check.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "testing_clock.h"
+#include "thread_wrapper.h"
+
+#define POOLSIZE 3
+#define HISTORYNODES 4
+#define HISTORYVALUES 50
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+#ifdef UA_ENABLE_HISTORIZING
+static UA_HistoryDataBackend backend;
+static UA_NodeId historyIds[HISTORYNODES];
+#endif
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+#ifdef UA_ENABLE_HISTORIZING
+static void
+addHistoryNodes(void) {
+    UA_HistoryDataGathering gathering = UA_HistoryDataGathering_Default(HISTORYNODES);
+    UA_ServerConfig *config = UA_Server_getConfig(server);
+    config->historyDatabase = UA_HistoryDatabase_default(gathering);
+    backend = UA_HistoryDataBackend_Memory(HISTORYNODES, HISTORYVALUES);
+
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(setting));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+
+    for(size_t i = 0; i < HISTORYNODES; i++) {
+        UA_VariableAttributes attr = UA_VariableAttributes_default;
+        UA_Int64 value = 0;
+        UA_Variant_setScalar(&attr.value, &value, &UA_TYPES[UA_TYPES_INT64]);
+        attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_HISTORYREAD;
+        attr.historizing = true;
+        UA_StatusCode res =
+            UA_Server_addVariableNode(server, UA_NODEID_NULL,
+                                      UA_NS0ID(OBJECTSFOLDER), UA_NS0ID(ORGANIZES),
+                                      UA_QUALIFIEDNAME(1, "History"),
+                                      UA_NS0ID(BASEDATAVARIABLETYPE), attr,
+                                      NULL, &historyIds[i]);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        res = gathering.registerNodeId(server, gathering.context,
+                                       &historyIds[i], setting);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        /* The values are the index of the node times 1000 plus the sample */
+        for(UA_Int64 j = 0; j < HISTORYVALUES; j++) {
+            UA_DataValue dv;
+            UA_DataValue_init(&dv);
+            UA_Int64 v = ((UA_Int64)i * 1000) + j;
+            UA_Variant_setScalar(&dv.value, &v, &UA_TYPES[UA_TYPES_INT64]);
+            dv.hasValue = true;
+            dv.hasSourceTimestamp = true;
+            dv.sourceTimestamp = (j + 1) * UA_DATETIME_SEC;
+            res = backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                               &historyIds[i], false, &dv);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+    }
+}
+#endif
+
+static void setup(void) {
+    running = true;
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+#ifdef UA_ENABLE_HISTORIZING
+    addHistoryNodes();
+#endif
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+#ifdef UA_ENABLE_HISTORIZING
+    UA_HistoryDataBackend_Memory_clear(&backend);
+#endif
+    UA_Server_delete(server);
+}
+
+static UA_ClientPool *
+newPool(size_t maxOperationsPerRequest) {
+    UA_ClientPool *pool = UA_ClientPool_newDefault(POOLSIZE, maxOperationsPerRequest);
+    ck_assert(pool != NULL);
+    ck_assert_uint_eq(UA_ClientPool_getSize(pool), POOLSIZE);
+    UA_EventLoop *el = UA_Client_getConfig(UA_ClientPool_getClient(pool, 0))->eventLoop;
+    el->dateTime_now = UA_DateTime_now_fake;
+    el->dateTime_nowMonotonic = UA_DateTime_now_fake;
+    for(size_t i = 1; i < POOLSIZE; i++)
+        ck_assert_ptr_eq(UA_Client_getConfig(UA_ClientPool_getClient(pool, i))->eventLoop, el);
+    ck_assert_ptr_eq(UA_ClientPool_getClient(pool, POOLSIZE), NULL);
+    return pool;
+}
+
+START_TEST(Pool_notConnected) {
+    UA_ClientPool *pool = newPool(0);
+    UA_ReadValueId rvid;
+    UA_ReadValueId_init(&rvid);
+    rvid.nodeId = UA_NS0ID(SERVER_SERVERSTATUS_STATE);
+    rvid.attributeId = UA_ATTRIBUTEID_VALUE;
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = &rvid;
+    request.nodesToReadSize = 1;
+    UA_ReadResponse response = UA_ClientPool_read(pool, &request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult,
+                      UA_STATUSCODE_BADSERVERNOTCONNECTED);
+    UA_ReadResponse_clear(&response);
+
+    request.nodesToReadSize = 0;
+    response = UA_ClientPool_read(pool, &request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult,
+                      UA_STATUSCODE_BADNOTHINGTODO);
+    UA_ReadResponse_clear(&response);
+    UA_ClientPool_delete(pool);
+} END_TEST
+
+START_TEST(Pool_addClient) {
+    UA_ClientPool *pool = UA_ClientPool_new(0);
+    UA_Client *c1 = UA_Client_newForUnitTest();
+    UA_Client *c2 = UA_Client_newForUnitTest();
+    ck_assert_uint_eq(UA_ClientPool_addClient(pool, c1), UA_STATUSCODE_GOOD);
+    /* The second client has a different EventLoop */
+    ck_assert_uint_eq(UA_ClientPool_addClient(pool, c2),
+                      UA_STATUSCODE_BADINVALIDARGUMENT);
+    ck_assert_uint_eq(UA_ClientPool_getSize(pool), 1);
+    UA_Client_delete(c2);
+    UA_ClientPool_delete(pool);
+} END_TEST
+
+START_TEST(Pool_read) {
+    UA_ClientPool *pool = newPool(7);
+    UA_StatusCode res = UA_ClientPool_connect(pool, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Every third node is unknown */
+    const size_t count = 100;
+    UA_ReadValueId *rvids = (UA_ReadValueId*)
+        UA_Array_new(count, &UA_TYPES[UA_TYPES_READVALUEID]);
+    for(size_t i = 0; i < count; i++) {
+        rvids[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        if(i % 3 == 0)
+            rvids[i].nodeId = UA_NODEID_NUMERIC(1, 100000 + (UA_UInt32)i);
+        else
+            rvids[i].nodeId = UA_NS0ID(SERVER_SERVERSTATUS_STATE);
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = rvids;
+    request.nodesToReadSize = count;
+
+    UA_ReadResponse response = UA_ClientPool_read(pool, &request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, count);
+    for(size_t i = 0; i < count; i++) {
+        if(i % 3 == 0) {
+            ck_assert(response.results[i].hasStatus);
+            ck_assert_uint_eq(response.results[i].status, UA_STATUSCODE_BADNODEIDUNKNOWN);
+        } else {
+            ck_assert(response.results[i].hasValue);
+            ck_assert(UA_Variant_hasScalarType(&response.results[i].value,
+                                               &UA_TYPES[UA_TYPES_INT32]));
+        }
+    }
+    UA_ReadResponse_clear(&response);
+    UA_Array_delete(rvids, count, &UA_TYPES[UA_TYPES_READVALUEID]);
+
+    /* Continue with the remaining clients */
+    UA_Client_disconnect(UA_ClientPool_getClient(pool, 0));
+    rvids = UA_ReadValueId_new();
+    rvids->attributeId = UA_ATTRIBUTEID_VALUE;
+    rvids->nodeId = UA_NS0ID(SERVER_SERVERSTATUS_STATE);
+    request.nodesToRead = rvids;
+    request.nodesToReadSize = 1;
+    response = UA_ClientPool_read(pool, &request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 1);
+    ck_assert(response.results[0].hasValue);
+    UA_ReadResponse_clear(&response);
+    UA_ReadValueId_delete(rvids);
+
+    UA_ClientPool_disconnect(pool);
+    UA_ClientPool_delete(pool);
+} END_TEST
+
+START_TEST(Pool_browse) {
+    UA_ClientPool *pool = newPool(0);
+    UA_StatusCode res = UA_ClientPool_connect(pool, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    const UA_UInt32 nodes[5] = {UA_NS0ID_SERVER, UA_NS0ID_OBJECTSFOLDER,
+                                UA_NS0ID_TYPESFOLDER, UA_NS0ID_BASEOBJECTTYPE,
+                                UA_NS0ID_SERVER_SERVERCAPABILITIES};
+    UA_BrowseDescription bd[5];
+    for(size_t i = 0; i < 5; i++) {
+        UA_BrowseDescription_init(&bd[i]);
+        bd[i].nodeId = UA_NODEID_NUMERIC(0, nodes[i]);
+        bd[i].browseDirection = UA_BROWSEDIRECTION_BOTH;
+        bd[i].resultMask = UA_BROWSERESULTMASK_ALL;
+    }
+
+    /* Browse every node with a single request as the reference */
+    UA_Client *client = UA_ClientPool_getClient(pool, 0);
+    UA_BrowseRequest request;
+    UA_BrowseRequest_init(&request);
+    request.nodesToBrowse = bd;
+    request.nodesToBrowseSize = 5;
+    UA_BrowseResponse expected = UA_Client_Service_browse(client, request);
+    ck_assert_uint_eq(expected.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+
+    /* The pool follows the continuation points */
+    request.requestedMaxReferencesPerNode = 2;
+    UA_BrowseResponse response = UA_ClientPool_browse(pool, &request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, 5);
+    for(size_t i = 0; i < 5; i++) {
+        ck_assert_uint_eq(response.results[i].statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(response.results[i].continuationPoint.length, 0);
+        ck_assert_uint_gt(response.results[i].referencesSize, 2);
+        ck_assert_uint_eq(response.results[i].referencesSize,
+                          expected.results[i].referencesSize);
+        for(size_t j = 0; j < response.results[i].referencesSize; j++)
+            ck_assert(UA_ReferenceDescription_equal(&response.results[i].references[j],
+                                                    &expected.results[i].references[j]));
+    }
+    UA_BrowseResponse_clear(&response);
+    UA_BrowseResponse_clear(&expected);
+
+    UA_ClientPool_disconnect(pool);
+    UA_ClientPool_delete(pool);
+} END_TEST
+
+#ifdef UA_ENABLE_HISTORIZING
+START_TEST(Pool_historyRead) {
+    UA_ClientPool *pool = newPool(1);
+    UA_StatusCode res = UA_ClientPool_connect(pool, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_ReadRawModifiedDetails details;
+    UA_ReadRawModifiedDetails_init(&details);
+    details.startTime = 1;
+    details.endTime = (HISTORYVALUES + 1) * UA_DATETIME_SEC;
+    details.numValuesPerNode = 7; /* Requires continuation points */
+
+    UA_HistoryReadValueId ids[HISTORYNODES];
+    for(size_t i = 0; i < HISTORYNODES; i++) {
+        UA_HistoryReadValueId_init(&ids[i]);
+        ids[i].nodeId = historyIds[i];
+    }
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    UA_ExtensionObject_setValue(&request.historyReadDetails, &details,
+                                &UA_TYPES[UA_TYPES_READRAWMODIFIEDDETAILS]);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+    request.nodesToRead = ids;
+    request.nodesToReadSize = HISTORYNODES;
+
+    UA_HistoryReadResponse response = UA_ClientPool_historyRead(pool, &request);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response.resultsSize, HISTORYNODES);
+    for(size_t i = 0; i < HISTORYNODES; i++) {
+        UA_HistoryReadResult *hr = &response.results[i];
+        ck_assert_uint_eq(hr->statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(hr->continuationPoint.length, 0);
+        ck_assert_ptr_eq(hr->historyData.content.decoded.type,
+                         &UA_TYPES[UA_TYPES_HISTORYDATA]);
+        UA_HistoryData *data = (UA_HistoryData*)hr->historyData.content.decoded.data;
+        ck_assert_uint_eq(data->dataValuesSize, HISTORYVALUES);
+        for(size_t j = 0; j < HISTORYVALUES; j++) {
+            UA_Int64 v = *(UA_Int64*)data->dataValues[j].value.data;
+            ck_assert_int_eq(v, ((UA_Int64)i * 1000) + (UA_Int64)j);
+        }
+    }
+    UA_HistoryReadResponse_clear(&response);
+
+    UA_ClientPool_disconnect(pool);
+    UA_ClientPool_delete(pool);
+} END_TEST
+#endif
+
+static Suite * client_pool_suite(void) {
+    Suite *s = suite_create("Client Pool");
+
+    TCase *tc_offline = tcase_create("Offline");
+    tcase_add_test(tc_offline, Pool_notConnected);
+    tcase_add_test(tc_offline, Pool_addClient);
+    suite_add_tcase(s, tc_offline);
+
+    TCase *tc_pool = tcase_create("Services");
+    tcase_add_checked_fixture(tc_pool, setup, teardown);
+    tcase_add_test(tc_pool, Pool_read);
+    tcase_add_test(tc_pool, Pool_browse);
+#ifdef UA_ENABLE_HISTORIZING
+    tcase_add_test(tc_pool, Pool_historyRead);
+#endif
+    suite_add_tcase(s, tc_pool);
+
+    return s;
+}
+
+int main(void) {
+    Suite *s = client_pool_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,129 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* This benchmark shows how many pipelined async read requests per second are
+ * processed by the client for a growing number of requests in flight. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_highlevel_async.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+
+#define REQUESTS 50000
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static void setup(void) {
+    running = true;
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+typedef struct {
+    size_t received;
+    size_t failed;
+} ReadCounter;
+
+static void
+readCallback(UA_Client *client, void *userdata,
+             UA_UInt32 requestId, UA_ReadResponse *response) {
+    ReadCounter *counter = (ReadCounter*)userdata;
+    counter->received++;
+    if(response->responseHeader.serviceResult != UA_STATUSCODE_GOOD)
+        counter->failed++;
+}
+
+START_TEST(pipelinedReadsPerSecond) {
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_ClientConfig *cc = UA_Client_getConfig(client);
+    cc->timeout = 60000;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+    cc->outStandingPublishRequests = 0;
+#endif
+    UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ReadValueId rvid;
+    UA_ReadValueId_init(&rvid);
+    rvid.attributeId = UA_ATTRIBUTEID_VALUE;
+    rvid.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_SERVERSTATUS_STATE);
+
+    UA_ReadRequest rr;
+    UA_ReadRequest_init(&rr);
+    rr.nodesToRead = &rvid;
+    rr.nodesToReadSize = 1;
+
+    /* Keep an increasing number of requests in flight */
+    const size_t windows[4] = {1, 100, 1000, 10000};
+    for(size_t w = 0; w < 4; w++) {
+        ReadCounter counter = {0, 0};
+        size_t sent = 0;
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        while(counter.received < REQUESTS) {
+            while(sent < REQUESTS && sent - counter.received < windows[w]) {
+                retval = UA_Client_sendAsyncReadRequest(client, &rr, readCallback,
+                                                        &counter, NULL);
+                ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+                sent++;
+            }
+            retval = UA_Client_run_iterate(client, 10);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        UA_DateTime finish = UA_DateTime_nowMonotonic();
+        double time_spent = (double)(finish - begin) / UA_DATETIME_SEC;
+        printf("%6lu in flight: %10.0f reads/s\n",
+               (unsigned long)windows[w], REQUESTS / time_spent);
+        ck_assert_uint_eq(counter.failed, 0);
+    }
+
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+} END_TEST
+
+static Suite * client_speed_async_suite(void) {
+    Suite *s = suite_create("Client Async Speed");
+
+    TCase* tc_speed = tcase_create("Pipelined Reads");
+    tcase_add_checked_fixture(tc_speed, setup, teardown);
+    tcase_add_test(tc_speed, pipelinedReadsPerSecond);
+    tcase_set_timeout(tc_speed, 0);
+    suite_add_tcase(s, tc_speed);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed = 0;
+    Suite *s = client_speed_async_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
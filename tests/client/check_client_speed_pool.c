@@ -0,0 +1,116 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* This benchmark shows how many read operations per second are processed by a
+ * client pool for a growing number of connections. The operations are sent in
+ * large requests that are split up over the connections. */
+
+#include <open62541/client.h>
+#include <open62541/client_config_default.h>
+#include <open62541/client_pool.h>
+#include <open62541/server.h>
+#include <open62541/server_config_default.h>
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "test_helpers.h"
+#include "thread_wrapper.h"
+
+#define OPERATIONS 10000
+#define REPETITIONS 10
+#define MAXOPERATIONS 500
+
+UA_Server *server;
+UA_Boolean running;
+THREAD_HANDLE server_thread;
+
+THREAD_CALLBACK(serverloop) {
+    while(running)
+        UA_Server_run_iterate(server, true);
+    return 0;
+}
+
+static void setup(void) {
+    running = true;
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+    THREAD_CREATE(server_thread, serverloop);
+}
+
+static void teardown(void) {
+    running = false;
+    THREAD_JOIN(server_thread);
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+START_TEST(poolReadsPerSecond) {
+    UA_ReadValueId *rvids = (UA_ReadValueId*)
+        UA_Array_new(OPERATIONS, &UA_TYPES[UA_TYPES_READVALUEID]);
+    for(size_t i = 0; i < OPERATIONS; i++) {
+        rvids[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        rvids[i].nodeId = UA_NS0ID(SERVER_SERVERSTATUS_STATE);
+    }
+    UA_ReadRequest request;
+    UA_ReadRequest_init(&request);
+    request.nodesToRead = rvids;
+    request.nodesToReadSize = OPERATIONS;
+
+    const size_t sizes[3] = {1, 2, 4};
+    for(size_t s = 0; s < 3; s++) {
+        UA_ClientPool *pool = UA_ClientPool_newDefault(sizes[s], MAXOPERATIONS);
+        ck_assert(pool != NULL);
+        for(size_t i = 0; i < sizes[s]; i++) {
+            UA_ClientConfig *cc = UA_Client_getConfig(UA_ClientPool_getClient(pool, i));
+            cc->timeout = 60000;
+#ifdef UA_ENABLE_SUBSCRIPTIONS
+            cc->outStandingPublishRequests = 0;
+#endif
+        }
+        UA_StatusCode retval = UA_ClientPool_connect(pool, "opc.tcp://localhost:4840");
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        for(size_t r = 0; r < REPETITIONS; r++) {
+            UA_ReadResponse response = UA_ClientPool_read(pool, &request);
+            ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+            ck_assert_uint_eq(response.resultsSize, OPERATIONS);
+            UA_ReadResponse_clear(&response);
+        }
+        UA_DateTime finish = UA_DateTime_nowMonotonic();
+        double time_spent = (double)(finish - begin) / UA_DATETIME_SEC;
+        printf("%lu connections: %10.0f reads/s\n", (unsigned long)sizes[s],
+               (OPERATIONS * REPETITIONS) / time_spent);
+
+        UA_ClientPool_disconnect(pool);
+        UA_ClientPool_delete(pool);
+    }
+
+    UA_Array_delete(rvids, OPERATIONS, &UA_TYPES[UA_TYPES_READVALUEID]);
+} END_TEST
+
+static Suite * client_speed_pool_suite(void) {
+    Suite *s = suite_create("Client Pool Speed");
+
+    TCase* tc_speed = tcase_create("Pooled Reads");
+    tcase_add_checked_fixture(tc_speed, setup, teardown);
+    tcase_add_test(tc_speed, poolReadsPerSecond);
+    tcase_set_timeout(tc_speed, 0);
+    suite_add_tcase(s, tc_speed);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed = 0;
+    Suite *s = client_speed_pool_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
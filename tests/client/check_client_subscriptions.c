@@ -1084,6 +1084,91 @@ START_TEST(Client_subscription_writeBurst) {
 }
 END_TEST
 
+static UA_String zeroCopyValue;
+static size_t zeroCopyCount;
+
+static void
+zeroCopyHandler(UA_Client *client, UA_UInt32 subId, void *subContext,
+                UA_UInt32 monId, void *monContext, UA_DataValue *value) {
+    /* The value is only valid during the callback */
+    ck_assert(UA_Variant_hasScalarType(&value->value, &UA_TYPES[UA_TYPES_STRING]));
+    UA_String_clear(&zeroCopyValue);
+    UA_String_copy((UA_String*)value->value.data, &zeroCopyValue);
+    zeroCopyCount++;
+}
+
+START_TEST(Client_subscription_zeroCopy) {
+    UA_VariableAttributes attr = UA_VariableAttributes_default;
+    UA_String text = UA_STRING("value 0");
+    UA_Variant_setScalar(&attr.value, &text, &UA_TYPES[UA_TYPES_STRING]);
+    attr.accessLevel = UA_ACCESSLEVELMASK_READ | UA_ACCESSLEVELMASK_WRITE;
+    UA_NodeId textNodeId = UA_NODEID_STRING(1, "the.text");
+    UA_StatusCode retval =
+        UA_Server_addVariableNode(server, textNodeId, UA_NS0ID(OBJECTSFOLDER),
+                                  UA_NS0ID(ORGANIZES), UA_QUALIFIEDNAME(1, "the text"),
+                                  UA_NODEID_NULL, attr, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_Client *client = UA_Client_newForUnitTest();
+    UA_Client_getConfig(client)->zeroCopyNotifications = true;
+    retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_CreateSubscriptionRequest request = UA_CreateSubscriptionRequest_default();
+    UA_CreateSubscriptionResponse response =
+        UA_Client_Subscriptions_create(client, request, NULL, NULL, NULL);
+    ck_assert_uint_eq(response.responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+
+    zeroCopyCount = 0;
+    UA_String_init(&zeroCopyValue);
+    UA_MonitoredItemCreateRequest monRequest =
+        UA_MonitoredItemCreateRequest_default(textNodeId);
+    UA_MonitoredItemCreateResult monResponse =
+        UA_Client_MonitoredItems_createDataChange(client, response.subscriptionId,
+                                                  UA_TIMESTAMPSTORETURN_BOTH,
+                                                  monRequest, NULL, zeroCopyHandler, NULL);
+    ck_assert_uint_eq(monResponse.statusCode, UA_STATUSCODE_GOOD);
+
+    running = false;
+    THREAD_JOIN(server_thread);
+
+    char buf[32];
+    for(size_t i = 1; i <= 10; i++) {
+        /* Change the value, then wait for the notification */
+        snprintf(buf, sizeof(buf), "value %u", (unsigned)i);
+        text = UA_STRING(buf);
+        UA_Variant v;
+        UA_Variant_setScalar(&v, &text, &UA_TYPES[UA_TYPES_STRING]);
+        retval = UA_Server_writeValue(server, textNodeId, v);
+        ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+        size_t count = zeroCopyCount;
+        for(size_t j = 0; j < 10 && zeroCopyCount == count; j++) {
+            UA_fakeSleep((UA_UInt32)publishingInterval + 1);
+            UA_Server_run_iterate(server, true);
+            retval = UA_Client_run_iterate(client, 0);
+            ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+        }
+        ck_assert_uint_gt(zeroCopyCount, count);
+        ck_assert(UA_String_equal(&zeroCopyValue, &text));
+    }
+
+    /* The notifications were decoded into the arena of the client. It was
+     * reset after each response. */
+    ck_assert_uint_gt(client->notificationArena.size, 0);
+    ck_assert_uint_eq(client->notificationArena.used, 0);
+    ck_assert_ptr_eq(client->notificationArena.overflow, NULL);
+    ck_assert(!client->notificationArena.inUse);
+
+    running = true;
+    THREAD_CREATE(server_thread, serverloop);
+
+    UA_String_clear(&zeroCopyValue);
+    UA_Client_disconnect(client);
+    UA_Client_delete(client);
+}
+END_TEST
+
 START_TEST(Client_subscription_timeout) {
     UA_Client *client = UA_Client_newForUnitTest();
     UA_StatusCode retval = UA_Client_connect(client, "opc.tcp://localhost:4840");
@@ -1665,6 +1750,7 @@ static Suite* testSuite_Client(void) {
     tcase_add_test(tc_client, Client_subscription_server_disappears);
     tcase_add_test(tc_client, Client_subscription_transfer);
     tcase_add_test(tc_client, Client_subscription_writeBurst);
+    tcase_add_test(tc_client, Client_subscription_zeroCopy);
     suite_add_tcase(s,tc_client);
 
 #ifdef UA_ENABLE_METHODCALLS
@@ -364,6 +364,85 @@ START_TEST(DecodeAndVerifyEncryptedNetworkMessage) {
 }
 END_TEST
 
+START_TEST(DecodeAndVerifyEncryptedNetworkMessageBatch) {
+    UA_FieldMetaData *fields = newReaderGroupWithSecurity(
+        UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+    UA_PubSubManager *psm = getPSM(server);
+    UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroupId);
+    ck_assert(rg != NULL);
+
+    /* The second message has an invalid signature */
+    const char *msgs_enc[3] = {MSG_HEADER MSG_PAYLOAD_ENC MSG_SIG,
+                               MSG_HEADER MSG_PAYLOAD_ENC MSG_SIG_INVALID,
+                               MSG_HEADER MSG_PAYLOAD_ENC MSG_SIG};
+    UA_ByteString buffers[3];
+    Ctx ctx[3];
+    Ctx *ctxs[3];
+    UA_NetworkMessage msgs[3];
+    UA_NetworkMessage *nms[3];
+    UA_StatusCode results[3];
+    memset(msgs, 0, sizeof(msgs));
+    for(size_t i = 0; i < 3; i++) {
+        buffers[i].length = MSG_LENGTH_ENCRYPTED;
+        buffers[i].data = hexstr_to_char(msgs_enc[i]);
+        memset(&ctx[i], 0, sizeof(Ctx));
+        ctx[i].pos = buffers[i].data;
+        ctx[i].end = buffers[i].data + buffers[i].length;
+        ck_assert_uint_eq(UA_NetworkMessage_decodeHeaders(&ctx[i], &msgs[i]),
+                          UA_STATUSCODE_GOOD);
+        ctxs[i] = &ctx[i];
+        nms[i] = &msgs[i];
+    }
+
+    verifyAndDecryptNetworkMessages(psm->logging, rg, 3, buffers, ctxs, nms, results);
+    ck_assert_uint_eq(results[0], UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(results[1], UA_STATUSCODE_BADSECURITYCHECKSFAILED);
+    ck_assert_uint_eq(results[2], UA_STATUSCODE_GOOD);
+
+    /* The valid messages are decrypted in place and the signature is cut off */
+    const char *msg_dec_exp = MSG_HEADER MSG_PAYLOAD_DEC;
+    UA_Byte *expectedData = hexstr_to_char(msg_dec_exp);
+    for(size_t i = 0; i < 3; i += 2) {
+        ck_assert(memcmp(buffers[i].data, expectedData, MSG_LENGTH_DECRYPTED) == 0);
+        ck_assert_uint_eq((uintptr_t)(ctx[i].end - buffers[i].data),
+                          MSG_LENGTH_ENCRYPTED - 32);
+    }
+
+    for(size_t i = 0; i < 3; i++) {
+        UA_NetworkMessage_clear(&msgs[i]);
+        UA_free(buffers[i].data);
+    }
+    UA_free(fields);
+    UA_free(expectedData);
+}
+END_TEST
+
+START_TEST(ProcessEncryptedNetworkMessageBatch) {
+    UA_FieldMetaData *fields = newReaderGroupWithSecurity(
+        UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
+
+    /* The packets are verified and decrypted in place */
+    const char *msg_enc = MSG_HEADER MSG_PAYLOAD_ENC MSG_SIG;
+    UA_ByteString packets[2];
+    for(size_t i = 0; i < 2; i++) {
+        packets[i].length = MSG_LENGTH_ENCRYPTED;
+        packets[i].data = hexstr_to_char(msg_enc);
+    }
+    UA_StatusCode rv =
+        UA_Server_processPubSubConnectionReceiveBatch(server, connectionId, 2, packets);
+    ck_assert_uint_eq(rv, UA_STATUSCODE_GOOD);
+
+    const char *msg_dec_exp = MSG_HEADER MSG_PAYLOAD_DEC;
+    UA_Byte *expectedData = hexstr_to_char(msg_dec_exp);
+    for(size_t i = 0; i < 2; i++) {
+        ck_assert(memcmp(packets[i].data, expectedData, MSG_LENGTH_DECRYPTED) == 0);
+        UA_free(packets[i].data);
+    }
+    UA_free(fields);
+    UA_free(expectedData);
+}
+END_TEST
+
 START_TEST(InvalidSignature) {
     UA_FieldMetaData *fields = newReaderGroupWithSecurity(
         UA_MESSAGESECURITYMODE_SIGNANDENCRYPT);
@@ -478,6 +557,8 @@ main(void) {
     TCase *tc_pubsub_subscribe_encrypted = tcase_create("PubSub Subscribe Security Enabled");
     tcase_add_checked_fixture(tc_pubsub_subscribe_encrypted, setup, teardown);
     tcase_add_test(tc_pubsub_subscribe_encrypted, DecodeAndVerifyEncryptedNetworkMessage);
+    tcase_add_test(tc_pubsub_subscribe_encrypted, DecodeAndVerifyEncryptedNetworkMessageBatch);
+    tcase_add_test(tc_pubsub_subscribe_encrypted, ProcessEncryptedNetworkMessageBatch);
 
     TCase *tc_pubsub_subscribe_invalid_sig = tcase_create("PubSub Subscribe Invalid Signature");
     tcase_add_checked_fixture(tc_pubsub_subscribe_invalid_sig, setup, teardown);
@@ -0,0 +1,367 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub_internal.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+
+#define FIELD_COUNT 5000
+#define KEYFRAME_COUNT 4
+#define CHANGED_COUNT (FIELD_COUNT / 50) /* 2% of the fields change */
+#define PUBLISH_COUNT 100
+
+UA_Server *server = NULL;
+UA_NodeId connectionId, writerGroupId, publishedDataSetId, writerId;
+UA_NodeId readerGroupId, readerId;
+UA_NodeId variableIds[FIELD_COUNT];
+UA_NodeId targetIds[FIELD_COUNT];
+
+static void
+addVariables(UA_NodeId *ids, char *name) {
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.displayName = UA_LOCALIZEDTEXT("en-US", name);
+        vAttr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        UA_UInt32 intValue = 0;
+        UA_Variant_setScalar(&vAttr.value, &intValue, &UA_TYPES[UA_TYPES_UINT32]);
+        UA_StatusCode res =
+            UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 0),
+                                      UA_NS0ID(OBJECTSFOLDER), UA_NS0ID(HASCOMPONENT),
+                                      UA_QUALIFIEDNAME(1, name),
+                                      UA_NS0ID(BASEDATAVARIABLETYPE),
+                                      vAttr, NULL, &ids[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void
+addWriter(UA_UInt32 keyFrameCount) {
+    addVariables(variableIds, "Published UInt32");
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet 1");
+    UA_StatusCode res =
+        UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_DataSetFieldConfig fieldConfig;
+        memset(&fieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        fieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        fieldConfig.field.variable.fieldNameAlias = UA_STRING("UInt32 variable");
+        fieldConfig.field.variable.publishParameters.publishedVariable = variableIds[i];
+        fieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        res = UA_Server_addDataSetField(server, publishedDataSetId,
+                                        &fieldConfig, NULL).result;
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup 1");
+    writerGroupConfig.publishingInterval = 1000000; /* Publish manually */
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    res = UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig,
+                                   &writerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetWriterConfig writerConfig;
+    memset(&writerConfig, 0, sizeof(UA_DataSetWriterConfig));
+    writerConfig.name = UA_STRING("DataSetWriter 1");
+    writerConfig.dataSetWriterId = 62541;
+    writerConfig.keyFrameCount = keyFrameCount;
+    res = UA_Server_addDataSetWriter(server, writerGroupId, publishedDataSetId,
+                                     &writerConfig, &writerId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+addReader(void) {
+    addVariables(targetIds, "Subscribed UInt32");
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup 1");
+    UA_StatusCode res =
+        UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig,
+                                 &readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader 1");
+    readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    readerConfig.publisherId.id.uint16 = 2234;
+    readerConfig.writerGroupId = 100;
+    readerConfig.dataSetWriterId = 62541;
+
+    UA_FieldMetaData *fields = (UA_FieldMetaData*)
+        UA_calloc(FIELD_COUNT, sizeof(UA_FieldMetaData));
+    UA_FieldTargetDataType *targets = (UA_FieldTargetDataType*)
+        UA_calloc(FIELD_COUNT, sizeof(UA_FieldTargetDataType));
+    ck_assert(fields != NULL && targets != NULL);
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        fields[i].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        fields[i].builtInType = UA_NS0ID_UINT32;
+        fields[i].name = UA_STRING("UInt32 variable");
+        fields[i].valueRank = -1; /* scalar */
+        targets[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        targets[i].targetNodeId = targetIds[i];
+    }
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet 1");
+    readerConfig.dataSetMetaData.fieldsSize = FIELD_COUNT;
+    readerConfig.dataSetMetaData.fields = fields;
+    readerConfig.subscribedDataSetType = UA_PUBSUB_SDS_TARGET;
+    readerConfig.subscribedDataSet.target.targetVariablesSize = FIELD_COUNT;
+    readerConfig.subscribedDataSet.target.targetVariables = targets;
+
+    res = UA_Server_addDataSetReader(server, readerGroupId, &readerConfig, &readerId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_free(fields);
+    UA_free(targets);
+}
+
+static void
+setupServer(UA_UInt32 keyFrameCount) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.id.uint16 = 2234;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    addWriter(keyFrameCount);
+    addReader();
+
+    res = UA_Server_enableAllPubSubComponents(server);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+}
+
+static void setup(void) {
+    setupServer(KEYFRAME_COUNT);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static void
+writeValue(const UA_NodeId id, UA_UInt32 value) {
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &value, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode res = UA_Server_writeValue(server, id, v);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static UA_UInt32
+readValue(const UA_NodeId id) {
+    UA_Variant v;
+    UA_StatusCode res = UA_Server_readValue(server, id, &v);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&v, &UA_TYPES[UA_TYPES_UINT32]));
+    UA_UInt32 value = *(UA_UInt32*)v.data;
+    UA_Variant_clear(&v);
+    return value;
+}
+
+static void
+generateDataSetMessage(UA_DataSetMessage *dsm) {
+    lockServer(server);
+    UA_PubSubManager *psm = getPSM(server);
+    UA_DataSetWriter *dsw = UA_DataSetWriter_find(psm, writerId);
+    ck_assert(dsw != NULL);
+    memset(dsm, 0, sizeof(UA_DataSetMessage));
+    UA_StatusCode res = UA_DataSetWriter_generateDataSetMessage(psm, dsw, dsm);
+    unlockServer(server);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    dsm->dataSetWriterId = 62541;
+}
+
+/* Encode the DataSetMessage in a NetworkMessage for the reader */
+static void
+encodeNetworkMessage(UA_DataSetMessage *dsm, UA_ByteString *buf) {
+    UA_NetworkMessage nm;
+    memset(&nm, 0, sizeof(UA_NetworkMessage));
+    nm.version = 1;
+    nm.networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    nm.publisherIdEnabled = true;
+    nm.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    nm.publisherId.id.uint16 = 2234;
+    nm.groupHeaderEnabled = true;
+    nm.groupHeader.writerGroupIdEnabled = true;
+    nm.groupHeader.writerGroupId = 100;
+    nm.payloadHeaderEnabled = true;
+    nm.payload.dataSetPayload.dataSetMessages = dsm;
+    nm.payload.dataSetPayload.dataSetMessagesSize = 1;
+    UA_ByteString_init(buf);
+    UA_StatusCode res = UA_NetworkMessage_encodeBinary(&nm, buf);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+START_TEST(KeyFrameInterval) {
+    /* One KeyFrame followed by KEYFRAME_COUNT - 1 DeltaFrames */
+    for(size_t i = 0; i < 3 * KEYFRAME_COUNT; i++) {
+        UA_DataSetMessage dsm;
+        generateDataSetMessage(&dsm);
+        if(i % KEYFRAME_COUNT == 0)
+            ck_assert_int_eq(dsm.header.dataSetMessageType,
+                             UA_DATASETMESSAGE_DATAKEYFRAME);
+        else
+            ck_assert_int_eq(dsm.header.dataSetMessageType,
+                             UA_DATASETMESSAGE_DATADELTAFRAME);
+        UA_DataSetMessage_clear(&dsm);
+    }
+} END_TEST
+
+START_TEST(DeltaFrameChangedFields) {
+    UA_DataSetMessage dsm;
+    generateDataSetMessage(&dsm);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATAKEYFRAME);
+    ck_assert_uint_eq(dsm.data.keyFrameData.fieldCount, FIELD_COUNT);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* Only the changed fields are contained */
+    writeValue(variableIds[3], 4711);
+    writeValue(variableIds[FIELD_COUNT - 1], 4712);
+    generateDataSetMessage(&dsm);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    UA_DataSetMessage_DataDeltaFrameData *dfd = &dsm.data.deltaFrameData;
+    ck_assert_uint_eq(dfd->fieldCount, 2);
+    ck_assert_uint_eq(dfd->deltaFrameFields[0].fieldIndex, 3);
+    ck_assert_uint_eq(*(UA_UInt32*)dfd->deltaFrameFields[0].fieldValue.value.data, 4711);
+    ck_assert_uint_eq(dfd->deltaFrameFields[1].fieldIndex, FIELD_COUNT - 1);
+    ck_assert_uint_eq(*(UA_UInt32*)dfd->deltaFrameFields[1].fieldValue.value.data, 4712);
+    UA_DataSetMessage_clear(&dsm);
+
+    /* Writing the same value is no change */
+    writeValue(variableIds[3], 4711);
+    generateDataSetMessage(&dsm);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    ck_assert_uint_eq(dsm.data.deltaFrameData.fieldCount, 0);
+
+    /* The empty DeltaFrame can be encoded and decoded */
+    UA_ByteString buf;
+    encodeNetworkMessage(&dsm, &buf);
+    UA_NetworkMessage nm;
+    UA_StatusCode res = UA_NetworkMessage_decodeBinary(&buf, &nm, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(nm.payload.dataSetPayload.dataSetMessagesSize, 1);
+    ck_assert_uint_eq(nm.payload.dataSetPayload.dataSetMessages[0].
+                      data.deltaFrameData.fieldCount, 0);
+    UA_NetworkMessage_clear(&nm);
+    UA_ByteString_clear(&buf);
+    UA_DataSetMessage_clear(&dsm);
+} END_TEST
+
+START_TEST(ReaderAppliesDeltaFrame) {
+    for(size_t i = 0; i < FIELD_COUNT; i++)
+        writeValue(variableIds[i], (UA_UInt32)i);
+
+    /* The KeyFrame sets all fields */
+    UA_DataSetMessage dsm;
+    generateDataSetMessage(&dsm);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATAKEYFRAME);
+    UA_ByteString buf;
+    encodeNetworkMessage(&dsm, &buf);
+    UA_StatusCode res = UA_Server_processPubSubConnectionReceive(server, connectionId, buf);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString_clear(&buf);
+    UA_DataSetMessage_clear(&dsm);
+    ck_assert_uint_eq(readValue(targetIds[10]), 10);
+    ck_assert_uint_eq(readValue(targetIds[FIELD_COUNT - 1]), FIELD_COUNT - 1);
+
+    /* The DeltaFrame updates only the changed field */
+    writeValue(variableIds[10], 1000000);
+    writeValue(targetIds[11], 4711);
+    generateDataSetMessage(&dsm);
+    ck_assert_int_eq(dsm.header.dataSetMessageType, UA_DATASETMESSAGE_DATADELTAFRAME);
+    encodeNetworkMessage(&dsm, &buf);
+    res = UA_Server_processPubSubConnectionReceive(server, connectionId, buf);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_ByteString_clear(&buf);
+    UA_DataSetMessage_clear(&dsm);
+    ck_assert_uint_eq(readValue(targetIds[10]), 1000000);
+    ck_assert_uint_eq(readValue(targetIds[11]), 4711);
+} END_TEST
+
+START_TEST(DeltaFrameSpeed) {
+    /* Compare KeyFrames only with DeltaFrames where 2% of the fields change
+     * in every cycle */
+    UA_PubSubManager *psm = getPSM(server);
+    UA_DataSetWriter *dsw = UA_DataSetWriter_find(psm, writerId);
+    ck_assert(dsw != NULL);
+    size_t keyFrameBytes = 0;
+    for(size_t round = 0; round < 2; round++) {
+        dsw->config.keyFrameCount = (round == 0) ? 1 : PUBLISH_COUNT + 1;
+        size_t bytes = 0;
+        clock_t begin = clock();
+        for(size_t i = 0; i < PUBLISH_COUNT; i++) {
+            for(size_t j = 0; j < CHANGED_COUNT; j++) {
+                size_t index = (i * CHANGED_COUNT + j) % FIELD_COUNT;
+                writeValue(variableIds[index], (UA_UInt32)(i + 1));
+            }
+            UA_DataSetMessage dsm;
+            generateDataSetMessage(&dsm);
+            UA_ByteString buf;
+            encodeNetworkMessage(&dsm, &buf);
+            bytes += buf.length;
+            UA_ByteString_clear(&buf);
+            UA_DataSetMessage_clear(&dsm);
+        }
+        clock_t finish = clock();
+        printf("%s: %u DataSetMessages with %u of %u fields changed, "
+               "%u bytes in %f s\n", (round == 0) ? "KeyFrames" : "DeltaFrames",
+               (unsigned)PUBLISH_COUNT, (unsigned)CHANGED_COUNT, (unsigned)FIELD_COUNT,
+               (unsigned)bytes, (double)(finish - begin) / CLOCKS_PER_SEC);
+        if(round == 0)
+            keyFrameBytes = bytes;
+        else
+            ck_assert_uint_lt(bytes * 10, keyFrameBytes);
+    }
+} END_TEST
+
+int main(void) {
+    TCase *tc_delta = tcase_create("Publish DeltaFrames");
+    tcase_add_checked_fixture(tc_delta, setup, teardown);
+    tcase_add_test(tc_delta, KeyFrameInterval);
+    tcase_add_test(tc_delta, DeltaFrameChangedFields);
+    tcase_add_test(tc_delta, ReaderAppliesDeltaFrame);
+    tcase_add_test(tc_delta, DeltaFrameSpeed);
+
+    Suite *s = suite_create("PubSub DeltaFrames");
+    suite_add_tcase(s, tc_delta);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,369 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub_internal.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+
+#define FIELD_COUNT 8
+#define PUBLISH_COUNT 100000
+
+UA_Server *server = NULL;
+UA_NodeId connectionId, writerGroupId, publishedDataSetId, writerId;
+UA_NodeId variableIds[FIELD_COUNT];
+UA_DataSetFieldContentMask contentMask;
+
+/* External data source for the last field. It is read in place by the
+ * fixed-layout publish path. */
+UA_DataValue externalDataValue;
+UA_DataValue *externalDataValuePtr = &externalDataValue;
+
+static void
+addPublishedVariables(void) {
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Published UInt32");
+        vAttr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        UA_UInt32 intValue = (UA_UInt32)i;
+        UA_Variant_setScalar(&vAttr.value, &intValue, &UA_TYPES[UA_TYPES_UINT32]);
+        UA_StatusCode res =
+            UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, (UA_UInt32)i + 50000),
+                                      UA_NS0ID(OBJECTSFOLDER), UA_NS0ID(HASCOMPONENT),
+                                      UA_QUALIFIEDNAME(1, "Published UInt32"),
+                                      UA_NS0ID(BASEDATAVARIABLETYPE),
+                                      vAttr, NULL, &variableIds[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* The last field is read from an external data source */
+    UA_DataValue_init(&externalDataValue);
+    UA_UInt32 externalValue = FIELD_COUNT - 1;
+    UA_Variant_setScalarCopy(&externalDataValue.value, &externalValue,
+                             &UA_TYPES[UA_TYPES_UINT32]);
+    externalDataValue.hasValue = true;
+    UA_ValueBackend backend;
+    memset(&backend, 0, sizeof(UA_ValueBackend));
+    backend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+    backend.backend.external.value = &externalDataValuePtr;
+    UA_StatusCode res =
+        UA_Server_setVariableNode_valueBackend(server, variableIds[FIELD_COUNT - 1],
+                                               backend);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+setupWriter(UA_DataSetFieldContentMask fieldContentMask) {
+    contentMask = fieldContentMask;
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    connectionConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    connectionConfig.publisherId.id.uint16 = 2234;
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    addPublishedVariables();
+
+    UA_PublishedDataSetConfig pdsConfig;
+    memset(&pdsConfig, 0, sizeof(UA_PublishedDataSetConfig));
+    pdsConfig.publishedDataSetType = UA_PUBSUB_DATASET_PUBLISHEDITEMS;
+    pdsConfig.name = UA_STRING("PublishedDataSet 1");
+    res = UA_Server_addPublishedDataSet(server, &pdsConfig, &publishedDataSetId).addResult;
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_DataSetFieldConfig fieldConfig;
+        memset(&fieldConfig, 0, sizeof(UA_DataSetFieldConfig));
+        fieldConfig.dataSetFieldType = UA_PUBSUB_DATASETFIELD_VARIABLE;
+        fieldConfig.field.variable.fieldNameAlias = UA_STRING("UInt32 variable");
+        fieldConfig.field.variable.publishParameters.publishedVariable = variableIds[i];
+        fieldConfig.field.variable.publishParameters.attributeId = UA_ATTRIBUTEID_VALUE;
+        res = UA_Server_addDataSetField(server, publishedDataSetId,
+                                        &fieldConfig, NULL).result;
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_UadpWriterGroupMessageDataType writerGroupMessage;
+    UA_UadpWriterGroupMessageDataType_init(&writerGroupMessage);
+    writerGroupMessage.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_SEQUENCENUMBER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+
+    UA_WriterGroupConfig writerGroupConfig;
+    memset(&writerGroupConfig, 0, sizeof(writerGroupConfig));
+    writerGroupConfig.name = UA_STRING("WriterGroup 1");
+    writerGroupConfig.publishingInterval = 1000000; /* Publish manually */
+    writerGroupConfig.writerGroupId = 100;
+    writerGroupConfig.encodingMimeType = UA_PUBSUB_ENCODING_UADP;
+    writerGroupConfig.fixedLayout = true;
+    UA_ExtensionObject_setValue(&writerGroupConfig.messageSettings, &writerGroupMessage,
+                                &UA_TYPES[UA_TYPES_UADPWRITERGROUPMESSAGEDATATYPE]);
+    res = UA_Server_addWriterGroup(server, connectionId, &writerGroupConfig,
+                                   &writerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_UadpDataSetWriterMessageDataType writerMessage;
+    UA_UadpDataSetWriterMessageDataType_init(&writerMessage);
+    writerMessage.dataSetMessageContentMask = (UA_UadpDataSetMessageContentMask)
+        (UA_UADPDATASETMESSAGECONTENTMASK_SEQUENCENUMBER |
+         UA_UADPDATASETMESSAGECONTENTMASK_TIMESTAMP);
+
+    UA_DataSetWriterConfig writerConfig;
+    memset(&writerConfig, 0, sizeof(UA_DataSetWriterConfig));
+    writerConfig.name = UA_STRING("DataSetWriter 1");
+    writerConfig.dataSetWriterId = 62541;
+    writerConfig.keyFrameCount = 0; /* Only KeyFrames */
+    writerConfig.dataSetFieldContentMask = fieldContentMask;
+    UA_ExtensionObject_setValue(&writerConfig.messageSettings, &writerMessage,
+                                &UA_TYPES[UA_TYPES_UADPDATASETWRITERMESSAGEDATATYPE]);
+    res = UA_Server_addDataSetWriter(server, writerGroupId, publishedDataSetId,
+                                     &writerConfig, &writerId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    res = UA_Server_enableAllPubSubComponents(server);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+
+    UA_PubSubState state;
+    res = UA_Server_getDataSetWriterState(server, writerId, &state);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_int_eq(state, UA_PUBSUBSTATE_OPERATIONAL);
+}
+
+static void setupRaw(void) {
+    setupWriter(UA_DATASETFIELDCONTENTMASK_RAWDATA);
+}
+
+static void setupVariant(void) {
+    setupWriter(UA_DATASETFIELDCONTENTMASK_NONE);
+}
+
+static void setupDataValue(void) {
+    setupWriter((UA_DataSetFieldContentMask)
+                (UA_DATASETFIELDCONTENTMASK_STATUSCODE |
+                 UA_DATASETFIELDCONTENTMASK_SOURCETIMESTAMP));
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_DataValue_clear(&externalDataValue);
+}
+
+static UA_WriterGroup *
+getWriterGroup(void) {
+    UA_WriterGroup *wg = UA_WriterGroup_find(getPSM(server), writerGroupId);
+    ck_assert(wg != NULL);
+    return wg;
+}
+
+/* Check the field values in the encoded message */
+static void
+checkFields(const UA_WriterGroupFixedLayout *fl, const UA_UInt32 *expected) {
+    size_t fieldIndex = 0;
+    for(size_t i = 0; i < fl->patchesSize; i++) {
+        const UA_FixedLayoutPatch *p = &fl->patches[i];
+        size_t offset = p->offset;
+        if(p->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT)
+            offset += 1;
+        else if(p->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE)
+            offset += 2;
+        else if(p->offsetType != UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW)
+            continue;
+        UA_UInt32 value;
+        UA_StatusCode res = UA_UInt32_decodeBinary(&fl->networkMessage, &offset, &value);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(value, expected[fieldIndex]);
+        fieldIndex++;
+    }
+    ck_assert_uint_eq(fieldIndex, FIELD_COUNT);
+
+    if(contentMask & UA_DATASETFIELDCONTENTMASK_RAWDATA)
+        return;
+
+    /* The message decodes with the normal decoder */
+    UA_NetworkMessage nm;
+    UA_StatusCode res = UA_NetworkMessage_decodeBinary(&fl->networkMessage, &nm, NULL);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(nm.payload.dataSetPayload.dataSetMessagesSize, 1);
+    UA_DataSetMessage *dsm = &nm.payload.dataSetPayload.dataSetMessages[0];
+    ck_assert_uint_eq(dsm->data.keyFrameData.fieldCount, FIELD_COUNT);
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_DataValue *dv = &dsm->data.keyFrameData.dataSetFields[i];
+        ck_assert(UA_Variant_hasScalarType(&dv->value, &UA_TYPES[UA_TYPES_UINT32]));
+        ck_assert_uint_eq(*(UA_UInt32*)dv->value.data, expected[i]);
+    }
+    UA_NetworkMessage_clear(&nm);
+}
+
+static UA_UInt16
+decodeSequenceNumber(const UA_WriterGroupFixedLayout *fl, UA_PubSubOffsetType type) {
+    for(size_t i = 0; i < fl->patchesSize; i++) {
+        if(fl->patches[i].offsetType != type)
+            continue;
+        size_t offset = fl->patches[i].offset;
+        UA_UInt16 seq = 0;
+        UA_StatusCode res = UA_UInt16_decodeBinary(&fl->networkMessage, &offset, &seq);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        return seq;
+    }
+    ck_abort_msg("Sequence number not found");
+    return 0;
+}
+
+START_TEST(PublishFixedLayout) {
+    UA_PubSubManager *psm = getPSM(server);
+    UA_WriterGroup *wg = getWriterGroup();
+
+    UA_WriterGroup_publishCallback(psm, wg);
+    UA_WriterGroupFixedLayout *fl = wg->fixedLayout;
+    ck_assert(fl != NULL);
+
+    UA_UInt32 expected[FIELD_COUNT];
+    for(size_t i = 0; i < FIELD_COUNT; i++)
+        expected[i] = (UA_UInt32)i;
+    checkFields(fl, expected);
+    UA_UInt16 nmSeq =
+        decodeSequenceNumber(fl, UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER);
+    UA_UInt16 dsmSeq =
+        decodeSequenceNumber(fl, UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER);
+
+    /* Update the internal and the external value */
+    UA_UInt32 newValue = 4711;
+    UA_Variant v;
+    UA_Variant_setScalar(&v, &newValue, &UA_TYPES[UA_TYPES_UINT32]);
+    UA_StatusCode res = UA_Server_writeValue(server, variableIds[0], v);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    *(UA_UInt32*)externalDataValue.value.data = 4712;
+    expected[0] = 4711;
+    expected[FIELD_COUNT - 1] = 4712;
+
+    /* The same buffer is patched in place */
+    UA_WriterGroup_publishCallback(psm, wg);
+    ck_assert_ptr_eq(wg->fixedLayout, fl);
+    checkFields(fl, expected);
+    ck_assert_uint_eq(decodeSequenceNumber(fl, UA_PUBSUBOFFSETTYPE_NETWORKMESSAGE_SEQUENCENUMBER),
+                      (UA_UInt16)(nmSeq + 1));
+    ck_assert_uint_eq(decodeSequenceNumber(fl, UA_PUBSUBOFFSETTYPE_DATASETMESSAGE_SEQUENCENUMBER),
+                      (UA_UInt16)(dsmSeq + 1));
+} END_TEST
+
+START_TEST(PublishTypeChange) {
+    UA_PubSubManager *psm = getPSM(server);
+    UA_WriterGroup *wg = getWriterGroup();
+    UA_WriterGroup_publishCallback(psm, wg);
+    ck_assert(wg->fixedLayout != NULL);
+
+    /* The external value changes the type. The message is encoded in the
+     * normal way and the fixed layout is recomputed. */
+    UA_DataValue_clear(&externalDataValue);
+    UA_Double d = 1.0;
+    UA_Variant_setScalarCopy(&externalDataValue.value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    externalDataValue.hasValue = true;
+    UA_WriterGroup_publishCallback(psm, wg);
+    ck_assert(wg->fixedLayout == NULL);
+    ck_assert(!wg->fixedLayoutComputed);
+
+    UA_WriterGroup_publishCallback(psm, wg);
+    ck_assert(wg->fixedLayout != NULL);
+    ck_assert_ptr_eq(wg->fixedLayout->patches[wg->fixedLayout->patchesSize - 1].type,
+                     &UA_TYPES[UA_TYPES_DOUBLE]);
+} END_TEST
+
+START_TEST(ResetFixedLayout) {
+    UA_PubSubManager *psm = getPSM(server);
+    UA_WriterGroup *wg = getWriterGroup();
+    UA_WriterGroup_publishCallback(psm, wg);
+    ck_assert(wg->fixedLayout != NULL);
+
+    /* Disabling a writer changes the content of the NetworkMessage */
+    UA_StatusCode res = UA_Server_disableDataSetWriter(server, writerId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(wg->fixedLayout == NULL);
+    res = UA_Server_enableDataSetWriter(server, writerId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_WriterGroup_publishCallback(psm, wg);
+    ck_assert(wg->fixedLayout != NULL);
+
+    res = UA_Server_disableWriterGroup(server, writerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(wg->fixedLayout == NULL);
+    ck_assert(!wg->fixedLayoutComputed);
+} END_TEST
+
+START_TEST(PublishSpeed) {
+    UA_PubSubManager *psm = getPSM(server);
+    UA_WriterGroup *wg = getWriterGroup();
+
+    /* Compare the normal and the fixed-layout publish path */
+    for(size_t round = 0; round < 2; round++) {
+        wg->config.fixedLayout = (round == 1);
+        clock_t begin = clock();
+        for(size_t i = 0; i < PUBLISH_COUNT; i++) {
+            *(UA_UInt32*)externalDataValue.value.data = (UA_UInt32)i;
+            UA_WriterGroup_publishCallback(psm, wg);
+        }
+        clock_t finish = clock();
+        printf("%s publish path: %u NetworkMessages with %u fields in %f s\n",
+               (round == 1) ? "fixed-layout" : "normal",
+               (unsigned)PUBLISH_COUNT, (unsigned)FIELD_COUNT,
+               (double)(finish - begin) / CLOCKS_PER_SEC);
+    }
+    ck_assert(wg->fixedLayout != NULL);
+} END_TEST
+
+int main(void) {
+    TCase *tc_raw = tcase_create("Publish fixed layout (raw)");
+    tcase_add_checked_fixture(tc_raw, setupRaw, teardown);
+    tcase_add_test(tc_raw, PublishFixedLayout);
+    tcase_add_test(tc_raw, PublishTypeChange);
+    tcase_add_test(tc_raw, ResetFixedLayout);
+    tcase_add_test(tc_raw, PublishSpeed);
+
+    TCase *tc_variant = tcase_create("Publish fixed layout (variant)");
+    tcase_add_checked_fixture(tc_variant, setupVariant, teardown);
+    tcase_add_test(tc_variant, PublishFixedLayout);
+    tcase_add_test(tc_variant, PublishTypeChange);
+    tcase_add_test(tc_variant, PublishSpeed);
+
+    TCase *tc_datavalue = tcase_create("Publish fixed layout (datavalue)");
+    tcase_add_checked_fixture(tc_datavalue, setupDataValue, teardown);
+    tcase_add_test(tc_datavalue, PublishFixedLayout);
+    tcase_add_test(tc_datavalue, PublishSpeed);
+
+    Suite *s = suite_create("PubSub fixed-layout publish path");
+    suite_add_tcase(s, tc_raw);
+    suite_add_tcase(s, tc_variant);
+    suite_add_tcase(s, tc_datavalue);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,408 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub_internal.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#define FIELD_COUNT 8
+#define MESSAGE_COUNT 20000
+#define HISTOGRAM_BUCKETS 12
+
+UA_Server *server = NULL;
+UA_NodeId connectionId, readerGroupId, readerId;
+UA_NodeId targetIds[FIELD_COUNT];
+UA_DataSetFieldContentMask readerFieldContentMask;
+
+/* External data source for the last field. The normal write path replaces the
+ * value with a deep copy. The fixed-layout path updates it in place. */
+UA_DataValue externalDataValue;
+UA_DataValue *externalDataValuePtr = &externalDataValue;
+
+static void
+addTargetVariables(UA_UInt32 firstId, UA_NodeId *ids) {
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_VariableAttributes vAttr = UA_VariableAttributes_default;
+        vAttr.displayName = UA_LOCALIZEDTEXT("en-US", "Subscribed UInt32");
+        vAttr.dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        UA_UInt32 intValue = 0;
+        UA_Variant_setScalar(&vAttr.value, &intValue, &UA_TYPES[UA_TYPES_UINT32]);
+        UA_StatusCode res =
+            UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, (UA_UInt32)i + firstId),
+                                      UA_NS0ID(OBJECTSFOLDER), UA_NS0ID(HASCOMPONENT),
+                                      UA_QUALIFIEDNAME(1, "Subscribed UInt32"),
+                                      UA_NS0ID(BASEDATAVARIABLETYPE),
+                                      vAttr, NULL, &ids[i]);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+static void
+addExternalDataSource(void) {
+    /* The last field is written to an external data source */
+    UA_DataValue_init(&externalDataValue);
+    UA_UInt32 externalValue = 0;
+    UA_Variant_setScalarCopy(&externalDataValue.value, &externalValue,
+                             &UA_TYPES[UA_TYPES_UINT32]);
+    externalDataValue.hasValue = true;
+    UA_ValueBackend backend;
+    memset(&backend, 0, sizeof(UA_ValueBackend));
+    backend.backendType = UA_VALUEBACKENDTYPE_EXTERNAL;
+    backend.backend.external.value = &externalDataValuePtr;
+    UA_StatusCode res =
+        UA_Server_setVariableNode_valueBackend(server, targetIds[FIELD_COUNT - 1],
+                                               backend);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+addReaderGroup(UA_Boolean fixedLayout, const UA_NodeId *targetNodeIds,
+               UA_NodeId *rgId, UA_NodeId *dsrId) {
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup");
+    readerGroupConfig.fixedLayout = fixedLayout;
+    UA_StatusCode res =
+        UA_Server_addReaderGroup(server, connectionId, &readerGroupConfig, rgId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    readerConfig.publisherId.id.uint16 = 2234;
+    readerConfig.writerGroupId = 100;
+    readerConfig.dataSetWriterId = 62541;
+    readerConfig.dataSetFieldContentMask = readerFieldContentMask;
+
+    UA_UadpDataSetReaderMessageDataType readerMessage;
+    UA_UadpDataSetReaderMessageDataType_init(&readerMessage);
+    readerMessage.networkMessageContentMask = (UA_UadpNetworkMessageContentMask)
+        (UA_UADPNETWORKMESSAGECONTENTMASK_PUBLISHERID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_GROUPHEADER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_SEQUENCENUMBER |
+         UA_UADPNETWORKMESSAGECONTENTMASK_WRITERGROUPID |
+         UA_UADPNETWORKMESSAGECONTENTMASK_PAYLOADHEADER);
+    readerMessage.dataSetMessageContentMask =
+        UA_UADPDATASETMESSAGECONTENTMASK_SEQUENCENUMBER;
+    UA_ExtensionObject_setValue(&readerConfig.messageSettings, &readerMessage,
+                                &UA_TYPES[UA_TYPES_UADPDATASETREADERMESSAGEDATATYPE]);
+
+    UA_FieldMetaData fields[FIELD_COUNT];
+    UA_FieldTargetDataType targets[FIELD_COUNT];
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_FieldMetaData_init(&fields[i]);
+        fields[i].dataType = UA_TYPES[UA_TYPES_UINT32].typeId;
+        fields[i].builtInType = UA_NS0ID_UINT32;
+        fields[i].name = UA_STRING("UInt32 variable");
+        fields[i].valueRank = -1; /* scalar */
+        UA_FieldTargetDataType_init(&targets[i]);
+        targets[i].attributeId = UA_ATTRIBUTEID_VALUE;
+        targets[i].targetNodeId = targetNodeIds[i];
+    }
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet 1");
+    readerConfig.dataSetMetaData.fieldsSize = FIELD_COUNT;
+    readerConfig.dataSetMetaData.fields = fields;
+    readerConfig.subscribedDataSetType = UA_PUBSUB_SDS_TARGET;
+    readerConfig.subscribedDataSet.target.targetVariablesSize = FIELD_COUNT;
+    readerConfig.subscribedDataSet.target.targetVariables = targets;
+
+    res = UA_Server_addDataSetReader(server, *rgId, &readerConfig, dsrId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void
+setupReader(UA_DataSetFieldContentMask fieldContentMask) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode res =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connectionId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    addTargetVariables(50000, targetIds);
+    addExternalDataSource();
+
+    readerFieldContentMask = fieldContentMask;
+    addReaderGroup(true, targetIds, &readerGroupId, &readerId);
+
+    res = UA_Server_enableAllPubSubComponents(server);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+}
+
+static void setupRaw(void) {
+    setupReader(UA_DATASETFIELDCONTENTMASK_RAWDATA);
+}
+
+static void setupVariant(void) {
+    setupReader(UA_DATASETFIELDCONTENTMASK_NONE);
+}
+
+static void setupDataValue(void) {
+    setupReader(UA_DATASETFIELDCONTENTMASK_STATUSCODE);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+    UA_DataValue_clear(&externalDataValue);
+}
+
+/* Get the template message and set the field values in the offset table */
+static void
+setFieldValues(UA_PubSubOffsetTable *ot, UA_UInt32 base) {
+    size_t field = 0;
+    for(size_t i = 0; i < ot->offsetsSize; i++) {
+        UA_PubSubOffset *o = &ot->offsets[i];
+        size_t pos = o->offset;
+        if(o->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_VARIANT)
+            pos += 1;
+        else if(o->offsetType == UA_PUBSUBOFFSETTYPE_DATASETFIELD_DATAVALUE)
+            pos += 2;
+        else if(o->offsetType != UA_PUBSUBOFFSETTYPE_DATASETFIELD_RAW)
+            continue;
+        /* Little-endian encoding */
+        UA_UInt32 value = base + (UA_UInt32)field;
+        for(size_t j = 0; j < 4; j++)
+            ot->networkMessage.data[pos + j] = (UA_Byte)(value >> (8 * j));
+        field++;
+    }
+    ck_assert_uint_eq(field, FIELD_COUNT);
+}
+
+static void
+checkTargetValues(const UA_NodeId *ids, UA_UInt32 base) {
+    for(size_t i = 0; i < FIELD_COUNT; i++) {
+        UA_Variant value;
+        UA_StatusCode res = UA_Server_readValue(server, ids[i], &value);
+        ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+        ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT32]));
+        ck_assert_uint_eq(*(UA_UInt32*)value.data, base + (UA_UInt32)i);
+        UA_Variant_clear(&value);
+    }
+}
+
+static void
+checkFieldValues(UA_UInt32 base) {
+    checkTargetValues(targetIds, base);
+    ck_assert(UA_Variant_hasScalarType(&externalDataValue.value,
+                                       &UA_TYPES[UA_TYPES_UINT32]));
+    ck_assert_uint_eq(*(UA_UInt32*)externalDataValue.value.data,
+                      base + FIELD_COUNT - 1);
+}
+
+static UA_Boolean
+hasFixedLayout(void) {
+    lockServer(server);
+    UA_ReaderGroup *rg = UA_ReaderGroup_find(getPSM(server), readerGroupId);
+    UA_Boolean res = (rg && rg->fixedLayout != NULL);
+    unlockServer(server);
+    return res;
+}
+
+START_TEST(ReceiveFixedLayout) {
+    UA_PubSubOffsetTable ot;
+    UA_StatusCode res = UA_Server_computeReaderGroupOffsetTable(server, readerGroupId, &ot);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The fixed-layout path updates the external value in place. The normal
+     * decoding path would replace it with a new copy. */
+    const void *externalData = externalDataValue.value.data;
+
+    setFieldValues(&ot, 1000);
+    res = UA_Server_processPubSubConnectionReceive(server, connectionId,
+                                                   ot.networkMessage);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(hasFixedLayout());
+    checkFieldValues(1000);
+    ck_assert_ptr_eq(externalDataValue.value.data, externalData);
+
+    UA_DataSetReaderConfig config;
+    res = UA_Server_getDataSetReaderConfig(server, readerId, &config);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_PubSubState state;
+    UA_Server_getDataSetReaderState(server, readerId, &state);
+    ck_assert_int_eq(state, UA_PUBSUBSTATE_OPERATIONAL);
+    UA_DataSetReaderConfig_clear(&config);
+
+    /* A message with a different DataSetWriterId does not match the template
+     * and is not processed */
+    setFieldValues(&ot, 2000);
+    UA_ByteString other;
+    UA_ByteString_copy(&ot.networkMessage, &other);
+    UA_UInt16 dswId = 62541;
+    for(size_t i = 0; i + 1 < other.length; i++) {
+        if(memcmp(&other.data[i], &dswId, 2) == 0) {
+            other.data[i]++;
+            break;
+        }
+    }
+    res = UA_Server_processPubSubConnectionReceive(server, connectionId, other);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    checkFieldValues(1000);
+    UA_ByteString_clear(&other);
+
+    /* The layout is recomputed after the ReaderGroup was disabled */
+    res = UA_Server_disableReaderGroup(server, readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(!hasFixedLayout());
+    res = UA_Server_enableReaderGroup(server, readerGroupId);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_processPubSubConnectionReceive(server, connectionId,
+                                                   ot.networkMessage);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(hasFixedLayout());
+    checkFieldValues(2000);
+    ck_assert_ptr_eq(externalDataValue.value.data, externalData);
+
+    UA_PubSubOffsetTable_clear(&ot);
+} END_TEST
+
+START_TEST(ReceiveFixedLayoutWithDecodedReaderGroup) {
+    /* A second ReaderGroup without the fixed layout on the same connection
+     * receives the same DataSetMessage */
+    UA_NodeId otherTargetIds[FIELD_COUNT];
+    UA_NodeId otherReaderGroupId, otherReaderId;
+    addTargetVariables(51000, otherTargetIds);
+    addReaderGroup(false, otherTargetIds, &otherReaderGroupId, &otherReaderId);
+    UA_StatusCode res = UA_Server_enableAllPubSubComponents(server);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_PubSubOffsetTable ot;
+    res = UA_Server_computeReaderGroupOffsetTable(server, readerGroupId, &ot);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    /* The fixed-layout ReaderGroup takes the fast path and is skipped when the
+     * message is decoded for the other ReaderGroup */
+    const void *externalData = externalDataValue.value.data;
+    setFieldValues(&ot, 3000);
+    res = UA_Server_processPubSubConnectionReceive(server, connectionId,
+                                                   ot.networkMessage);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(hasFixedLayout());
+    checkFieldValues(3000);
+    ck_assert_ptr_eq(externalDataValue.value.data, externalData);
+    checkTargetValues(otherTargetIds, 3000);
+
+    /* The same with the batch receive */
+    UA_ByteString packets[2];
+    setFieldValues(&ot, 4000);
+    UA_ByteString_copy(&ot.networkMessage, &packets[0]);
+    setFieldValues(&ot, 5000);
+    UA_ByteString_copy(&ot.networkMessage, &packets[1]);
+    res = UA_Server_processPubSubConnectionReceiveBatch(server, connectionId,
+                                                        2, packets);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    checkFieldValues(5000);
+    ck_assert_ptr_eq(externalDataValue.value.data, externalData);
+    checkTargetValues(otherTargetIds, 5000);
+    UA_ByteString_clear(&packets[0]);
+    UA_ByteString_clear(&packets[1]);
+
+    UA_PubSubOffsetTable_clear(&ot);
+} END_TEST
+
+static void
+printHistogram(const char *name, size_t *buckets) {
+    printf("%s latency histogram (%u messages)\n", name, MESSAGE_COUNT);
+    for(size_t i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        if(i + 1 < HISTOGRAM_BUCKETS)
+            printf("  < %5u us: %u\n", 1u << i, (unsigned)buckets[i]);
+        else
+            printf("  >=%5u us: %u\n", 1u << (i - 1), (unsigned)buckets[i]);
+    }
+}
+
+static void
+receiveLatency(const char *name, UA_PubSubOffsetTable *ot) {
+    size_t buckets[HISTOGRAM_BUCKETS];
+    memset(buckets, 0, sizeof(buckets));
+    for(UA_UInt32 i = 0; i < MESSAGE_COUNT; i++) {
+        setFieldValues(ot, i);
+        UA_DateTime begin = UA_DateTime_nowMonotonic();
+        UA_Server_processPubSubConnectionReceive(server, connectionId,
+                                                 ot->networkMessage);
+        UA_DateTime duration = UA_DateTime_nowMonotonic() - begin;
+        size_t bucket = 0;
+        while(bucket + 1 < HISTOGRAM_BUCKETS &&
+              duration >= (UA_DateTime)(1u << bucket) * UA_DATETIME_USEC)
+            bucket++;
+        buckets[bucket]++;
+    }
+    checkFieldValues(MESSAGE_COUNT - 1);
+    printHistogram(name, buckets);
+}
+
+START_TEST(ReceiveLatency) {
+    UA_PubSubOffsetTable ot;
+    UA_StatusCode res = UA_Server_computeReaderGroupOffsetTable(server, readerGroupId, &ot);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+
+    receiveLatency("Fixed layout", &ot);
+    ck_assert(hasFixedLayout());
+
+    /* Switch to the normal decoding path */
+    UA_ReaderGroupConfig config;
+    res = UA_Server_getReaderGroupConfig(server, readerGroupId, &config);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    config.fixedLayout = false;
+    UA_Server_disableReaderGroup(server, readerGroupId);
+    res = UA_Server_updateReaderGroupConfig(server, readerGroupId, &config);
+    ck_assert_int_eq(res, UA_STATUSCODE_GOOD);
+    UA_ReaderGroupConfig_clear(&config);
+    UA_Server_enableReaderGroup(server, readerGroupId);
+
+    receiveLatency("Decoded", &ot);
+    ck_assert(!hasFixedLayout());
+
+    UA_PubSubOffsetTable_clear(&ot);
+} END_TEST
+
+int main(void) {
+    TCase *tc_raw = tcase_create("Fixed layout with raw fields");
+    tcase_add_checked_fixture(tc_raw, setupRaw, teardown);
+    tcase_add_test(tc_raw, ReceiveFixedLayout);
+    tcase_add_test(tc_raw, ReceiveFixedLayoutWithDecodedReaderGroup);
+    tcase_add_test(tc_raw, ReceiveLatency);
+
+    TCase *tc_variant = tcase_create("Fixed layout with variant fields");
+    tcase_add_checked_fixture(tc_variant, setupVariant, teardown);
+    tcase_add_test(tc_variant, ReceiveFixedLayout);
+    tcase_add_test(tc_variant, ReceiveFixedLayoutWithDecodedReaderGroup);
+    tcase_add_test(tc_variant, ReceiveLatency);
+
+    TCase *tc_datavalue = tcase_create("Fixed layout with datavalue fields");
+    tcase_add_checked_fixture(tc_datavalue, setupDataValue, teardown);
+    tcase_add_test(tc_datavalue, ReceiveFixedLayout);
+
+    Suite *s = suite_create("PubSub Subscriber Fixed Layout");
+    suite_add_tcase(s, tc_raw);
+    suite_add_tcase(s, tc_variant);
+    suite_add_tcase(s, tc_datavalue);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
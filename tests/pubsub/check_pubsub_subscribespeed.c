@@ -0,0 +1,190 @@
+/* This Source Code Form is subject to the terms of the Mozilla Public
+ * License, v. 2.0. If a copy of the MPL was not distributed with this
+ * file, You can obtain one at http://mozilla.org/MPL/2.0/.
+ */
+
+#include <open62541/server_config_default.h>
+#include <open62541/server_pubsub.h>
+
+#include "test_helpers.h"
+#include "ua_pubsub_internal.h"
+#include "ua_server_internal.h"
+
+#include <check.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdlib.h>
+
+#define PUBLISHER_ID 2234
+#define WRITER_GROUP_ID 100
+#define READER_COUNT 1000
+
+UA_Server *server = NULL;
+UA_NodeId connection1, readerGroup1;
+UA_NodeId readerIds[READER_COUNT];
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+
+    UA_PubSubConnectionConfig connectionConfig;
+    memset(&connectionConfig, 0, sizeof(UA_PubSubConnectionConfig));
+    connectionConfig.name = UA_STRING("UADP Connection");
+    UA_NetworkAddressUrlDataType networkAddressUrl =
+        {UA_STRING_NULL, UA_STRING("opc.udp://224.0.0.22:4840/")};
+    UA_Variant_setScalar(&connectionConfig.address, &networkAddressUrl,
+                         &UA_TYPES[UA_TYPES_NETWORKADDRESSURLDATATYPE]);
+    connectionConfig.transportProfileUri =
+        UA_STRING("http://opcfoundation.org/UA-Profile/Transport/pubsub-udp-uadp");
+    UA_StatusCode retval =
+        UA_Server_addPubSubConnection(server, &connectionConfig, &connection1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_ReaderGroupConfig readerGroupConfig;
+    memset(&readerGroupConfig, 0, sizeof(UA_ReaderGroupConfig));
+    readerGroupConfig.name = UA_STRING("ReaderGroup 1");
+    retval = UA_Server_addReaderGroup(server, connection1, &readerGroupConfig,
+                                      &readerGroup1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+
+    /* Add many readers that differ only in the DataSetWriterId */
+    UA_DataSetReaderConfig readerConfig;
+    memset(&readerConfig, 0, sizeof(UA_DataSetReaderConfig));
+    readerConfig.name = UA_STRING("DataSetReader");
+    readerConfig.publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    readerConfig.publisherId.id.uint16 = PUBLISHER_ID;
+    readerConfig.writerGroupId = WRITER_GROUP_ID;
+    readerConfig.dataSetMetaData.name = UA_STRING("DataSet");
+    for(UA_UInt16 i = 0; i < READER_COUNT; i++) {
+        readerConfig.dataSetWriterId = (UA_UInt16)(i + 1);
+        retval = UA_Server_addDataSetReader(server, readerGroup1, &readerConfig,
+                                            &readerIds[i]);
+        ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    }
+
+    retval = UA_Server_enableAllPubSubComponents(server);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+/* NetworkMessage with a single (empty) KeyFrame */
+static void
+initNetworkMessage(UA_NetworkMessage *nm, UA_DataSetMessage *dsm,
+                   UA_UInt16 dataSetWriterId) {
+    memset(nm, 0, sizeof(UA_NetworkMessage));
+    memset(dsm, 0, sizeof(UA_DataSetMessage));
+    nm->version = 1;
+    nm->networkMessageType = UA_NETWORKMESSAGE_DATASET;
+    nm->publisherIdEnabled = true;
+    nm->publisherId.idType = UA_PUBLISHERIDTYPE_UINT16;
+    nm->publisherId.id.uint16 = PUBLISHER_ID;
+    nm->groupHeaderEnabled = true;
+    nm->groupHeader.writerGroupIdEnabled = true;
+    nm->groupHeader.writerGroupId = WRITER_GROUP_ID;
+    nm->payloadHeaderEnabled = true;
+    dsm->header.dataSetMessageType = UA_DATASETMESSAGE_DATAKEYFRAME;
+    dsm->dataSetWriterId = dataSetWriterId;
+    nm->payload.dataSetPayload.dataSetMessages = dsm;
+    nm->payload.dataSetPayload.dataSetMessagesSize = 1;
+}
+
+START_TEST(ReaderIndexLookup) {
+    lockServer(server);
+    UA_PubSubManager *psm = getPSM(server);
+    UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroup1);
+    ck_assert(rg != NULL);
+
+    UA_NetworkMessage nm;
+    UA_DataSetMessage dsm;
+    initNetworkMessage(&nm, &dsm, READER_COUNT / 2);
+    ck_assert(UA_ReaderGroup_hasMatchingReader(psm, rg, &nm));
+
+    /* Unknown DataSetWriterId */
+    dsm.dataSetWriterId = READER_COUNT + 1;
+    ck_assert(!UA_ReaderGroup_hasMatchingReader(psm, rg, &nm));
+
+    /* Different PublisherId */
+    dsm.dataSetWriterId = 1;
+    nm.publisherId.id.uint16 = PUBLISHER_ID + 1;
+    ck_assert(!UA_ReaderGroup_hasMatchingReader(psm, rg, &nm));
+    nm.publisherId.id.uint16 = PUBLISHER_ID;
+    ck_assert(UA_ReaderGroup_hasMatchingReader(psm, rg, &nm));
+    unlockServer(server);
+
+    /* Removed readers are no longer found */
+    UA_StatusCode retval = UA_Server_disableReaderGroup(server, readerGroup1);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_removeDataSetReader(server, readerIds[0]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    lockServer(server);
+    ck_assert(!UA_ReaderGroup_hasMatchingReader(psm, rg, &nm));
+    unlockServer(server);
+
+    /* The index follows a config update */
+    UA_DataSetReaderConfig config;
+    retval = UA_Server_getDataSetReaderConfig(server, readerIds[1], &config);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    config.dataSetWriterId = 1;
+    retval = UA_Server_disableDataSetReader(server, readerIds[1]);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_updateDataSetReaderConfig(server, readerIds[1], &config);
+    ck_assert_int_eq(retval, UA_STATUSCODE_GOOD);
+    UA_DataSetReaderConfig_clear(&config);
+    lockServer(server);
+    ck_assert(UA_ReaderGroup_hasMatchingReader(psm, rg, &nm));
+    dsm.dataSetWriterId = 2;
+    ck_assert(!UA_ReaderGroup_hasMatchingReader(psm, rg, &nm));
+    unlockServer(server);
+} END_TEST
+
+START_TEST(SubscribeSpeedTest) {
+    lockServer(server);
+    UA_PubSubManager *psm = getPSM(server);
+    UA_ReaderGroup *rg = UA_ReaderGroup_find(psm, readerGroup1);
+    ck_assert(rg != NULL);
+
+    UA_NetworkMessage nm;
+    UA_DataSetMessage dsm;
+    initNetworkMessage(&nm, &dsm, 1);
+
+    printf("start processing 100000 messages in a ReaderGroup with %u readers\n",
+           READER_COUNT);
+
+    clock_t begin, finish;
+    begin = clock();
+
+    for(int i = 0; i < 100000; i++) {
+        dsm.dataSetWriterId = (UA_UInt16)((i % READER_COUNT) + 1);
+        UA_ReaderGroup_process(psm, rg, &nm);
+    }
+
+    finish = clock();
+    double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+    printf("duration was %f s\n", time_spent);
+
+    /* The last message was received by the matching reader */
+    ck_assert(UA_ReaderGroup_process(psm, rg, &nm));
+    unlockServer(server);
+} END_TEST
+
+int main(void) {
+    TCase *tc_subscribespeed = tcase_create("Speed of the subscriber");
+    tcase_add_checked_fixture(tc_subscribespeed, setup, teardown);
+    tcase_add_test(tc_subscribespeed, ReaderIndexLookup);
+    tcase_add_test(tc_subscribespeed, SubscribeSpeedTest);
+
+    Suite *s = suite_create("PubSub Subscribe Speed Test");
+    suite_add_tcase(s, tc_subscribespeed);
+
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr,CK_NORMAL);
+    int number_failed = srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -9,6 +9,8 @@
 #include <open62541/client_config_default.h>
 #include <open62541/client_highlevel.h>
 #include <open62541/plugin/historydata/history_data_backend.h>
+#include <open62541/plugin/historydata/history_data_backend_columnar.h>
+#include <open62541/plugin/historydata/history_data_backend_file.h>
 #include <open62541/plugin/historydata/history_data_backend_memory.h>
 #include <open62541/plugin/historydata/history_data_gathering_default.h>
 #include <open62541/plugin/historydata/history_database_default.h>
@@ -21,6 +23,12 @@
 #include <check.h>
 #include <stdlib.h>
 #include <stdio.h>
+#include <math.h>
+
+#if defined(__linux__) || defined(__unix__)
+#include <dirent.h>
+#include <unistd.h>
+#endif
 
 #include "test_helpers.h"
 #include "testing_clock.h"
@@ -647,9 +655,9 @@ START_TEST(Server_HistorizingUpdateReplace)
 }
 END_TEST
 
-START_TEST(Server_HistorizingUpdateUpdate)
-{
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+/* Returns the backend as registered with the gathering */
+static UA_HistoryDataBackend
+testUpdateUpdate(UA_HistoryDataBackend backend) {
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -692,10 +700,75 @@ START_TEST(Server_HistorizingUpdateUpdate)
     }
 
     UA_HistoryData_clear(&data);
-    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+    return setting.historizingBackend;
+}
+
+START_TEST(Server_HistorizingUpdateUpdate)
+{
+    UA_HistoryDataBackend backend = testUpdateUpdate(UA_HistoryDataBackend_Memory(1, 1));
+    UA_HistoryDataBackend_Memory_clear(&backend);
 }
 END_TEST
 
+START_TEST(Server_HistorizingUpdateUpdateColumnar)
+{
+    UA_HistoryDataBackend backend = testUpdateUpdate(UA_HistoryDataBackend_Columnar(1));
+    UA_HistoryDataBackend_Columnar_clear(&backend);
+}
+END_TEST
+
+#if defined(__linux__) || defined(__unix__)
+
+/* Create an empty directory for the file backend */
+static void
+makeHistoryDirectory(char *dir) {
+    strcpy(dir, "/tmp/open62541_historyXXXXXX");
+    ck_assert(mkdtemp(dir) != NULL);
+}
+
+static void
+removeHistoryDirectory(const char *dir) {
+    DIR *d = opendir(dir);
+    ck_assert(d != NULL);
+    struct dirent *entry;
+    char path[512];
+    while((entry = readdir(d))) {
+        if(entry->d_name[0] == '.')
+            continue;
+        snprintf(path, sizeof(path), "%s/%s", dir, entry->d_name);
+        unlink(path);
+    }
+    closedir(d);
+    rmdir(dir);
+}
+
+static size_t
+countHistoryFiles(const char *dir) {
+    DIR *d = opendir(dir);
+    ck_assert(d != NULL);
+    size_t count = 0;
+    struct dirent *entry;
+    while((entry = readdir(d))) {
+        if(entry->d_name[0] != '.')
+            count++;
+    }
+    closedir(d);
+    return count;
+}
+
+START_TEST(Server_HistorizingUpdateUpdateFile)
+{
+    char dir[64];
+    makeHistoryDirectory(dir);
+    UA_HistoryDataBackend backend =
+        testUpdateUpdate(UA_HistoryDataBackend_File(dir, 256, 0));
+    UA_HistoryDataBackend_File_clear(&backend);
+    removeHistoryDirectory(dir);
+}
+END_TEST
+
+#endif
+
 START_TEST(Server_HistorizingStrategyUser) {
     // set a data backend
     UA_HistorizingNodeIdSettings setting;
@@ -890,9 +963,9 @@ START_TEST(Server_HistorizingStrategyValueSet) {
 }
 END_TEST
 
-START_TEST(Server_HistorizingBackendMemory)
-{
-    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+/* Returns the backend as registered with the gathering */
+static UA_HistoryDataBackend
+testBackend(UA_HistoryDataBackend backend) {
     UA_HistorizingNodeIdSettings setting;
     setting.historizingBackend = backend;
     setting.maxHistoryDataResponseSize = 1000;
@@ -901,27 +974,363 @@ START_TEST(Server_HistorizingBackendMemory)
     ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
 
     // empty backend should not crash
-    UA_UInt32 retval = testHistoricalDataBackend(100);
-    fprintf(stderr, "%x tests expected failed.\n", retval);
+    testHistoricalDataBackend(100);
 
     // fill backend
     ck_assert_uint_eq(fillHistoricalDataBackend(backend), true);
 
     // read all in one
-    retval = testHistoricalDataBackend(100);
-    fprintf(stderr, "%x tests failed.\n", retval);
-    ck_assert_uint_eq(retval, 0);
+    ck_assert_uint_eq(testHistoricalDataBackend(100), 0);
 
     // read continuous one at one request
-    retval = testHistoricalDataBackend(1);
-    fprintf(stderr, "%x tests failed.\n", retval);
-    ck_assert_uint_eq(retval, 0);
+    ck_assert_uint_eq(testHistoricalDataBackend(1), 0);
 
     // read continuous two at one request
-    retval = testHistoricalDataBackend(2);
-    fprintf(stderr, "%x tests failed.\n", retval);
-    ck_assert_uint_eq(retval, 0);
-    UA_HistoryDataBackend_Memory_clear(&setting.historizingBackend);
+    ck_assert_uint_eq(testHistoricalDataBackend(2), 0);
+    return setting.historizingBackend;
+}
+
+START_TEST(Server_HistorizingBackendMemory)
+{
+    UA_HistoryDataBackend backend = testBackend(UA_HistoryDataBackend_Memory(1, 1));
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingBackendColumnar)
+{
+    UA_HistoryDataBackend backend = testBackend(UA_HistoryDataBackend_Columnar(1));
+    UA_HistoryDataBackend_Columnar_clear(&backend);
+}
+END_TEST
+
+static const UA_NumericRange noRange = {0, NULL};
+
+/* Page through a backend with its continuation points */
+static size_t
+readBackendPages(UA_HistoryDataBackend *backend, UA_Boolean reverse,
+                 size_t pageSize, UA_DateTime *timestamps) {
+    size_t end = backend->getEnd(server, backend->context, NULL, NULL, &outNodeId);
+    size_t first = backend->firstIndex(server, backend->context, NULL, NULL, &outNodeId);
+    size_t last = backend->lastIndex(server, backend->context, NULL, NULL, &outNodeId);
+    ck_assert_uint_ne(end, 0);
+    UA_DataValue *values = (UA_DataValue*)
+        UA_Array_new(pageSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    size_t total = 0;
+    do {
+        UA_ByteString outCp = UA_BYTESTRING_NULL;
+        size_t provided = 0;
+        UA_StatusCode res =
+            backend->copyDataValues(server, backend->context, NULL, NULL, &outNodeId,
+                                    reverse ? last : first, reverse ? first : last,
+                                    reverse, pageSize, noRange, false,
+                                    &cp, &outCp, &provided, values);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        for(size_t i = 0; i < provided; i++) {
+            timestamps[total++] = values[i].sourceTimestamp;
+            UA_DataValue_clear(&values[i]);
+        }
+        UA_ByteString_clear(&cp);
+        cp = outCp;
+    } while(cp.length > 0);
+    UA_Array_delete(values, pageSize, &UA_TYPES[UA_TYPES_DATAVALUE]);
+    return total;
+}
+
+START_TEST(Server_HistorizingBackendMemoryPaging) {
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 1);
+    const size_t count = 1000;
+    for(size_t i = 0; i < count; i++) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = (UA_DateTime)(i + 1) * UA_DATETIME_SEC;
+        UA_StatusCode res =
+            backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                         &outNodeId, false, &value);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* Every value is delivered once and in order */
+    UA_DateTime timestamps[1000];
+    ck_assert_uint_eq(readBackendPages(&backend, false, 7, timestamps), count);
+    for(size_t i = 0; i < count; i++)
+        ck_assert_int_eq(timestamps[i], (UA_DateTime)(i + 1) * UA_DATETIME_SEC);
+    ck_assert_uint_eq(readBackendPages(&backend, true, 7, timestamps), count);
+    for(size_t i = 0; i < count; i++)
+        ck_assert_int_eq(timestamps[i], (UA_DateTime)(count - i) * UA_DATETIME_SEC);
+
+    /* Removing values invalidates the cursor. The read resumes after the
+     * last delivered timestamp. */
+    UA_DataValue values[10];
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    UA_ByteString outCp = UA_BYTESTRING_NULL;
+    size_t provided = 0;
+    UA_StatusCode res =
+        backend.copyDataValues(server, backend.context, NULL, NULL, &outNodeId,
+                               0, count - 1, false, 10, noRange, false,
+                               &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, 10);
+    for(size_t i = 0; i < provided; i++)
+        UA_DataValue_clear(&values[i]);
+    res = backend.removeDataValue(server, backend.context, NULL, NULL, &outNodeId,
+                                  UA_DATETIME_SEC, UA_DATETIME_SEC);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = backend.copyDataValues(server, backend.context, NULL, NULL, &outNodeId,
+                                 0, count - 2, false, 10, noRange, false,
+                                 &outCp, &cp, &provided, values);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(provided, 10);
+    ck_assert_int_eq(values[0].sourceTimestamp, 11 * UA_DATETIME_SEC);
+    for(size_t i = 0; i < provided; i++)
+        UA_DataValue_clear(&values[i]);
+    UA_ByteString_clear(&outCp);
+
+    /* A cursor outside of the requested range is rejected */
+    res = backend.copyDataValues(server, backend.context, NULL, NULL, &outNodeId,
+                                 0, 5, false, 10, noRange, false,
+                                 &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADCONTINUATIONPOINTINVALID);
+    ck_assert_uint_eq(outCp.length, 0);
+    res = backend.copyDataValues(server, backend.context, NULL, NULL, &outNodeId,
+                                 5, 0, true, 10, noRange, false,
+                                 &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADCONTINUATIONPOINTINVALID);
+    memset(cp.data, 0xff, cp.length);
+    res = backend.copyDataValues(server, backend.context, NULL, NULL, &outNodeId,
+                                 0, count - 2, false, 10, noRange, false,
+                                 &cp, &outCp, &provided, values);
+    ck_assert_uint_eq(res, UA_STATUSCODE_BADCONTINUATIONPOINTINVALID);
+    UA_ByteString_clear(&cp);
+
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+#if defined(__linux__) || defined(__unix__)
+
+START_TEST(Server_HistorizingBackendFile)
+{
+    char dir[64];
+    makeHistoryDirectory(dir);
+    UA_HistoryDataBackend backend =
+        testBackend(UA_HistoryDataBackend_File(dir, 4096, 0));
+    UA_HistoryDataBackend_File_clear(&backend);
+    removeHistoryDirectory(dir);
+}
+END_TEST
+
+static void
+appendFileValues(UA_HistoryDataBackend *backend, size_t from, size_t to) {
+    for(size_t i = from; i < to; i++) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        UA_UInt32 v = (UA_UInt32)i;
+        UA_Variant_setScalar(&value.value, &v, &UA_TYPES[UA_TYPES_UINT32]);
+        value.hasValue = true;
+        value.hasSourceTimestamp = true;
+        value.sourceTimestamp = (UA_DateTime)(i + 1) * UA_DATETIME_SEC;
+        UA_StatusCode res =
+            backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                          &outNodeId, true, &value);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+}
+
+START_TEST(Server_HistorizingBackendFileReopen) {
+    char dir[64];
+    makeHistoryDirectory(dir);
+    const size_t count = 1000;
+
+    /* Small segments to spread the values over many files */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 1024, 0);
+    appendFileValues(&backend, 0, count);
+    size_t files = countHistoryFiles(dir);
+    ck_assert_uint_gt(files, 10);
+    UA_HistoryDataBackend_File_clear(&backend);
+
+    /* The values are loaded from the files */
+    backend = UA_HistoryDataBackend_File(dir, 1024, 0);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &outNodeId), count);
+    UA_DateTime timestamps[1000];
+    ck_assert_uint_eq(readBackendPages(&backend, false, 7, timestamps), count);
+    for(size_t i = 0; i < count; i++)
+        ck_assert_int_eq(timestamps[i], (UA_DateTime)(i + 1) * UA_DATETIME_SEC);
+    ck_assert_uint_eq(readBackendPages(&backend, true, 7, timestamps), count);
+    for(size_t i = 0; i < count; i++)
+        ck_assert_int_eq(timestamps[i], (UA_DateTime)(count - i) * UA_DATETIME_SEC);
+    size_t index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &outNodeId,
+                                            500 * UA_DATETIME_SEC + 1, MATCH_BEFORE);
+    ck_assert_uint_eq(index, 499);
+    const UA_DataValue *dv =
+        backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, index);
+    ck_assert_uint_eq(*(UA_UInt32*)dv->value.data, 499);
+    UA_HistoryDataBackend_File_clear(&backend);
+
+    /* Segments beyond the retention are deleted when a segment is started */
+    backend = UA_HistoryDataBackend_File(dir, 1024, 100 * 1000.0);
+    appendFileValues(&backend, count, count + 100);
+    size_t end = backend.getEnd(server, backend.context, NULL, NULL, &outNodeId);
+    ck_assert_uint_lt(end, 300);
+    ck_assert_uint_lt(countHistoryFiles(dir), files);
+    dv = backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, 0);
+    ck_assert_int_ge(dv->sourceTimestamp, (UA_DateTime)(count + 100 - 200) * UA_DATETIME_SEC);
+    dv = backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, end - 1);
+    ck_assert_uint_eq(*(UA_UInt32*)dv->value.data, count + 99);
+    UA_HistoryDataBackend_File_clear(&backend);
+
+    removeHistoryDirectory(dir);
+}
+END_TEST
+
+/* NodeIds whose escaped names are too long for a file name are hashed */
+START_TEST(Server_HistorizingBackendFileLongName) {
+    char dir[64];
+    makeHistoryDirectory(dir);
+    char id[400], other[400];
+    memset(id, '/', sizeof(id) - 1);
+    id[sizeof(id) - 1] = 0;
+    memcpy(other, id, sizeof(id));
+    other[0] = 'a';
+    UA_NodeId longId = UA_NODEID_STRING(1, id);
+    UA_NodeId otherId = UA_NODEID_STRING(1, other);
+
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_File(dir, 1024, 0);
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    UA_UInt32 v = 1;
+    UA_Variant_setScalar(&value.value, &v, &UA_TYPES[UA_TYPES_UINT32]);
+    value.hasValue = true;
+    value.hasSourceTimestamp = true;
+    value.sourceTimestamp = UA_DATETIME_SEC;
+    UA_StatusCode res =
+        backend.serverSetHistoryData(server, backend.context, NULL, NULL,
+                                     &longId, true, &value);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(countHistoryFiles(dir), 1);
+    UA_HistoryDataBackend_File_clear(&backend);
+
+    /* The hashed name is found again and differs for another NodeId */
+    backend = UA_HistoryDataBackend_File(dir, 1024, 0);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &longId), 1);
+    ck_assert_uint_eq(backend.getEnd(server, backend.context, NULL, NULL, &otherId), 0);
+    UA_HistoryDataBackend_File_clear(&backend);
+
+    removeHistoryDirectory(dir);
+}
+END_TEST
+
+#endif
+
+#define COLUMNAR_COUNT 10000
+
+static UA_DateTime
+columnarTimestamp(size_t i) {
+    /* 100ms sampling interval with jitter */
+    return UA_DATETIME_SEC + (UA_DateTime)i * 100 * UA_DATETIME_MSEC +
+        (UA_DateTime)((i * 7919) % 13) * UA_DATETIME_USEC;
+}
+
+static UA_Double
+columnarValue(size_t i) {
+    return 20.0 + (UA_Double)((i * 31) % 100) / 8.0;
+}
+
+static void
+setColumnarValue(UA_HistoryDataBackend *backend, UA_DateTime timestamp,
+                 void *value, const UA_DataType *type) {
+    UA_DataValue dv;
+    UA_DataValue_init(&dv);
+    UA_Variant_setScalar(&dv.value, value, type);
+    dv.hasValue = true;
+    dv.hasSourceTimestamp = true;
+    dv.sourceTimestamp = timestamp;
+    dv.hasServerTimestamp = true;
+    dv.serverTimestamp = timestamp + 3 * UA_DATETIME_MSEC;
+    UA_StatusCode res =
+        backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                      &outNodeId, true, &dv);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+START_TEST(Server_HistorizingBackendColumnarCompression) {
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Columnar(1);
+    for(size_t i = 0; i < COLUMNAR_COUNT; i++) {
+        UA_Double v = columnarValue(i);
+        setColumnarValue(&backend, columnarTimestamp(i), &v, &UA_TYPES[UA_TYPES_DOUBLE]);
+    }
+
+    /* The values and both timestamps are restored exactly */
+    size_t end = backend.getEnd(server, backend.context, NULL, NULL, &outNodeId);
+    ck_assert_uint_eq(end, COLUMNAR_COUNT);
+    for(size_t i = 0; i < COLUMNAR_COUNT; i++) {
+        const UA_DataValue *dv =
+            backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, i);
+        ck_assert(dv->value.type == &UA_TYPES[UA_TYPES_DOUBLE]);
+        ck_assert(*(UA_Double*)dv->value.data == columnarValue(i));
+        ck_assert_int_eq(dv->sourceTimestamp, columnarTimestamp(i));
+        ck_assert_int_eq(dv->serverTimestamp, columnarTimestamp(i) + 3 * UA_DATETIME_MSEC);
+    }
+
+    /* Page through the blocks in both directions */
+    UA_DateTime *timestamps = (UA_DateTime*)
+        UA_malloc(COLUMNAR_COUNT * sizeof(UA_DateTime));
+    ck_assert_uint_eq(readBackendPages(&backend, false, 333, timestamps), COLUMNAR_COUNT);
+    for(size_t i = 0; i < COLUMNAR_COUNT; i++)
+        ck_assert_int_eq(timestamps[i], columnarTimestamp(i));
+    ck_assert_uint_eq(readBackendPages(&backend, true, 333, timestamps), COLUMNAR_COUNT);
+    for(size_t i = 0; i < COLUMNAR_COUNT; i++)
+        ck_assert_int_eq(timestamps[i], columnarTimestamp(COLUMNAR_COUNT - 1 - i));
+    UA_free(timestamps);
+
+    /* Search in the middle of a block */
+    size_t index =
+        backend.getDateTimeMatch(server, backend.context, NULL, NULL, &outNodeId,
+                                 columnarTimestamp(5000) + 1, MATCH_EQUAL_OR_AFTER);
+    ck_assert_uint_eq(index, 5001);
+    index = backend.getDateTimeMatch(server, backend.context, NULL, NULL, &outNodeId,
+                                     columnarTimestamp(5000), MATCH_EQUAL);
+    ck_assert_uint_eq(index, 5000);
+
+    /* Insert out of order and change the DataType */
+    UA_Int32 i32 = -5;
+    UA_DateTime between = columnarTimestamp(5000) + 1;
+    setColumnarValue(&backend, between, &i32, &UA_TYPES[UA_TYPES_INT32]);
+    UA_String str = UA_STRING("text");
+    UA_DateTime last = columnarTimestamp(COLUMNAR_COUNT);
+    setColumnarValue(&backend, last, &str, &UA_TYPES[UA_TYPES_STRING]);
+    UA_Boolean b = true;
+    setColumnarValue(&backend, last + UA_DATETIME_SEC, &b, &UA_TYPES[UA_TYPES_BOOLEAN]);
+    end = backend.getEnd(server, backend.context, NULL, NULL, &outNodeId);
+    ck_assert_uint_eq(end, COLUMNAR_COUNT + 3);
+
+    const UA_DataValue *dv =
+        backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, 5001);
+    ck_assert(dv->value.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)dv->value.data, -5);
+    dv = backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, 5002);
+    ck_assert(*(UA_Double*)dv->value.data == columnarValue(5001));
+    dv = backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, COLUMNAR_COUNT + 1);
+    ck_assert(UA_String_equal((UA_String*)dv->value.data, &str));
+    dv = backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, COLUMNAR_COUNT + 2);
+    ck_assert_uint_eq(*(UA_Boolean*)dv->value.data, true);
+
+    /* Remove a range across blocks. The end timestamp is excluded. */
+    UA_StatusCode res =
+        backend.removeDataValue(server, backend.context, NULL, NULL, &outNodeId,
+                                columnarTimestamp(1000), columnarTimestamp(3000));
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    end = backend.getEnd(server, backend.context, NULL, NULL, &outNodeId);
+    ck_assert_uint_eq(end, COLUMNAR_COUNT + 3 - 2000);
+    dv = backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, 999);
+    ck_assert_int_eq(dv->sourceTimestamp, columnarTimestamp(999));
+    dv = backend.getDataValue(server, backend.context, NULL, NULL, &outNodeId, 1000);
+    ck_assert_int_eq(dv->sourceTimestamp, columnarTimestamp(3000));
+    ck_assert(*(UA_Double*)dv->value.data == columnarValue(3000));
+
+    UA_HistoryDataBackend_Columnar_clear(&backend);
 }
 END_TEST
 
@@ -953,6 +1362,448 @@ START_TEST(Server_HistorizingRandomIndexBackend)
 }
 END_TEST
 
+static void
+requestProcessed(UA_DateTime start, UA_DateTime end, UA_Double interval,
+                 UA_UInt32 aggregate, UA_ByteString *continuationPoint,
+                 UA_HistoryReadResponse *response) {
+    UA_ReadProcessedDetails *details = UA_ReadProcessedDetails_new();
+    details->startTime = start;
+    details->endTime = end;
+    details->processingInterval = interval;
+    details->aggregateType = UA_NodeId_new();
+    *details->aggregateType = UA_NODEID_NUMERIC(0, aggregate);
+    details->aggregateTypeSize = 1;
+    details->aggregateConfiguration.useServerCapabilitiesDefaults = true;
+
+    UA_HistoryReadValueId *valueId = UA_HistoryReadValueId_new();
+    UA_NodeId_copy(&outNodeId, &valueId->nodeId);
+    if(continuationPoint)
+        UA_ByteString_copy(continuationPoint, &valueId->continuationPoint);
+
+    UA_HistoryReadRequest request;
+    UA_HistoryReadRequest_init(&request);
+    UA_ExtensionObject_setValue(&request.historyReadDetails, details,
+                                &UA_TYPES[UA_TYPES_READPROCESSEDDETAILS]);
+    request.timestampsToReturn = UA_TIMESTAMPSTORETURN_SOURCE;
+    request.nodesToReadSize = 1;
+    request.nodesToRead = valueId;
+
+    UA_HistoryReadResponse_init(response);
+    lockServer(server);
+    Service_HistoryRead(server, &server->adminSession, &request, response);
+    unlockServer(server);
+    UA_HistoryReadRequest_clear(&request);
+    ck_assert_uint_eq(response->responseHeader.serviceResult, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(response->resultsSize, 1);
+}
+
+/* Returns the HistoryData of the single result */
+static UA_HistoryData *
+processedData(UA_HistoryReadResponse *response) {
+    ck_assert_str_eq(UA_StatusCode_name(response->results[0].statusCode),
+                     UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    ck_assert(response->results[0].historyData.content.decoded.type ==
+              &UA_TYPES[UA_TYPES_HISTORYDATA]);
+    return (UA_HistoryData*)response->results[0].historyData.content.decoded.data;
+}
+
+static UA_Double
+processedValue(const UA_DataValue *dv) {
+    ck_assert(dv->hasValue);
+    ck_assert(dv->value.type == &UA_TYPES[UA_TYPES_DOUBLE]);
+    return *(UA_Double*)dv->value.data;
+}
+
+#define PROCESSED_BASE (UA_DATETIME_SEC * 1000)
+
+/* The value of sample i is i at i seconds after the base */
+static void
+fillProcessedBackend(UA_HistoryDataBackend *backend, size_t count) {
+    for(size_t i = 0; i < count; i++) {
+        UA_Double d = (UA_Double)i;
+        UA_DataValue dv;
+        UA_DataValue_init(&dv);
+        UA_Variant_setScalar(&dv.value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+        dv.hasValue = true;
+        dv.sourceTimestamp = PROCESSED_BASE + (UA_DateTime)i * UA_DATETIME_SEC;
+        dv.hasSourceTimestamp = true;
+        backend->serverSetHistoryData(server, backend->context, NULL, NULL,
+                                      &outNodeId, true, &dv);
+    }
+}
+
+static void
+registerProcessedBackend(UA_HistoryDataBackend backend, size_t maxResponseSize) {
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = maxResponseSize;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_USER;
+    UA_StatusCode ret = gathering->registerNodeId(server, gathering->context, &outNodeId, setting);
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+}
+
+START_TEST(Server_HistorizingReadProcessed) {
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 100);
+    registerProcessedBackend(backend, 100);
+    fillProcessedBackend(&backend, 100);
+    const UA_DateTime end = PROCESSED_BASE + 100 * UA_DATETIME_SEC;
+
+    /* Ten intervals of ten samples */
+    const UA_UInt32 aggregates[] = {
+        UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, UA_NS0ID_AGGREGATEFUNCTION_MINIMUM,
+        UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, UA_NS0ID_AGGREGATEFUNCTION_RANGE,
+        UA_NS0ID_AGGREGATEFUNCTION_START, UA_NS0ID_AGGREGATEFUNCTION_END,
+        UA_NS0ID_AGGREGATEFUNCTION_DELTA, UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE,
+        UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE, UA_NS0ID_AGGREGATEFUNCTION_TOTAL};
+    for(size_t a = 0; a < sizeof(aggregates) / sizeof(aggregates[0]); a++) {
+        UA_HistoryReadResponse response;
+        requestProcessed(PROCESSED_BASE, end, 10000.0, aggregates[a], NULL, &response);
+        UA_HistoryData *data = processedData(&response);
+        ck_assert_uint_eq(data->dataValuesSize, 10);
+        ck_assert_uint_eq(response.results[0].continuationPoint.length, 0);
+        for(size_t k = 0; k < 10; k++) {
+            const UA_DataValue *dv = &data->dataValues[k];
+            UA_Double first = (UA_Double)(10 * k);
+            UA_Double expected = 0.0;
+            switch(aggregates[a]) {
+            case UA_NS0ID_AGGREGATEFUNCTION_AVERAGE: expected = first + 4.5; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_MINIMUM: expected = first; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM: expected = first + 9; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_RANGE: expected = 9; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_START: expected = first; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_END: expected = first + 9; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_DELTA: expected = 9; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE: expected = first; break;
+            /* The last value is extrapolated in the last interval */
+            case UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE:
+                expected = (k < 9) ? first + 5 : 94.95; break;
+            case UA_NS0ID_AGGREGATEFUNCTION_TOTAL:
+                expected = (k < 9) ? 10 * (first + 5) : 949.5; break;
+            default: break;
+            }
+            ck_assert(fabs(processedValue(dv) - expected) < 1e-9);
+            ck_assert(dv->hasSourceTimestamp);
+            ck_assert_int_eq(dv->sourceTimestamp,
+                             PROCESSED_BASE + (UA_DateTime)k * 10 * UA_DATETIME_SEC);
+            ck_assert(!UA_StatusCode_isBad(dv->status));
+        }
+        UA_HistoryReadResponse_clear(&response);
+    }
+
+    /* Count is an Int32. Empty intervals have no data. */
+    UA_HistoryReadResponse response;
+    requestProcessed(PROCESSED_BASE - 20 * UA_DATETIME_SEC, PROCESSED_BASE + 10 * UA_DATETIME_SEC,
+                     10000.0, UA_NS0ID_AGGREGATEFUNCTION_COUNT, NULL, &response);
+    UA_HistoryData *data = processedData(&response);
+    ck_assert_uint_eq(data->dataValuesSize, 3);
+    ck_assert(data->dataValues[2].value.type == &UA_TYPES[UA_TYPES_INT32]);
+    ck_assert_int_eq(*(UA_Int32*)data->dataValues[0].value.data, 0);
+    ck_assert_int_eq(*(UA_Int32*)data->dataValues[2].value.data, 10);
+    UA_HistoryReadResponse_clear(&response);
+    requestProcessed(PROCESSED_BASE - 20 * UA_DATETIME_SEC, PROCESSED_BASE,
+                     10000.0, UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, NULL, &response);
+    data = processedData(&response);
+    ck_assert_uint_eq(data->dataValuesSize, 2);
+    ck_assert_uint_eq(data->dataValues[0].status, UA_STATUSCODE_BADNODATA);
+    UA_HistoryReadResponse_clear(&response);
+
+    /* Interpolated between two samples */
+    requestProcessed(PROCESSED_BASE + UA_DATETIME_SEC / 2, end, 0.0,
+                     UA_NS0ID_AGGREGATEFUNCTION_INTERPOLATIVE, NULL, &response);
+    data = processedData(&response);
+    ck_assert_uint_eq(data->dataValuesSize, 1);
+    ck_assert(fabs(processedValue(&data->dataValues[0]) - 0.5) < 1e-9);
+    ck_assert_uint_eq(data->dataValues[0].status & 0xff, 0x02);
+    UA_HistoryReadResponse_clear(&response);
+
+    /* The last interval is partial */
+    requestProcessed(PROCESSED_BASE, end, 30000.0,
+                     UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, NULL, &response);
+    data = processedData(&response);
+    ck_assert_uint_eq(data->dataValuesSize, 4);
+    ck_assert(fabs(processedValue(&data->dataValues[3]) - 99.0) < 1e-9);
+    ck_assert_uint_eq(data->dataValues[2].status & 0x04, 0);
+    ck_assert_uint_eq(data->dataValues[3].status & 0x04, 0x04);
+    UA_HistoryReadResponse_clear(&response);
+
+    /* Backwards in time */
+    requestProcessed(end, PROCESSED_BASE, 10000.0,
+                     UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, NULL, &response);
+    data = processedData(&response);
+    ck_assert_uint_eq(data->dataValuesSize, 10);
+    ck_assert(fabs(processedValue(&data->dataValues[0]) - 94.5) < 1e-9);
+    ck_assert(fabs(processedValue(&data->dataValues[9]) - 4.5) < 1e-9);
+    UA_HistoryReadResponse_clear(&response);
+
+    /* Unknown aggregate */
+    requestProcessed(PROCESSED_BASE, end, 10000.0,
+                     UA_NS0ID_AGGREGATEFUNCTION_WORSTQUALITY, NULL, &response);
+    ck_assert_uint_eq(response.results[0].statusCode,
+                      UA_STATUSCODE_BADAGGREGATENOTSUPPORTED);
+    UA_HistoryReadResponse_clear(&response);
+
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingReadProcessedContinuation) {
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 100);
+    registerProcessedBackend(backend, 4);
+    fillProcessedBackend(&backend, 100);
+
+    /* Ten intervals in pages of four */
+    size_t total = 0;
+    UA_ByteString cp = UA_BYTESTRING_NULL;
+    do {
+        UA_HistoryReadResponse response;
+        requestProcessed(PROCESSED_BASE, PROCESSED_BASE + 100 * UA_DATETIME_SEC,
+                         10000.0, UA_NS0ID_AGGREGATEFUNCTION_MINIMUM, &cp, &response);
+        UA_HistoryData *data = processedData(&response);
+        ck_assert_uint_le(data->dataValuesSize, 4);
+        for(size_t i = 0; i < data->dataValuesSize; i++) {
+            ck_assert(fabs(processedValue(&data->dataValues[i]) - (UA_Double)(10 * total)) < 1e-9);
+            total++;
+        }
+        UA_ByteString_clear(&cp);
+        UA_ByteString_copy(&response.results[0].continuationPoint, &cp);
+        UA_HistoryReadResponse_clear(&response);
+    } while(cp.length > 0);
+    ck_assert_uint_eq(total, 10);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+/* Without a maximum response size, the number of intervals per response is
+ * still bounded. Invalid and extreme intervals are handled without overflow. */
+START_TEST(Server_HistorizingReadProcessedLimits) {
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 100);
+    registerProcessedBackend(backend, 0);
+    fillProcessedBackend(&backend, 100);
+
+    /* One interval per tick */
+    UA_HistoryReadResponse response;
+    requestProcessed(PROCESSED_BASE, PROCESSED_BASE + UA_DATETIME_SEC,
+                     1.0 / UA_DATETIME_MSEC, UA_NS0ID_AGGREGATEFUNCTION_COUNT,
+                     NULL, &response);
+    ck_assert_uint_eq(processedData(&response)->dataValuesSize, 10000);
+    ck_assert_uint_gt(response.results[0].continuationPoint.length, 0);
+    UA_HistoryReadResponse_clear(&response);
+
+    /* A processing interval beyond the time range is a single interval */
+    requestProcessed(PROCESSED_BASE, UA_INT64_MAX, 1e300,
+                     UA_NS0ID_AGGREGATEFUNCTION_MAXIMUM, NULL, &response);
+    UA_HistoryData *data = processedData(&response);
+    ck_assert_uint_eq(data->dataValuesSize, 1);
+    ck_assert(fabs(processedValue(&data->dataValues[0]) - 99.0) < 1e-9);
+    ck_assert_uint_eq(response.results[0].continuationPoint.length, 0);
+    UA_HistoryReadResponse_clear(&response);
+
+    /* The last interval ends at the end of the range */
+    requestProcessed(UA_INT64_MAX, PROCESSED_BASE, 1000.0 * 3600 * 24 * 365 * 10000,
+                     UA_NS0ID_AGGREGATEFUNCTION_COUNT, NULL, &response);
+    data = processedData(&response);
+    ck_assert_uint_gt(data->dataValuesSize, 1);
+    ck_assert_int_eq(data->dataValues[data->dataValuesSize - 1].sourceTimestamp,
+                     PROCESSED_BASE);
+    UA_HistoryReadResponse_clear(&response);
+
+    requestProcessed(PROCESSED_BASE, PROCESSED_BASE + UA_DATETIME_SEC, NAN,
+                     UA_NS0ID_AGGREGATEFUNCTION_COUNT, NULL, &response);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_BADINVALIDARGUMENT);
+    UA_HistoryReadResponse_clear(&response);
+    requestProcessed(UA_INT64_MIN, UA_INT64_MAX, 1000.0,
+                     UA_NS0ID_AGGREGATEFUNCTION_COUNT, NULL, &response);
+    ck_assert_uint_eq(response.results[0].statusCode, UA_STATUSCODE_BADINVALIDARGUMENT);
+    UA_HistoryReadResponse_clear(&response);
+
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+/* The columnar backend provides the statistics of its compressed blocks. The
+ * results must match the memory backend. */
+START_TEST(Server_HistorizingReadProcessedColumnar) {
+    const size_t samples = 5000;
+    const UA_UInt32 aggregates[] = {
+        UA_NS0ID_AGGREGATEFUNCTION_AVERAGE, UA_NS0ID_AGGREGATEFUNCTION_MINIMUMACTUALTIME,
+        UA_NS0ID_AGGREGATEFUNCTION_MAXIMUMACTUALTIME, UA_NS0ID_AGGREGATEFUNCTION_COUNT,
+        UA_NS0ID_AGGREGATEFUNCTION_DELTA, UA_NS0ID_AGGREGATEFUNCTION_TIMEAVERAGE};
+    const size_t aggregatesSize = sizeof(aggregates) / sizeof(aggregates[0]);
+    UA_HistoryReadResponse expected[sizeof(aggregates) / sizeof(aggregates[0])];
+
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, samples);
+    registerProcessedBackend(backend, 100);
+    fillProcessedBackend(&backend, samples);
+    for(size_t a = 0; a < aggregatesSize; a++)
+        requestProcessed(PROCESSED_BASE, PROCESSED_BASE + 5000 * UA_DATETIME_SEC,
+                         1500000.0, aggregates[a], NULL, &expected[a]);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+
+    backend = UA_HistoryDataBackend_Columnar(1);
+    UA_HistorizingNodeIdSettings setting =
+        *gathering->getHistorizingSetting(server, gathering->context, &outNodeId);
+    setting.historizingBackend = backend;
+    gathering->updateNodeIdSetting(server, gathering->context, &outNodeId, setting);
+    fillProcessedBackend(&backend, samples);
+
+    UA_HistoryDataSummary summary;
+    UA_StatusCode ret = backend.getSummary(server, backend.context, NULL, NULL,
+                                           &outNodeId, 10, samples - 1, &summary);
+    ck_assert_uint_eq(ret, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(summary.count, samples - 10);
+    ck_assert_uint_eq(summary.goodCount, samples - 10);
+    ck_assert(fabs(summary.min - 10.0) < 1e-9);
+    ck_assert(fabs(summary.max - (UA_Double)(samples - 1)) < 1e-9);
+    ck_assert_int_eq(summary.maxTimestamp,
+                     PROCESSED_BASE + (UA_DateTime)(samples - 1) * UA_DATETIME_SEC);
+
+    for(size_t a = 0; a < aggregatesSize; a++) {
+        UA_HistoryReadResponse response;
+        requestProcessed(PROCESSED_BASE, PROCESSED_BASE + 5000 * UA_DATETIME_SEC,
+                         1500000.0, aggregates[a], NULL, &response);
+        UA_HistoryData *data = processedData(&response);
+        UA_HistoryData *exp = processedData(&expected[a]);
+        ck_assert_uint_eq(data->dataValuesSize, 4);
+        ck_assert_uint_eq(data->dataValuesSize, exp->dataValuesSize);
+        for(size_t i = 0; i < data->dataValuesSize; i++)
+            ck_assert(UA_order(&data->dataValues[i], &exp->dataValues[i],
+                               &UA_TYPES[UA_TYPES_DATAVALUE]) == UA_ORDER_EQ);
+        UA_HistoryReadResponse_clear(&response);
+        UA_HistoryReadResponse_clear(&expected[a]);
+    }
+    UA_HistoryDataBackend_Columnar_clear(&backend);
+}
+END_TEST
+
+/* The buffered gathering runs in its own server. The samples are stored by
+ * the flush callback in the EventLoop of that server. */
+static UA_Server *
+newBufferedServer(UA_HistoryDataGathering *g, const UA_HistoryBufferConfig *bc,
+                  UA_HistoryDataBackend backend, const UA_NodeId *nodeId) {
+    UA_Server *bserver = UA_Server_newForUnitTest();
+    ck_assert(bserver != NULL);
+    *g = UA_HistoryDataGathering_Buffered(1, bc);
+    ck_assert(g->context != NULL);
+    UA_Server_getConfig(bserver)->historyDatabase = UA_HistoryDatabase_default(*g);
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 100;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_VALUESET;
+    UA_StatusCode ret = g->registerNodeId(bserver, g->context, nodeId, setting);
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    return bserver;
+}
+
+static void
+setBufferedValues(UA_Server *bserver, UA_HistoryDataGathering *g,
+                  const UA_NodeId *nodeId, UA_UInt32 count) {
+    for(UA_UInt32 i = 0; i < count; i++) {
+        UA_DataValue value;
+        UA_DataValue_init(&value);
+        UA_Variant_setScalar(&value.value, &i, &UA_TYPES[UA_TYPES_UINT32]);
+        value.hasValue = true;
+        value.sourceTimestamp = (i + 1) * UA_DATETIME_SEC;
+        value.hasSourceTimestamp = true;
+        g->setValue(bserver, g->context, NULL, NULL, nodeId, true, &value);
+    }
+}
+
+START_TEST(Server_HistorizingGatheringBuffered) {
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 5000);
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 100);
+    UA_HistoryBufferConfig bc = {4, 2, 100.0, UA_HISTORYBUFFERPOLICY_DROPNEWEST};
+    UA_HistoryDataGathering g;
+    UA_Server *bserver = newBufferedServer(&g, &bc, backend, &nodeId);
+    UA_StatusCode ret = UA_Server_run_startup(bserver);
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+
+    /* The last two samples do not fit */
+    UA_EventLoop *el = UA_Server_getConfig(bserver)->eventLoop;
+    UA_DateTime bufferTime = el->dateTime_now(el);
+    setBufferedValues(bserver, &g, &nodeId, 6);
+    UA_HistoryBufferStatistics stats;
+    ret = UA_HistoryDataGathering_Buffered_getStatistics(&g, &stats);
+    ck_assert_str_eq(UA_StatusCode_name(ret), UA_StatusCode_name(UA_STATUSCODE_GOOD));
+    ck_assert_uint_eq(stats.buffered, 4);
+    ck_assert_uint_eq(stats.dropped, 2);
+    ck_assert_uint_eq(stats.stored, 0);
+    ck_assert_uint_eq(stats.size, 4);
+    ck_assert_uint_eq(stats.highWatermark, 4);
+    ck_assert_uint_eq(backend.getEnd(bserver, backend.context, NULL, NULL, &nodeId), 0);
+
+    /* Each flush callback stores one batch */
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(bserver, false);
+    UA_HistoryDataGathering_Buffered_getStatistics(&g, &stats);
+    ck_assert_uint_eq(stats.stored, 2);
+    ck_assert_uint_eq(stats.size, 2);
+    UA_fakeSleep(100);
+    UA_Server_run_iterate(bserver, false);
+    UA_HistoryDataGathering_Buffered_getStatistics(&g, &stats);
+    ck_assert_uint_eq(stats.stored, 4);
+    ck_assert_uint_eq(stats.size, 0);
+    ck_assert_uint_eq(backend.getEnd(bserver, backend.context, NULL, NULL, &nodeId), 4);
+    size_t last = backend.lastIndex(bserver, backend.context, NULL, NULL, &nodeId);
+    const UA_DataValue *dv =
+        backend.getDataValue(bserver, backend.context, NULL, NULL, &nodeId, last);
+    ck_assert_int_eq(dv->sourceTimestamp, 4 * UA_DATETIME_SEC);
+
+    /* The server timestamp is the time of buffering, not of storing */
+    ck_assert(dv->hasServerTimestamp);
+    ck_assert_int_eq(dv->serverTimestamp, bufferTime);
+
+    UA_Server_run_shutdown(bserver);
+    UA_Server_delete(bserver);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
+START_TEST(Server_HistorizingGatheringBufferedPolicy) {
+    UA_NodeId nodeId = UA_NODEID_NUMERIC(1, 5000);
+    UA_HistoryBufferStatistics stats;
+
+    /* The oldest samples are replaced */
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 100);
+    UA_HistoryBufferConfig bc = {4, 4, 1000.0, UA_HISTORYBUFFERPOLICY_DROPOLDEST};
+    UA_HistoryDataGathering g;
+    UA_Server *bserver = newBufferedServer(&g, &bc, backend, &nodeId);
+    setBufferedValues(bserver, &g, &nodeId, 10);
+    UA_HistoryDataGathering_Buffered_flush(bserver, &g);
+    UA_HistoryDataGathering_Buffered_getStatistics(&g, &stats);
+    ck_assert_uint_eq(stats.buffered, 10);
+    ck_assert_uint_eq(stats.dropped, 6);
+    ck_assert_uint_eq(stats.stored, 4);
+    ck_assert_uint_eq(backend.getEnd(bserver, backend.context, NULL, NULL, &nodeId), 4);
+    size_t first = backend.firstIndex(bserver, backend.context, NULL, NULL, &nodeId);
+    const UA_DataValue *dv =
+        backend.getDataValue(bserver, backend.context, NULL, NULL, &nodeId, first);
+    ck_assert_int_eq(dv->sourceTimestamp, 7 * UA_DATETIME_SEC);
+    UA_Server_delete(bserver);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+
+    /* A full buffer stores a batch before the sample is added */
+    backend = UA_HistoryDataBackend_Memory(1, 100);
+    bc.batchSize = 3;
+    bc.policy = UA_HISTORYBUFFERPOLICY_FLUSH;
+    bserver = newBufferedServer(&g, &bc, backend, &nodeId);
+    setBufferedValues(bserver, &g, &nodeId, 10);
+    UA_HistoryDataGathering_Buffered_getStatistics(&g, &stats);
+    ck_assert_uint_eq(stats.dropped, 0);
+    ck_assert_uint_eq(stats.forcedFlushes, 2);
+    ck_assert_uint_eq(stats.stored, 6);
+    ck_assert_uint_eq(stats.size, 4);
+    UA_HistoryDataGathering_Buffered_flush(bserver, &g);
+    ck_assert_uint_eq(backend.getEnd(bserver, backend.context, NULL, NULL, &nodeId), 10);
+
+    /* Pending samples are freed with the server */
+    setBufferedValues(bserver, &g, &nodeId, 2);
+    UA_Server_delete(bserver);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+}
+END_TEST
+
 static Suite *
 testSuite_Client(void) {
     Suite *s = suite_create("Server Historical Data");
@@ -962,13 +1813,34 @@ testSuite_Client(void) {
     tcase_add_test(tc_server, Server_HistorizingStrategyUser);
     tcase_add_test(tc_server, Server_HistorizingStrategyValueSet);
     tcase_add_test(tc_server, Server_HistorizingBackendMemory);
+    tcase_add_test(tc_server, Server_HistorizingBackendMemoryPaging);
+    tcase_add_test(tc_server, Server_HistorizingBackendColumnar);
+    tcase_add_test(tc_server, Server_HistorizingBackendColumnarCompression);
+#if defined(__linux__) || defined(__unix__)
+    tcase_add_test(tc_server, Server_HistorizingBackendFile);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileReopen);
+    tcase_add_test(tc_server, Server_HistorizingBackendFileLongName);
+#endif
     tcase_add_test(tc_server, Server_HistorizingRandomIndexBackend);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessed);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessedContinuation);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessedLimits);
+    tcase_add_test(tc_server, Server_HistorizingReadProcessedColumnar);
     tcase_add_test(tc_server, Server_HistorizingUpdateDelete);
     tcase_add_test(tc_server, Server_HistorizingUpdateInsert);
     tcase_add_test(tc_server, Server_HistorizingUpdateReplace);
     tcase_add_test(tc_server, Server_HistorizingUpdateUpdate);
+    tcase_add_test(tc_server, Server_HistorizingUpdateUpdateColumnar);
+#if defined(__linux__) || defined(__unix__)
+    tcase_add_test(tc_server, Server_HistorizingUpdateUpdateFile);
+#endif
     suite_add_tcase(s, tc_server);
 
+    TCase *tc_buffered = tcase_create("Server Historical Data Buffered");
+    tcase_add_test(tc_buffered, Server_HistorizingGatheringBuffered);
+    tcase_add_test(tc_buffered, Server_HistorizingGatheringBufferedPolicy);
+    suite_add_tcase(s, tc_buffered);
+
     return s;
 }
 
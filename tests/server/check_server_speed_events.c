@@ -0,0 +1,189 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* This benchmark shows how many events per second can be filtered for a
+ * growing number of event MonitoredItems. The server does not open a TCP
+ * port. */
+
+#include <open62541/server_config_default.h>
+
+#include "test_helpers.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define EVENTS 100
+
+static UA_Server *server;
+static size_t callbackCount = 0;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+    UA_Server_run_startup(server);
+}
+
+static void teardown(void) {
+    UA_Server_run_shutdown(server);
+    UA_Server_delete(server);
+}
+
+static void
+eventCallback(UA_Server *s, UA_UInt32 monitoredItemId,
+              void *monitoredItemContext, const UA_KeyValueMap eventFields) {
+    callbackCount++;
+}
+
+static void
+setField(const UA_NodeId eventNodeId, const char *name,
+         void *value, const UA_DataType *type) {
+    UA_Variant v;
+    UA_Variant_setScalar(&v, value, type);
+    UA_StatusCode res =
+        UA_Server_writeObjectProperty(server, eventNodeId,
+                                      UA_QUALIFIEDNAME(0, (char*)(uintptr_t)name), v);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+}
+
+/* Select four fields with the where clause
+ * OfType(eventType) && Severity >= 100 */
+static void
+createMonitoredItem(const UA_NodeId eventType) {
+    UA_EventFilter filter;
+    UA_EventFilter_init(&filter);
+    UA_SimpleAttributeOperand select[4];
+    UA_SimpleAttributeOperand_parse(&select[0], UA_STRING("/EventId"));
+    UA_SimpleAttributeOperand_parse(&select[1], UA_STRING("/EventType"));
+    UA_SimpleAttributeOperand_parse(&select[2], UA_STRING("/Message"));
+    UA_SimpleAttributeOperand_parse(&select[3], UA_STRING("/Severity"));
+    filter.selectClauses = select;
+    filter.selectClausesSize = 4;
+
+    UA_ContentFilterElement elm[3];
+    UA_ExtensionObject andOps[2], ofTypeOp, gteOps[2];
+    UA_ElementOperand eo[2];
+    UA_LiteralOperand typeLiteral, severityLiteral;
+    UA_Byte minSeverity = 100; /* Cast to the UInt16 of the Severity field */
+
+    for(size_t i = 0; i < 3; i++)
+        UA_ContentFilterElement_init(&elm[i]);
+    elm[0].filterOperator = UA_FILTEROPERATOR_AND;
+    elm[0].filterOperandsSize = 2;
+    elm[0].filterOperands = andOps;
+    UA_ElementOperand_init(&eo[0]);
+    UA_ElementOperand_init(&eo[1]);
+    eo[0].index = 1;
+    eo[1].index = 2;
+    UA_ExtensionObject_setValue(&andOps[0], &eo[0], &UA_TYPES[UA_TYPES_ELEMENTOPERAND]);
+    UA_ExtensionObject_setValue(&andOps[1], &eo[1], &UA_TYPES[UA_TYPES_ELEMENTOPERAND]);
+
+    elm[1].filterOperator = UA_FILTEROPERATOR_OFTYPE;
+    elm[1].filterOperandsSize = 1;
+    elm[1].filterOperands = &ofTypeOp;
+    UA_LiteralOperand_init(&typeLiteral);
+    UA_Variant_setScalar(&typeLiteral.value, (void*)(uintptr_t)&eventType,
+                         &UA_TYPES[UA_TYPES_NODEID]);
+    UA_ExtensionObject_setValue(&ofTypeOp, &typeLiteral,
+                                &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+
+    elm[2].filterOperator = UA_FILTEROPERATOR_GREATERTHANOREQUAL;
+    elm[2].filterOperandsSize = 2;
+    elm[2].filterOperands = gteOps;
+    UA_ExtensionObject_setValue(&gteOps[0], &select[3],
+                                &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    UA_LiteralOperand_init(&severityLiteral);
+    UA_Variant_setScalar(&severityLiteral.value, &minSeverity,
+                         &UA_TYPES[UA_TYPES_BYTE]);
+    UA_ExtensionObject_setValue(&gteOps[1], &severityLiteral,
+                                &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+
+    filter.whereClause.elements = elm;
+    filter.whereClause.elementsSize = 3;
+
+    /* The queue holds all events of one measurement */
+    UA_MonitoredItemCreateRequest item;
+    UA_MonitoredItemCreateRequest_init(&item);
+    item.itemToMonitor.nodeId = UA_NS0ID(SERVER);
+    item.itemToMonitor.attributeId = UA_ATTRIBUTEID_EVENTNOTIFIER;
+    item.monitoringMode = UA_MONITORINGMODE_REPORTING;
+    item.requestedParameters.queueSize = EVENTS;
+    UA_ExtensionObject_setValue(&item.requestedParameters.filter, &filter,
+                                &UA_TYPES[UA_TYPES_EVENTFILTER]);
+    UA_MonitoredItemCreateResult res =
+        UA_Server_createEventMonitoredItemEx(server, item, NULL, eventCallback);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_GOOD);
+
+    for(size_t i = 0; i < 4; i++)
+        UA_SimpleAttributeOperand_clear(&select[i]);
+}
+
+START_TEST(eventsPerSecond) {
+    /* Add an event type and the node representation of one event */
+    UA_NodeId eventType;
+    UA_ObjectTypeAttributes attr = UA_ObjectTypeAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectTypeNode(server, UA_NODEID_NULL, UA_NS0ID(BASEEVENTTYPE),
+                                    UA_NS0ID(HASSUBTYPE),
+                                    UA_QUALIFIEDNAME(1, "SpeedEventType"),
+                                    attr, NULL, &eventType);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    UA_NodeId eventNodeId;
+    res = UA_Server_createEvent(server, eventType, &eventNodeId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_UInt16 severity = 500;
+    setField(eventNodeId, "Severity", &severity, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_LocalizedText message = UA_LOCALIZEDTEXT("en-US", "Speed Event");
+    setField(eventNodeId, "Message", &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+
+    /* Increase the number of MonitoredItems */
+    size_t monitoredItems = 0;
+    for(size_t target = 1; target <= 1000; target *= 10) {
+        for(; monitoredItems < target; monitoredItems++)
+            createMonitoredItem(eventType);
+
+        clock_t begin = clock();
+        for(size_t i = 0; i < EVENTS; i++) {
+            res = UA_Server_triggerEvent(server, eventNodeId, UA_NS0ID(SERVER),
+                                         NULL, false);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+        clock_t finish = clock();
+        double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+        printf("%5lu MonitoredItems: %10.0f events/s, %10.0f filtered/s\n",
+               (unsigned long)monitoredItems, EVENTS / time_spent,
+               (double)(EVENTS * monitoredItems) / time_spent);
+
+        /* Every MonitoredItem received all events */
+        callbackCount = 0;
+        UA_Server_run_iterate(server, false);
+        ck_assert_uint_eq(callbackCount, EVENTS * monitoredItems);
+    }
+
+    UA_Server_deleteNode(server, eventNodeId, true);
+} END_TEST
+
+static Suite * event_speed_suite(void) {
+    Suite *s = suite_create("Event Speed");
+
+    TCase* tc_events = tcase_create("Events");
+    tcase_add_checked_fixture(tc_events, setup, teardown);
+    tcase_add_test(tc_events, eventsPerSecond);
+    tcase_set_timeout(tc_events, 0);
+    suite_add_tcase(s, tc_events);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed = 0;
+    Suite *s = event_speed_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
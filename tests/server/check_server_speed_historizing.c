@@ -0,0 +1,155 @@
+/* This work is licensed under a Creative Commons CCZero 1.0 Universal License.
+ * See http://creativecommons.org/publicdomain/zero/1.0/ for more information. */
+
+/* This benchmark shows how many samples per second are historized for a
+ * growing number of historized nodes. The samples are passed through the
+ * default gathering to the memory backend. The buffered gathering is measured
+ * separately for the sampling and the storing of the batches. */
+
+#include <open62541/plugin/historydata/history_data_backend_memory.h>
+#include <open62541/plugin/historydata/history_data_gathering_default.h>
+#include <open62541/server_config_default.h>
+
+#include "test_helpers.h"
+
+#include <check.h>
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+
+#define SAMPLES 50000
+
+static UA_Server *server;
+
+static void setup(void) {
+    server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+}
+
+static void teardown(void) {
+    UA_Server_delete(server);
+}
+
+START_TEST(samplesPerSecond) {
+    UA_HistoryDataGathering gathering = UA_HistoryDataGathering_Default(1);
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 4);
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_VALUESET;
+
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    UA_Double d = 42.0;
+    UA_Variant_setScalar(&value.value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    value.hasValue = true;
+    value.hasSourceTimestamp = true;
+
+    /* Increase the number of historized nodes */
+    size_t nodes = 0;
+    UA_DateTime timestamp = UA_DATETIME_SEC;
+    const size_t targets[4] = {1, 100, 10000, 50000};
+    for(size_t t = 0; t < 4; t++) {
+        for(; nodes < targets[t]; nodes++) {
+            UA_NodeId id = UA_NODEID_NUMERIC(1, (UA_UInt32)(10000 + nodes));
+            UA_StatusCode res =
+                gathering.registerNodeId(server, gathering.context, &id, setting);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+
+        /* Distribute the samples over all nodes */
+        clock_t begin = clock();
+        for(size_t i = 0; i < SAMPLES; i++) {
+            UA_NodeId id = UA_NODEID_NUMERIC(1, (UA_UInt32)(10000 + (i % nodes)));
+            value.sourceTimestamp = timestamp++;
+            gathering.setValue(server, gathering.context, NULL, NULL,
+                               &id, true, &value);
+        }
+        clock_t finish = clock();
+        double time_spent = (double)(finish - begin) / CLOCKS_PER_SEC;
+        printf("%6lu nodes: %10.0f samples/s\n",
+               (unsigned long)nodes, SAMPLES / time_spent);
+    }
+
+    /* All samples are stored */
+    UA_NodeId first = UA_NODEID_NUMERIC(1, 10000);
+    size_t end = backend.getEnd(server, backend.context, NULL, NULL, &first);
+    ck_assert_uint_eq(end, SAMPLES + SAMPLES / 100 + SAMPLES / 10000 + SAMPLES / 50000);
+
+    gathering.deleteMembers(&gathering);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+} END_TEST
+
+START_TEST(samplesPerSecondBuffered) {
+    UA_HistoryBufferConfig bc = {SAMPLES, 1024, 1000.0, UA_HISTORYBUFFERPOLICY_FLUSH};
+    UA_HistoryDataGathering gathering = UA_HistoryDataGathering_Buffered(1, &bc);
+    UA_HistoryDataBackend backend = UA_HistoryDataBackend_Memory(1, 4);
+    UA_HistorizingNodeIdSettings setting;
+    memset(&setting, 0, sizeof(UA_HistorizingNodeIdSettings));
+    setting.historizingBackend = backend;
+    setting.maxHistoryDataResponseSize = 1000;
+    setting.historizingUpdateStrategy = UA_HISTORIZINGUPDATESTRATEGY_VALUESET;
+
+    const size_t nodes = 10000;
+    for(size_t i = 0; i < nodes; i++) {
+        UA_NodeId id = UA_NODEID_NUMERIC(1, (UA_UInt32)(10000 + i));
+        UA_StatusCode res =
+            gathering.registerNodeId(server, gathering.context, &id, setting);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    UA_DataValue value;
+    UA_DataValue_init(&value);
+    UA_Double d = 42.0;
+    UA_Variant_setScalar(&value.value, &d, &UA_TYPES[UA_TYPES_DOUBLE]);
+    value.hasValue = true;
+    value.hasSourceTimestamp = true;
+
+    clock_t begin = clock();
+    for(size_t i = 0; i < SAMPLES; i++) {
+        UA_NodeId id = UA_NODEID_NUMERIC(1, (UA_UInt32)(10000 + (i % nodes)));
+        value.sourceTimestamp = UA_DATETIME_SEC + (UA_DateTime)i;
+        gathering.setValue(server, gathering.context, NULL, NULL,
+                           &id, true, &value);
+    }
+    clock_t buffered = clock();
+    UA_HistoryDataGathering_Buffered_flush(server, &gathering);
+    clock_t finish = clock();
+    printf("%6lu nodes: %10.0f samples/s buffered, %10.0f samples/s stored\n",
+           (unsigned long)nodes,
+           SAMPLES / ((double)(buffered - begin) / CLOCKS_PER_SEC),
+           SAMPLES / ((double)(finish - buffered) / CLOCKS_PER_SEC));
+
+    UA_HistoryBufferStatistics stats;
+    UA_HistoryDataGathering_Buffered_getStatistics(&gathering, &stats);
+    ck_assert_uint_eq(stats.stored, SAMPLES);
+    ck_assert_uint_eq(stats.dropped, 0);
+
+    gathering.deleteMembers(&gathering);
+    UA_HistoryDataBackend_Memory_clear(&backend);
+} END_TEST
+
+static Suite * historizing_speed_suite(void) {
+    Suite *s = suite_create("Historizing Speed");
+
+    TCase* tc_history = tcase_create("Historizing");
+    tcase_add_checked_fixture(tc_history, setup, teardown);
+    tcase_add_test(tc_history, samplesPerSecond);
+    tcase_add_test(tc_history, samplesPerSecondBuffered);
+    tcase_set_timeout(tc_history, 0);
+    suite_add_tcase(s, tc_history);
+
+    return s;
+}
+
+int main(void) {
+    int number_failed = 0;
+    Suite *s = historizing_speed_suite();
+    SRunner *sr = srunner_create(s);
+    srunner_set_fork_status(sr, CK_NOFORK);
+    srunner_run_all(sr, CK_NORMAL);
+    number_failed += srunner_ntests_failed(sr);
+    srunner_free(sr);
+    return (number_failed == 0) ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -217,6 +217,120 @@ START_TEST(Service_Browse_ClassMask) {
 }
 END_TEST
 
+static void *
+countTargetNodeClass(void *context, UA_ReferenceTarget *t) {
+    if(t->targetNodeClass == UA_NODECLASS_OBJECT ||
+       t->targetNodeClass == UA_NODECLASS_VARIABLE)
+        (*(size_t*)context)++;
+    return NULL;
+}
+
+START_TEST(Service_Browse_TargetNodeClassSummary) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_NodeId folderId, varId;
+    UA_ObjectAttributes oa = UA_ObjectAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                UA_QUALIFIEDNAME(1, "Folder"),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oa, NULL, &folderId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    /* Enough children to switch the references to the tree representation */
+    for(size_t i = 0; i < 20; i++) {
+        char name[16];
+        snprintf(name, sizeof(name), "Child%u", (unsigned)i);
+        if(i % 2 == 0) {
+            res = UA_Server_addObjectNode(server, UA_NODEID_NULL, folderId,
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                          UA_QUALIFIEDNAME(1, name),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                          oa, NULL, NULL);
+        } else {
+            UA_VariableAttributes va = UA_VariableAttributes_default;
+            res = UA_Server_addVariableNode(server, UA_NODEID_NULL, folderId,
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                            UA_QUALIFIEDNAME(1, name),
+                                            UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                            va, NULL, (i == 1) ? &varId : NULL);
+        }
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* The NodeClass of the targets is stored in the references */
+    const UA_Node *folder = UA_NODESTORE_GET(server, &folderId);
+    ck_assert(folder != NULL);
+    size_t forward = 0;
+    for(size_t i = 0; i < folder->head.referencesSize; i++) {
+        UA_NodeReferenceKind *rk = &folder->head.references[i];
+        if(rk->isInverse ||
+           rk->referenceTypeIndex != UA_REFERENCETYPEINDEX_ORGANIZES)
+            continue;
+        ck_assert(rk->hasRefTree);
+        UA_NodeReferenceKind_iterate(rk, countTargetNodeClass, &forward);
+    }
+    UA_NODESTORE_RELEASE(server, folder);
+    ck_assert_uint_eq(forward, 20);
+
+    /* Browse the variables with a result mask that is answered from the
+     * references alone */
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = folderId;
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    bd.nodeClassMask = UA_NODECLASS_VARIABLE;
+    bd.resultMask = UA_BROWSERESULTMASK_NODECLASS |
+        UA_BROWSERESULTMASK_REFERENCETYPEID | UA_BROWSERESULTMASK_ISFORWARD;
+    UA_BrowseResult br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 10);
+    for(size_t i = 0; i < br.referencesSize; i++) {
+        ck_assert_int_eq(br.references[i].nodeClass, UA_NODECLASS_VARIABLE);
+        ck_assert(br.references[i].isForward);
+        UA_NodeClass cl = UA_NODECLASS_UNSPECIFIED;
+        UA_Server_readNodeClass(server, br.references[i].nodeId.nodeId, &cl);
+        ck_assert_int_eq(cl, UA_NODECLASS_VARIABLE);
+    }
+    UA_BrowseResult_clear(&br);
+
+    /* The TypeDefinition is taken from the target node */
+    bd.nodeClassMask = UA_NODECLASS_OBJECT;
+    bd.resultMask = UA_BROWSERESULTMASK_ALL;
+    br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 10);
+    UA_NodeId folderType = UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE);
+    for(size_t i = 0; i < br.referencesSize; i++) {
+        ck_assert_int_eq(br.references[i].nodeClass, UA_NODECLASS_OBJECT);
+        ck_assert(UA_NodeId_equal(&br.references[i].typeDefinition.nodeId,
+                                  &folderType));
+        ck_assert_uint_eq(br.references[i].browseName.namespaceIndex, 1);
+    }
+    UA_BrowseResult_clear(&br);
+
+    /* References to a node that was deleted without its references are not
+     * returned, even if the result mask is answered from the references */
+    res = UA_Server_deleteNode(server, varId, false);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    bd.nodeClassMask = UA_NODECLASS_VARIABLE;
+    bd.resultMask = UA_BROWSERESULTMASK_NODECLASS;
+    br = UA_Server_browse(server, 0, &bd);
+    ck_assert_uint_eq(br.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(br.referencesSize, 9);
+    for(size_t i = 0; i < br.referencesSize; i++)
+        ck_assert(!UA_NodeId_equal(&br.references[i].nodeId.nodeId, &varId));
+    UA_BrowseResult_clear(&br);
+    UA_NodeId_clear(&varId);
+
+    UA_Server_delete(server);
+}
+END_TEST
+
 START_TEST(Service_Browse_ReferenceTypes) {
     UA_Server *server = UA_Server_newForUnitTest();
     ck_assert(server != NULL);
@@ -303,6 +417,88 @@ START_TEST(Service_Browse_Recursive) {
 }
 END_TEST
 
+START_TEST(Service_Browse_RecursiveSharedTargets) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    /* Three levels of ten objects. Every object references all objects of
+     * the next level. The last level references a single variable. */
+    UA_ObjectAttributes oa = UA_ObjectAttributes_default;
+    UA_StatusCode res;
+    for(UA_UInt32 l = 0; l < 3; l++) {
+        for(UA_UInt32 i = 0; i < 10; i++) {
+            UA_NodeId parent = (l == 0) ?
+                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER) :
+                UA_NODEID_NUMERIC(1, 1000 + ((l - 1) * 10));
+            res = UA_Server_addObjectNode(server, UA_NODEID_NUMERIC(1, 1000 + (l * 10) + i),
+                                          parent, UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                          UA_QUALIFIEDNAME(1, "Object"),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_BASEOBJECTTYPE),
+                                          oa, NULL, NULL);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+            for(UA_UInt32 p = 1; l > 0 && p < 10; p++) {
+                res = UA_Server_addReference(server,
+                                             UA_NODEID_NUMERIC(1, 1000 + ((l - 1) * 10) + p),
+                                             UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                             UA_EXPANDEDNODEID_NUMERIC(1, 1000 + (l * 10) + i),
+                                             true);
+                ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+            }
+        }
+    }
+
+    UA_VariableAttributes va = UA_VariableAttributes_default;
+    res = UA_Server_addVariableNode(server, UA_NODEID_NUMERIC(1, 2000),
+                                    UA_NODEID_NUMERIC(1, 1020),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                    UA_QUALIFIEDNAME(1, "Variable"),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_BASEDATAVARIABLETYPE),
+                                    va, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    for(UA_UInt32 p = 1; p < 10; p++) {
+        res = UA_Server_addReference(server, UA_NODEID_NUMERIC(1, 1020 + p),
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                     UA_EXPANDEDNODEID_NUMERIC(1, 2000), true);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    }
+
+    /* Every object is returned once */
+    size_t resultSize = 0;
+    UA_ExpandedNodeId *result = NULL;
+    UA_BrowseDescription bd;
+    UA_BrowseDescription_init(&bd);
+    bd.nodeId = UA_NODEID_NUMERIC(1, 1000);
+    bd.referenceTypeId = UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES);
+    bd.browseDirection = UA_BROWSEDIRECTION_FORWARD;
+    bd.nodeClassMask = UA_NODECLASS_OBJECT;
+    res = UA_Server_browseRecursive(server, &bd, &resultSize, &result);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(resultSize, 20);
+
+    UA_Boolean found[20];
+    memset(found, 0, sizeof(found));
+    for(size_t i = 0; i < resultSize; i++) {
+        ck_assert_uint_eq(result[i].nodeId.namespaceIndex, 1);
+        UA_UInt32 id = result[i].nodeId.identifier.numeric;
+        ck_assert(id >= 1010 && id < 1030);
+        ck_assert(!found[id - 1010]);
+        found[id - 1010] = true;
+    }
+    UA_Array_delete(result, resultSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+
+    /* The variable is found below all objects of the last level */
+    bd.nodeId = UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER);
+    bd.nodeClassMask = UA_NODECLASS_VARIABLE;
+    res = UA_Server_browseRecursive(server, &bd, &resultSize, &result);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(resultSize, 1);
+    ck_assert_uint_eq(result[0].nodeId.identifier.numeric, 2000);
+    UA_Array_delete(result, resultSize, &UA_TYPES[UA_TYPES_EXPANDEDNODEID]);
+
+    UA_Server_delete(server);
+}
+END_TEST
+
 START_TEST(Service_Browse_Localization) {
     UA_Server *server = UA_Server_newForUnitTest();
     ck_assert(server != NULL);
@@ -480,6 +676,213 @@ START_TEST(Service_TranslateBrowsePathsNoMatches) {
 }
 END_TEST
 
+/* Remote targets have no known BrowseName. They are returned with the
+ * RemainingPathIndex set. Test with a reference array (few children) and a
+ * reference tree (many children) in the parent node. */
+START_TEST(Service_TranslateBrowsePathsRemoteTarget) {
+    size_t childrenSizes[2] = {1, 40};
+    for(size_t i = 0; i < 2; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), "RemoteParent%u", (unsigned)i);
+        UA_NodeId parent;
+        UA_ObjectAttributes oa = UA_ObjectAttributes_default;
+        UA_StatusCode res =
+            UA_Server_addObjectNode(server_translate_browse, UA_NODEID_NULL,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                    UA_QUALIFIEDNAME(1, name),
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                    oa, NULL, &parent);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        for(size_t j = 0; j < childrenSizes[i]; j++) {
+            snprintf(name, sizeof(name), "Child%u", (unsigned)j);
+            res = UA_Server_addObjectNode(server_translate_browse, UA_NODEID_NULL, parent,
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                          UA_QUALIFIEDNAME(1, name),
+                                          UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                          oa, NULL, NULL);
+            ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+        }
+
+        UA_ExpandedNodeId remote = UA_EXPANDEDNODEID_NUMERIC(1, 4711);
+        remote.serverIndex = 1;
+        res = UA_Server_addReference(server_translate_browse, parent,
+                                     UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                     remote, true);
+        ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+        /* The local child is found via its BrowseName */
+        UA_QualifiedName path[2] = {UA_QUALIFIEDNAME(1, "Child0"),
+                                    UA_QUALIFIEDNAME(1, "Deeper")};
+        UA_BrowsePathResult bpr =
+            UA_Server_browseSimplifiedBrowsePath(server_translate_browse, parent, 1, path);
+        ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(bpr.targetsSize, 1);
+        ck_assert_uint_eq(bpr.targets[0].remainingPathIndex, UA_UINT32_MAX);
+        UA_BrowsePathResult_clear(&bpr);
+
+        /* The remote target remains for the second element */
+        path[0] = UA_QUALIFIEDNAME(1, "Remote");
+        bpr = UA_Server_browseSimplifiedBrowsePath(server_translate_browse, parent, 2, path);
+        ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+        ck_assert_uint_eq(bpr.targetsSize, 1);
+        ck_assert(UA_ExpandedNodeId_equal(&bpr.targets[0].targetId, &remote));
+        ck_assert_uint_eq(bpr.targets[0].remainingPathIndex, 1);
+        UA_BrowsePathResult_clear(&bpr);
+
+        UA_Server_deleteNode(server_translate_browse, parent, true);
+    }
+}
+END_TEST
+
+START_TEST(Service_TranslateBrowsePathsCache) {
+    UA_Server *server = UA_Server_newForUnitTest();
+    ck_assert(server != NULL);
+
+    UA_QualifiedName path[2] = {UA_QUALIFIEDNAME(0, "Objects"),
+                                UA_QUALIFIEDNAME(1, "CachedNode")};
+    UA_NodeId root = UA_NODEID_NUMERIC(0, UA_NS0ID_ROOTFOLDER);
+
+    /* The first resolution is a miss, the second a hit */
+    UA_BrowsePathResult bpr =
+        UA_Server_browseSimplifiedBrowsePath(server, root, 1, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    UA_BrowsePathResult_clear(&bpr);
+    UA_ServerStatistics stats = UA_Server_getStatistics(server);
+    size_t hits = stats.bpcs.hitCount;
+    size_t misses = stats.bpcs.missCount;
+
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 1, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bpr.targetsSize, 1);
+    ck_assert_uint_eq(bpr.targets[0].targetId.nodeId.identifier.numeric,
+                      UA_NS0ID_OBJECTSFOLDER);
+    UA_BrowsePathResult_clear(&bpr);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.hitCount, hits + 1);
+    ck_assert_uint_eq(stats.bpcs.missCount, misses);
+
+    /* The cached BadNoMatch is kept when an unrelated node is added */
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 2, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_BADNOMATCH);
+    UA_BrowsePathResult_clear(&bpr);
+
+    UA_NodeId unrelatedId;
+    UA_ObjectAttributes oa = UA_ObjectAttributes_default;
+    UA_StatusCode res =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_HASCOMPONENT),
+                                path[1], UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oa, NULL, &unrelatedId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    res = UA_Server_deleteNode(server, unrelatedId, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    stats = UA_Server_getStatistics(server);
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 2, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_BADNOMATCH);
+    UA_BrowsePathResult_clear(&bpr);
+    UA_ServerStatistics stats2 = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats2.bpcs.hitCount, stats.bpcs.hitCount + 1);
+    ck_assert_uint_eq(stats2.bpcs.invalidationCount, stats.bpcs.invalidationCount);
+
+    /* The cached BadNoMatch is invalidated when the node is added to a visited
+     * node */
+    UA_NodeId nodeId;
+    res =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL,
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_OBJECTSFOLDER),
+                                UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                path[1], UA_NODEID_NUMERIC(0, UA_NS0ID_FOLDERTYPE),
+                                oa, NULL, &nodeId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 2, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bpr.targetsSize, 1);
+    ck_assert(UA_NodeId_equal(&bpr.targets[0].targetId.nodeId, &nodeId));
+    UA_BrowsePathResult_clear(&bpr);
+
+    /* The cached result is invalidated when the node is deleted */
+    res = UA_Server_deleteNode(server, nodeId, true);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 2, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_BADNOMATCH);
+    UA_BrowsePathResult_clear(&bpr);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_ge(stats.bpcs.invalidationCount, 2);
+
+#ifdef UA_ENABLE_SUBSCRIPTIONS_EVENTS
+    /* Paths starting at an event are not cached */
+    UA_NodeId eventId;
+    res = UA_Server_createEvent(server, UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE),
+                                &eventId);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    UA_QualifiedName severity = UA_QUALIFIEDNAME(0, "Severity");
+    stats = UA_Server_getStatistics(server);
+    for(size_t i = 0; i < 2; i++) {
+        bpr = UA_Server_browseSimplifiedBrowsePath(server, eventId, 1, &severity);
+        ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+        UA_BrowsePathResult_clear(&bpr);
+    }
+    stats2 = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats2.bpcs.missCount, stats.bpcs.missCount + 2);
+    ck_assert_uint_eq(stats2.bpcs.currentEntries, stats.bpcs.currentEntries);
+    UA_Server_deleteNode(server, eventId, true);
+#endif
+
+#if defined(UA_ENABLE_DIAGNOSTICS) && defined(UA_GENERATED_NAMESPACE_ZERO)
+    /* The statistics are exposed below VendorServerInfo */
+    UA_QualifiedName hitsName = UA_QUALIFIEDNAME(1, "BrowsePathCacheHits");
+    bpr = UA_Server_browseSimplifiedBrowsePath(server,
+              UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER_VENDORSERVERINFO), 1, &hitsName);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(bpr.targetsSize, 1);
+    UA_Variant value;
+    res = UA_Server_readValue(server, bpr.targets[0].targetId.nodeId, &value);
+    UA_BrowsePathResult_clear(&bpr);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    ck_assert(UA_Variant_hasScalarType(&value, &UA_TYPES[UA_TYPES_UINT64]));
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(*(UA_UInt64*)value.data, stats.bpcs.hitCount);
+    UA_Variant_clear(&value);
+#endif
+
+    /* A new ReferenceType (HasSubtype reference outside of the path)
+     * invalidates the cached results. Paths with includeSubtypes can match
+     * the new type. */
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 1, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    UA_BrowsePathResult_clear(&bpr);
+    UA_ReferenceTypeAttributes ra = UA_ReferenceTypeAttributes_default;
+    res = UA_Server_addReferenceTypeNode(server, UA_NODEID_NULL,
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_ORGANIZES),
+                                         UA_NODEID_NUMERIC(0, UA_NS0ID_HASSUBTYPE),
+                                         UA_QUALIFIEDNAME(1, "CachedRefType"),
+                                         ra, NULL, NULL);
+    ck_assert_uint_eq(res, UA_STATUSCODE_GOOD);
+    size_t invalidations = UA_Server_getStatistics(server).bpcs.invalidationCount;
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 1, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    UA_BrowsePathResult_clear(&bpr);
+    stats = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats.bpcs.invalidationCount, invalidations + 1);
+
+    /* Without a cache size the cache is bypassed */
+    UA_Server_getConfig(server)->browsePathCacheSize = 0;
+    bpr = UA_Server_browseSimplifiedBrowsePath(server, root, 1, path);
+    ck_assert_uint_eq(bpr.statusCode, UA_STATUSCODE_GOOD);
+    UA_BrowsePathResult_clear(&bpr);
+    stats2 = UA_Server_getStatistics(server);
+    ck_assert_uint_eq(stats2.bpcs.hitCount, stats.bpcs.hitCount);
+    ck_assert_uint_eq(stats2.bpcs.missCount, stats.bpcs.missCount);
+
+    UA_Server_delete(server);
+}
+END_TEST
+
 START_TEST(BrowseSimplifiedBrowsePath) {
     UA_QualifiedName objectsName = UA_QUALIFIEDNAME(0, "Objects");
     UA_BrowsePathResult bpr =
@@ -500,8 +903,10 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     tcase_add_test(tc_browse, Service_Browse_WithBrowseName);
     tcase_add_test(tc_browse, Service_Browse_ClassMask);
     tcase_add_test(tc_browse, Service_Browse_ReferenceTypes);
+    tcase_add_test(tc_browse, Service_Browse_TargetNodeClassSummary);
     tcase_add_test(tc_browse, Service_Browse_WithMaxResults);
     tcase_add_test(tc_browse, Service_Browse_Recursive);
+    tcase_add_test(tc_browse, Service_Browse_RecursiveSharedTargets);
     tcase_add_test(tc_browse, Service_Browse_Localization);
     suite_add_tcase(s, tc_browse);
 
@@ -510,6 +915,8 @@ static Suite *testSuite_Service_TranslateBrowsePathsToNodeIds(void) {
     tcase_add_test(tc_translate, ServiceTest_TranslateBrowsePathsToNodeIds);
     tcase_add_test(tc_translate, Service_TranslateBrowsePathsWithHashCollision);
     tcase_add_test(tc_translate, Service_TranslateBrowsePathsNoMatches);
+    tcase_add_test(tc_translate, Service_TranslateBrowsePathsRemoteTarget);
+    tcase_add_test(tc_translate, Service_TranslateBrowsePathsCache);
     tcase_add_test(tc_translate, BrowseSimplifiedBrowsePath);
 
     suite_add_tcase(s, tc_translate);
@@ -117,11 +117,362 @@ START_TEST(generateEvents) {
     ck_assert_uint_eq(callbackCount, 3);
 } END_TEST
 
+static unsigned nodelessCount = 0;
+static UA_UInt16 nodelessSeverity = 0;
+
+static void
+nodelessEventCallback(UA_Server *server, UA_UInt32 monitoredItemId,
+                      void *monitoredItemContext, const UA_KeyValueMap eventFields) {
+    ck_assert_uint_eq(eventFields.mapSize, 4);
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[0].value,
+                                       &UA_TYPES[UA_TYPES_UINT16]));
+    nodelessSeverity = *(UA_UInt16*)eventFields.map[0].value.data;
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[1].value,
+                                       &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]));
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[2].value,
+                                       &UA_TYPES[UA_TYPES_NODEID]));
+    ck_assert(UA_NodeId_equal((UA_NodeId*)eventFields.map[2].value.data, &eventType));
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[3].value,
+                                       &UA_TYPES[UA_TYPES_NODEID]));
+    UA_NodeId serverId = UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER);
+    ck_assert(UA_NodeId_equal((UA_NodeId*)eventFields.map[3].value.data, &serverId));
+    nodelessCount++;
+}
+
+/* Events without a node representation are filtered from the field map */
+START_TEST(emitNodelessEvents) {
+    UA_EventFilter ef;
+    UA_EventFilter_init(&ef);
+    ef.selectClauses = (UA_SimpleAttributeOperand *)
+            UA_Array_new(4, &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    ef.selectClausesSize = 4;
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[0], UA_STRING("/Severity"));
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[1], UA_STRING("/Message"));
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[2], UA_STRING("/EventType"));
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[3], UA_STRING("/SourceNode"));
+
+    /* Where clause: OfType(eventType) && Severity > 500 */
+    ef.whereClause.elements = (UA_ContentFilterElement*)
+        UA_Array_new(3, &UA_TYPES[UA_TYPES_CONTENTFILTERELEMENT]);
+    ef.whereClause.elementsSize = 3;
+    UA_ContentFilterElement *andElm = &ef.whereClause.elements[0];
+    andElm->filterOperator = UA_FILTEROPERATOR_AND;
+    andElm->filterOperands = (UA_ExtensionObject*)
+        UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    andElm->filterOperandsSize = 2;
+    UA_ElementOperand eo;
+    eo.index = 1;
+    UA_ExtensionObject_setValueCopy(&andElm->filterOperands[0], &eo,
+                                    &UA_TYPES[UA_TYPES_ELEMENTOPERAND]);
+    eo.index = 2;
+    UA_ExtensionObject_setValueCopy(&andElm->filterOperands[1], &eo,
+                                    &UA_TYPES[UA_TYPES_ELEMENTOPERAND]);
+
+    UA_ContentFilterElement *ofType = &ef.whereClause.elements[1];
+    ofType->filterOperator = UA_FILTEROPERATOR_OFTYPE;
+    ofType->filterOperands = (UA_ExtensionObject*)
+        UA_Array_new(1, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    ofType->filterOperandsSize = 1;
+    UA_LiteralOperand lo;
+    UA_Variant_setScalar(&lo.value, &eventType, &UA_TYPES[UA_TYPES_NODEID]);
+    UA_ExtensionObject_setValueCopy(&ofType->filterOperands[0], &lo,
+                                    &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+
+    UA_ContentFilterElement *gt = &ef.whereClause.elements[2];
+    gt->filterOperator = UA_FILTEROPERATOR_GREATERTHAN;
+    gt->filterOperands = (UA_ExtensionObject*)
+        UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    gt->filterOperandsSize = 2;
+    UA_ExtensionObject_setValueCopy(&gt->filterOperands[0], &ef.selectClauses[0],
+                                    &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    UA_UInt16 threshold = 500;
+    UA_Variant_setScalar(&lo.value, &threshold, &UA_TYPES[UA_TYPES_UINT16]);
+    UA_ExtensionObject_setValueCopy(&gt->filterOperands[1], &lo,
+                                    &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+
+    UA_MonitoredItemCreateResult res =
+        UA_Server_createEventMonitoredItem(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                           ef, NULL, nodelessEventCallback);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_GOOD);
+    UA_EventFilter_clear(&ef);
+
+    UA_UInt16 severity = 1000;
+    UA_LocalizedText message = UA_LOCALIZEDTEXT("en-US", "Generated Event");
+    UA_KeyValuePair fields[2];
+    fields[0].key = UA_QUALIFIEDNAME(0, "Severity");
+    UA_Variant_setScalar(&fields[0].value, &severity, &UA_TYPES[UA_TYPES_UINT16]);
+    fields[1].key = UA_QUALIFIEDNAME(0, "Message");
+    UA_Variant_setScalar(&fields[1].value, &message, &UA_TYPES[UA_TYPES_LOCALIZEDTEXT]);
+    UA_KeyValueMap map = {2, fields};
+
+    UA_ByteString eventId = UA_BYTESTRING_NULL;
+    UA_StatusCode retval =
+        UA_Server_emitEvent(server, eventType, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                            &map, &eventId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    ck_assert_uint_eq(eventId.length, 16);
+    UA_ByteString_clear(&eventId);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(nodelessCount, 1);
+    ck_assert_uint_eq(nodelessSeverity, 1000);
+
+    /* Filtered out by the where clause */
+    severity = 100;
+    retval = UA_Server_emitEvent(server, eventType, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                 &map, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(nodelessCount, 1);
+
+    /* Not of the filtered EventType */
+    severity = 1000;
+    retval = UA_Server_emitEvent(server, UA_NODEID_NUMERIC(0, UA_NS0ID_BASEEVENTTYPE),
+                                 UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER), &map, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(nodelessCount, 1);
+
+    /* Conditions cannot be emitted without a node */
+    retval = UA_Server_emitEvent(server, UA_NODEID_NUMERIC(0, UA_NS0ID_CONDITIONTYPE),
+                                 UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER), &map, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADINVALIDARGUMENT);
+} END_TEST
+
+static unsigned timeCount = 0;
+static UA_DateTime eventTime = 0;
+static UA_DateTime eventReceiveTime = 0;
+
+/* Time and ReceiveTime have the UtcTime DataType. Events emitted by the server
+ * during the shutdown are also received here. */
+static void
+timeFieldsCallback(UA_Server *server, UA_UInt32 monitoredItemId,
+                   void *monitoredItemContext, const UA_KeyValueMap eventFields) {
+    if(eventFields.mapSize != 2 ||
+       !UA_Variant_isScalar(&eventFields.map[0].value) ||
+       eventFields.map[0].value.type->typeKind != UA_DATATYPEKIND_DATETIME ||
+       !UA_Variant_isScalar(&eventFields.map[1].value) ||
+       eventFields.map[1].value.type->typeKind != UA_DATATYPEKIND_DATETIME)
+        return;
+    eventTime = *(UA_DateTime*)eventFields.map[0].value.data;
+    eventReceiveTime = *(UA_DateTime*)eventFields.map[1].value.data;
+    timeCount++;
+}
+
+/* The mandatory Time and ReceiveTime fields are set if they are not given */
+START_TEST(emitNodelessEventTimes) {
+    UA_EventFilter ef;
+    UA_EventFilter_init(&ef);
+    ef.selectClauses = (UA_SimpleAttributeOperand *)
+            UA_Array_new(2, &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    ef.selectClausesSize = 2;
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[0], UA_STRING("/Time"));
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[1], UA_STRING("/ReceiveTime"));
+    UA_MonitoredItemCreateResult res =
+        UA_Server_createEventMonitoredItem(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                           ef, NULL, timeFieldsCallback);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_GOOD);
+    UA_EventFilter_clear(&ef);
+
+    UA_StatusCode retval =
+        UA_Server_emitEvent(server, eventType, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                            NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(timeCount, 1);
+    ck_assert(eventTime > 0);
+    ck_assert(eventTime == eventReceiveTime);
+
+    /* The Time from the map is used */
+    UA_DateTime time = eventTime - UA_DATETIME_SEC;
+    UA_KeyValuePair field;
+    field.key = UA_QUALIFIEDNAME(0, "Time");
+    UA_Variant_setScalar(&field.value, &time, &UA_TYPES[UA_TYPES_DATETIME]);
+    UA_KeyValueMap map = {1, &field};
+    retval = UA_Server_emitEvent(server, eventType, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                 &map, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(timeCount, 2);
+    ck_assert(eventTime == time);
+    ck_assert(eventReceiveTime > time);
+} END_TEST
+
+static unsigned sharedCount = 0;
+
+static void
+sharedFieldsCallback(UA_Server *server, UA_UInt32 monitoredItemId,
+                     void *monitoredItemContext, const UA_KeyValueMap eventFields) {
+    ck_assert_uint_eq(eventFields.mapSize, 3);
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[0].value,
+                                       &UA_TYPES[UA_TYPES_UINT16]));
+    ck_assert(UA_Variant_hasScalarType(&eventFields.map[2].value,
+                                       &UA_TYPES[UA_TYPES_UINT16]));
+    ck_assert_uint_eq(*(UA_UInt16*)eventFields.map[0].value.data, 1000);
+    ck_assert_uint_eq(*(UA_UInt16*)eventFields.map[2].value.data, 1000);
+    ck_assert(UA_NodeId_equal((UA_NodeId*)eventFields.map[1].value.data, &eventType));
+    sharedCount++;
+}
+
+/* Select and where clauses share the resolved fields of the event. Two
+ * MonitoredItems with the same filter share the evaluation. */
+START_TEST(sharedFieldSlots) {
+    UA_EventFilter ef;
+    UA_EventFilter_init(&ef);
+    ef.selectClauses = (UA_SimpleAttributeOperand *)
+            UA_Array_new(3, &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    ef.selectClausesSize = 3;
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[0], UA_STRING("/Severity"));
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[1], UA_STRING("/EventType"));
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[2], UA_STRING("/Severity"));
+
+    /* Where clause: Severity > 200 (the Byte literal is cast to UInt16) */
+    UA_ContentFilterElement elm;
+    UA_ContentFilterElement_init(&elm);
+    elm.filterOperator = UA_FILTEROPERATOR_GREATERTHAN;
+    elm.filterOperands = (UA_ExtensionObject*)
+        UA_Array_new(2, &UA_TYPES[UA_TYPES_EXTENSIONOBJECT]);
+    elm.filterOperandsSize = 2;
+    UA_SimpleAttributeOperand *sao = UA_SimpleAttributeOperand_new();
+    UA_SimpleAttributeOperand_parse(sao, UA_STRING("/Severity"));
+    UA_ExtensionObject_setValue(&elm.filterOperands[0], sao,
+                                &UA_TYPES[UA_TYPES_SIMPLEATTRIBUTEOPERAND]);
+    UA_LiteralOperand *lo = UA_LiteralOperand_new();
+    UA_Byte minSeverity = 200;
+    UA_Variant_setScalarCopy(&lo->value, &minSeverity, &UA_TYPES[UA_TYPES_BYTE]);
+    UA_ExtensionObject_setValue(&elm.filterOperands[1], lo,
+                                &UA_TYPES[UA_TYPES_LITERALOPERAND]);
+    ef.whereClause.elements = &elm;
+    ef.whereClause.elementsSize = 1;
+
+    UA_MonitoredItemCreateResult res =
+        UA_Server_createEventMonitoredItem(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                           ef, NULL, sharedFieldsCallback);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_GOOD);
+    UA_MonitoredItemCreateResult res2 =
+        UA_Server_createEventMonitoredItem(server, UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER),
+                                           ef, NULL, sharedFieldsCallback);
+    ck_assert_uint_eq(res2.statusCode, UA_STATUSCODE_GOOD);
+    ef.whereClause.elements = NULL;
+    ef.whereClause.elementsSize = 0;
+    UA_ContentFilterElement_clear(&elm);
+    UA_EventFilter_clear(&ef);
+
+    /* Severity 1000 passes the filter */
+    UA_NodeId eventNodeId;
+    eventSetup(&eventNodeId);
+    UA_StatusCode retval =
+        UA_Server_triggerEvent(server, eventNodeId,
+                               UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER), NULL, false);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(sharedCount, 2);
+
+    /* The remaining MonitoredItem still uses the filter */
+    retval = UA_Server_deleteMonitoredItem(server, res2.monitoredItemId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_triggerEvent(server, eventNodeId,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER), NULL, false);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(sharedCount, 3);
+
+    /* Severity 10 is filtered out */
+    UA_UInt16 severity = 10;
+    UA_Variant value;
+    UA_Variant_setScalar(&value, &severity, &UA_TYPES[UA_TYPES_UINT16]);
+    retval = UA_Server_writeObjectProperty(server, eventNodeId,
+                                           UA_QUALIFIEDNAME(0, "Severity"), value);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_triggerEvent(server, eventNodeId,
+                                    UA_NODEID_NUMERIC(0, UA_NS0ID_SERVER), NULL, true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(sharedCount, 3);
+} END_TEST
+
+static unsigned notifierCount = 0;
+
+static void
+notifierCallback(UA_Server *server, UA_UInt32 monitoredItemId,
+                 void *monitoredItemContext, const UA_KeyValueMap eventFields) {
+    notifierCount++;
+}
+
+/* The cached notifier hierarchy follows reference changes */
+START_TEST(eventSourceCache) {
+    UA_ObjectAttributes oAttr = UA_ObjectAttributes_default;
+    UA_NodeId sourceId, notifierId;
+    UA_StatusCode retval =
+        UA_Server_addObjectNode(server, UA_NODEID_NULL, UA_NS0ID(OBJECTSFOLDER),
+                                UA_NS0ID(ORGANIZES), UA_QUALIFIEDNAME(1, "Source"),
+                                UA_NS0ID(BASEOBJECTTYPE), oAttr, NULL, &sourceId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    oAttr.eventNotifier = UA_EVENTNOTIFIER_SUBSCRIBE_TO_EVENT;
+    retval = UA_Server_addObjectNode(server, UA_NODEID_NULL, UA_NS0ID(OBJECTSFOLDER),
+                                     UA_NS0ID(ORGANIZES), UA_QUALIFIEDNAME(1, "Notifier"),
+                                     UA_NS0ID(BASEOBJECTTYPE), oAttr, NULL, &notifierId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+
+    UA_EventFilter ef;
+    UA_EventFilter_init(&ef);
+    ef.selectClauses = UA_SimpleAttributeOperand_new();
+    ef.selectClausesSize = 1;
+    UA_SimpleAttributeOperand_parse(&ef.selectClauses[0], UA_STRING("/EventId"));
+    UA_MonitoredItemCreateResult res =
+        UA_Server_createEventMonitoredItem(server, notifierId, ef, NULL, notifierCallback);
+    ck_assert_uint_eq(res.statusCode, UA_STATUSCODE_GOOD);
+    UA_EventFilter_clear(&ef);
+
+    /* The notifier does not emit the events of the source */
+    UA_NodeId baseEventType = UA_NS0ID(BASEEVENTTYPE);
+    retval = UA_Server_emitEvent(server, baseEventType, sourceId, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(notifierCount, 0);
+
+    /* The new reference invalidates the cached hierarchy of the source */
+    retval = UA_Server_addReference(server, notifierId, UA_NS0ID(HASEVENTSOURCE),
+                                    UA_EXPANDEDNODEID_NODEID(sourceId), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_emitEvent(server, baseEventType, sourceId, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(notifierCount, 1);
+
+    /* Events on a node-based event also use the cache */
+    UA_NodeId eventNodeId;
+    retval = UA_Server_createEvent(server, eventType, &eventNodeId);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_triggerEvent(server, eventNodeId, sourceId, NULL, true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(notifierCount, 2);
+
+    /* Removing the reference stops the propagation */
+    retval = UA_Server_deleteReference(server, notifierId, UA_NS0ID(HASEVENTSOURCE),
+                                       true, UA_EXPANDEDNODEID_NODEID(sourceId), true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_emitEvent(server, baseEventType, sourceId, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    UA_Server_run_iterate(server, false);
+    ck_assert_uint_eq(notifierCount, 2);
+
+    /* Deleted sources are no longer valid */
+    retval = UA_Server_deleteNode(server, sourceId, true);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_GOOD);
+    retval = UA_Server_emitEvent(server, baseEventType, sourceId, NULL, NULL);
+    ck_assert_uint_eq(retval, UA_STATUSCODE_BADNOTFOUND);
+} END_TEST
+
 static Suite *testSuite_event(void) {
     Suite *s = suite_create("Server Local Subscription Events");
     TCase *tc_server = tcase_create("Server Local Subscription Events");
     tcase_add_unchecked_fixture(tc_server, setup, teardown);
     tcase_add_test(tc_server, generateEvents);
+    tcase_add_test(tc_server, emitNodelessEvents);
+    tcase_add_test(tc_server, emitNodelessEventTimes);
+    tcase_add_test(tc_server, sharedFieldSlots);
+    tcase_add_test(tc_server, eventSourceCache);
     suite_add_tcase(s, tc_server);
     return s;
 }